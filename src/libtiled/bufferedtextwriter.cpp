@@ -0,0 +1,123 @@
+/*
+ * bufferedtextwriter.cpp
+ * Copyright 2016, Tiled contributors
+ *
+ * This file is part of libtiled.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *    1. Redistributions of source code must retain the above copyright notice,
+ *       this list of conditions and the following disclaimer.
+ *
+ *    2. Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE CONTRIBUTORS ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO
+ * EVENT SHALL THE CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ * OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+ * ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "bufferedtextwriter.h"
+
+#include <QIODevice>
+
+using namespace Tiled;
+
+/**
+ * Writes the decimal representation of \a value into the characters before
+ * \a end and returns a pointer to its first character.
+ */
+static inline char *formatUnsigned(char *end, unsigned value)
+{
+    char *p = end;
+    do {
+        *--p = char('0' + value % 10);
+        value /= 10;
+    } while (value);
+    return p;
+}
+
+BufferedTextWriter::BufferedTextWriter(QIODevice *device)
+    : mDevice(device)
+    , mError(false)
+{
+    mBuffer.reserve(BufferSize);
+}
+
+/**
+ * Writes any remaining buffered text to the device.
+ */
+BufferedTextWriter::~BufferedTextWriter()
+{
+    flush();
+}
+
+void BufferedTextWriter::writeNumber(int value)
+{
+    char buffer[12];
+    char *end = buffer + sizeof(buffer);
+    char *start;
+
+    if (value < 0) {
+        start = formatUnsigned(end, 0u - unsigned(value));
+        *--start = '-';
+    } else {
+        start = formatUnsigned(end, unsigned(value));
+    }
+
+    write(start, int(end - start));
+}
+
+void BufferedTextWriter::writeNumber(unsigned value)
+{
+    char buffer[12];
+    char *end = buffer + sizeof(buffer);
+    char *start = formatUnsigned(end, value);
+
+    write(start, int(end - start));
+}
+
+/**
+ * Writes \a count numbers from \a values, separated by \a separator.
+ */
+void BufferedTextWriter::writeNumbers(const unsigned *values, int count,
+                                      const char *separator)
+{
+    const int separatorLength = int(qstrlen(separator));
+
+    char buffer[12];
+    char *end = buffer + sizeof(buffer);
+
+    for (int i = 0; i < count; ++i) {
+        if (i > 0)
+            mBuffer.append(separator, separatorLength);
+
+        char *start = formatUnsigned(end, values[i]);
+        mBuffer.append(start, int(end - start));
+
+        flushIfFull();
+    }
+}
+
+/**
+ * Writes the buffered text to the device.
+ */
+void BufferedTextWriter::flush()
+{
+    if (mBuffer.isEmpty())
+        return;
+
+    if (mDevice->write(mBuffer) != mBuffer.size())
+        mError = true;
+
+    mBuffer.resize(0);
+}
@@ -0,0 +1,105 @@
+/*
+ * bufferedtextwriter.h
+ * Copyright 2016, Tiled contributors
+ *
+ * This file is part of libtiled.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *    1. Redistributions of source code must retain the above copyright notice,
+ *       this list of conditions and the following disclaimer.
+ *
+ *    2. Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE CONTRIBUTORS ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO
+ * EVENT SHALL THE CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ * OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+ * ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef BUFFEREDTEXTWRITER_H
+#define BUFFEREDTEXTWRITER_H
+
+#include "tiled_global.h"
+
+#include <QByteArray>
+
+class QIODevice;
+
+namespace Tiled {
+
+/**
+ * Writes text to a device through a large buffer. Provides fast functions
+ * for writing out numbers, which are used by the text based map formats to
+ * write out tile layer data.
+ */
+class TILEDSHARED_EXPORT BufferedTextWriter
+{
+public:
+    explicit BufferedTextWriter(QIODevice *device);
+    ~BufferedTextWriter();
+
+    void write(char c);
+    void write(const char *bytes, int length);
+    void write(const char *bytes);
+    void write(const QByteArray &bytes);
+
+    void writeNumber(int value);
+    void writeNumber(unsigned value);
+
+    void writeNumbers(const unsigned *values, int count,
+                      const char *separator);
+
+    void flush();
+
+    /**
+     * Returns whether writing to the device failed.
+     */
+    bool hasError() const { return mError; }
+
+private:
+    enum { BufferSize = 64 * 1024 };
+
+    void flushIfFull();
+
+    QIODevice *mDevice;
+    QByteArray mBuffer;
+    bool mError;
+};
+
+inline void BufferedTextWriter::flushIfFull()
+{
+    if (mBuffer.size() >= BufferSize)
+        flush();
+}
+
+inline void BufferedTextWriter::write(char c)
+{
+    mBuffer.append(c);
+    flushIfFull();
+}
+
+inline void BufferedTextWriter::write(const char *bytes, int length)
+{
+    mBuffer.append(bytes, length);
+    flushIfFull();
+}
+
+inline void BufferedTextWriter::write(const char *bytes)
+{ write(bytes, int(qstrlen(bytes))); }
+
+inline void BufferedTextWriter::write(const QByteArray &bytes)
+{ write(bytes.constData(), bytes.size()); }
+
+} // namespace Tiled
+
+#endif // BUFFEREDTEXTWRITER_H
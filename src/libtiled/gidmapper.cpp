@@ -34,10 +34,20 @@
 
 using namespace Tiled;
 
-// Bits on the far end of the 32-bit global tile ID are used for tile flags
-const int FlippedHorizontallyFlag   = 0x80000000;
-const int FlippedVerticallyFlag     = 0x40000000;
-const int FlippedAntiDiagonallyFlag = 0x20000000;
+/**
+ * Returns the given \a gid with the flip flags of \a cell applied.
+ */
+static inline unsigned withFlags(unsigned gid, const Cell &cell)
+{
+    if (cell.flippedHorizontally)
+        gid |= FlippedHorizontallyFlag;
+    if (cell.flippedVertically)
+        gid |= FlippedVerticallyFlag;
+    if (cell.flippedAntiDiagonally)
+        gid |= FlippedAntiDiagonallyFlag;
+
+    return gid;
+}
 
 /**
  * Default constructor. Use \l insert to initialize the gid mapper
@@ -61,11 +71,45 @@ GidMapper::GidMapper(const QVector<SharedTileset> &tilesets)
     }
 }
 
+/**
+ * Insert the given \a tileset with \a firstGid as its first global ID.
+ */
+void GidMapper::insert(unsigned firstGid, Tileset *tileset)
+{
+    mFirstGidToTileset.insert(firstGid, tileset);
+
+    // When a tileset is inserted more than once, its lowest gid is used
+    QHash<const Tileset*, unsigned>::iterator it = mTilesetToFirstGid.find(tileset);
+    if (it == mTilesetToFirstGid.end())
+        mTilesetToFirstGid.insert(tileset, firstGid);
+    else if (firstGid < it.value())
+        it.value() = firstGid;
+}
+
 /**
  * Returns the cell data matched by the given \a gid. The \a ok parameter
  * indicates whether an error occurred.
+ *
+ * Tiles that don't exist yet in their tileset are created.
  */
 Cell GidMapper::gidToCell(unsigned gid, bool &ok) const
+{
+    return toCell(gid, ok, true);
+}
+
+/**
+ * Returns the cell data matched by the given \a gid, like gidToCell(). Unlike
+ * that function, this never creates tiles, so \a ok is also set to false
+ * when the tile doesn't exist.
+ *
+ * Useful when the tilesets may be shared with other maps.
+ */
+Cell GidMapper::findCell(unsigned gid, bool &ok) const
+{
+    return toCell(gid, ok, false);
+}
+
+Cell GidMapper::toCell(unsigned gid, bool &ok, bool createTiles) const
 {
     Cell result;
 
@@ -94,9 +138,13 @@ Cell GidMapper::gidToCell(unsigned gid, bool &ok) const
             int tileId = gid - i.key();
             Tileset *tileset = i.value();
 
-            result.tile = tileset->findOrCreateTile(tileId);
-
-            ok = true;
+            if (createTiles) {
+                result.tile = tileset->findOrCreateTile(tileId);
+                ok = true;
+            } else {
+                result.tile = tileset->findTile(tileId);
+                ok = result.tile != nullptr;
+            }
         }
     }
 
@@ -112,26 +160,51 @@ unsigned GidMapper::cellToGid(const Cell &cell) const
     if (cell.isEmpty())
         return 0;
 
-    const Tileset *tileset = cell.tile->tileset();
-
     // Find the first GID for the tileset
-    QMap<unsigned, Tileset*>::const_iterator i = mFirstGidToTileset.begin();
-    QMap<unsigned, Tileset*>::const_iterator i_end = mFirstGidToTileset.end();
-    while (i != i_end && i.value() != tileset)
-        ++i;
+    QHash<const Tileset*, unsigned>::const_iterator i =
+            mTilesetToFirstGid.find(cell.tile->tileset());
 
-    if (i == i_end) // tileset not found
+    if (i == mTilesetToFirstGid.end()) // tileset not found
         return 0;
 
-    unsigned gid = i.key() + cell.tile->id();
-    if (cell.flippedHorizontally)
-        gid |= FlippedHorizontallyFlag;
-    if (cell.flippedVertically)
-        gid |= FlippedVerticallyFlag;
-    if (cell.flippedAntiDiagonally)
-        gid |= FlippedAntiDiagonallyFlag;
+    return withFlags(i.value() + cell.tile->id(), cell);
+}
 
-    return gid;
+/**
+ * Returns the global IDs of all the cells of \a tileLayer, row by row.
+ *
+ * This is faster than calling cellToGid for each cell, since the tileset
+ * lookup is skipped while consecutive cells use the same tileset.
+ */
+QVector<unsigned> GidMapper::cellsToGids(const TileLayer &tileLayer) const
+{
+    QVector<unsigned> gids;
+    gids.reserve(tileLayer.width() * tileLayer.height());
+
+    const Tileset *lastTileset = nullptr;
+    unsigned firstGid = 0;
+    bool found = false;
+
+    for (const Cell &cell : tileLayer) {
+        if (cell.isEmpty()) {
+            gids.append(0);
+            continue;
+        }
+
+        const Tileset *tileset = cell.tile->tileset();
+        if (tileset != lastTileset) {
+            QHash<const Tileset*, unsigned>::const_iterator i =
+                    mTilesetToFirstGid.find(tileset);
+
+            lastTileset = tileset;
+            found = i != mTilesetToFirstGid.end();
+            firstGid = found ? i.value() : 0;
+        }
+
+        gids.append(found ? withFlags(firstGid + cell.tile->id(), cell) : 0);
+    }
+
+    return gids;
 }
 
 /**
@@ -145,17 +218,16 @@ QByteArray GidMapper::encodeLayerData(const TileLayer &tileLayer,
     Q_ASSERT(format != Map::XML);
     Q_ASSERT(format != Map::CSV);
 
+    const QVector<unsigned> gids = cellsToGids(tileLayer);
+
     QByteArray tileData;
-    tileData.reserve(tileLayer.height() * tileLayer.width() * 4);
-
-    for (int y = 0; y < tileLayer.height(); ++y) {
-        for (int x = 0; x < tileLayer.width(); ++x) {
-            const unsigned gid = cellToGid(tileLayer.cellAt(x, y));
-            tileData.append((char) (gid));
-            tileData.append((char) (gid >> 8));
-            tileData.append((char) (gid >> 16));
-            tileData.append((char) (gid >> 24));
-        }
+    tileData.reserve(gids.size() * 4);
+
+    for (const unsigned gid : gids) {
+        tileData.append((char) (gid));
+        tileData.append((char) (gid >> 8));
+        tileData.append((char) (gid >> 16));
+        tileData.append((char) (gid >> 24));
     }
 
     if (format == Map::Base64Gzip)
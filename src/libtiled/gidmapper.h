@@ -32,10 +32,17 @@
 #include "map.h"
 #include "tilelayer.h"
 
+#include <QHash>
 #include <QMap>
+#include <QVector>
 
 namespace Tiled {
 
+// Bits on the far end of the 32-bit global tile ID are used for tile flags
+const unsigned FlippedHorizontallyFlag   = 0x80000000;
+const unsigned FlippedVerticallyFlag     = 0x40000000;
+const unsigned FlippedAntiDiagonallyFlag = 0x20000000;
+
 /**
  * A class that maps cells to global IDs (gids) and back.
  */
@@ -50,7 +57,9 @@ public:
     bool isEmpty() const;
 
     Cell gidToCell(unsigned gid, bool &ok) const;
+    Cell findCell(unsigned gid, bool &ok) const;
     unsigned cellToGid(const Cell &cell) const;
+    QVector<unsigned> cellsToGids(const TileLayer &tileLayer) const;
 
     QByteArray encodeLayerData(const TileLayer &tileLayer,
                                Map::LayerDataFormat format) const;
@@ -69,26 +78,22 @@ public:
     unsigned invalidTile() const;
 
 private:
+    Cell toCell(unsigned gid, bool &ok, bool createTiles) const;
+
     QMap<unsigned, Tileset*> mFirstGidToTileset;
+    QHash<const Tileset*, unsigned> mTilesetToFirstGid;
 
     mutable unsigned mInvalidTile;
 };
 
 
-/**
- * Insert the given \a tileset with \a firstGid as its first global ID.
- */
-inline void GidMapper::insert(unsigned firstGid, Tileset *tileset)
-{
-    mFirstGidToTileset.insert(firstGid, tileset);
-}
-
 /**
  * Clears the gid mapper, so that it can be reused.
  */
 inline void GidMapper::clear()
 {
     mFirstGidToTileset.clear();
+    mTilesetToFirstGid.clear();
 }
 
 /**
@@ -160,8 +160,8 @@ void HexagonalRenderer::drawGrid(QPainter *painter, const QRectF &exposed,
         QPoint(p.sideOffsetX,               p.tileHeight)
     };
 
+    // All lines are collected first, so they can be drawn in one go
     QVector<QLine> lines;
-    lines.reserve(8);
 
     gridColor.setAlpha(128);
 
@@ -200,9 +200,6 @@ void HexagonalRenderer::drawGrid(QPainter *painter, const QRectF &exposed,
                 if (bottomLeft)
                     lines.append(QLine(rowPos + oct[7], rowPos + oct[0]));
 
-                painter->drawLines(lines);
-                lines.resize(0);
-
                 rowPos.ry() += p.tileHeight + p.sideLengthY;
             }
 
@@ -238,15 +235,14 @@ void HexagonalRenderer::drawGrid(QPainter *painter, const QRectF &exposed,
                 if (bottomLeft)
                     lines.append(QLine(rowPos + oct[7], rowPos + oct[0]));
 
-                painter->drawLines(lines);
-                lines.resize(0);
-
                 rowPos.rx() += p.tileWidth + p.sideLengthX;
             }
 
             startPos.ry() += p.rowHeight;
         }
     }
+
+    painter->drawLines(lines);
 }
 
 void HexagonalRenderer::drawTileLayer(QPainter *painter,
@@ -290,7 +286,7 @@ void HexagonalRenderer::drawTileLayer(QPainter *painter,
     if (inLeftHalf)
         startTile.rx()--;
 
-    CellRenderer renderer(painter);
+    CellRenderer renderer(painter, tileImages());
 
     if (p.staggerX) {
         startTile.setX(qMax(-1, startTile.x()));
@@ -305,15 +301,21 @@ void HexagonalRenderer::drawTileLayer(QPainter *painter,
             QPoint rowTile = startTile;
             QPoint rowPos = startPos;
 
-            for (; rowPos.x() < rect.right() && rowTile.x() < layer->width(); rowTile.rx() += 2) {
-                if (layer->contains(rowTile)) {
+            // The start tile may be one column or row outside of the layer
+            if (rowTile.x() < 0) {
+                rowTile.rx() += 2;
+                rowPos.rx() += p.tileWidth + p.sideLengthX;
+            }
+
+            if (rowTile.y() >= 0) {
+                for (; rowPos.x() < rect.right() && rowTile.x() < layer->width(); rowTile.rx() += 2) {
                     const Cell &cell = layer->cellAt(rowTile);
 
                     if (!cell.isEmpty())
                         renderer.render(cell, rowPos, QSizeF(0, 0), CellRenderer::BottomLeft);
-                }
 
-                rowPos.rx() += p.tileWidth + p.sideLengthX;
+                    rowPos.rx() += p.tileWidth + p.sideLengthX;
+                }
             }
 
             if (staggeredRow) {
@@ -369,7 +371,14 @@ void HexagonalRenderer::drawTileSelection(QPainter *painter,
     painter->setBrush(color);
     painter->setPen(Qt::NoPen);
 
-    foreach (const QRect &r, region.rects()) {
+    // Only look at the tiles that can be visible in the exposed area
+    const QPoint topLeft = screenToTileCoords(exposed.topLeft()).toPoint();
+    const QPoint bottomRight = screenToTileCoords(exposed.bottomRight()).toPoint();
+    const QRect exposedTiles = QRect(topLeft, bottomRight).adjusted(-1, -1, 1, 1);
+
+    foreach (const QRect &regionRect, region.rects()) {
+        const QRect r = regionRect.intersected(exposedTiles);
+
         for (int y = r.top(); y <= r.bottom(); ++y) {
             for (int x = r.left(); x <= r.right(); ++x) {
                 const QPolygonF polygon = tileToScreenPolygon(x, y);
@@ -380,6 +389,23 @@ void HexagonalRenderer::drawTileSelection(QPainter *painter,
     }
 }
 
+QPainterPath HexagonalRenderer::tileRegionShape(const QRegion &region) const
+{
+    QPainterPath path;
+    path.setFillRule(Qt::WindingFill);
+
+    foreach (const QRect &r, region.rects()) {
+        for (int y = r.top(); y <= r.bottom(); ++y) {
+            for (int x = r.left(); x <= r.right(); ++x) {
+                path.addPolygon(tileToScreenPolygon(x, y));
+                path.closeSubpath();
+            }
+        }
+    }
+
+    return path.simplified();
+}
+
 QPointF HexagonalRenderer::tileToPixelCoords(qreal x, qreal y) const
 {
     return HexagonalRenderer::tileToScreenCoords(x, y);
@@ -85,6 +85,8 @@ public:
                            const QColor &color,
                            const QRectF &exposed) const override;
 
+    QPainterPath tileRegionShape(const QRegion &region) const override;
+
     using OrthogonalRenderer::pixelToTileCoords;
     QPointF pixelToTileCoords(qreal x, qreal y) const override;
 
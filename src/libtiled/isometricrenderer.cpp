@@ -34,10 +34,16 @@
 #include "tilelayer.h"
 #include "tileset.h"
 
-#include <cmath>
-
 using namespace Tiled;
 
+/**
+ * Integer division rounding towards negative infinity, for positive \a b.
+ */
+static inline int floorDiv(int a, int b)
+{
+    return a >= 0 ? a / b : -((-a + b - 1) / b);
+}
+
 QSize IsometricRenderer::mapSize() const
 {
     // Map width and height contribute equally in both directions
@@ -158,16 +164,21 @@ void IsometricRenderer::drawGrid(QPainter *painter, const QRectF &rect,
     gridPen.setDashPattern(QVector<qreal>() << 2 << 2);
     painter->setPen(gridPen);
 
+    QVector<QLineF> lines;
+    lines.reserve(qMax(0, endY - startY + 1) + qMax(0, endX - startX + 1));
+
     for (int y = startY; y <= endY; ++y) {
         const QPointF start = tileToScreenCoords(startX, y);
         const QPointF end = tileToScreenCoords(endX, y);
-        painter->drawLine(start, end);
+        lines.append(QLineF(start, end));
     }
     for (int x = startX; x <= endX; ++x) {
         const QPointF start = tileToScreenCoords(x, startY);
         const QPointF end = tileToScreenCoords(x, endY);
-        painter->drawLine(start, end);
+        lines.append(QLineF(start, end));
     }
+
+    painter->drawLines(lines);
 }
 
 void IsometricRenderer::drawTileLayer(QPainter *painter,
@@ -193,69 +204,58 @@ void IsometricRenderer::drawTileLayer(QPainter *painter,
                 drawMargins.left(),
                 drawMargins.top());
 
-    // Determine the tile and pixel coordinates to start at
-    QPointF tilePos = screenToTileCoords(rect.x(), rect.y());
-    QPoint rowItr = QPoint((int) std::floor(tilePos.x()),
-                           (int) std::floor(tilePos.y()));
-    QPointF startPos = tileToScreenCoords(rowItr);
-    startPos.rx() -= tileWidth / 2;
-    startPos.ry() += tileHeight;
-
-    // Compensate for the layer position
-    rowItr -= QPoint(layer->x(), layer->y());
-
-    /* Determine in which half of the tile the top-left corner of the area we
-     * need to draw is. If we're in the upper half, we need to start one row
-     * up due to those tiles being visible as well. How we go up one row
-     * depends on whether we're in the left or right half of the tile.
+    /* Each screen row contains the tiles for which x + y is the same, with
+     * x - y increasing by two from one tile to the next. This allows
+     * determining the visible range of each row up front, using integers
+     * only, instead of checking each tile that is passed on the way.
+     *
+     * Below, a tile is identified by its map coordinates. The bottom-left
+     * corner of its image is at ((x - y - 1) * tileWidth / 2 + originX,
+     * (x + y + 2) * tileHeight / 2).
      */
-    const bool inUpperHalf = startPos.y() - rect.y() > tileHeight / 2;
-    const bool inLeftHalf = rect.x() - startPos.x() < tileWidth / 2;
-
-    if (inUpperHalf) {
-        if (inLeftHalf) {
-            --rowItr.rx();
-            startPos.rx() -= tileWidth / 2;
-        } else {
-            --rowItr.ry();
-            startPos.rx() += tileWidth / 2;
-        }
-        startPos.ry() -= tileHeight / 2;
-    }
+    const int originX = map()->height() * tileWidth / 2;
 
-    // Determine whether the current row is shifted half a tile to the right
-    bool shifted = inUpperHalf ^ inLeftHalf;
+    const int left = rect.left();
+    const int top = rect.top();
+    const int right = rect.left() + rect.width();
+    const int bottom = rect.top() + rect.height();
 
-    CellRenderer renderer(painter);
+    // Range of x - y for which tiles overlap horizontally with the rect
+    const int minDiff = floorDiv(2 * (left - originX), tileWidth);
+    const int maxDiff = -floorDiv(-2 * (right - originX), tileWidth);
 
-    for (int y = startPos.y() * 2; y - tileHeight * 2 < rect.bottom() * 2;
-         y += tileHeight)
-    {
-        QPoint columnItr = rowItr;
+    // Range of x + y for which tiles overlap vertically with the rect
+    const int layerX = layer->x();
+    const int layerY = layer->y();
+    const int minSum = qMax(floorDiv(2 * top, tileHeight) - 1,
+                            layerX + layerY);
+    const int maxSum = qMin(-floorDiv(-2 * bottom, tileHeight) - 1,
+                            layerX + layerY + layer->width() + layer->height() - 2);
 
-        for (int x = startPos.x(); x < rect.right(); x += tileWidth) {
-            if (layer->contains(columnItr)) {
-                const Cell &cell = layer->cellAt(columnItr);
-                if (!cell.isEmpty()) {
-                    renderer.render(cell, QPointF(x, (float)y / 2), QSizeF(0, 0),
-                                    CellRenderer::BottomLeft);
-                }
-            }
+    CellRenderer renderer(painter, tileImages());
 
-            // Advance to the next column
-            ++columnItr.rx();
-            --columnItr.ry();
-        }
+    for (int sum = minSum; sum <= maxSum; ++sum) {
+        // Intersect the visible range with the range covered by the layer
+        int startX = -floorDiv(-(sum + minDiff), 2);
+        int endX = floorDiv(sum + maxDiff, 2);
+        startX = qMax(startX, qMax(layerX, sum - layerY - layer->height() + 1));
+        endX = qMin(endX, qMin(layerX + layer->width() - 1, sum - layerY));
+
+        if (startX > endX)
+            continue;
+
+        QPointF pos((2 * startX - sum - 1) * tileWidth / qreal(2) + originX,
+                    (sum + 2) * tileHeight / qreal(2));
+
+        int x = startX - layerX;
+        int y = sum - startX - layerY;
+
+        for (int end = endX - layerX; x <= end; ++x, --y) {
+            const Cell &cell = layer->cellAt(x, y);
+            if (!cell.isEmpty())
+                renderer.render(cell, pos, QSizeF(0, 0), CellRenderer::BottomLeft);
 
-        // Advance to the next row
-        if (!shifted) {
-            ++rowItr.rx();
-            startPos.rx() += tileWidth / 2;
-            shifted = true;
-        } else {
-            ++rowItr.ry();
-            startPos.rx() -= tileWidth / 2;
-            shifted = false;
+            pos.rx() += tileWidth;
         }
     }
 }
@@ -291,8 +291,8 @@ void IsometricRenderer::drawMapObject(QPainter *painter,
         const QPointF pos = pixelToScreenCoords(object->position());
         const QPointF tileOffset = tile->offset();
 
-        CellRenderer(painter).render(cell, pos, object->size(),
-                                     CellRenderer::BottomCenter);
+        CellRenderer(painter, tileImages()).render(cell, pos, object->size(),
+                                                   CellRenderer::BottomCenter);
 
         if (testFlag(ShowTileObjectOutlines)) {
             QRectF rect(QPointF(pos.x() - imgSize.width() / 2 + tileOffset.x(),
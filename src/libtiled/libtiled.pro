@@ -25,6 +25,7 @@ DEFINES += TILED_LIBRARY
 contains(QT_CONFIG, reduce_exports): CONFIG += hide_symbols
 
 SOURCES += compression.cpp \
+    bufferedtextwriter.cpp \
     gidmapper.cpp \
     hexagonalrenderer.cpp \
     imagelayer.cpp \
@@ -32,6 +33,7 @@ SOURCES += compression.cpp \
     isometricrenderer.cpp \
     layer.cpp \
     map.cpp \
+    mapcompositor.cpp \
     mapobject.cpp \
     mapreader.cpp \
     maprenderer.cpp \
@@ -42,13 +44,18 @@ SOURCES += compression.cpp \
     plugin.cpp \
     pluginmanager.cpp \
     properties.cpp \
+    regionbuilder.cpp \
+    selectionmask.cpp \
     staggeredrenderer.cpp \
+    terrainmatchindex.cpp \
     tile.cpp \
     tilelayer.cpp \
     tileset.cpp \
     tilesetformat.cpp \
+    tileusageindex.cpp \
     varianttomapconverter.cpp
 HEADERS += compression.h \
+    bufferedtextwriter.h \
     gidmapper.h \
     hexagonalrenderer.h \
     imagelayer.h \
@@ -57,6 +64,7 @@ HEADERS += compression.h \
     layer.h \
     logginginterface.h \
     map.h \
+    mapcompositor.h \
     mapformat.h \
     mapobject.h \
     mapreader.h \
@@ -69,14 +77,18 @@ HEADERS += compression.h \
     plugin.h \
     pluginmanager.h \
     properties.h \
+    regionbuilder.h \
+    selectionmask.h \
     staggeredrenderer.h \
     terrain.h \
+    terrainmatchindex.h \
     tile.h \
     tiled.h \
     tiled_global.h \
     tilelayer.h \
     tileset.h \
     tilesetformat.h \
+    tileusageindex.h \
     varianttomapconverter.h
 
 contains(INSTALL_HEADERS, yes) {
@@ -0,0 +1,355 @@
+/*
+ * mapcompositor.cpp
+ * Copyright 2016, Tiled contributors
+ *
+ * This file is part of libtiled.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *    1. Redistributions of source code must retain the above copyright notice,
+ *       this list of conditions and the following disclaimer.
+ *
+ *    2. Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE CONTRIBUTORS ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO
+ * EVENT SHALL THE CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ * OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+ * ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "mapcompositor.h"
+
+#include "imagelayer.h"
+#include "map.h"
+#include "mapobject.h"
+#include "maprenderer.h"
+#include "objectgroup.h"
+#include "tile.h"
+#include "tilelayer.h"
+#include "tileset.h"
+
+#include <QAtomicInt>
+#include <QHash>
+#include <QImage>
+#include <QPainter>
+#include <QRunnable>
+#include <QSemaphore>
+#include <QThreadPool>
+
+using namespace Tiled;
+
+namespace {
+
+/**
+ * Bands smaller than this are not worth the overhead of drawing each layer
+ * several times.
+ */
+const int MinimumBandHeight = 128;
+
+/**
+ * Helps drawing the bands on one of the threads in the pool.
+ */
+class BandTask : public QRunnable
+{
+public:
+    BandTask(const std::function<void ()> &drawBands, QSemaphore *done)
+        : mDrawBands(drawBands)
+        , mDone(done)
+    {}
+
+    void run() override
+    {
+        mDrawBands();
+        mDone->release();
+    }
+
+private:
+    std::function<void ()> mDrawBands;
+    QSemaphore *mDone;
+};
+
+} // anonymous namespace
+
+/**
+ * Everything the bands need that can't be accessed from other threads,
+ * prepared on the calling thread.
+ */
+struct MapCompositor::BandData
+{
+    TileImages tileImages;
+    QHash<const ImageLayer*, QImage> layerImages;
+    QHash<const MapObject*, QColor> objectColors;
+};
+
+static bool objectLessThan(const MapObject *a, const MapObject *b)
+{
+    return a->y() < b->y();
+}
+
+static bool canPaintInBands(const QImage &image)
+{
+    switch (image.format()) {
+    case QImage::Format_RGB32:
+    case QImage::Format_ARGB32:
+    case QImage::Format_ARGB32_Premultiplied:
+        return image.devicePixelRatio() == 1;
+    default:
+        return false;
+    }
+}
+
+MapCompositor::MapCompositor(MapRenderer *renderer)
+    : mRenderer(renderer)
+{
+}
+
+void MapCompositor::setLayerFilter(const LayerFilter &filter)
+{
+    mLayerFilter = filter;
+}
+
+void MapCompositor::setObjectColorFunction(const ObjectColorFunction &function)
+{
+    mObjectColorFunction = function;
+}
+
+void MapCompositor::render(QPainter *painter) const
+{
+    QList<const Layer*> layers;
+    for (const Layer *layer : mRenderer->map()->layers())
+        if (!mLayerFilter || mLayerFilter(layer))
+            layers.append(layer);
+
+    QImage *image = nullptr;
+    if (painter->device()->devType() == QInternal::Image && !painter->hasClipping())
+        image = static_cast<QImage*>(painter->device());
+
+    int bandCount = 1;
+    if (image && canPaintInBands(*image)) {
+        bandCount = qMin(QThreadPool::globalInstance()->maxThreadCount(),
+                         image->height() / MinimumBandHeight);
+    }
+
+    if (bandCount <= 1) {
+        painter->save();
+        drawLayers(painter, layers, QRectF(), nullptr);
+        painter->restore();
+        return;
+    }
+
+    BandData data;
+    prepareBands(layers, data);
+
+    const TileImages *previousTileImages = mRenderer->tileImages();
+    mRenderer->setTileImages(&data.tileImages);
+
+    // Each band paints directly on the rows of the image it covers
+    const QTransform transform = painter->transform();
+    const QPainter::RenderHints renderHints = painter->renderHints();
+    const QPainter::CompositionMode compositionMode = painter->compositionMode();
+    const int bandHeight = (image->height() + bandCount - 1) / bandCount;
+    QAtomicInt nextBand(0);
+
+    auto drawBands = [&] {
+        int band;
+        while ((band = nextBand.fetchAndAddRelaxed(1)) < bandCount) {
+            const int top = band * bandHeight;
+            const int height = qMin(bandHeight, image->height() - top);
+            if (height <= 0)
+                continue;
+
+            // Wrap the rows without detaching the image being painted on
+            QImage bandImage(const_cast<uchar*>(image->constScanLine(top)),
+                             image->width(), height,
+                             image->bytesPerLine(), image->format());
+
+            QPainter bandPainter(&bandImage);
+            bandPainter.setRenderHints(renderHints);
+            bandPainter.setCompositionMode(compositionMode);
+            bandPainter.setTransform(transform * QTransform::fromTranslate(0, -top));
+
+            const QRectF bandRect(0, 0, bandImage.width(), bandImage.height());
+            const QRectF exposed = bandPainter.transform().inverted().mapRect(bandRect);
+
+            drawLayers(&bandPainter, layers, exposed, &data);
+        }
+    };
+
+    // Only use threads that are available right away, since waiting for busy
+    // ones would not speed things up
+    QSemaphore done;
+    int helpers = 0;
+    while (helpers < bandCount - 1) {
+        BandTask *task = new BandTask(drawBands, &done);
+        if (!QThreadPool::globalInstance()->tryStart(task)) {
+            delete task;
+            break;
+        }
+        ++helpers;
+    }
+
+    drawBands();
+    done.acquire(helpers);
+
+    mRenderer->setTileImages(previousTileImages);
+}
+
+static void addTileImage(TileImages &tileImages, const Tile *tile)
+{
+    if (!tileImages.contains(tile))
+        tileImages.insert(tile, tile->currentFrameImage().toImage());
+}
+
+/**
+ * Converts the pixmaps of the tiles and image layers used on the given
+ * \a layers to images and determines the colors of their objects.
+ *
+ * Also computes the draw margins of the tile layers, since these are cached
+ * on first use, which should not happen concurrently.
+ */
+void MapCompositor::prepareBands(const QList<const Layer *> &layers,
+                                 BandData &data) const
+{
+    for (const Layer *layer : layers) {
+        switch (layer->layerType()) {
+        case Layer::TileLayerType: {
+            const TileLayer *tileLayer = static_cast<const TileLayer*>(layer);
+            tileLayer->drawMargins();
+
+            // Tiles tend to repeat, so skip the lookup for those
+            const Tile *lastTile = nullptr;
+            for (const Cell &cell : *tileLayer) {
+                if (cell.tile && cell.tile != lastTile) {
+                    addTileImage(data.tileImages, cell.tile);
+                    lastTile = cell.tile;
+                }
+            }
+            break;
+        }
+
+        case Layer::ObjectGroupType: {
+            const ObjectGroup *objectGroup = static_cast<const ObjectGroup*>(layer);
+            for (const MapObject *object : objectGroup->objects()) {
+                data.objectColors.insert(object, objectColor(object));
+                if (const Tile *tile = object->cell().tile)
+                    addTileImage(data.tileImages, tile);
+            }
+            break;
+        }
+
+        case Layer::ImageLayerType: {
+            const ImageLayer *imageLayer = static_cast<const ImageLayer*>(layer);
+            data.layerImages.insert(imageLayer, imageLayer->image().toImage());
+            break;
+        }
+        }
+    }
+}
+
+/**
+ * Draws the given \a layers. When drawing a band, \a data provides the
+ * images and colors prepared for it, otherwise it is null.
+ */
+void MapCompositor::drawLayers(QPainter *painter,
+                               const QList<const Layer *> &layers,
+                               const QRectF &exposed,
+                               const BandData *data) const
+{
+    for (const Layer *layer : layers) {
+        const QPointF offset = layer->offset();
+
+        painter->setOpacity(layer->opacity());
+        painter->translate(offset);
+
+        drawLayer(painter, layer,
+                  exposed.isNull() ? exposed : exposed.translated(-offset),
+                  data);
+
+        painter->translate(-offset);
+    }
+}
+
+void MapCompositor::drawLayer(QPainter *painter,
+                              const Layer *layer,
+                              const QRectF &exposed,
+                              const BandData *data) const
+{
+    switch (layer->layerType()) {
+    case Layer::TileLayerType: {
+        const TileLayer *tileLayer = static_cast<const TileLayer*>(layer);
+        mRenderer->drawTileLayer(painter, tileLayer, exposed);
+        break;
+    }
+
+    case Layer::ObjectGroupType: {
+        const ObjectGroup *objectGroup = static_cast<const ObjectGroup*>(layer);
+        QList<MapObject*> objects = objectGroup->objects();
+
+        if (objectGroup->drawOrder() == ObjectGroup::TopDownOrder)
+            qStableSort(objects.begin(), objects.end(), objectLessThan);
+
+        for (const MapObject *object : objects) {
+            if (!object->isVisible())
+                continue;
+
+            QTransform rotation;
+            if (object->rotation() != qreal(0)) {
+                const QPointF origin = mRenderer->pixelToScreenCoords(object->position());
+                rotation.translate(origin.x(), origin.y());
+                rotation.rotate(object->rotation());
+                rotation.translate(-origin.x(), -origin.y());
+            }
+
+            if (!exposed.isNull()) {
+                const QRectF bounds = rotation.mapRect(mRenderer->boundingRect(object));
+                if (!bounds.intersects(exposed))
+                    continue;
+            }
+
+            if (!rotation.isIdentity()) {
+                painter->save();
+                painter->setTransform(rotation, true);
+            }
+
+            const QColor color = data ? data->objectColors.value(object)
+                                      : objectColor(object);
+
+            mRenderer->drawMapObject(painter, object, color);
+
+            if (!rotation.isIdentity())
+                painter->restore();
+        }
+        break;
+    }
+
+    case Layer::ImageLayerType: {
+        const ImageLayer *imageLayer = static_cast<const ImageLayer*>(layer);
+        if (data)
+            painter->drawImage(QPointF(), data->layerImages.value(imageLayer));
+        else
+            mRenderer->drawImageLayer(painter, imageLayer, exposed);
+        break;
+    }
+    }
+}
+
+QColor MapCompositor::objectColor(const MapObject *object) const
+{
+    if (mObjectColorFunction)
+        return mObjectColorFunction(object);
+
+    const ObjectGroup *objectGroup = object->objectGroup();
+    if (objectGroup && objectGroup->color().isValid())
+        return objectGroup->color();
+
+    return Qt::gray;
+}
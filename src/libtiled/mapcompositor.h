@@ -0,0 +1,114 @@
+/*
+ * mapcompositor.h
+ * Copyright 2016, Tiled contributors
+ *
+ * This file is part of libtiled.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *    1. Redistributions of source code must retain the above copyright notice,
+ *       this list of conditions and the following disclaimer.
+ *
+ *    2. Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE CONTRIBUTORS ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO
+ * EVENT SHALL THE CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ * OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+ * ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef MAPCOMPOSITOR_H
+#define MAPCOMPOSITOR_H
+
+#include "tiled_global.h"
+
+#include <QColor>
+#include <QList>
+#include <QRectF>
+
+#include <functional>
+
+class QPainter;
+
+namespace Tiled {
+
+class Layer;
+class MapObject;
+class MapRenderer;
+
+/**
+ * Draws the layers of a map, as used when rendering a map to an image.
+ *
+ * When painting on a large enough image, the image is split up in horizontal
+ * bands that are drawn concurrently on the global thread pool. Each band is
+ * drawn with all its layers in order, so that the result is the same as when
+ * drawing the layers one after the other.
+ *
+ * Pixmaps can only be used on the GUI thread, and the hooks may not be safe
+ * to call from other threads either. So before drawing in bands, the layer
+ * filter and object colors are evaluated and the pixmaps of the used tiles
+ * and of the image layers are converted to images, on the calling thread.
+ *
+ * While rendering, the map and the renderer should not be changed.
+ */
+class TILEDSHARED_EXPORT MapCompositor
+{
+public:
+    typedef std::function<bool (const Layer *)> LayerFilter;
+    typedef std::function<QColor (const MapObject *)> ObjectColorFunction;
+
+    explicit MapCompositor(MapRenderer *renderer);
+
+    /**
+     * Sets the \a filter deciding which layers are drawn. By default, all
+     * layers are drawn.
+     */
+    void setLayerFilter(const LayerFilter &filter);
+
+    /**
+     * Sets the \a function determining the color of map objects. By default
+     * the color of their object group is used, or gray when it has none.
+     */
+    void setObjectColorFunction(const ObjectColorFunction &function);
+
+    /**
+     * Draws the layers of the map using the given \a painter. The transform
+     * and render hints of the painter are respected.
+     *
+     * Tile layer data is expected to be loaded.
+     */
+    void render(QPainter *painter) const;
+
+private:
+    struct BandData;
+
+    void prepareBands(const QList<const Layer *> &layers,
+                      BandData &data) const;
+
+    void drawLayers(QPainter *painter,
+                    const QList<const Layer *> &layers,
+                    const QRectF &exposed,
+                    const BandData *data) const;
+    void drawLayer(QPainter *painter, const Layer *layer,
+                   const QRectF &exposed,
+                   const BandData *data) const;
+
+    QColor objectColor(const MapObject *object) const;
+
+    MapRenderer *mRenderer;
+    LayerFilter mLayerFilter;
+    ObjectColorFunction mObjectColorFunction;
+};
+
+} // namespace Tiled
+
+#endif // MAPCOMPOSITOR_H
@@ -63,7 +63,8 @@ class MapReaderPrivate
 public:
     MapReaderPrivate(MapReader *mapReader):
         p(mapReader),
-        mReadingExternalTileset(false)
+        mReadingExternalTileset(false),
+        mLazyLayerLoading(false)
     {}
 
     Map *readMap(QIODevice *device, const QString &path);
@@ -86,10 +87,6 @@ private:
 
     TileLayer *readLayer();
     void readLayerData(TileLayer &tileLayer);
-    void decodeBinaryLayerData(TileLayer &tileLayer,
-                               const QByteArray &data,
-                               Map::LayerDataFormat format);
-    void decodeCSVLayerData(TileLayer &tileLayer, QStringRef text);
 
     /**
      * Returns the cell for the given global tile ID. Errors are raised with
@@ -119,6 +116,7 @@ private:
     QScopedPointer<Map> mMap;
     GidMapper mGidMapper;
     bool mReadingExternalTileset;
+    bool mLazyLayerLoading;
 
     QXmlStreamReader xml;
 };
@@ -126,6 +124,88 @@ private:
 } // namespace Internal
 } // namespace Tiled
 
+/**
+ * Decodes base64 or CSV encoded layer \a data into \a tileLayer. Returns an
+ * error message, or an empty string on success.
+ */
+static QString decodeLayerData(TileLayer &tileLayer,
+                               GidMapper &gidMapper,
+                               const QByteArray &data,
+                               Map::LayerDataFormat format)
+{
+    if (format != Map::CSV) {
+        switch (gidMapper.decodeLayerData(tileLayer, data, format)) {
+        case GidMapper::CorruptLayerData:
+            return MapReaderPrivate::tr("Corrupt layer data for layer '%1'").arg(tileLayer.name());
+        case GidMapper::TileButNoTilesets:
+            return MapReaderPrivate::tr("Tile used but no tilesets specified");
+        case GidMapper::InvalidTile:
+            return MapReaderPrivate::tr("Invalid tile: %1").arg(gidMapper.invalidTile());
+        case GidMapper::NoError:
+            break;
+        }
+        return QString();
+    }
+
+    const QString trimText = QString::fromLatin1(data).trimmed();
+    const QStringList tiles = trimText.split(QLatin1Char(','));
+
+    if (tiles.length() != tileLayer.width() * tileLayer.height())
+        return MapReaderPrivate::tr("Corrupt layer data for layer '%1'").arg(tileLayer.name());
+
+    for (int y = 0; y < tileLayer.height(); y++) {
+        for (int x = 0; x < tileLayer.width(); x++) {
+            bool conversionOk;
+            const unsigned gid = tiles.at(y * tileLayer.width() + x)
+                    .toUInt(&conversionOk);
+            if (!conversionOk) {
+                return MapReaderPrivate::tr("Unable to parse tile at (%1,%2) on layer '%3'")
+                        .arg(x + 1).arg(y + 1).arg(tileLayer.name());
+            }
+
+            bool ok;
+            const Cell cell = gidMapper.gidToCell(gid, ok);
+            if (!ok) {
+                if (gidMapper.isEmpty())
+                    return MapReaderPrivate::tr("Tile used but no tilesets specified");
+                return MapReaderPrivate::tr("Invalid tile: %1").arg(gid);
+            }
+
+            tileLayer.setCell(x, y, cell);
+        }
+    }
+
+    return QString();
+}
+
+/**
+ * The encoded data of a tile layer, kept around when lazy layer loading is
+ * enabled. The tilesets referenced by the gid mapper are owned by the map.
+ */
+class EncodedLayerData : public TileLayerDataLoader
+{
+public:
+    EncodedLayerData(const GidMapper &gidMapper,
+                     Map::LayerDataFormat format,
+                     const QByteArray &data)
+        : mGidMapper(gidMapper)
+        , mFormat(format)
+        , mData(data)
+    {}
+
+    bool load(TileLayer &tileLayer, QString &error) const override
+    {
+        GidMapper gidMapper(mGidMapper);
+        error = decodeLayerData(tileLayer, gidMapper, mData, mFormat);
+        return error.isEmpty();
+    }
+
+private:
+    const GidMapper mGidMapper;
+    const Map::LayerDataFormat mFormat;
+    const QByteArray mData;
+};
+
 Map *MapReaderPrivate::readMap(QIODevice *device, const QString &path)
 {
     mError.clear();
@@ -625,61 +705,21 @@ void MapReaderPrivate::readLayerData(TileLayer &tileLayer)
                 readUnknownElement();
             }
         } else if (xml.isCharacters() && !xml.isWhitespace()) {
-            if (encoding == QLatin1String("base64")) {
-                decodeBinaryLayerData(tileLayer,
-                                      xml.text().toLatin1(),
-                                      layerDataFormat);
-            } else if (encoding == QLatin1String("csv")) {
-                decodeCSVLayerData(tileLayer, xml.text());
-            }
-        }
-    }
-}
-
-void MapReaderPrivate::decodeBinaryLayerData(TileLayer &tileLayer,
-                                             const QByteArray &data,
-                                             Map::LayerDataFormat format)
-{
-    GidMapper::DecodeError error = mGidMapper.decodeLayerData(tileLayer, data, format);
-
-    switch (error) {
-    case GidMapper::CorruptLayerData:
-        xml.raiseError(tr("Corrupt layer data for layer '%1'").arg(tileLayer.name()));
-        return;
-    case GidMapper::TileButNoTilesets:
-        xml.raiseError(tr("Tile used but no tilesets specified"));
-        return;
-    case GidMapper::InvalidTile:
-        xml.raiseError(tr("Invalid tile: %1").arg(mGidMapper.invalidTile()));
-        return;
-    case GidMapper::NoError:
-        break;
-    }
-}
-
-void MapReaderPrivate::decodeCSVLayerData(TileLayer &tileLayer, QStringRef text)
-{
-    QString trimText = text.trimmed().toString();
-    QStringList tiles = trimText.split(QLatin1Char(','));
+            if (layerDataFormat == Map::XML)
+                continue;
 
-    if (tiles.length() != tileLayer.width() * tileLayer.height()) {
-        xml.raiseError(tr("Corrupt layer data for layer '%1'")
-                       .arg(tileLayer.name()));
-        return;
-    }
+            const QByteArray data = xml.text().toLatin1();
 
-    for (int y = 0; y < tileLayer.height(); y++) {
-        for (int x = 0; x < tileLayer.width(); x++) {
-            bool conversionOk;
-            const unsigned gid = tiles.at(y * tileLayer.width() + x)
-                    .toUInt(&conversionOk);
-            if (!conversionOk) {
-                xml.raiseError(
-                        tr("Unable to parse tile at (%1,%2) on layer '%3'")
-                               .arg(x + 1).arg(y + 1).arg(tileLayer.name()));
-                return;
+            if (mLazyLayerLoading) {
+                tileLayer.setDataLoader(new EncodedLayerData(mGidMapper,
+                                                             layerDataFormat,
+                                                             data));
+            } else {
+                const QString error = decodeLayerData(tileLayer, mGidMapper,
+                                                      data, layerDataFormat);
+                if (!error.isEmpty())
+                    xml.raiseError(error);
             }
-            tileLayer.setCell(x, y, cellForGid(gid));
         }
     }
 }
@@ -1000,6 +1040,16 @@ SharedTileset MapReader::readTileset(const QString &fileName)
     return tileset;
 }
 
+void MapReader::setLazyLayerLoading(bool lazy)
+{
+    d->mLazyLayerLoading = lazy;
+}
+
+bool MapReader::lazyLayerLoading() const
+{
+    return d->mLazyLayerLoading;
+}
+
 QString MapReader::errorString() const
 {
     return d->errorString();
@@ -90,6 +90,18 @@ public:
      */
     SharedTileset readTileset(const QString &fileName);
 
+    /**
+     * Sets whether the data of tile layers is decoded only when it is needed.
+     * The encoded data is kept with each tile layer and decoded on first
+     * access to its cells. Call TileLayer::loadData() to find out whether
+     * the data is valid. Layer data stored as XML elements is always decoded
+     * right away.
+     *
+     * Lazy loading is disabled by default.
+     */
+    void setLazyLayerLoading(bool lazy);
+    bool lazyLayerLoading() const;
+
     /**
      * Returns the error message for the last occurred error.
      */
@@ -43,6 +43,24 @@ QRectF MapRenderer::boundingRect(const ImageLayer *imageLayer) const
     return QRectF(QPointF(), imageLayer->image().size());
 }
 
+QPainterPath MapRenderer::tileRegionShape(const QRegion &region) const
+{
+    QPainterPath path;
+    path.setFillRule(Qt::WindingFill);
+
+    foreach (const QRect &r, region.rects()) {
+        QPolygonF polygon;
+        polygon << tileToScreenCoords(r.left(), r.top())
+                << tileToScreenCoords(r.right() + 1, r.top())
+                << tileToScreenCoords(r.right() + 1, r.bottom() + 1)
+                << tileToScreenCoords(r.left(), r.bottom() + 1);
+        path.addPolygon(polygon);
+        path.closeSubpath();
+    }
+
+    return path.simplified();
+}
+
 void MapRenderer::drawImageLayer(QPainter *painter,
                                  const ImageLayer *imageLayer,
                                  const QRectF &exposed)
@@ -89,9 +107,11 @@ static bool hasOpenGLEngine(const QPainter *painter)
             type == QPaintEngine::OpenGL2);
 }
 
-CellRenderer::CellRenderer(QPainter *painter)
+CellRenderer::CellRenderer(QPainter *painter, const TileImages *tileImages)
     : mPainter(painter)
+    , mTileImages(tileImages)
     , mTile(nullptr)
+    , mTileImage(nullptr)
     , mIsOpenGL(hasOpenGLEngine(painter))
 {
 }
@@ -104,14 +124,24 @@ CellRenderer::CellRenderer(QPainter *painter)
  * kind of tile has to be drawn. For this reason it is necessary to call
  * flush when finished doing drawCell calls. This function is also called by
  * the destructor so usually an explicit call is not needed.
+ *
+ * Tiles for which an image was given are batched as well, as long as they
+ * don't need to be flipped or rotated.
  */
 void CellRenderer::render(const Cell &cell, const QPointF &pos, const QSizeF &cellSize, Origin origin)
 {
     if (mTile != cell.tile)
         flush();
 
-    const QPixmap &image = cell.tile->currentFrameImage();
-    const QSizeF size = image.size();
+    const QImage *tileImage = nullptr;
+    if (mTileImages) {
+        const auto it = mTileImages->constFind(cell.tile);
+        if (it != mTileImages->constEnd())
+            tileImage = &it.value();
+    }
+
+    const QSizeF size = tileImage ? tileImage->size()
+                                  : cell.tile->currentFrameImage().size();
     const QSizeF objectSize = (cellSize == QSizeF(0,0)) ? size : cellSize;
     const QSizeF scale(objectSize.width() / size.width(), objectSize.height() / size.height());
     const QPoint offset = cell.tile->offset();
@@ -151,8 +181,14 @@ void CellRenderer::render(const Cell &cell, const QPointF &pos, const QSizeF &ce
     fragment.scaleX = scale.width() * (flippedHorizontally ? -1 : 1);
     fragment.scaleY = scale.height() * (flippedVertically ? -1 : 1);
 
-    if (mIsOpenGL || (fragment.scaleX > 0 && fragment.scaleY > 0)) {
+    const bool canBatch = tileImage ? (fragment.rotation == 0 &&
+                                       fragment.scaleX > 0 && fragment.scaleY > 0)
+                                    : (mIsOpenGL ||
+                                       (fragment.scaleX > 0 && fragment.scaleY > 0));
+
+    if (canBatch) {
         mTile = cell.tile;
+        mTileImage = tileImage;
         mFragments.append(fragment);
         return;
     }
@@ -173,7 +209,10 @@ void CellRenderer::render(const Cell &cell, const QPointF &pos, const QSizeF &ce
     const QRectF source(0, 0, fragment.width, fragment.height);
 
     mPainter->setTransform(transform);
-    mPainter->drawPixmap(target, image, source);
+    if (tileImage)
+        mPainter->drawImage(target, *tileImage, source);
+    else
+        mPainter->drawPixmap(target, cell.tile->currentFrameImage(), source);
     mPainter->setTransform(oldTransform);
 }
 
@@ -185,10 +224,27 @@ void CellRenderer::flush()
     if (!mTile)
         return;
 
-    mPainter->drawPixmapFragments(mFragments.constData(),
-                                  mFragments.size(),
-                                  mTile->currentFrameImage());
+    if (mTileImage) {
+        // There is no equivalent of drawPixmapFragments for images, but since
+        // these fragments are neither flipped nor rotated, they can be drawn
+        // without changing the transform
+        for (const QPainter::PixmapFragment &fragment : mFragments) {
+            const qreal width = fragment.width * fragment.scaleX;
+            const qreal height = fragment.height * fragment.scaleY;
+            const QRectF target(fragment.x - width / 2,
+                                fragment.y - height / 2,
+                                width, height);
+            const QRectF source(fragment.sourceLeft, fragment.sourceTop,
+                                fragment.width, fragment.height);
+            mPainter->drawImage(target, *mTileImage, source);
+        }
+    } else {
+        mPainter->drawPixmapFragments(mFragments.constData(),
+                                      mFragments.size(),
+                                      mTile->currentFrameImage());
+    }
 
     mTile = nullptr;
+    mTileImage = nullptr;
     mFragments.resize(0);
 }
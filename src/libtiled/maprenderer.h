@@ -31,6 +31,8 @@
 
 #include "tiled_global.h"
 
+#include <QHash>
+#include <QImage>
 #include <QPainter>
 
 namespace Tiled {
@@ -49,6 +51,12 @@ enum RenderFlag {
 
 Q_DECLARE_FLAGS(RenderFlags, RenderFlag)
 
+/**
+ * Images to draw in place of the images of tiles, which are pixmaps. Unlike
+ * pixmaps, these can be drawn outside of the GUI thread.
+ */
+typedef QHash<const Tile*, QImage> TileImages;
+
 /**
  * This interface is used for rendering tile layers and retrieving associated
  * metrics. The different implementations deal with different map
@@ -62,6 +70,7 @@ public:
         , mFlags(nullptr)
         , mObjectLineWidth(2)
         , mPainterScale(1)
+        , mTileImages(nullptr)
     {}
 
     virtual ~MapRenderer() {}
@@ -131,6 +140,15 @@ public:
                                    const QColor &color,
                                    const QRectF &exposed) const = 0;
 
+    /**
+     * Returns the outline in pixels of the tiles in the given \a region.
+     *
+     * Filling this shape gives the same result as drawTileSelection(), but
+     * the shape can be kept around to avoid going over the whole region
+     * each time it is drawn.
+     */
+    virtual QPainterPath tileRegionShape(const QRegion &region) const;
+
     /**
      * Draws the \a object in the given \a color using the \a painter.
      */
@@ -212,6 +230,14 @@ public:
     RenderFlags flags() const { return mFlags; }
     void setFlags(RenderFlags flags) { mFlags = flags; }
 
+    /**
+     * Sets the \a tileImages to draw instead of the tile pixmaps, where
+     * available. This is needed when drawing outside of the GUI thread. The
+     * images are not owned by the renderer.
+     */
+    void setTileImages(const TileImages *tileImages) { mTileImages = tileImages; }
+    const TileImages *tileImages() const { return mTileImages; }
+
     static QPolygonF lineToPolygon(const QPointF &start, const QPointF &end);
 
 private:
@@ -220,6 +246,7 @@ private:
     RenderFlags mFlags;
     qreal mObjectLineWidth;
     qreal mPainterScale;
+    const TileImages *mTileImages;
 };
 
 inline const Map *MapRenderer::map() const
@@ -259,7 +286,8 @@ public:
         BottomCenter
     };
 
-    explicit CellRenderer(QPainter *painter);
+    explicit CellRenderer(QPainter *painter,
+                          const TileImages *tileImages = nullptr);
 
     ~CellRenderer() { flush(); }
 
@@ -268,7 +296,9 @@ public:
 
 private:
     QPainter * const mPainter;
+    const TileImages * const mTileImages;
     Tile *mTile;
+    const QImage *mTileImage;
     QVector<QPainter::PixmapFragment> mFragments;
     const bool mIsOpenGL;
 };
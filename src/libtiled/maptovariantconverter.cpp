@@ -260,6 +260,12 @@ QVariant MapToVariantConverter::toVariant(const TileLayer *tileLayer,
     switch (format) {
     case Map::XML:
     case Map::CSV: {
+        if (mPackedTileData) {
+            const QVector<unsigned> gids = mGidMapper.cellsToGids(*tileLayer);
+            tileLayerVariant[QLatin1String("data")] = QVariant::fromValue(gids);
+            break;
+        }
+
         QVariantList tileVariants;
         for (int y = 0; y < tileLayer->height(); ++y)
             for (int x = 0; x < tileLayer->width(); ++x)
@@ -36,7 +36,20 @@ namespace Tiled {
 class TILEDSHARED_EXPORT MapToVariantConverter
 {
 public:
-    MapToVariantConverter() {}
+    MapToVariantConverter()
+        : mPackedTileData(false)
+    {}
+
+    /**
+     * Sets whether the tile data of layers stored in CSV format is packed.
+     * When enabled, the global tile IDs are stored as a QVector<unsigned>
+     * rather than as a QVariantList, which avoids allocating a QVariant for
+     * each tile. Only enable this when the consumer of the resulting variant
+     * knows how to handle this type.
+     *
+     * Disabled by default.
+     */
+    void setPackedTileData(bool packed) { mPackedTileData = packed; }
 
     /**
      * Converts the given \s map to a QVariant. The \a mapDir is used to
@@ -67,6 +80,7 @@ private:
 
     QDir mMapDir;
     GidMapper mGidMapper;
+    bool mPackedTileData;
 };
 
 } // namespace Tiled
@@ -439,17 +439,20 @@ void MapWriterPrivate::writeTileLayer(QXmlStreamWriter &w,
             }
         }
     } else if (mLayerDataFormat == Map::CSV) {
+        const QVector<unsigned> gids = mGidMapper.cellsToGids(tileLayer);
+        const unsigned *gid = gids.constData();
+
         QString tileData;
+        tileData.reserve(gids.size() * 4);
 
         for (int y = 0; y < tileLayer.height(); ++y) {
             for (int x = 0; x < tileLayer.width(); ++x) {
-                const unsigned gid = mGidMapper.cellToGid(tileLayer.cellAt(x, y));
-                tileData.append(QString::number(gid));
+                tileData.append(QString::number(*gid++));
                 if (x != tileLayer.width() - 1
                     || y != tileLayer.height() - 1)
-                    tileData.append(QLatin1String(","));
+                    tileData.append(QLatin1Char(','));
             }
-            tileData.append(QLatin1String("\n"));
+            tileData.append(QLatin1Char('\n'));
         }
 
         w.writeCharacters(QLatin1String("\n"));
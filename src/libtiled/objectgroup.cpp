@@ -73,6 +73,24 @@ void ObjectGroup::insertObject(int index, MapObject *object)
         object->setId(mMap->takeNextObjectId());
 }
 
+void ObjectGroup::insertObjects(int index, const QList<MapObject*> &objects)
+{
+    if (index == mObjects.size()) {
+        mObjects.append(objects);
+    } else {
+        const QList<MapObject*> tail = mObjects.mid(index);
+        mObjects.erase(mObjects.begin() + index, mObjects.end());
+        mObjects.append(objects);
+        mObjects.append(tail);
+    }
+
+    for (MapObject *object : objects) {
+        object->setObjectGroup(this);
+        if (mMap && object->id() == 0)
+            object->setId(mMap->takeNextObjectId());
+    }
+}
+
 int ObjectGroup::removeObject(MapObject *object)
 {
     const int index = mObjects.indexOf(object);
@@ -89,6 +107,15 @@ void ObjectGroup::removeObjectAt(int index)
     object->setObjectGroup(nullptr);
 }
 
+void ObjectGroup::removeObjectsAt(int index, int count)
+{
+    for (int i = index; i < index + count; ++i)
+        mObjects.at(i)->setObjectGroup(nullptr);
+
+    mObjects.erase(mObjects.begin() + index,
+                   mObjects.begin() + index + count);
+}
+
 void ObjectGroup::moveObjects(int from, int to, int count)
 {
     // It's an error when 'to' lies within the moving range of objects
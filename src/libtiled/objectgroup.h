@@ -103,6 +103,11 @@ public:
      */
     void insertObject(int index, MapObject *object);
 
+    /**
+     * Inserts \a objects at the specified index, in the given order.
+     */
+    void insertObjects(int index, const QList<MapObject*> &objects);
+
     /**
      * Removes an object from this object group. Ownership of the object is
      * transferred to the caller.
@@ -121,6 +126,12 @@ public:
      */
     void removeObjectAt(int index);
 
+    /**
+     * Removes \a count objects starting at the given index. Ownership of the
+     * objects is transferred to the caller.
+     */
+    void removeObjectsAt(int index, int count);
+
     /**
      * Moves \a count objects starting at \a from to the index given by \a to.
      *
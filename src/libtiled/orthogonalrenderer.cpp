@@ -239,7 +239,7 @@ void OrthogonalRenderer::drawTileLayer(QPainter *painter,
     const QTransform savedTransform = painter->transform();
     painter->translate(layerPos);
 
-    CellRenderer renderer(painter);
+    CellRenderer renderer(painter, tileImages());
 
     Map::RenderOrder renderOrder = map()->renderOrder();
 
@@ -312,8 +312,8 @@ void OrthogonalRenderer::drawMapObject(QPainter *painter,
     const Cell &cell = object->cell();
 
     if (!cell.isEmpty()) {
-        CellRenderer(painter).render(cell, QPointF(), object->size(),
-                                     CellRenderer::BottomLeft);
+        CellRenderer(painter, tileImages()).render(cell, QPointF(), object->size(),
+                                                   CellRenderer::BottomLeft);
 
         if (testFlag(ShowTileObjectOutlines)) {
             const Tile *tile = cell.tile;
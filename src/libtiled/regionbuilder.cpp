@@ -0,0 +1,99 @@
+/*
+ * regionbuilder.cpp
+ * Copyright 2016, Tiled contributors
+ *
+ * This file is part of libtiled.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *    1. Redistributions of source code must retain the above copyright notice,
+ *       this list of conditions and the following disclaimer.
+ *
+ *    2. Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE CONTRIBUTORS ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO
+ * EVENT SHALL THE CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ * OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+ * ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "regionbuilder.h"
+
+using namespace Tiled;
+
+RegionBuilder::RegionBuilder()
+    : mRowY(0)
+    , mBandStart(-1)
+    , mBandY(0)
+{
+}
+
+void RegionBuilder::addRun(int x, int y, int width)
+{
+    if (width <= 0)
+        return;
+
+    if (y != mRowY) {
+        finishRow();
+        mRowY = y;
+    }
+
+    if (!mRow.isEmpty() && mRow.last().right() + 1 == x)
+        mRow.last().setWidth(mRow.last().width() + width);
+    else
+        mRow.append(QRect(x, y, width, 1));
+}
+
+QVector<QRect> RegionBuilder::rects()
+{
+    finishRow();
+    return mRects;
+}
+
+QRegion RegionBuilder::region()
+{
+    finishRow();
+
+    // The rects are y-x banded already, so they can be taken over directly
+    QRegion region;
+    region.setRects(mRects.constData(), mRects.size());
+    return region;
+}
+
+void RegionBuilder::finishRow()
+{
+    if (mRow.isEmpty())
+        return;
+
+    const int rowCount = mRow.size();
+    bool extendsBand = mBandStart != -1
+            && mBandY == mRowY - 1
+            && mRects.size() - mBandStart == rowCount;
+
+    for (int i = 0; extendsBand && i < rowCount; ++i) {
+        const QRect &bandRect = mRects.at(mBandStart + i);
+        const QRect &run = mRow.at(i);
+        extendsBand = bandRect.left() == run.left()
+                && bandRect.right() == run.right();
+    }
+
+    if (extendsBand) {
+        for (int i = mBandStart; i < mRects.size(); ++i)
+            mRects[i].setBottom(mRowY);
+    } else {
+        mBandStart = mRects.size();
+        mRects += mRow;
+    }
+
+    mBandY = mRowY;
+    mRow.clear();
+}
@@ -0,0 +1,79 @@
+/*
+ * regionbuilder.h
+ * Copyright 2016, Tiled contributors
+ *
+ * This file is part of libtiled.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *    1. Redistributions of source code must retain the above copyright notice,
+ *       this list of conditions and the following disclaimer.
+ *
+ *    2. Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE CONTRIBUTORS ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO
+ * EVENT SHALL THE CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ * OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+ * ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef REGIONBUILDER_H
+#define REGIONBUILDER_H
+
+#include "tiled_global.h"
+
+#include <QRect>
+#include <QRegion>
+#include <QVector>
+
+namespace Tiled {
+
+/**
+ * Builds a QRegion out of horizontal runs of tiles.
+ *
+ * Uniting rectangles one by one with a QRegion gets slow as the region grows,
+ * since each operation has to process all its rectangles. The runs passed to
+ * this class are instead merged into y-x banded rectangles as they come in,
+ * from which the region is built in one go.
+ */
+class TILEDSHARED_EXPORT RegionBuilder
+{
+public:
+    RegionBuilder();
+
+    /**
+     * Adds a run of \a width tiles starting at (\a x, \a y). Runs have to be
+     * added sorted by y and then by x, and may not overlap.
+     */
+    void addRun(int x, int y, int width);
+
+    /**
+     * Returns the rectangles making up the added runs. Horizontally touching
+     * runs are merged, as are rows with identical runs.
+     */
+    QVector<QRect> rects();
+
+    QRegion region();
+
+private:
+    void finishRow();
+
+    QVector<QRect> mRects;
+    QVector<QRect> mRow;    // The runs on the current row
+    int mRowY;
+    int mBandStart;         // Index of the first rect of the last band
+    int mBandY;             // The last row of the last band
+};
+
+} // namespace Tiled
+
+#endif // REGIONBUILDER_H
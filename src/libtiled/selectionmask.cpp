@@ -0,0 +1,473 @@
+/*
+ * selectionmask.cpp
+ * Copyright 2016, Tiled contributors
+ *
+ * This file is part of libtiled.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *    1. Redistributions of source code must retain the above copyright notice,
+ *       this list of conditions and the following disclaimer.
+ *
+ *    2. Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE CONTRIBUTORS ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO
+ * EVENT SHALL THE CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ * OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+ * ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "selectionmask.h"
+
+#include "regionbuilder.h"
+
+using namespace Tiled;
+
+static const quint64 AllBits = ~quint64(0);
+
+static inline int countTrailingZeros(quint64 value)
+{
+#if defined(Q_CC_GNU)
+    return __builtin_ctzll(value);
+#else
+    int count = 0;
+    while (!(value & 1)) {
+        value >>= 1;
+        ++count;
+    }
+    return count;
+#endif
+}
+
+static inline int highestSetBit(quint64 value)
+{
+#if defined(Q_CC_GNU)
+    return 63 - __builtin_clzll(value);
+#else
+    int bit = 63;
+    while (!(value & (quint64(1) << bit)))
+        --bit;
+    return bit;
+#endif
+}
+
+/**
+ * Returns a mask for the bits used in the last word of a row that is
+ * \a width bits wide.
+ */
+static inline quint64 lastWordMask(int width)
+{
+    const int usedBits = width & 63;
+    return usedBits ? AllBits >> (64 - usedBits) : AllBits;
+}
+
+/**
+ * Returns the index of the first bit at or after \a from that is set (or
+ * not set, depending on \a set). Returns words * 64 when there is none.
+ */
+static int findBit(const quint64 *row, int words, int from, bool set)
+{
+    int word = from >> 6;
+    if (word >= words)
+        return words * 64;
+
+    quint64 bits = (set ? row[word] : ~row[word]) & (AllBits << (from & 63));
+
+    while (!bits) {
+        if (++word == words)
+            return words * 64;
+        bits = set ? row[word] : ~row[word];
+    }
+
+    return word * 64 + countTrailingZeros(bits);
+}
+
+
+SelectionMask::SelectionMask()
+    : mWordsPerRow(0)
+    , mBoundsValid(true)
+{
+}
+
+SelectionMask::SelectionMask(const QRect &rect)
+    : mWordsPerRow(0)
+    , mBoundsValid(true)
+{
+    if (rect.isEmpty())
+        return;
+
+    allocate(rect);
+    for (int y = rect.top(); y <= rect.bottom(); ++y)
+        setRange(y, rect.left(), rect.right(), true);
+
+    mBounds = rect;
+    mBoundsValid = true;
+}
+
+SelectionMask::SelectionMask(const QRegion &region)
+    : mWordsPerRow(0)
+    , mBoundsValid(true)
+{
+    const QRect bounds = region.boundingRect();
+    if (bounds.isEmpty())
+        return;
+
+    allocate(bounds);
+    for (const QRect &rect : region.rects())
+        for (int y = rect.top(); y <= rect.bottom(); ++y)
+            setRange(y, rect.left(), rect.right(), true);
+
+    mBounds = bounds;
+    mBoundsValid = true;
+}
+
+QRect SelectionMask::boundingRect() const
+{
+    if (mBoundsValid)
+        return mBounds;
+
+    bool found = false;
+    int top = 0;
+    int bottom = 0;
+    int left = mArea.width();
+    int right = -1;
+
+    for (int y = mArea.top(); y <= mArea.bottom(); ++y) {
+        const quint64 *row = rowData(y);
+
+        int first = 0;
+        while (first < mWordsPerRow && !row[first])
+            ++first;
+        if (first == mWordsPerRow)
+            continue;
+
+        int last = mWordsPerRow - 1;
+        while (!row[last])
+            --last;
+
+        if (!found) {
+            top = y;
+            found = true;
+        }
+        bottom = y;
+        left = qMin(left, first * 64 + countTrailingZeros(row[first]));
+        right = qMax(right, last * 64 + highestSetBit(row[last]));
+    }
+
+    if (!found)
+        mBounds = QRect();
+    else
+        mBounds = QRect(QPoint(mArea.left() + left, top),
+                        QPoint(mArea.left() + right, bottom));
+
+    mBoundsValid = true;
+    return mBounds;
+}
+
+bool SelectionMask::contains(int x, int y) const
+{
+    if (!mArea.contains(x, y))
+        return false;
+
+    const int column = x - mArea.left();
+    return (rowData(y)[column >> 6] >> (column & 63)) & 1;
+}
+
+SelectionMask SelectionMask::united(const SelectionMask &other) const
+{
+    return combine(*this, other, Unite);
+}
+
+SelectionMask SelectionMask::intersected(const SelectionMask &other) const
+{
+    return combine(*this, other, Intersect);
+}
+
+SelectionMask SelectionMask::subtracted(const SelectionMask &other) const
+{
+    return combine(*this, other, Subtract);
+}
+
+SelectionMask SelectionMask::xored(const SelectionMask &other) const
+{
+    return combine(*this, other, Xor);
+}
+
+void SelectionMask::add(const QRect &rect)
+{
+    if (rect.isEmpty())
+        return;
+
+    if (!mArea.contains(rect)) {
+        *this = united(SelectionMask(rect));
+        return;
+    }
+
+    for (int y = rect.top(); y <= rect.bottom(); ++y)
+        setRange(y, rect.left(), rect.right(), true);
+
+    if (mBoundsValid)
+        mBounds = mBounds.united(rect);
+}
+
+void SelectionMask::reserve(const QRect &area)
+{
+    if (area.isEmpty() || mArea.contains(area))
+        return;
+
+    *this = reallocated(mArea.united(area));
+}
+
+void SelectionMask::remove(const QRect &rect)
+{
+    const QRect area = rect & mArea;
+    if (area.isEmpty())
+        return;
+
+    for (int y = area.top(); y <= area.bottom(); ++y)
+        setRange(y, area.left(), area.right(), false);
+
+    mBoundsValid = false;
+}
+
+void SelectionMask::translate(const QPoint &offset)
+{
+    mArea.translate(offset);
+    if (mBoundsValid && !mBounds.isNull())
+        mBounds.translate(offset);
+}
+
+SelectionMask SelectionMask::translated(const QPoint &offset) const
+{
+    SelectionMask mask = *this;
+    mask.translate(offset);
+    return mask;
+}
+
+QVector<QRect> SelectionMask::rects() const
+{
+    RegionBuilder builder;
+    addRuns(builder);
+    return builder.rects();
+}
+
+QRegion SelectionMask::toRegion() const
+{
+    RegionBuilder builder;
+    addRuns(builder);
+    return builder.region();
+}
+
+bool SelectionMask::operator==(const SelectionMask &other) const
+{
+    const QRect bounds = boundingRect();
+    if (bounds != other.boundingRect())
+        return false;
+    if (bounds.isEmpty())
+        return true;
+
+    const quint64 lastMask = lastWordMask(bounds.width());
+
+    for (int y = bounds.top(); y <= bounds.bottom(); ++y) {
+        for (int x = bounds.left(); x <= bounds.right(); x += 64) {
+            const quint64 mask = x + 64 > bounds.right() ? lastMask : AllBits;
+            if ((fetch(x, y) & mask) != (other.fetch(x, y) & mask))
+                return false;
+        }
+    }
+
+    return true;
+}
+
+SelectionMask SelectionMask::combine(const SelectionMask &a,
+                                     const SelectionMask &b,
+                                     Operation operation)
+{
+    const QRect boundsA = a.boundingRect();
+    const QRect boundsB = b.boundingRect();
+
+    if (boundsB.isEmpty())
+        return operation == Intersect ? SelectionMask() : a;
+    if (boundsA.isEmpty())
+        return (operation == Unite || operation == Xor) ? b : SelectionMask();
+
+    QRect area;
+    switch (operation) {
+    case Unite:
+    case Xor:
+        area = boundsA.united(boundsB);
+        break;
+    case Intersect:
+        area = boundsA.intersected(boundsB);
+        break;
+    case Subtract:
+        area = boundsA;
+        break;
+    }
+
+    if (area.isEmpty())
+        return SelectionMask();
+
+    SelectionMask result;
+    result.allocate(area);
+
+    const int lastWord = result.mWordsPerRow - 1;
+    const quint64 lastMask = lastWordMask(area.width());
+
+    for (int y = area.top(); y <= area.bottom(); ++y) {
+        quint64 *row = result.rowData(y);
+
+        for (int word = 0; word <= lastWord; ++word) {
+            const int x = area.left() + word * 64;
+            const quint64 bitsA = a.fetch(x, y);
+            const quint64 bitsB = b.fetch(x, y);
+
+            quint64 bits = 0;
+            switch (operation) {
+            case Unite:     bits = bitsA | bitsB; break;
+            case Intersect: bits = bitsA & bitsB; break;
+            case Subtract:  bits = bitsA & ~bitsB; break;
+            case Xor:       bits = bitsA ^ bitsB; break;
+            }
+
+            if (word == lastWord)
+                bits &= lastMask;
+
+            row[word] = bits;
+        }
+    }
+
+    result.trim();
+    return result;
+}
+
+void SelectionMask::allocate(const QRect &area)
+{
+    mArea = area;
+    mWordsPerRow = (area.width() + 63) / 64;
+    mBits = QVector<quint64>(mWordsPerRow * area.height(), 0);
+    mBoundsValid = false;
+}
+
+/**
+ * Sets or clears the bits from \a left to \a right (inclusive) on row \a y.
+ * The range has to be within the allocated area.
+ */
+void SelectionMask::setRange(int y, int left, int right, bool value)
+{
+    quint64 *row = rowData(y);
+    const int start = left - mArea.left();
+    const int end = right - mArea.left();
+    const int firstWord = start >> 6;
+    const int lastWord = end >> 6;
+
+    for (int word = firstWord; word <= lastWord; ++word) {
+        quint64 mask = AllBits;
+        if (word == firstWord)
+            mask &= AllBits << (start & 63);
+        if (word == lastWord)
+            mask &= AllBits >> (63 - (end & 63));
+
+        if (value)
+            row[word] |= mask;
+        else
+            row[word] &= ~mask;
+    }
+}
+
+/**
+ * Returns the 64 bits starting at (\a x, \a y), where bit 0 corresponds to
+ * \a x. Bits outside of the allocated area are 0.
+ */
+quint64 SelectionMask::fetch(int x, int y) const
+{
+    const int column = x - mArea.left();
+    if (column <= -64 || column >= mArea.width())
+        return 0;
+    if (y < mArea.top() || y > mArea.bottom())
+        return 0;
+
+    const quint64 *row = rowData(y);
+
+    if (column < 0)
+        return row[0] << -column;
+
+    const int word = column >> 6;
+    const int shift = column & 63;
+    if (shift == 0)
+        return row[word];
+
+    const quint64 high = word + 1 < mWordsPerRow ? row[word + 1] : 0;
+    return (row[word] >> shift) | (high << (64 - shift));
+}
+
+void SelectionMask::addRuns(RegionBuilder &builder) const
+{
+    const int width = mArea.width();
+
+    for (int y = mArea.top(); y <= mArea.bottom(); ++y) {
+        const quint64 *row = rowData(y);
+        int column = 0;
+
+        for (;;) {
+            const int start = findBit(row, mWordsPerRow, column, true);
+            if (start >= width)
+                break;
+
+            column = qMin(findBit(row, mWordsPerRow, start, false), width);
+            builder.addRun(mArea.left() + start, y, column - start);
+        }
+    }
+}
+
+/**
+ * Shrinks the allocated area to the bounding rect of the set bits.
+ */
+void SelectionMask::trim()
+{
+    mBoundsValid = false;
+    const QRect bounds = boundingRect();
+
+    if (bounds.isEmpty()) {
+        *this = SelectionMask();
+        return;
+    }
+    if (bounds != mArea)
+        *this = reallocated(bounds);
+}
+
+/**
+ * Returns a copy of this mask with the given allocated \a area. Bits outside
+ * of the area are dropped.
+ */
+SelectionMask SelectionMask::reallocated(const QRect &area) const
+{
+    SelectionMask mask;
+    mask.allocate(area);
+
+    const int lastWord = mask.mWordsPerRow - 1;
+    const quint64 lastMask = lastWordMask(area.width());
+
+    for (int y = area.top(); y <= area.bottom(); ++y) {
+        quint64 *row = mask.rowData(y);
+        for (int word = 0; word <= lastWord; ++word)
+            row[word] = fetch(area.left() + word * 64, y);
+        row[lastWord] &= lastMask;
+    }
+
+    if (mBoundsValid && area.contains(mBounds)) {
+        mask.mBounds = mBounds;
+        mask.mBoundsValid = true;
+    }
+
+    return mask;
+}
@@ -0,0 +1,196 @@
+/*
+ * selectionmask.h
+ * Copyright 2016, Tiled contributors
+ *
+ * This file is part of libtiled.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *    1. Redistributions of source code must retain the above copyright notice,
+ *       this list of conditions and the following disclaimer.
+ *
+ *    2. Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE CONTRIBUTORS ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO
+ * EVENT SHALL THE CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ * OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+ * ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef SELECTIONMASK_H
+#define SELECTIONMASK_H
+
+#include "tiled_global.h"
+
+#include <QRect>
+#include <QRegion>
+#include <QVector>
+
+namespace Tiled {
+
+class RegionBuilder;
+
+/**
+ * A set of tiles, stored as one bit per tile within a bounding area.
+ *
+ * Unlike QRegion, whose operations slow down with the number of rectangles
+ * needed to describe it, the boolean operations on a selection mask only
+ * depend on the size of the area involved. This makes it suitable for large
+ * and fragmented tile selections.
+ *
+ * The data is implicitly shared, so copying a mask is cheap.
+ */
+class TILEDSHARED_EXPORT SelectionMask
+{
+public:
+    SelectionMask();
+    SelectionMask(const QRect &rect);
+    SelectionMask(const QRegion &region);
+
+    /**
+     * Returns a mask containing the tiles within \a area for which the given
+     * \a condition returns true. The condition is called with the x and y
+     * coordinates of each tile.
+     */
+    template<typename Condition>
+    static SelectionMask fromCondition(const QRect &area, Condition condition);
+
+    bool isEmpty() const { return boundingRect().isEmpty(); }
+
+    /**
+     * Returns the smallest rectangle containing all the tiles of this mask.
+     */
+    QRect boundingRect() const;
+
+    bool contains(int x, int y) const;
+    bool contains(const QPoint &point) const
+    { return contains(point.x(), point.y()); }
+
+    SelectionMask united(const SelectionMask &other) const;
+    SelectionMask intersected(const SelectionMask &other) const;
+    SelectionMask subtracted(const SelectionMask &other) const;
+    SelectionMask xored(const SelectionMask &other) const;
+
+    /**
+     * Adds or removes the tiles in the given \a rect. Faster than the
+     * general operations when the rect lies within the current area.
+     */
+    void add(const QRect &rect);
+    void remove(const QRect &rect);
+
+    /**
+     * Allocates room for the given \a area, so that tiles can be added
+     * within it without reallocating.
+     */
+    void reserve(const QRect &area);
+
+    void translate(const QPoint &offset);
+    SelectionMask translated(const QPoint &offset) const;
+
+    /**
+     * Returns the mask as a list of non-overlapping rectangles, sorted by
+     * y and then x. Horizontally adjacent tiles are merged into runs and
+     * rows with identical runs are merged into bands.
+     */
+    QVector<QRect> rects() const;
+
+    /**
+     * Converts this mask to a QRegion, for use with APIs that require one.
+     */
+    QRegion toRegion() const;
+
+    bool operator==(const SelectionMask &other) const;
+    bool operator!=(const SelectionMask &other) const
+    { return !(*this == other); }
+
+    SelectionMask operator|(const SelectionMask &other) const
+    { return united(other); }
+    SelectionMask operator&(const SelectionMask &other) const
+    { return intersected(other); }
+    SelectionMask operator-(const SelectionMask &other) const
+    { return subtracted(other); }
+    SelectionMask operator^(const SelectionMask &other) const
+    { return xored(other); }
+
+    SelectionMask &operator|=(const SelectionMask &other)
+    { return *this = united(other); }
+    SelectionMask &operator&=(const SelectionMask &other)
+    { return *this = intersected(other); }
+    SelectionMask &operator-=(const SelectionMask &other)
+    { return *this = subtracted(other); }
+    SelectionMask &operator^=(const SelectionMask &other)
+    { return *this = xored(other); }
+
+    SelectionMask &operator|=(const QRect &rect)
+    { add(rect); return *this; }
+    SelectionMask &operator-=(const QRect &rect)
+    { remove(rect); return *this; }
+
+private:
+    enum Operation { Unite, Intersect, Subtract, Xor };
+
+    static SelectionMask combine(const SelectionMask &a,
+                                 const SelectionMask &b,
+                                 Operation operation);
+
+    void allocate(const QRect &area);
+    void setRange(int y, int left, int right, bool value);
+    quint64 fetch(int x, int y) const;
+    void addRuns(RegionBuilder &builder) const;
+    SelectionMask reallocated(const QRect &area) const;
+    quint64 *rowData(int y)
+    { return mBits.data() + (y - mArea.top()) * mWordsPerRow; }
+    const quint64 *rowData(int y) const
+    { return mBits.constData() + (y - mArea.top()) * mWordsPerRow; }
+    void trim();
+
+    QRect mArea;                // The area covered by mBits
+    int mWordsPerRow;
+    QVector<quint64> mBits;     // Bits outside of mArea are always 0
+
+    mutable QRect mBounds;      // Cached result of boundingRect()
+    mutable bool mBoundsValid;
+};
+
+template<typename Condition>
+SelectionMask SelectionMask::fromCondition(const QRect &area,
+                                           Condition condition)
+{
+    SelectionMask mask;
+    if (area.isEmpty())
+        return mask;
+
+    mask.allocate(area);
+
+    for (int y = area.top(); y <= area.bottom(); ++y) {
+        quint64 *row = mask.rowData(y);
+
+        for (int word = 0; word < mask.mWordsPerRow; ++word) {
+            const int left = area.left() + word * 64;
+            const int right = qMin(left + 63, area.right());
+            quint64 bits = 0;
+
+            for (int x = left; x <= right; ++x)
+                if (condition(x, y))
+                    bits |= quint64(1) << (x - left);
+
+            row[word] = bits;
+        }
+    }
+
+    mask.trim();
+    return mask;
+}
+
+} // namespace Tiled
+
+#endif // SELECTIONMASK_H
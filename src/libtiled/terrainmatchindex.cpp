@@ -0,0 +1,127 @@
+/*
+ * terrainmatchindex.cpp
+ * Copyright 2016, Tiled contributors
+ *
+ * This file is part of libtiled.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *    1. Redistributions of source code must retain the above copyright notice,
+ *       this list of conditions and the following disclaimer.
+ *
+ *    2. Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE CONTRIBUTORS ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO
+ * EVENT SHALL THE CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ * OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+ * ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "terrainmatchindex.h"
+
+#include "tile.h"
+#include "tileset.h"
+
+#include <algorithm>
+#include <climits>
+
+using namespace Tiled;
+
+Tile *TerrainMatchIndex::Matches::pick(qreal random) const
+{
+    Q_ASSERT(!isEmpty());
+
+    const qreal threshold = random * mThresholds.last();
+    const auto it = std::lower_bound(mThresholds.begin(), mThresholds.end(),
+                                     threshold);
+
+    if (it != mThresholds.end())
+        return mTiles.at(it - mThresholds.begin());
+    return mTiles.last();
+}
+
+TerrainMatchIndex::TerrainMatchIndex(const Tileset *tileset)
+    : mTileset(tileset)
+{
+    QHash<unsigned, int> groupIndexes;
+
+    for (Tile *tile : tileset->tiles()) {
+        const unsigned terrain = tile->terrain();
+
+        int index = groupIndexes.value(terrain, -1);
+        if (index == -1) {
+            index = mGroups.size();
+            groupIndexes.insert(terrain, index);
+            mGroups.append(TerrainGroup { terrain, QVector<Tile*>() });
+        }
+
+        mGroups[index].tiles.append(tile);
+    }
+}
+
+const TerrainMatchIndex::Matches &TerrainMatchIndex::matches(unsigned terrain,
+                                                             unsigned considerationMask) const
+{
+    const quint64 key = (quint64(terrain) << 32) | considerationMask;
+
+    auto it = mMatches.find(key);
+    if (it == mMatches.end())
+        it = mMatches.insert(key, findMatches(terrain, considerationMask));
+
+    return it.value();
+}
+
+TerrainMatchIndex::Matches TerrainMatchIndex::findMatches(unsigned terrain,
+                                                          unsigned considerationMask) const
+{
+    Matches matches;
+    int penalty = INT_MAX;
+    qreal sum = 0;
+
+    for (const TerrainGroup &group : mGroups) {
+        const unsigned t = group.terrain;
+
+        if ((t & considerationMask) != (terrain & considerationMask))
+            continue;
+
+        // calculate the tile transition penalty based on shortest distance to target terrain type
+        int tr = mTileset->terrainTransitionPenalty(t >> 24, terrain >> 24);
+        int tl = mTileset->terrainTransitionPenalty((t >> 16) & 0xFF, (terrain >> 16) & 0xFF);
+        int br = mTileset->terrainTransitionPenalty((t >> 8) & 0xFF, (terrain >> 8) & 0xFF);
+        int bl = mTileset->terrainTransitionPenalty(t & 0xFF, terrain & 0xFF);
+
+        // if there is no path to the destination terrain, this isn't a useful transition
+        if (tr < 0 || tl < 0 || br < 0 || bl < 0)
+            continue;
+
+        const int transitionPenalty = tr + tl + br + bl;
+        if (transitionPenalty > penalty)
+            continue;
+
+        if (transitionPenalty < penalty) {
+            matches.mTiles.clear();
+            matches.mThresholds.clear();
+            sum = 0;
+            penalty = transitionPenalty;
+        }
+
+        for (Tile *tile : group.tiles) {
+            if (tile->probability() > 0) {
+                sum += tile->probability();
+                matches.mTiles.append(tile);
+                matches.mThresholds.append(sum);
+            }
+        }
+    }
+
+    return matches;
+}
@@ -0,0 +1,102 @@
+/*
+ * terrainmatchindex.h
+ * Copyright 2016, Tiled contributors
+ *
+ * This file is part of libtiled.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *    1. Redistributions of source code must retain the above copyright notice,
+ *       this list of conditions and the following disclaimer.
+ *
+ *    2. Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE CONTRIBUTORS ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO
+ * EVENT SHALL THE CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ * OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+ * ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef TERRAINMATCHINDEX_H
+#define TERRAINMATCHINDEX_H
+
+#include "tiled_global.h"
+
+#include <QHash>
+#include <QVector>
+
+namespace Tiled {
+
+class Tile;
+class Tileset;
+
+/**
+ * Looks up the tiles of a tileset that best match a certain combination of
+ * corner terrains, as needed when painting terrain.
+ *
+ * The tiles are grouped by their terrain, so that a lookup only needs to look
+ * at each distinct terrain combination once. The results of lookups are
+ * cached, so the index has to be recreated when the terrain information,
+ * the tiles or the tile probabilities of the tileset change.
+ */
+class TILEDSHARED_EXPORT TerrainMatchIndex
+{
+public:
+    /**
+     * The best matching tiles for a lookup, along with the running sum of
+     * their probabilities.
+     */
+    class Matches
+    {
+    public:
+        bool isEmpty() const { return mTiles.isEmpty(); }
+        const QVector<Tile*> &tiles() const { return mTiles; }
+
+        /**
+         * Picks one of the tiles based on their probabilities, given a
+         * \a random number between 0 and 1.
+         */
+        Tile *pick(qreal random) const;
+
+    private:
+        friend class TerrainMatchIndex;
+
+        QVector<Tile*> mTiles;
+        QVector<qreal> mThresholds;
+    };
+
+    explicit TerrainMatchIndex(const Tileset *tileset);
+
+    /**
+     * Returns the tiles with the lowest transition penalty towards
+     * \a terrain, among the tiles that match \a terrain in the corners
+     * selected by \a considerationMask. Tiles with a probability of 0 are
+     * left out.
+     */
+    const Matches &matches(unsigned terrain, unsigned considerationMask) const;
+
+private:
+    Matches findMatches(unsigned terrain, unsigned considerationMask) const;
+
+    struct TerrainGroup {
+        unsigned terrain;
+        QVector<Tile*> tiles;
+    };
+
+    const Tileset *mTileset;
+    QVector<TerrainGroup> mGroups;
+    mutable QHash<quint64, Matches> mMatches;
+};
+
+} // namespace Tiled
+
+#endif // TERRAINMATCHINDEX_H
@@ -111,6 +111,18 @@ void Tile::setTerrain(unsigned terrain)
     mTileset->markTerrainDistancesDirty();
 }
 
+/**
+ * Set the relative probability of this tile appearing while painting.
+ */
+void Tile::setProbability(float probability)
+{
+    if (mProbability == probability)
+        return;
+
+    mProbability = probability;
+    mTileset->markTerrainMatchesDirty();
+}
+
 /**
  * Sets \a objectGroup to be the group of objects associated with this tile.
  * The Tile takes ownership over the ObjectGroup and it can't also be part of
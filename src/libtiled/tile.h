@@ -252,14 +252,6 @@ inline float Tile::probability() const
     return mProbability;
 }
 
-/**
- * Set the relative probability of this tile appearing while painting.
- */
-inline void Tile::setProbability(float probability)
-{
-    mProbability = probability;
-}
-
 /**
  * @return The group of objects associated with this tile. This is generally
  *         expected to be used for editing collision shapes.
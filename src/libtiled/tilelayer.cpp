@@ -82,35 +82,13 @@ QMargins TileLayer::drawMargins() const
     return computeDrawMargins(usedTilesets());
 }
 
-QRegion TileLayer::region(std::function<bool (const Cell &)> condition) const
-{
-    QRegion region;
-
-    for (int y = 0; y < mHeight; ++y) {
-        for (int x = 0; x < mWidth; ++x) {
-            if (condition(cellAt(x, y))) {
-                const int rangeStart = x;
-                for (++x; x <= mWidth; ++x) {
-                    if (x == mWidth || !condition(cellAt(x, y))) {
-                        const int rangeEnd = x;
-                        region += QRect(rangeStart + mX, y + mY,
-                                        rangeEnd - rangeStart, 1);
-                        break;
-                    }
-                }
-            }
-        }
-    }
-
-    return region;
-}
-
 /**
  * Sets the cell at the given coordinates.
  */
 void Tiled::TileLayer::setCell(int x, int y, const Cell &cell)
 {
     Q_ASSERT(contains(x, y));
+    ensureDataLoaded();
 
     Cell &existingCell = mGrid[x + y * mWidth];
 
@@ -125,6 +103,13 @@ void Tiled::TileLayer::setCell(int x, int y, const Cell &cell)
         }
     }
 
+    if (mUsageIndex && existingCell.tile != cell.tile) {
+        if (existingCell.tile)
+            mUsageIndex->remove(existingCell.tile, x, y);
+        if (cell.tile)
+            mUsageIndex->add(cell.tile, x, y);
+    }
+
     existingCell = cell;
 }
 
@@ -193,6 +178,8 @@ void TileLayer::erase(const QRegion &area)
 
 void TileLayer::flip(FlipDirection direction)
 {
+    ensureDataLoaded();
+
     QVector<Cell> newGrid(mWidth * mHeight);
 
     Q_ASSERT(direction == FlipHorizontally || direction == FlipVertically);
@@ -213,6 +200,7 @@ void TileLayer::flip(FlipDirection direction)
     }
 
     mGrid = newGrid;
+    mUsageIndex.reset();
 }
 
 void TileLayer::rotate(RotateDirection direction)
@@ -223,6 +211,8 @@ void TileLayer::rotate(RotateDirection direction)
     const char (&rotateMask)[8] =
             (direction == RotateRight) ? rotateRightMask : rotateLeftMask;
 
+    ensureDataLoaded();
+
     int newWidth = mHeight;
     int newHeight = mWidth;
     QVector<Cell> newGrid(newWidth * newHeight);
@@ -253,6 +243,7 @@ void TileLayer::rotate(RotateDirection direction)
     mWidth = newWidth;
     mHeight = newHeight;
     mGrid = newGrid;
+    mUsageIndex.reset();
 }
 
 
@@ -261,9 +252,16 @@ QSet<SharedTileset> TileLayer::usedTilesets() const
     if (mUsedTilesetsDirty) {
         QSet<SharedTileset> tilesets;
 
-        for (const Cell &cell : mGrid)
-            if (const Tile *tile = cell.tile)
-                tilesets.insert(tile->sharedTileset());
+        if (mUsageIndex) {
+            for (Tileset *tileset : mUsageIndex->tilesets())
+                tilesets.insert(tileset->sharedPointer());
+        } else {
+            ensureDataLoaded();
+
+            for (const Cell &cell : mGrid)
+                if (const Tile *tile = cell.tile)
+                    tilesets.insert(tile->sharedTileset());
+        }
 
         mUsedTilesets.swap(tilesets);
         mUsedTilesetsDirty = false;
@@ -274,6 +272,8 @@ QSet<SharedTileset> TileLayer::usedTilesets() const
 
 bool TileLayer::hasCell(std::function<bool (const Cell &)> condition) const
 {
+    ensureDataLoaded();
+
     for (const Cell &cell : mGrid)
         if (condition(cell))
             return true;
@@ -283,6 +283,11 @@ bool TileLayer::hasCell(std::function<bool (const Cell &)> condition) const
 
 bool TileLayer::referencesTileset(const Tileset *tileset) const
 {
+    if (mUsageIndex)
+        return mUsageIndex->count(tileset) > 0;
+
+    ensureDataLoaded();
+
     for (const Cell &cell : mGrid) {
         const Tile *tile = cell.tile;
         if (tile && tile->tileset() == tileset)
@@ -293,10 +298,35 @@ bool TileLayer::referencesTileset(const Tileset *tileset) const
 
 void TileLayer::removeReferencesToTileset(Tileset *tileset)
 {
-    for (int i = 0, i_end = mGrid.size(); i < i_end; ++i) {
-        const Tile *tile = mGrid.at(i).tile;
-        if (tile && tile->tileset() == tileset)
-            mGrid.replace(i, Cell());
+    if (!mUsageIndex) {
+        ensureDataLoaded();
+
+        for (int i = 0, i_end = mGrid.size(); i < i_end; ++i) {
+            const Tile *tile = mGrid.at(i).tile;
+            if (tile && tile->tileset() == tileset)
+                mGrid.replace(i, Cell());
+        }
+    } else if (mUsageIndex->count(tileset) > 0) {
+        const TileUsageIndex &index = *mUsageIndex;
+
+        // Only look at the chunks where the tiles of this tileset are used
+        for (const Tile *tile : tileset->tiles()) {
+            if (index.count(tile) == 0)
+                continue;
+
+            const QVector<QRect> chunks = index.chunks(tile);
+            for (const QRect &chunk : chunks) {
+                for (int y = chunk.top(); y <= chunk.bottom(); ++y) {
+                    for (int x = chunk.left(); x <= chunk.right(); ++x) {
+                        Cell &cell = mGrid[x + y * mWidth];
+                        if (cell.tile == tile) {
+                            cell = Cell();
+                            mUsageIndex->remove(tile, x, y);
+                        }
+                    }
+                }
+            }
+        }
     }
 
     mUsedTilesets.remove(tileset->sharedPointer());
@@ -305,6 +335,8 @@ void TileLayer::removeReferencesToTileset(Tileset *tileset)
 void TileLayer::replaceReferencesToTileset(Tileset *oldTileset,
                                            Tileset *newTileset)
 {
+    ensureDataLoaded();
+
     for (Cell &cell : mGrid) {
         const Tile *tile = cell.tile;
         if (tile && tile->tileset() == oldTileset)
@@ -313,6 +345,62 @@ void TileLayer::replaceReferencesToTileset(Tileset *oldTileset,
 
     if (mUsedTilesets.remove(oldTileset->sharedPointer()))
         mUsedTilesets.insert(newTileset->sharedPointer());
+
+    mUsageIndex.reset();
+}
+
+SelectionMask TileLayer::cellsMatching(const Cell &cell) const
+{
+    const QPoint offset = position();
+
+    // Empty cells are not indexed
+    if (cell.isEmpty()) {
+        return SelectionMask::fromCondition(bounds(), [&] (int x, int y) {
+            return cellAt(x - offset.x(), y - offset.y()).isEmpty();
+        });
+    }
+
+    const QVector<QRect> chunks = usageIndex().chunks(cell.tile);
+
+    QRect area;
+    for (const QRect &chunk : chunks)
+        area |= chunk;
+
+    SelectionMask mask;
+    mask.reserve(area.translated(offset));
+
+    for (const QRect &chunk : chunks) {
+        for (int y = chunk.top(); y <= chunk.bottom(); ++y) {
+            const Cell *row = mGrid.constData() + y * mWidth;
+
+            int x = chunk.left();
+            while (x <= chunk.right()) {
+                if (row[x] != cell) {
+                    ++x;
+                    continue;
+                }
+
+                const int rangeStart = x;
+                while (x <= chunk.right() && row[x] == cell)
+                    ++x;
+
+                mask.add(QRect(rangeStart + offset.x(), y + offset.y(),
+                               x - rangeStart, 1));
+            }
+        }
+    }
+
+    return mask;
+}
+
+const TileUsageIndex &TileLayer::usageIndex() const
+{
+    ensureDataLoaded();
+
+    if (!mUsageIndex)
+        mUsageIndex.reset(new TileUsageIndex(this));
+
+    return *mUsageIndex;
 }
 
 void TileLayer::resize(const QSize &size, const QPoint &offset)
@@ -320,6 +408,8 @@ void TileLayer::resize(const QSize &size, const QPoint &offset)
     if (this->size() == size && offset.isNull())
         return;
 
+    ensureDataLoaded();
+
     QVector<Cell> newGrid(size.width() * size.height());
 
     // Copy over the preserved part
@@ -336,6 +426,7 @@ void TileLayer::resize(const QSize &size, const QPoint &offset)
     }
 
     mGrid = newGrid;
+    mUsageIndex.reset();
     setSize(size);
 }
 
@@ -343,6 +434,8 @@ void TileLayer::offsetTiles(const QPoint &offset,
                             const QRect &bounds,
                             bool wrapX, bool wrapY)
 {
+    ensureDataLoaded();
+
     QVector<Cell> newGrid(mWidth * mHeight);
 
     for (int y = 0; y < mHeight; ++y) {
@@ -382,6 +475,7 @@ void TileLayer::offsetTiles(const QPoint &offset,
     }
 
     mGrid = newGrid;
+    mUsageIndex.reset();
 }
 
 bool TileLayer::canMergeWith(Layer *other) const
@@ -405,7 +499,10 @@ Layer *TileLayer::mergedWith(Layer *other) const
 
 QRegion TileLayer::computeDiffRegion(const TileLayer *other) const
 {
-    QRegion ret;
+    ensureDataLoaded();
+    other->ensureDataLoaded();
+
+    RegionBuilder builder;
 
     const int dx = other->x() - mX;
     const int dy = other->y() - mY;
@@ -413,24 +510,31 @@ QRegion TileLayer::computeDiffRegion(const TileLayer *other) const
     r &= QRect(dx, dy, other->width(), other->height());
 
     for (int y = r.top(); y <= r.bottom(); ++y) {
-        for (int x = r.left(); x <= r.right(); ++x) {
-            if (cellAt(x, y) != other->cellAt(x - dx, y - dy)) {
-                const int rangeStart = x;
-                while (x <= r.right() &&
-                       cellAt(x, y) != other->cellAt(x - dx, y - dy)) {
-                    ++x;
-                }
-                const int rangeEnd = x;
-                ret += QRect(rangeStart, y, rangeEnd - rangeStart, 1);
+        const Cell *row = mGrid.constData() + y * mWidth;
+        const Cell *otherRow = other->mGrid.constData() + (y - dy) * other->mWidth;
+
+        int x = r.left();
+        while (x <= r.right()) {
+            if (row[x] == otherRow[x - dx]) {
+                ++x;
+                continue;
             }
+
+            const int rangeStart = x;
+            while (x <= r.right() && row[x] != otherRow[x - dx])
+                ++x;
+
+            builder.addRun(rangeStart, y, x - rangeStart);
         }
     }
 
-    return ret;
+    return builder.region();
 }
 
 bool TileLayer::isEmpty() const
 {
+    ensureDataLoaded();
+
     for (const Cell &cell : mGrid)
         if (!cell.isEmpty())
             return false;
@@ -454,5 +558,29 @@ TileLayer *TileLayer::initializeClone(TileLayer *clone) const
     clone->mGrid = mGrid;
     clone->mUsedTilesets = mUsedTilesets;
     clone->mUsedTilesetsDirty = mUsedTilesetsDirty;
+    clone->mDataLoader = mDataLoader;
     return clone;
 }
+
+void TileLayer::setDataLoader(TileLayerDataLoader *loader)
+{
+    mDataLoader.reset(loader);
+}
+
+bool TileLayer::loadData(QString *error)
+{
+    if (!mDataLoader)
+        return true;
+
+    // Loading is only attempted once, also when it fails
+    const QSharedPointer<const TileLayerDataLoader> loader = mDataLoader;
+    mDataLoader.reset();
+
+    QString loadError;
+    const bool ok = loader->load(*this, loadError);
+
+    if (!ok && error)
+        *error = loadError;
+
+    return ok;
+}
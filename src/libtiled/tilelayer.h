@@ -33,9 +33,13 @@
 #include "tiled_global.h"
 
 #include "layer.h"
+#include "regionbuilder.h"
+#include "selectionmask.h"
 #include "tiled.h"
+#include "tileusageindex.h"
 
 #include <QMargins>
+#include <QScopedPointer>
 #include <QString>
 #include <QVector>
 #include <QSharedPointer>
@@ -45,6 +49,7 @@
 namespace Tiled {
 
 class Tile;
+class TileLayer;
 
 /**
  * A cell on a tile layer grid.
@@ -90,6 +95,25 @@ public:
     bool flippedAntiDiagonally;
 };
 
+/**
+ * Decodes the cells of a tile layer on demand. Used by map readers that can
+ * defer decoding layer data until it is needed.
+ *
+ * A loader may be shared between clones of a layer, so load() should leave
+ * the loader itself unchanged.
+ */
+class TILEDSHARED_EXPORT TileLayerDataLoader
+{
+public:
+    virtual ~TileLayerDataLoader() {}
+
+    /**
+     * Sets the cells of \a tileLayer. Returns false and sets \a error when
+     * the data could not be decoded.
+     */
+    virtual bool load(TileLayer &tileLayer, QString &error) const = 0;
+};
+
 /**
  * A tile layer is a grid of cells. Each cell refers to a specific tile, and
  * stores how the tile is flipped.
@@ -113,8 +137,12 @@ public:
     /**
      * Calculates the region of cells in this tile layer for which the given
      * \a condition returns true.
+     *
+     * The condition is a template parameter rather than a std::function, so
+     * that it can be inlined into the loop over the cells.
      */
-    QRegion region(std::function<bool (const Cell &)> condition) const;
+    template<typename Condition>
+    QRegion region(Condition condition) const;
 
     /**
      * Calculates the region occupied by the tiles of this layer. Similar to
@@ -188,6 +216,29 @@ public:
      */
     bool referencesTileset(const Tileset *tileset) const override;
 
+    /**
+     * Returns the cells that are equal to \a cell, in the same coordinates as
+     * region(). For non-empty cells, only the parts of the layer where the
+     * tile is used are looked at.
+     */
+    SelectionMask cellsMatching(const Cell &cell) const;
+
+    /**
+     * Returns an index of the tiles used on this layer. The index is created
+     * on first use and kept up to date by setCell() after that. Operations
+     * that rearrange the whole layer drop it, in which case it is created
+     * again when needed.
+     *
+     * Getting the non-const begin() or end() iterators also drops the index,
+     * since cells changed through them can't be tracked.
+     *
+     * referencesTileset(), usedTilesets() and removeReferencesToTileset() use
+     * the index when it exists and scan the cells otherwise, so that layers
+     * that never ask for the index don't pay for keeping it up to date.
+     */
+    const TileUsageIndex &usageIndex() const;
+    bool hasUsageIndex() const { return !mUsageIndex.isNull(); }
+
     /**
      * Removes all references to the given tileset. This sets all tiles on this
      * layer that are from the given tileset to null.
@@ -233,19 +284,48 @@ public:
 
     virtual Layer *clone() const override;
 
-    // Enable easy iteration over cells with range-based for
-    QVector<Cell>::iterator begin() { return mGrid.begin(); }
-    QVector<Cell>::iterator end() { return mGrid.end(); }
-    QVector<Cell>::const_iterator begin() const { return mGrid.begin(); }
-    QVector<Cell>::const_iterator end() const { return mGrid.end(); }
+    /**
+     * Sets the \a loader that will provide the cells of this layer once they
+     * are needed. The cells are decoded by loadData(), or otherwise on first
+     * access. The layer takes ownership of the loader.
+     */
+    void setDataLoader(TileLayerDataLoader *loader);
+
+    /**
+     * Returns whether the cells of this layer have been loaded. This is only
+     * false for layers read with lazy loading enabled.
+     */
+    bool isDataLoaded() const { return mDataLoader.isNull(); }
+
+    /**
+     * Decodes the cells of this layer, if that was deferred. Returns false
+     * and sets \a error when the data could not be decoded.
+     *
+     * Accessing the cells decodes them as well, but in that case errors are
+     * not reported and the layer remains (partially) empty.
+     */
+    bool loadData(QString *error = nullptr);
+
+    // Enable easy iteration over cells with range-based for. Since cells may
+    // be changed through the non-const iterators, these drop the usage index
+    // and the cached list of used tilesets.
+    QVector<Cell>::iterator begin() { cellsChangedExternally(); return mGrid.begin(); }
+    QVector<Cell>::iterator end() { cellsChangedExternally(); return mGrid.end(); }
+    QVector<Cell>::const_iterator begin() const { ensureDataLoaded(); return mGrid.begin(); }
+    QVector<Cell>::const_iterator end() const { ensureDataLoaded(); return mGrid.end(); }
 
 protected:
     TileLayer *initializeClone(TileLayer *clone) const;
 
 private:
+    void ensureDataLoaded() const;
+    void cellsChangedExternally();
+
     QVector<Cell> mGrid;
     mutable QSet<SharedTileset> mUsedTilesets;
     mutable bool mUsedTilesetsDirty;
+    mutable QScopedPointer<TileUsageIndex> mUsageIndex;
+    QSharedPointer<const TileLayerDataLoader> mDataLoader;
 };
 
 
@@ -262,6 +342,34 @@ inline bool TileLayer::contains(const QPoint &point) const
     return contains(point.x(), point.y());
 }
 
+template<typename Condition>
+QRegion TileLayer::region(Condition condition) const
+{
+    ensureDataLoaded();
+
+    RegionBuilder builder;
+    const Cell *row = mGrid.constData();
+
+    for (int y = 0; y < mHeight; ++y, row += mWidth) {
+        int x = 0;
+
+        for (;;) {
+            while (x < mWidth && !condition(row[x]))
+                ++x;
+            if (x == mWidth)
+                break;
+
+            const int rangeStart = x;
+            while (x < mWidth && condition(row[x]))
+                ++x;
+
+            builder.addRun(rangeStart + mX, y + mY, x - rangeStart);
+        }
+    }
+
+    return builder.region();
+}
+
 inline QRegion TileLayer::region() const
 {
     return region([] (const Cell &cell) { return !cell.isEmpty(); });
@@ -274,6 +382,7 @@ inline QRegion TileLayer::region() const
 inline const Cell &TileLayer::cellAt(int x, int y) const
 {
     Q_ASSERT(contains(x, y));
+    ensureDataLoaded();
     return mGrid.at(x + y * mWidth);
 }
 
@@ -282,6 +391,23 @@ inline const Cell &TileLayer::cellAt(const QPoint &point) const
     return cellAt(point.x(), point.y());
 }
 
+/**
+ * Decodes the cells when they were not loaded yet. This makes sure a lazily
+ * loaded layer never appears empty, even when loadData() was not called.
+ */
+inline void TileLayer::ensureDataLoaded() const
+{
+    if (Q_UNLIKELY(!mDataLoader.isNull()))
+        const_cast<TileLayer*>(this)->loadData();
+}
+
+inline void TileLayer::cellsChangedExternally()
+{
+    ensureDataLoaded();
+    mUsageIndex.reset();
+    mUsedTilesetsDirty = true;
+}
+
 typedef QSharedPointer<TileLayer> SharedTileLayer;
 
 } // namespace Tiled
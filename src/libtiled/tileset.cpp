@@ -101,6 +101,7 @@ Tile *Tileset::findOrCreateTile(int id)
         return tile;
 
     mNextTileId = std::max(mNextTileId, id + 1);
+    markTerrainMatchesDirty();
     return mTiles[id] = new Tile(id, this);
 }
 
@@ -126,6 +127,24 @@ void Tileset::setImageReference(const ImageReference &reference)
     mExpectedColumnCount = columnCountForWidth(mImageReference.size.width());
 }
 
+/**
+ * Cuts the tile at \a rect out of the tileset \a image, masking out the
+ * \a transparent color when it is valid.
+ */
+static QPixmap cutTile(const QImage &image, const QRect &rect,
+                       const QColor &transparent)
+{
+    const QImage tileImage = image.copy(rect);
+    QPixmap tilePixmap = QPixmap::fromImage(tileImage);
+
+    if (transparent.isValid()) {
+        const QImage mask = tileImage.createMaskFromColor(transparent.rgb());
+        tilePixmap.setMask(QBitmap::fromImage(mask));
+    }
+
+    return tilePixmap;
+}
+
 /**
  * Load this tileset from the given tileset \a image. This will replace
  * existing tile images in this tileset with new ones. If the new image
@@ -163,20 +182,16 @@ bool Tileset::loadFromImage(const QImage &image,
 
     for (int y = margin; y <= stopHeight; y += tileSize.height() + spacing) {
         for (int x = margin; x <= stopWidth; x += tileSize.width() + spacing) {
-            const QImage tileImage = image.copy(x, y, tileSize.width(), tileSize.height());
-            QPixmap tilePixmap = QPixmap::fromImage(tileImage);
-            const QColor &transparent = mImageReference.transparentColor;
-
-            if (transparent.isValid()) {
-                const QImage mask = tileImage.createMaskFromColor(transparent.rgb());
-                tilePixmap.setMask(QBitmap::fromImage(mask));
-            }
+            const QPixmap tilePixmap = cutTile(image, QRect(QPoint(x, y), tileSize),
+                                               mImageReference.transparentColor);
 
             auto it = mTiles.find(tileNum);
-            if (it != mTiles.end())
+            if (it != mTiles.end()) {
                 it.value()->setImage(tilePixmap);
-            else
+            } else {
                 mTiles.insert(tileNum, new Tile(tilePixmap, tileNum, this));
+                markTerrainMatchesDirty();
+            }
 
             ++tileNum;
         }
@@ -200,6 +215,55 @@ bool Tileset::loadFromImage(const QImage &image,
     return true;
 }
 
+/**
+ * Updates the tiles of this tileset from a new version of its tileset
+ * \a image. Unlike loadFromImage(), only the tiles whose pixels actually
+ * changed get a new image. These tiles are appended to \a changedTiles.
+ *
+ * This only works when the tileset image is loaded and the new image has the
+ * same size, so that the tiles are laid out the same way.
+ *
+ * @return <code>true</code> if the tiles were updated, or
+ *         <code>false</code> if the tileset needs to be loaded from the
+ *         image instead
+ */
+bool Tileset::updateFromImage(const QImage &image, QList<Tile*> &changedTiles)
+{
+    if (!mImageReference.loaded || image.isNull())
+        return false;
+    if (image.size() != mImageReference.size)
+        return false;
+
+    const QSize tileSize = this->tileSize();
+    const int margin = this->margin();
+    const int spacing = this->tileSpacing();
+
+    const int stopWidth = image.width() - tileSize.width();
+    const int stopHeight = image.height() - tileSize.height();
+
+    int tileNum = 0;
+
+    for (int y = margin; y <= stopHeight; y += tileSize.height() + spacing) {
+        for (int x = margin; x <= stopWidth; x += tileSize.width() + spacing) {
+            Tile *tile = mTiles.value(tileNum);
+            ++tileNum;
+
+            if (!tile)
+                continue;
+
+            const QPixmap tilePixmap = cutTile(image, QRect(QPoint(x, y), tileSize),
+                                               mImageReference.transparentColor);
+
+            if (tile->image().toImage() != tilePixmap.toImage()) {
+                tile->setImage(tilePixmap);
+                changedTiles.append(tile);
+            }
+        }
+    }
+
+    return true;
+}
+
 /**
  * Tries to load the image this tileset is referring to.
  *
@@ -323,7 +387,7 @@ void Tileset::insertTerrain(int index, Terrain *terrain)
         }
     }
 
-    mTerrainDistancesDirty = true;
+    markTerrainDistancesDirty();
 }
 
 /**
@@ -353,7 +417,7 @@ Terrain *Tileset::takeTerrainAt(int index)
         }
     }
 
-    mTerrainDistancesDirty = true;
+    markTerrainDistancesDirty();
 
     return terrain;
 }
@@ -380,6 +444,14 @@ int Tileset::terrainTransitionPenalty(int terrainType0, int terrainType1) const
     return mTerrainTypes.at(terrainType0)->transitionDistance(terrainType1);
 }
 
+const TerrainMatchIndex &Tileset::terrainMatchIndex() const
+{
+    if (!mTerrainMatchIndex)
+        mTerrainMatchIndex.reset(new TerrainMatchIndex(this));
+
+    return *mTerrainMatchIndex;
+}
+
 /**
  * Calculates the transition distance matrix for all terrain types.
  */
@@ -476,6 +548,8 @@ Tile *Tileset::addTile(const QPixmap &image, const QString &source)
     newTile->setImageSource(source);
 
     mTiles.insert(newTile->id(), newTile);
+    markTerrainMatchesDirty();
+
     if (mTileHeight < image.height())
         mTileHeight = image.height();
     if (mTileWidth < image.width())
@@ -495,6 +569,7 @@ void Tileset::addTiles(const QList<Tile *> &tiles)
         mTiles.insert(tile->id(), tile);
     }
 
+    markTerrainMatchesDirty();
     updateTileSize();
 }
 
@@ -510,6 +585,7 @@ void Tileset::removeTiles(const QList<Tile *> &tiles)
         mTiles.remove(tile->id());
     }
 
+    markTerrainMatchesDirty();
     updateTileSize();
 }
 
@@ -519,6 +595,7 @@ void Tileset::removeTiles(const QList<Tile *> &tiles)
 void Tileset::deleteTile(int id)
 {
     delete mTiles.take(id);
+    markTerrainMatchesDirty();
 }
 
 /**
@@ -32,11 +32,13 @@
 
 #include "imagereference.h"
 #include "object.h"
+#include "terrainmatchindex.h"
 
 #include <QColor>
 #include <QList>
 #include <QVector>
 #include <QPoint>
+#include <QScopedPointer>
 #include <QSharedPointer>
 #include <QString>
 #include <QPixmap>
@@ -138,6 +140,7 @@ public:
 
     bool loadFromImage(const QImage &image, const QString &fileName);
     bool loadFromImage(const QString &fileName);
+    bool updateFromImage(const QImage &image, QList<Tile*> &changedTiles);
     bool loadImage();
 
     SharedTileset findSimilarTileset(const QVector<SharedTileset> &tilesets) const;
@@ -158,6 +161,13 @@ public:
 
     int terrainTransitionPenalty(int terrainType0, int terrainType1) const;
 
+    /**
+     * Returns an index for looking up the tiles that best match a certain
+     * terrain. The index is created on first use and dropped when the
+     * terrain information, the tiles or their probabilities change.
+     */
+    const TerrainMatchIndex &terrainMatchIndex() const;
+
     Tile *addTile(const QPixmap &image, const QString &source = QString());
     void addTiles(const QList<Tile*> &tiles);
     void removeTiles(const QList<Tile *> &tiles);
@@ -172,6 +182,7 @@ public:
                       const QString &source = QString());
 
     void markTerrainDistancesDirty();
+    void markTerrainMatchesDirty();
 
     SharedTileset sharedPointer() const;
 
@@ -197,6 +208,7 @@ private:
     int mNextTileId;
     QList<Terrain*> mTerrainTypes;
     bool mTerrainDistancesDirty;
+    mutable QScopedPointer<TerrainMatchIndex> mTerrainMatchIndex;
     bool mLoaded;
 
     QWeakPointer<Tileset> mWeakPointer;
@@ -472,6 +484,15 @@ inline int Tileset::takeNextTileId()
 inline void Tileset::markTerrainDistancesDirty()
 {
     mTerrainDistancesDirty = true;
+    mTerrainMatchIndex.reset();
+}
+
+/**
+ * Used by the Tile class when its probability changes.
+ */
+inline void Tileset::markTerrainMatchesDirty()
+{
+    mTerrainMatchIndex.reset();
 }
 
 inline SharedTileset Tileset::sharedPointer() const
@@ -0,0 +1,112 @@
+/*
+ * tileusageindex.cpp
+ * Copyright 2016, Tiled contributors
+ *
+ * This file is part of libtiled.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *    1. Redistributions of source code must retain the above copyright notice,
+ *       this list of conditions and the following disclaimer.
+ *
+ *    2. Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE CONTRIBUTORS ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO
+ * EVENT SHALL THE CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ * OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+ * ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "tileusageindex.h"
+
+#include "tile.h"
+#include "tilelayer.h"
+
+using namespace Tiled;
+
+TileUsageIndex::TileUsageIndex(const TileLayer *layer)
+    : mWidth(layer->width())
+    , mHeight(layer->height())
+    , mChunkColumns((layer->width() + ChunkSize - 1) / ChunkSize)
+    , mChunkCount(mChunkColumns * ((layer->height() + ChunkSize - 1) / ChunkSize))
+{
+    for (int y = 0; y < mHeight; ++y)
+        for (int x = 0; x < mWidth; ++x)
+            if (const Tile *tile = layer->cellAt(x, y).tile)
+                add(tile, x, y);
+}
+
+void TileUsageIndex::add(const Tile *tile, int x, int y)
+{
+    TileUsage &usage = mTiles[tile];
+    if (usage.count++ == 0)
+        usage.chunks.resize(mChunkCount);
+    usage.chunks.setBit(chunkIndex(x, y));
+
+    ++mTilesets[tile->tileset()];
+}
+
+void TileUsageIndex::remove(const Tile *tile, int x, int y)
+{
+    auto it = mTiles.find(tile);
+    Q_ASSERT(it != mTiles.end());
+    if (it == mTiles.end())
+        return;
+
+    // The chunk bit is left set, since the tile may still be used elsewhere
+    // in the same chunk
+    if (--it.value().count == 0)
+        mTiles.erase(it);
+
+    auto tileset = mTilesets.find(tile->tileset());
+    if (tileset != mTilesets.end() && --tileset.value() == 0)
+        mTilesets.erase(tileset);
+}
+
+int TileUsageIndex::count(const Tile *tile) const
+{
+    return mTiles.value(tile).count;
+}
+
+int TileUsageIndex::count(const Tileset *tileset) const
+{
+    return mTilesets.value(const_cast<Tileset*>(tileset));
+}
+
+QList<Tileset*> TileUsageIndex::tilesets() const
+{
+    return mTilesets.keys();
+}
+
+QVector<QRect> TileUsageIndex::chunks(const Tile *tile) const
+{
+    QVector<QRect> chunks;
+
+    auto it = mTiles.find(tile);
+    if (it == mTiles.end())
+        return chunks;
+
+    const QBitArray &bits = it.value().chunks;
+    const QRect layerRect(0, 0, mWidth, mHeight);
+
+    for (int index = 0; index < bits.size(); ++index) {
+        if (!bits.testBit(index))
+            continue;
+
+        const QRect chunk((index % mChunkColumns) * ChunkSize,
+                          (index / mChunkColumns) * ChunkSize,
+                          ChunkSize, ChunkSize);
+        chunks.append(chunk & layerRect);
+    }
+
+    return chunks;
+}
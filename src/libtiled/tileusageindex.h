@@ -0,0 +1,113 @@
+/*
+ * tileusageindex.h
+ * Copyright 2016, Tiled contributors
+ *
+ * This file is part of libtiled.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *    1. Redistributions of source code must retain the above copyright notice,
+ *       this list of conditions and the following disclaimer.
+ *
+ *    2. Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE CONTRIBUTORS ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO
+ * EVENT SHALL THE CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ * OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+ * ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef TILEUSAGEINDEX_H
+#define TILEUSAGEINDEX_H
+
+#include "tiled_global.h"
+
+#include <QBitArray>
+#include <QHash>
+#include <QList>
+#include <QRect>
+#include <QVector>
+
+namespace Tiled {
+
+class Tile;
+class TileLayer;
+class Tileset;
+
+/**
+ * Keeps track of how often each tile is used on a tile layer, and in which
+ * parts of the layer.
+ *
+ * The layer is divided into square chunks, and for each tile a bitmap of the
+ * chunks it occurs in is kept. This allows finding all cells using a certain
+ * tile by only looking at those chunks.
+ */
+class TILEDSHARED_EXPORT TileUsageIndex
+{
+public:
+    enum { ChunkSize = 16 };
+
+    /**
+     * Creates the index for the current cells of \a layer.
+     */
+    explicit TileUsageIndex(const TileLayer *layer);
+
+    /**
+     * Updates the index for the given \a tile being placed at or removed
+     * from (\a x, \a y).
+     */
+    void add(const Tile *tile, int x, int y);
+    void remove(const Tile *tile, int x, int y);
+
+    /**
+     * Returns the number of cells using the given \a tile.
+     */
+    int count(const Tile *tile) const;
+
+    /**
+     * Returns the number of cells using a tile from the given \a tileset.
+     */
+    int count(const Tileset *tileset) const;
+
+    QList<Tileset*> tilesets() const;
+
+    /**
+     * Returns the areas of the chunks in which the given \a tile is used, in
+     * local coordinates and sorted by y and then x.
+     *
+     * Chunks are not cleared when a tile is removed from them, so the result
+     * may include chunks where the tile is no longer used.
+     */
+    QVector<QRect> chunks(const Tile *tile) const;
+
+private:
+    int chunkIndex(int x, int y) const
+    { return (y / ChunkSize) * mChunkColumns + x / ChunkSize; }
+
+    struct TileUsage {
+        TileUsage() : count(0) {}
+
+        int count;
+        QBitArray chunks;
+    };
+
+    int mWidth;
+    int mHeight;
+    int mChunkColumns;
+    int mChunkCount;
+    QHash<const Tile*, TileUsage> mTiles;
+    QHash<Tileset*, int> mTilesets;
+};
+
+} // namespace Tiled
+
+#endif // TILEUSAGEINDEX_H
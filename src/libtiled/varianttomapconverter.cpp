@@ -358,6 +358,25 @@ TileLayer *VariantToMapConverter::toTileLayer(const QVariantMap &variantMap)
     switch (layerDataFormat) {
     case Map::XML:
     case Map::CSV: {
+        if (dataVariant.userType() == qMetaTypeId<QVector<unsigned> >()) {
+            // Packed tile data, as produced by the JSON plugin
+            const QVector<unsigned> gids = dataVariant.value<QVector<unsigned> >();
+
+            if (gids.size() != width * height) {
+                mError = tr("Corrupt layer data for layer '%1'").arg(name);
+                return nullptr;
+            }
+
+            const unsigned *gid = gids.constData();
+            bool ok;
+
+            for (int y = 0; y < height; ++y)
+                for (int x = 0; x < width; ++x)
+                    tileLayer->setCell(x, y, mGidMapper.gidToCell(*gid++, ok));
+
+            break;
+        }
+
         const QVariantList dataVariantList = dataVariant.toList();
 
         if (dataVariantList.size() != width * height) {
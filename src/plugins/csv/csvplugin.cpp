@@ -20,6 +20,7 @@
 
 #include "csvplugin.h"
 
+#include "bufferedtextwriter.h"
 #include "map.h"
 #include "tile.h"
 #include "tilelayer.h"
@@ -27,6 +28,7 @@
 #include <QDir>
 #include <QFile>
 #include <QFileInfo>
+#include <QHash>
 #include <QSaveFile>
 
 using namespace Tiled;
@@ -41,6 +43,8 @@ bool CsvPlugin::write(const Map *map, const QString &fileName)
     // Get file paths for each layer
     QStringList layerPaths = outputFiles(map, fileName);
 
+    QHash<const Tile*, QByteArray> tileTexts;
+
     // Traverse all tile layers
     uint currentLayer = 0u;
     foreach (const Layer *layer, map->layers()) {
@@ -57,24 +61,38 @@ bool CsvPlugin::write(const Map *map, const QString &fileName)
         }
 
         // Write out tiles either by ID or their name, if given. -1 is "empty"
-        for (int y = 0; y < tileLayer->height(); ++y) {
-            for (int x = 0; x < tileLayer->width(); ++x) {
-                if (x > 0)
-                    file.write(",", 1);
-    
-                const Cell &cell = tileLayer->cellAt(x, y);
-                const Tile *tile = cell.tile;
-                if (tile && tile->hasProperty(QLatin1String("name"))) {
-                    file.write(tile->property(QLatin1String("name")).toString().toUtf8());
-                } else {
-                    const int id = tile ? tile->id() : -1;
-                    file.write(QByteArray::number(id));
+        {
+            BufferedTextWriter writer(&file);
+
+            for (int y = 0; y < tileLayer->height(); ++y) {
+                for (int x = 0; x < tileLayer->width(); ++x) {
+                    if (x > 0)
+                        writer.write(',');
+
+                    const Tile *tile = tileLayer->cellAt(x, y).tile;
+                    if (!tile) {
+                        writer.writeNumber(-1);
+                        continue;
+                    }
+
+                    // Determine the text for each tile only once
+                    QHash<const Tile*, QByteArray>::iterator text = tileTexts.find(tile);
+                    if (text == tileTexts.end()) {
+                        if (tile->hasProperty(QLatin1String("name"))) {
+                            const QString name = tile->property(QLatin1String("name")).toString();
+                            text = tileTexts.insert(tile, name.toUtf8());
+                        } else {
+                            text = tileTexts.insert(tile, QByteArray::number(tile->id()));
+                        }
+                    }
+
+                    writer.write(text.value());
                 }
+
+                writer.write('\n');
             }
-    
-            file.write("\n", 1);
         }
-    
+
         if (file.error() != QFile::NoError) {
             mError = file.errorString();
             return false;
@@ -22,6 +22,7 @@
 
 #include "flareplugin.h"
 
+#include "bufferedtextwriter.h"
 #include "gidmapper.h"
 #include "map.h"
 #include "mapobject.h"
@@ -321,19 +322,21 @@ bool FlarePlugin::write(const Tiled::Map *map, const QString &fileName)
             out << "[layer]\n";
             out << "type=" << layer->name() << "\n";
             out << "data=\n";
-            for (int y = 0; y < mapHeight; ++y) {
-                for (int x = 0; x < mapWidth; ++x) {
-                    Cell t = tileLayer->cellAt(x, y);
-                    int id = 0;
-                    if (t.tile)
-                        id = gidMapper.cellToGid(t);
-                    out << id;
-                    if (x < mapWidth - 1)
-                        out << ",";
+            out.flush();
+
+            // Write the tile data directly, bypassing the text stream
+            const QVector<unsigned> gids = gidMapper.cellsToGids(*tileLayer);
+            const int layerWidth = tileLayer->width();
+            const int layerHeight = tileLayer->height();
+            {
+                BufferedTextWriter writer(&file);
+                for (int y = 0; y < layerHeight; ++y) {
+                    writer.writeNumbers(gids.constData() + y * layerWidth,
+                                        layerWidth, ",");
+                    if (y < layerHeight - 1)
+                        writer.write(',');
+                    writer.write('\n');
                 }
-                if (y < mapHeight - 1)
-                    out << ",";
-                out << "\n";
             }
             out << "\n";
         }
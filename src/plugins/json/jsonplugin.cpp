@@ -24,15 +24,36 @@
 #include "maptovariantconverter.h"
 #include "varianttomapconverter.h"
 
+#include "jsonstreamreader.h"
+#include "jsonstreamwriter.h"
 #include "qjsonparser/json.h"
 
 #include <QFile>
 #include <QFileInfo>
 #include <QSaveFile>
-#include <QTextStream>
 
 namespace Json {
 
+/**
+ * Reads a JSON document from \a file. UTF-8 encoded files are parsed while
+ * reading them, other encodings are left to the JsonReader.
+ */
+static QVariant readJson(QFile &file, bool skipPrefix, QString &error)
+{
+    if (file.peek(4).contains('\0')) {
+        JsonReader reader;
+        reader.parse(file.readAll());
+        error = reader.errorString();
+        return reader.result();
+    }
+
+    JsonStreamReader reader(&file);
+    reader.setSkipPrefix(skipPrefix);
+    reader.parse();
+    error = reader.errorString();
+    return reader.result();
+}
+
 void JsonPlugin::initialize()
 {
     addObject(new JsonMapFormat(JsonMapFormat::Json, this));
@@ -54,24 +75,13 @@ Tiled::Map *JsonMapFormat::read(const QString &fileName)
         return nullptr;
     }
 
-    JsonReader reader;
-    QByteArray contents = file.readAll();
-    if (mSubFormat == JavaScript && contents.size() > 0 && contents[0] != '{') {
-        // Scan past JSONP prefix; look for an open curly at the start of the line
-        int i = contents.indexOf(QLatin1String("\n{"));
-        if (i > 0) {
-            contents.remove(0, i);
-            contents = contents.trimmed(); // potential trailing whitespace
-            if (contents.endsWith(';')) contents.chop(1);
-            if (contents.endsWith(')')) contents.chop(1);
-        }
-    }
-    reader.parse(contents);
-
-    const QVariant variant = reader.result();
+    QString parseError;
+    const QVariant variant = readJson(file, mSubFormat == JavaScript, parseError);
 
     if (!variant.isValid()) {
         mError = tr("Error parsing file.");
+        if (!parseError.isEmpty())
+            mError += QLatin1Char('\n') + parseError;
         return nullptr;
     }
 
@@ -94,35 +104,33 @@ bool JsonMapFormat::write(const Tiled::Map *map, const QString &fileName)
     }
 
     Tiled::MapToVariantConverter converter;
+    converter.setPackedTileData(true);
     QVariant variant = converter.toVariant(map, QFileInfo(fileName).dir());
 
-    JsonWriter writer;
+    JsonStreamWriter writer(&file);
     writer.setAutoFormatting(true);
 
-    if (!writer.stringify(variant)) {
+    if (mSubFormat == JavaScript) {
+        writer.writeRaw("(function(name,data){\n if(typeof onTileMapLoaded === 'undefined') {\n"
+                        "  if(typeof TileMaps === 'undefined') TileMaps = {};\n"
+                        "  TileMaps[name] = data;\n"
+                        " } else {\n"
+                        "  onTileMapLoaded(name,data);\n"
+                        " }})(");
+        // Trim and escape name
+        writer.write(QFileInfo(fileName).baseName());
+        writer.writeRaw(",\n");
+    }
+
+    if (!writer.write(variant)) {
         // This can only happen due to coding error
         mError = writer.errorString();
         return false;
     }
 
-    QTextStream out(&file);
-    if (mSubFormat == JavaScript) {
-        // Trim and escape name
-        JsonWriter nameWriter;
-        QString baseName = QFileInfo(fileName).baseName();
-        nameWriter.stringify(baseName);
-        out << "(function(name,data){\n if(typeof onTileMapLoaded === 'undefined') {\n";
-        out << "  if(typeof TileMaps === 'undefined') TileMaps = {};\n";
-        out << "  TileMaps[name] = data;\n";
-        out << " } else {\n";
-        out << "  onTileMapLoaded(name,data);\n";
-        out << " }})(" << nameWriter.result() << ",\n";
-    }
-    out << writer.result();
-    if (mSubFormat == JavaScript) {
-        out << ");";
-    }
-    out.flush();
+    if (mSubFormat == JavaScript)
+        writer.writeRaw(");");
+    writer.flush();
 
     if (file.error() != QFile::NoError) {
         mError = tr("Error while writing file:\n%1").arg(file.errorString());
@@ -173,15 +181,13 @@ Tiled::SharedTileset JsonTilesetFormat::read(const QString &fileName)
         return Tiled::SharedTileset();
     }
 
-    JsonReader reader;
-    QByteArray contents = file.readAll();
-
-    reader.parse(contents);
-
-    const QVariant variant = reader.result();
+    QString parseError;
+    const QVariant variant = readJson(file, false, parseError);
 
     if (!variant.isValid()) {
         mError = tr("Error parsing file.");
+        if (!parseError.isEmpty())
+            mError += QLatin1Char('\n') + parseError;
         return Tiled::SharedTileset();
     }
 
@@ -215,18 +221,16 @@ bool JsonTilesetFormat::write(const Tiled::Tileset &tileset,
     Tiled::MapToVariantConverter converter;
     QVariant variant = converter.toVariant(tileset, QFileInfo(fileName).dir());
 
-    JsonWriter writer;
+    JsonStreamWriter writer(&file);
     writer.setAutoFormatting(true);
 
-    if (!writer.stringify(variant)) {
+    if (!writer.write(variant)) {
         // This can only happen due to coding error
         mError = writer.errorString();
         return false;
     }
 
-    QTextStream out(&file);
-    out << writer.result();
-    out.flush();
+    writer.flush();
 
     if (file.error() != QFile::NoError) {
         mError = tr("Error while writing file:\n%1").arg(file.errorString());
@@ -0,0 +1,503 @@
+/*
+ * jsonstreamreader.cpp
+ * Copyright 2016, Tiled contributors
+ *
+ * This file is part of Tiled.
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation; either version 2 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "jsonstreamreader.h"
+
+#include <QIODevice>
+#include <QVector>
+
+#include <limits>
+
+using namespace Json;
+
+static const int BufferSize = 64 * 1024;
+static const int MaximumDepth = 512;
+
+static void appendUtf8(QByteArray &bytes, uint code)
+{
+    if (code < 0x80) {
+        bytes.append(char(code));
+    } else if (code < 0x800) {
+        bytes.append(char(0xC0 | (code >> 6)));
+        bytes.append(char(0x80 | (code & 0x3F)));
+    } else if (code < 0x10000) {
+        bytes.append(char(0xE0 | (code >> 12)));
+        bytes.append(char(0x80 | ((code >> 6) & 0x3F)));
+        bytes.append(char(0x80 | (code & 0x3F)));
+    } else {
+        bytes.append(char(0xF0 | (code >> 18)));
+        bytes.append(char(0x80 | ((code >> 12) & 0x3F)));
+        bytes.append(char(0x80 | ((code >> 6) & 0x3F)));
+        bytes.append(char(0x80 | (code & 0x3F)));
+    }
+}
+
+static void unpack(QVector<unsigned> &packed, QVariantList &list)
+{
+    list.reserve(packed.size());
+    for (unsigned value : packed)
+        list.append(qlonglong(value));
+    packed.clear();
+}
+
+/**
+ * The "data" array is parsed in packed form before it is known whether the
+ * object is a tile layer, since its "type" may come later. Only the data of
+ * tile layers is left packed.
+ */
+static void unpackUnlessTileLayer(QVariantMap &map)
+{
+    const QVariantMap::iterator data = map.find(QLatin1String("data"));
+    if (data == map.end())
+        return;
+    if (data.value().userType() != qMetaTypeId<QVector<unsigned> >())
+        return;
+    if (map.value(QLatin1String("type")).toString() == QLatin1String("tilelayer"))
+        return;
+
+    QVector<unsigned> packed = data.value().value<QVector<unsigned> >();
+    QVariantList list;
+    unpack(packed, list);
+    data.value() = list;
+}
+
+
+JsonStreamReader::JsonStreamReader(QIODevice *device)
+    : mDevice(device)
+    , mPos(0)
+    , mEnd(0)
+    , mLine(1)
+    , mSkipPrefix(false)
+{
+}
+
+bool JsonStreamReader::parse()
+{
+    mResult = QVariant();
+    mError.clear();
+    mLine = 1;
+
+    // Skip the UTF-8 byte order mark
+    if (peek() == 0xEF) {
+        if (next() != 0xEF || next() != 0xBB || next() != 0xBF) {
+            setError(QLatin1String("Invalid byte order mark"));
+            return false;
+        }
+    }
+
+    if (mSkipPrefix && skipWhitespace() != '{') {
+        int c;
+        while ((c = next()) != -1) {
+            if (c == '\n') {
+                ++mLine;
+                if (peek() == '{')
+                    break;
+            }
+        }
+        if (c == -1) {
+            setError(QLatin1String("No object found"));
+            return false;
+        }
+    }
+
+    const QVariant value = parseValue(false, 0);
+    if (!mError.isEmpty())
+        return false;
+
+    if (!mSkipPrefix && skipWhitespace() != -1) {
+        setError(QLatin1String("Unexpected data after the end of the document"));
+        return false;
+    }
+
+    mResult = value;
+    return true;
+}
+
+/**
+ * Reads the next chunk from the device. Returns false when there is no more
+ * data.
+ */
+bool JsonStreamReader::fill()
+{
+    if (mBuffer.size() != BufferSize)
+        mBuffer.resize(BufferSize);
+
+    const qint64 bytesRead = mDevice->read(mBuffer.data(), BufferSize);
+
+    mPos = 0;
+    mEnd = bytesRead > 0 ? int(bytesRead) : 0;
+    return mEnd > 0;
+}
+
+/**
+ * Returns the current character without consuming it, or -1 at the end of
+ * the data.
+ */
+inline int JsonStreamReader::peek()
+{
+    if (mPos == mEnd && !fill())
+        return -1;
+    return static_cast<uchar>(mBuffer.constData()[mPos]);
+}
+
+inline int JsonStreamReader::next()
+{
+    const int c = peek();
+    if (c != -1)
+        ++mPos;
+    return c;
+}
+
+/**
+ * Skips any whitespace and returns the next character without consuming it.
+ */
+int JsonStreamReader::skipWhitespace()
+{
+    for (;;) {
+        const int c = peek();
+        switch (c) {
+        case '\n':
+            ++mLine;
+            // fall through
+        case ' ':
+        case '\t':
+        case '\r':
+            ++mPos;
+            break;
+        default:
+            return c;
+        }
+    }
+}
+
+bool JsonStreamReader::expect(char c)
+{
+    if (skipWhitespace() != c) {
+        setError(QString(QLatin1String("Expected '%1'")).arg(QLatin1Char(c)));
+        return false;
+    }
+
+    ++mPos;
+    return true;
+}
+
+QVariant JsonStreamReader::parseValue(bool packIntegers, int depth)
+{
+    if (depth > MaximumDepth) {
+        setError(QLatin1String("Nesting too deep"));
+        return QVariant();
+    }
+
+    const int c = skipWhitespace();
+
+    switch (c) {
+    case '{':
+        return parseObject(depth + 1);
+    case '[':
+        return parseArray(packIntegers, depth + 1);
+    case '"': {
+        QString string;
+        if (parseString(string))
+            return string;
+        return QVariant();
+    }
+    case 't':
+        if (parseKeyword("true"))
+            return true;
+        return QVariant();
+    case 'f':
+        if (parseKeyword("false"))
+            return false;
+        return QVariant();
+    case 'n':
+        parseKeyword("null");
+        return QVariant();
+    case -1:
+        setError(QLatin1String("Unexpected end of file"));
+        return QVariant();
+    }
+
+    if (c == '-' || (c >= '0' && c <= '9')) {
+        qlonglong integer;
+        double real;
+        bool isInteger;
+        if (!parseNumber(integer, real, isInteger))
+            return QVariant();
+        return isInteger ? QVariant(integer) : QVariant(real);
+    }
+
+    setError(QString(QLatin1String("Unexpected character '%1'")).arg(QChar(c)));
+    return QVariant();
+}
+
+QVariant JsonStreamReader::parseObject(int depth)
+{
+    ++mPos;     // '{'
+
+    QVariantMap map;
+    if (skipWhitespace() == '}') {
+        ++mPos;
+        return map;
+    }
+
+    for (;;) {
+        if (skipWhitespace() != '"') {
+            setError(QLatin1String("Expected a string as object key"));
+            return QVariant();
+        }
+
+        QString key;
+        if (!parseString(key) || !expect(':'))
+            return QVariant();
+
+        const bool packIntegers = key == QLatin1String("data");
+        map.insert(key, parseValue(packIntegers, depth));
+        if (!mError.isEmpty())
+            return QVariant();
+
+        const int c = skipWhitespace();
+        if (c == ',') {
+            ++mPos;
+        } else if (c == '}') {
+            ++mPos;
+            unpackUnlessTileLayer(map);
+            return map;
+        } else {
+            setError(QLatin1String("Expected ',' or '}'"));
+            return QVariant();
+        }
+    }
+}
+
+/**
+ * Parses an array. When \a packIntegers is true and the array contains only
+ * unsigned integers, it is returned as a QVector<unsigned>.
+ */
+QVariant JsonStreamReader::parseArray(bool packIntegers, int depth)
+{
+    ++mPos;     // '['
+
+    QVariantList list;
+    QVector<unsigned> packed;
+
+    if (skipWhitespace() == ']') {
+        ++mPos;
+        return packIntegers ? QVariant::fromValue(packed) : QVariant(list);
+    }
+
+    for (;;) {
+        const int c = skipWhitespace();
+
+        if (packIntegers && c >= '0' && c <= '9') {
+            qlonglong integer;
+            double real;
+            bool isInteger;
+            if (!parseNumber(integer, real, isInteger))
+                return QVariant();
+
+            if (isInteger && integer <= std::numeric_limits<unsigned>::max()) {
+                packed.append(unsigned(integer));
+            } else {
+                packIntegers = false;
+                unpack(packed, list);
+                list.append(isInteger ? QVariant(integer) : QVariant(real));
+            }
+        } else {
+            if (packIntegers) {
+                packIntegers = false;
+                unpack(packed, list);
+            }
+
+            list.append(parseValue(false, depth));
+            if (!mError.isEmpty())
+                return QVariant();
+        }
+
+        const int separator = skipWhitespace();
+        if (separator == ',') {
+            ++mPos;
+        } else if (separator == ']') {
+            ++mPos;
+            return packIntegers ? QVariant::fromValue(packed) : QVariant(list);
+        } else {
+            setError(QLatin1String("Expected ',' or ']'"));
+            return QVariant();
+        }
+    }
+}
+
+bool JsonStreamReader::parseString(QString &string)
+{
+    ++mPos;     // '"'
+
+    mStringBuffer.resize(0);
+
+    for (;;) {
+        if (mPos == mEnd && !fill()) {
+            setError(QLatin1String("Unterminated string"));
+            return false;
+        }
+
+        // Copy unescaped characters in bulk
+        const char *data = mBuffer.constData();
+        const int start = mPos;
+        while (mPos < mEnd && data[mPos] != '"' && data[mPos] != '\\')
+            ++mPos;
+
+        mStringBuffer.append(data + start, mPos - start);
+
+        if (mPos == mEnd)
+            continue;
+
+        if (data[mPos++] == '"') {
+            string = QString::fromUtf8(mStringBuffer);
+            return true;
+        }
+
+        const int c = next();
+        switch (c) {
+        case '"':
+        case '\\':
+        case '/':
+            mStringBuffer.append(char(c));
+            break;
+        case 'b': mStringBuffer.append('\b'); break;
+        case 'f': mStringBuffer.append('\f'); break;
+        case 'n': mStringBuffer.append('\n'); break;
+        case 'r': mStringBuffer.append('\r'); break;
+        case 't': mStringBuffer.append('\t'); break;
+        case 'u': {
+            uint code = 0;
+            bool surrogate = false;
+
+            for (int part = 0; part < 2; ++part) {
+                if (part == 1 && (next() != '\\' || next() != 'u')) {
+                    setError(QLatin1String("Invalid surrogate pair"));
+                    return false;
+                }
+
+                uint unit = 0;
+                for (int i = 0; i < 4; ++i) {
+                    const int h = next();
+                    unit <<= 4;
+                    if (h >= '0' && h <= '9') {
+                        unit |= h - '0';
+                    } else if (h >= 'a' && h <= 'f') {
+                        unit |= h - 'a' + 10;
+                    } else if (h >= 'A' && h <= 'F') {
+                        unit |= h - 'A' + 10;
+                    } else {
+                        setError(QLatin1String("Invalid unicode escape"));
+                        return false;
+                    }
+                }
+
+                if (part == 0) {
+                    code = unit;
+                    surrogate = unit >= 0xD800 && unit < 0xDC00;
+                    if (!surrogate)
+                        break;
+                } else if (unit >= 0xDC00 && unit < 0xE000) {
+                    code = 0x10000 + ((code - 0xD800) << 10) + (unit - 0xDC00);
+                } else {
+                    setError(QLatin1String("Invalid surrogate pair"));
+                    return false;
+                }
+            }
+
+            appendUtf8(mStringBuffer, code);
+            break;
+        }
+        default:
+            setError(QLatin1String("Invalid escape sequence"));
+            return false;
+        }
+    }
+}
+
+/**
+ * Parses a number. Integers that fit in a qlonglong are returned in
+ * \a integer, other numbers in \a real.
+ */
+bool JsonStreamReader::parseNumber(qlonglong &integer, double &real,
+                                   bool &isInteger)
+{
+    char token[64];
+    int length = 0;
+    isInteger = true;
+
+    for (;;) {
+        const int c = peek();
+        if (c == '.' || c == 'e' || c == 'E' || c == '+')
+            isInteger = false;
+        else if (c != '-' && (c < '0' || c > '9'))
+            break;
+
+        if (length == int(sizeof(token)) - 1) {
+            setError(QLatin1String("Number too long"));
+            return false;
+        }
+
+        token[length++] = char(c);
+        ++mPos;
+    }
+
+    const bool negative = token[0] == '-';
+    const int digits = length - negative;
+
+    // Up to 18 digits always fit in a qlonglong
+    if (isInteger && digits > 0 && digits <= 18) {
+        qlonglong value = 0;
+        for (int i = negative; i < length; ++i) {
+            if (token[i] < '0' || token[i] > '9') {
+                setError(QLatin1String("Invalid number"));
+                return false;
+            }
+            value = value * 10 + (token[i] - '0');
+        }
+
+        integer = negative ? -value : value;
+        return true;
+    }
+
+    bool ok;
+    isInteger = false;
+    real = QByteArray::fromRawData(token, length).toDouble(&ok);
+    if (!ok)
+        setError(QLatin1String("Invalid number"));
+    return ok;
+}
+
+bool JsonStreamReader::parseKeyword(const char *keyword)
+{
+    for (const char *c = keyword; *c; ++c) {
+        if (next() != *c) {
+            setError(QLatin1String("Invalid keyword"));
+            return false;
+        }
+    }
+    return true;
+}
+
+void JsonStreamReader::setError(const QString &message)
+{
+    if (mError.isEmpty())
+        mError = QString(QLatin1String("%1 on line %2")).arg(message).arg(mLine);
+}
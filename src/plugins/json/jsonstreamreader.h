@@ -0,0 +1,93 @@
+/*
+ * jsonstreamreader.h
+ * Copyright 2016, Tiled contributors
+ *
+ * This file is part of Tiled.
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation; either version 2 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef JSONSTREAMREADER_H
+#define JSONSTREAMREADER_H
+
+#include <QByteArray>
+#include <QString>
+#include <QVariant>
+
+class QIODevice;
+
+namespace Json {
+
+/**
+ * A JSON reader that parses UTF-8 encoded data while reading it from a
+ * device in chunks, without first converting the whole document to a
+ * QString.
+ *
+ * The result is the same QVariant tree the JsonReader produces, except that
+ * the "data" arrays of tile layers that contain only unsigned integers are
+ * returned as a QVector<unsigned>. This avoids allocating a QVariant for each
+ * tile of a tile layer.
+ */
+class JsonStreamReader
+{
+public:
+    explicit JsonStreamReader(QIODevice *device);
+
+    /**
+     * Sets whether a JSONP prefix should be skipped. When enabled, anything
+     * before the first line starting with '{' is skipped and anything after
+     * the top-level value is ignored.
+     */
+    void setSkipPrefix(bool skipPrefix) { mSkipPrefix = skipPrefix; }
+
+    /**
+     * Parses the contents of the device. Returns whether this was
+     * successful.
+     */
+    bool parse();
+
+    const QVariant &result() const { return mResult; }
+    const QString &errorString() const { return mError; }
+
+private:
+    bool fill();
+    inline int peek();
+    inline int next();
+    int skipWhitespace();
+    bool expect(char c);
+
+    QVariant parseValue(bool packIntegers, int depth);
+    QVariant parseObject(int depth);
+    QVariant parseArray(bool packIntegers, int depth);
+    bool parseString(QString &string);
+    bool parseNumber(qlonglong &integer, double &real, bool &isInteger);
+    bool parseKeyword(const char *keyword);
+
+    void setError(const QString &message);
+
+    QIODevice *mDevice;
+    QByteArray mBuffer;
+    int mPos;
+    int mEnd;
+    int mLine;
+    bool mSkipPrefix;
+
+    QByteArray mStringBuffer;
+    QVariant mResult;
+    QString mError;
+};
+
+} // namespace Json
+
+#endif // JSONSTREAMREADER_H
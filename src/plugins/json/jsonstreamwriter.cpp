@@ -0,0 +1,180 @@
+/*
+ * jsonstreamwriter.cpp
+ * Copyright 2016, Tiled contributors
+ *
+ * This file is part of Tiled.
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation; either version 2 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "jsonstreamwriter.h"
+
+#include <qnumeric.h>
+
+using namespace Json;
+
+static const int IndentSize = 4;
+
+JsonStreamWriter::JsonStreamWriter(QIODevice *device)
+    : mWriter(device)
+    , mAutoFormatting(false)
+{
+}
+
+bool JsonStreamWriter::write(const QVariant &variant)
+{
+    mError.clear();
+    stringify(variant, 0);
+    return mError.isEmpty();
+}
+
+void JsonStreamWriter::writeIndent(int depth)
+{
+    for (int i = depth * IndentSize; i > 0; --i)
+        mWriter.write(' ');
+}
+
+/**
+ * Follows the formatting of JsonWriter::stringify, so that both writers
+ * produce the same output.
+ */
+void JsonStreamWriter::stringify(const QVariant &variant, int depth)
+{
+    const int type = variant.userType();
+
+    if (type == QMetaType::QVariantList || type == QMetaType::QStringList) {
+        mWriter.write('[');
+        const QVariantList list = variant.toList();
+        for (int i = 0; i < list.count(); ++i) {
+            if (i != 0) {
+                mWriter.write(',');
+                if (mAutoFormatting)
+                    mWriter.write(' ');
+            }
+            stringify(list.at(i), depth + 1);
+        }
+        mWriter.write(']');
+    } else if (type == qMetaTypeId<QVector<unsigned> >()) {
+        const QVector<unsigned> &numbers =
+                *static_cast<const QVector<unsigned>*>(variant.constData());
+        mWriter.write('[');
+        mWriter.writeNumbers(numbers.constData(), numbers.size(),
+                             mAutoFormatting ? ", " : ",");
+        mWriter.write(']');
+    } else if (type == QMetaType::QVariantMap) {
+        const QVariantMap map = variant.toMap();
+        if (mAutoFormatting && depth != 0) {
+            mWriter.write('\n');
+            writeIndent(depth);
+            mWriter.write("{\n", 2);
+        } else {
+            mWriter.write('{');
+        }
+        for (QVariantMap::const_iterator it = map.constBegin(); it != map.constEnd(); ++it) {
+            if (it != map.constBegin()) {
+                mWriter.write(',');
+                if (mAutoFormatting)
+                    mWriter.write('\n');
+            }
+            if (mAutoFormatting) {
+                writeIndent(depth);
+                mWriter.write(' ');
+            }
+            writeString(it.key());
+            mWriter.write(':');
+            stringify(it.value(), depth + 1);
+        }
+        if (mAutoFormatting) {
+            mWriter.write('\n');
+            writeIndent(depth);
+        }
+        mWriter.write('}');
+    } else if (type == QMetaType::QString || type == QMetaType::QByteArray) {
+        writeString(variant.toString());
+    } else if (type == QMetaType::Double || type == QMetaType::Float) {
+        const double d = variant.toDouble();
+        if (qIsFinite(d))
+            writeRaw(QByteArray::number(d, 'g', 15));
+        else
+            mWriter.write("null", 4);
+    } else if (type == QMetaType::Bool) {
+        if (variant.toBool())
+            mWriter.write("true", 4);
+        else
+            mWriter.write("false", 5);
+    } else if (type == QMetaType::UnknownType) {
+        mWriter.write("null", 4);
+    } else if (type == QMetaType::UInt) {
+        mWriter.writeNumber(variant.toUInt());
+    } else if (type == QMetaType::ULongLong) {
+        writeRaw(QByteArray::number(variant.toULongLong()));
+    } else if (type == QMetaType::Int || type == QMetaType::LongLong) {
+        writeRaw(QByteArray::number(variant.toLongLong()));
+    } else if (type == QMetaType::QChar) {
+        writeString(QString(variant.toChar()));
+    } else if (variant.canConvert<qlonglong>()) {
+        writeRaw(QByteArray::number(variant.toLongLong()));
+    } else if (variant.canConvert<QString>()) {
+        writeString(variant.toString());
+    } else {
+        if (!mError.isEmpty())
+            mError.append(QLatin1Char('\n'));
+        mError.append(QString(QLatin1String("Unsupported type %1 (id: %2)"))
+                      .arg(QString::fromUtf8(variant.typeName()))
+                      .arg(type));
+        mWriter.write("null", 4);
+    }
+}
+
+/**
+ * Writes a quoted string, escaping special and non-ASCII characters.
+ */
+void JsonStreamWriter::writeString(const QString &string)
+{
+    static const char hexDigits[] = "0123456789abcdef";
+
+    mWriter.write('"');
+
+    const ushort *data = string.utf16();
+    const int length = string.length();
+
+    for (int i = 0; i < length; ++i) {
+        const ushort c = data[i];
+        switch (c) {
+        case '\b': mWriter.write("\\b", 2); break;
+        case '\f': mWriter.write("\\f", 2); break;
+        case '\n': mWriter.write("\\n", 2); break;
+        case '\r': mWriter.write("\\r", 2); break;
+        case '\t': mWriter.write("\\t", 2); break;
+        case '"':  mWriter.write("\\\"", 2); break;
+        case '\\': mWriter.write("\\\\", 2); break;
+        case '/':  mWriter.write("\\/", 2); break;
+        default:
+            if (c > 127) {
+                const char escaped[6] = {
+                    '\\', 'u',
+                    hexDigits[(c >> 12) & 0xF],
+                    hexDigits[(c >> 8) & 0xF],
+                    hexDigits[(c >> 4) & 0xF],
+                    hexDigits[c & 0xF]
+                };
+                mWriter.write(escaped, 6);
+            } else {
+                mWriter.write(char(c));
+            }
+        }
+    }
+
+    mWriter.write('"');
+}
@@ -0,0 +1,80 @@
+/*
+ * jsonstreamwriter.h
+ * Copyright 2016, Tiled contributors
+ *
+ * This file is part of Tiled.
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation; either version 2 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef JSONSTREAMWRITER_H
+#define JSONSTREAMWRITER_H
+
+#include "bufferedtextwriter.h"
+
+#include <QByteArray>
+#include <QString>
+#include <QVariant>
+#include <QVector>
+
+class QIODevice;
+
+namespace Json {
+
+/**
+ * A JSON writer that writes its output to a device in chunks, rather than
+ * building up the whole document as a QString first.
+ *
+ * It produces the same output as the JsonWriter, and in addition supports
+ * QVector<unsigned> values, which are written as an array of numbers. This
+ * is used for the packed tile layer data.
+ */
+class JsonStreamWriter
+{
+public:
+    explicit JsonStreamWriter(QIODevice *device);
+
+    void setAutoFormatting(bool enable) { mAutoFormatting = enable; }
+
+    /**
+     * Writes the given \a variant as JSON. Returns false when it contained
+     * an unsupported type, which is written as null.
+     */
+    bool write(const QVariant &variant);
+
+    /**
+     * Writes the given \a data as-is.
+     */
+    void writeRaw(const QByteArray &data) { mWriter.write(data); }
+
+    /**
+     * Writes any buffered output to the device.
+     */
+    void flush() { mWriter.flush(); }
+
+    const QString &errorString() const { return mError; }
+
+private:
+    void stringify(const QVariant &variant, int depth);
+    void writeString(const QString &string);
+    void writeIndent(int depth);
+
+    Tiled::BufferedTextWriter mWriter;
+    bool mAutoFormatting;
+    QString mError;
+};
+
+} // namespace Json
+
+#endif // JSONSTREAMWRITER_H
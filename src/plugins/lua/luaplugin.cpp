@@ -334,18 +334,22 @@ void LuaPlugin::writeTileLayer(LuaTableWriter &writer,
 
     switch (format) {
     case Map::XML:
-    case Map::CSV:
+    case Map::CSV: {
         writer.writeKeyAndValue("encoding", "lua");
         writer.writeStartTable("data");
+
+        const QVector<unsigned> gids = mGidMapper.cellsToGids(*tileLayer);
+        const int width = tileLayer->width();
+
         for (int y = 0; y < tileLayer->height(); ++y) {
             if (y > 0)
                 writer.prepareNewLine();
 
-            for (int x = 0; x < tileLayer->width(); ++x)
-                writer.writeValue(mGidMapper.cellToGid(tileLayer->cellAt(x, y)));
+            writer.writeValues(gids.constData() + y * width, width);
         }
         writer.writeEndTable();
         break;
+    }
 
     case Map::Base64:
     case Map::Base64Zlib:
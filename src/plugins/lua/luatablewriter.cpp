@@ -25,13 +25,12 @@
 namespace Lua {
 
 LuaTableWriter::LuaTableWriter(QIODevice *device)
-    : m_device(device)
+    : m_writer(device)
     , m_indent(0)
     , m_valueSeparator(',')
     , m_suppressNewlines(false)
     , m_newLine(true)
     , m_valueWritten(false)
-    , m_error(false)
 {
 }
 
@@ -44,6 +43,7 @@ void LuaTableWriter::writeEndDocument()
 {
     Q_ASSERT(m_indent == 0);
     write('\n');
+    m_writer.flush();
 }
 
 void LuaTableWriter::writeStartTable()
@@ -93,6 +93,24 @@ void LuaTableWriter::writeValue(const QByteArray &value)
     m_valueWritten = true;
 }
 
+/**
+ * Writes \a count numbers from \a values as separate values of the current
+ * table. This is a lot faster than calling writeValue for each number.
+ */
+void LuaTableWriter::writeValues(const unsigned *values, int count)
+{
+    if (count == 0)
+        return;
+
+    prepareNewValue();
+
+    const char separator[3] = { m_valueSeparator, ' ', '\0' };
+    m_writer.writeNumbers(values, count, separator);
+
+    m_newLine = false;
+    m_valueWritten = true;
+}
+
 void LuaTableWriter::writeUnquotedValue(const QByteArray &value)
 {
     prepareNewValue();
@@ -220,10 +238,4 @@ void LuaTableWriter::writeNewline()
     }
 }
 
-void LuaTableWriter::write(const char *bytes, unsigned length)
-{
-    if (m_device->write(bytes, length) != length)
-        m_error = true;
-}
-
 } // namespace Lua
@@ -21,6 +21,8 @@
 #ifndef LUATABLEWRITER_H
 #define LUATABLEWRITER_H
 
+#include "bufferedtextwriter.h"
+
 #include <QByteArray>
 #include <QString>
 #include <QVariant>
@@ -50,6 +52,8 @@ public:
     void writeValue(const QByteArray &value);
     void writeValue(const QString &value);
 
+    void writeValues(const unsigned *values, int count);
+
     void writeUnquotedValue(const QByteArray &value);
 
     void writeKeyAndValue(const QByteArray &key, int value);
@@ -69,7 +73,7 @@ public:
 
     void prepareNewLine();
 
-    bool hasError() const { return m_error; }
+    bool hasError() const { return m_writer.hasError(); }
 
     static QString quote(const QString &str);
 
@@ -83,20 +87,29 @@ private:
     void write(const QByteArray &bytes);
     void write(char c);
 
-    QIODevice *m_device;
+    Tiled::BufferedTextWriter m_writer;
     int m_indent;
     char m_valueSeparator;
     bool m_suppressNewlines;
     bool m_newLine;
     bool m_valueWritten;
-    bool m_error;
 };
 
 inline void LuaTableWriter::writeValue(int value)
-{ writeUnquotedValue(QByteArray::number(value)); }
+{
+    prepareNewValue();
+    m_writer.writeNumber(value);
+    m_newLine = false;
+    m_valueWritten = true;
+}
 
 inline void LuaTableWriter::writeValue(unsigned value)
-{ writeUnquotedValue(QByteArray::number(value)); }
+{
+    prepareNewValue();
+    m_writer.writeNumber(value);
+    m_newLine = false;
+    m_valueWritten = true;
+}
 
 inline void LuaTableWriter::writeValue(const QString &value)
 { writeUnquotedValue(quote(value).toUtf8()); }
@@ -116,14 +129,17 @@ inline void LuaTableWriter::writeKeyAndValue(const QByteArray &key, bool value)
 inline void LuaTableWriter::writeKeyAndValue(const QByteArray &key, const QString &value)
 { writeKeyAndUnquotedValue(key, quote(value).toUtf8()); }
 
+inline void LuaTableWriter::write(const char *bytes, unsigned length)
+{ m_writer.write(bytes, length); }
+
 inline void LuaTableWriter::write(const char *bytes)
-{ write(bytes, qstrlen(bytes)); }
+{ m_writer.write(bytes); }
 
 inline void LuaTableWriter::write(const QByteArray &bytes)
-{ write(bytes.constData(), bytes.length()); }
+{ m_writer.write(bytes); }
 
 inline void LuaTableWriter::write(char c)
-{ write(&c, 1); }
+{ m_writer.write(c); }
 
 /**
  * Sets whether newlines should be suppressed. While newlines are suppressed,
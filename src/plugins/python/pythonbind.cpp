@@ -89,6 +89,7 @@ typedef enum _PyBindGenWrapperFlags {
 #include "tilelayer.h"
 #include "objectgroup.h"
 #include "tileset.h"
+#include "gidmapper.h"
 #include <QImage>
 #include <QFileDialog>
 #include <QWidget>
@@ -2422,6 +2423,86 @@ bool loadTilesetFromFile(Tiled::Tileset *ts, QString file)
     return ts->loadFromImage(img, file);
 }
 
+/*
+ * Bulk access to the cells of a tile layer, to avoid a round trip between
+ * Python and C++ for every cell. The GIDs are stored row by row as unsigned
+ * 32-bit integers in native byte order, using the tilesets of the given map.
+ */
+PyObject* tileLayerGids(Tiled::Map *map, Tiled::TileLayer *layer)
+{
+    const Tiled::GidMapper gidMapper(map->tilesets());
+    const QVector<unsigned> gids = gidMapper.cellsToGids(*layer);
+
+    return PyByteArray_FromStringAndSize(
+                reinterpret_cast<const char*>(gids.constData()),
+                gids.size() * sizeof(unsigned));
+}
+
+PyObject* setTileLayerGids(Tiled::Map *map, Tiled::TileLayer *layer, PyObject *data)
+{
+    const Py_ssize_t expectedSize = Py_ssize_t(layer->width()) * layer->height() * sizeof(unsigned);
+    const unsigned *gids = 0;
+    Py_ssize_t size = 0;
+
+    Py_buffer view;
+    bool haveView = false;
+
+    if (PyObject_CheckBuffer(data)) {
+        if (PyObject_GetBuffer(data, &view, PyBUF_SIMPLE) < 0)
+            return NULL;
+        haveView = true;
+        gids = static_cast<const unsigned*>(view.buf);
+        size = view.len;
+    } else {
+#if PY_VERSION_HEX < 0x03000000
+        // Old-style buffers, like array.array on Python 2
+        const void *buffer;
+        if (PyObject_AsReadBuffer(data, &buffer, &size) < 0)
+            return NULL;
+        gids = static_cast<const unsigned*>(buffer);
+#else
+        PyErr_SetString(PyExc_TypeError, "data does not support the buffer protocol");
+        return NULL;
+#endif
+    }
+
+    if (size != expectedSize) {
+        if (haveView)
+            PyBuffer_Release(&view);
+        PyErr_Format(PyExc_ValueError, "expected %zd bytes of data, got %zd",
+                     expectedSize, size);
+        return NULL;
+    }
+
+    const Tiled::GidMapper gidMapper(map->tilesets());
+    QVector<Tiled::Cell> cells(layer->width() * layer->height());
+
+    for (int i = 0; i < cells.size(); ++i) {
+        unsigned gid;
+        memcpy(&gid, gids + i, sizeof(unsigned));   // may be unaligned
+
+        bool ok;
+        cells[i] = gidMapper.gidToCell(gid, ok);
+        if (!ok) {
+            if (haveView)
+                PyBuffer_Release(&view);
+            PyErr_Format(PyExc_ValueError, "invalid tile: %u", gid);
+            return NULL;
+        }
+    }
+
+    if (haveView)
+        PyBuffer_Release(&view);
+
+    // Only touch the layer once all GIDs are known to be valid
+    const int width = layer->width();
+    for (int i = 0; i < cells.size(); ++i)
+        layer->setCell(i % width, i / width, cells.at(i));
+
+    Py_INCREF(Py_None);
+    return Py_None;
+}
+
 #if PY_VERSION_HEX >= 0x03000000
 static struct PyModuleDef qt_moduledef = {
     PyModuleDef_HEAD_INIT,
@@ -6319,12 +6400,61 @@ _wrap_tiled_tileLayerAt(PyObject * PYBINDGEN_UNUSED(dummy), PyObject *args, PyOb
 }
 PyObject * _wrap_tiled_tileLayerAt(PyObject * PYBINDGEN_UNUSED(dummy), PyObject *args, PyObject *kwargs);
 
+
+PyObject *
+_wrap_tiled_tileLayerGids(PyObject * PYBINDGEN_UNUSED(dummy), PyObject *args, PyObject *kwargs)
+{
+    PyObject *py_retval;
+    PyObject *retval;
+    PyTiledMap *map;
+    Tiled::Map *map_ptr;
+    PyTiledTileLayer *layer;
+    Tiled::TileLayer *layer_ptr;
+    const char *keywords[] = {"map", "layer", NULL};
+
+    if (!PyArg_ParseTupleAndKeywords(args, kwargs, (char *) "O!O!", (char **) keywords, &PyTiledMap_Type, &map, &PyTiledTileLayer_Type, &layer)) {
+        return NULL;
+    }
+    map_ptr = (map ? map->obj : NULL);
+    layer_ptr = (layer ? layer->obj : NULL);
+    retval = tileLayerGids(map_ptr, layer_ptr);
+    py_retval = Py_BuildValue((char *) "N", retval);
+    return py_retval;
+}
+PyObject * _wrap_tiled_tileLayerGids(PyObject * PYBINDGEN_UNUSED(dummy), PyObject *args, PyObject *kwargs);
+
+
+PyObject *
+_wrap_tiled_setTileLayerGids(PyObject * PYBINDGEN_UNUSED(dummy), PyObject *args, PyObject *kwargs)
+{
+    PyObject *py_retval;
+    PyObject *retval;
+    PyTiledMap *map;
+    Tiled::Map *map_ptr;
+    PyTiledTileLayer *layer;
+    Tiled::TileLayer *layer_ptr;
+    PyObject *data;
+    const char *keywords[] = {"map", "layer", "data", NULL};
+
+    if (!PyArg_ParseTupleAndKeywords(args, kwargs, (char *) "O!O!O", (char **) keywords, &PyTiledMap_Type, &map, &PyTiledTileLayer_Type, &layer, &data)) {
+        return NULL;
+    }
+    map_ptr = (map ? map->obj : NULL);
+    layer_ptr = (layer ? layer->obj : NULL);
+    retval = setTileLayerGids(map_ptr, layer_ptr, data);
+    py_retval = Py_BuildValue((char *) "N", retval);
+    return py_retval;
+}
+PyObject * _wrap_tiled_setTileLayerGids(PyObject * PYBINDGEN_UNUSED(dummy), PyObject *args, PyObject *kwargs);
+
 static PyMethodDef tiled_functions[] = {
     {(char *) "isTileLayerAt", (PyCFunction) _wrap_tiled_isTileLayerAt, METH_KEYWORDS|METH_VARARGS, NULL },
     {(char *) "loadTilesetFromFile", (PyCFunction) _wrap_tiled_loadTilesetFromFile, METH_KEYWORDS|METH_VARARGS, NULL },
     {(char *) "objectGroupAt", (PyCFunction) _wrap_tiled_objectGroupAt, METH_KEYWORDS|METH_VARARGS, NULL },
     {(char *) "isObjectGroupAt", (PyCFunction) _wrap_tiled_isObjectGroupAt, METH_KEYWORDS|METH_VARARGS, NULL },
     {(char *) "tileLayerAt", (PyCFunction) _wrap_tiled_tileLayerAt, METH_KEYWORDS|METH_VARARGS, NULL },
+    {(char *) "tileLayerGids", (PyCFunction) _wrap_tiled_tileLayerGids, METH_KEYWORDS|METH_VARARGS, NULL },
+    {(char *) "setTileLayerGids", (PyCFunction) _wrap_tiled_setTileLayerGids, METH_KEYWORDS|METH_VARARGS, NULL },
     {NULL, NULL, 0, NULL}
 };
 /* --- classes --- */
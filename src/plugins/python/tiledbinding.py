@@ -30,6 +30,7 @@ mod.add_include('"imagelayer.h"')
 mod.add_include('"tilelayer.h"')
 mod.add_include('"objectgroup.h"')
 mod.add_include('"tileset.h"')
+mod.add_include('"gidmapper.h"')
 
 mod.header.writeln('#pragma GCC diagnostic ignored "-Wmissing-field-initializers"')
 
@@ -285,6 +286,98 @@ bool loadTilesetFromFile(Tiled::Tileset *ts, QString file)
 }
 """)
 
+mod.add_function('tileLayerGids',
+    retval('PyObject*',caller_owns_return=True),
+    [param('Tiled::Map*','map',transfer_ownership=False),
+     param('Tiled::TileLayer*','layer',transfer_ownership=False)])
+mod.add_function('setTileLayerGids',
+    retval('PyObject*',caller_owns_return=True),
+    [param('Tiled::Map*','map',transfer_ownership=False),
+     param('Tiled::TileLayer*','layer',transfer_ownership=False),
+     param('PyObject*','data',transfer_ownership=False)])
+
+mod.body.writeln("""
+/*
+ * Bulk access to the cells of a tile layer, to avoid a round trip between
+ * Python and C++ for every cell. The GIDs are stored row by row as unsigned
+ * 32-bit integers in native byte order, using the tilesets of the given map.
+ */
+PyObject* tileLayerGids(Tiled::Map *map, Tiled::TileLayer *layer)
+{
+    const Tiled::GidMapper gidMapper(map->tilesets());
+    const QVector<unsigned> gids = gidMapper.cellsToGids(*layer);
+
+    return PyByteArray_FromStringAndSize(
+                reinterpret_cast<const char*>(gids.constData()),
+                gids.size() * sizeof(unsigned));
+}
+
+PyObject* setTileLayerGids(Tiled::Map *map, Tiled::TileLayer *layer, PyObject *data)
+{
+    const Py_ssize_t expectedSize = Py_ssize_t(layer->width()) * layer->height() * sizeof(unsigned);
+    const unsigned *gids = 0;
+    Py_ssize_t size = 0;
+
+    Py_buffer view;
+    bool haveView = false;
+
+    if (PyObject_CheckBuffer(data)) {
+        if (PyObject_GetBuffer(data, &view, PyBUF_SIMPLE) < 0)
+            return NULL;
+        haveView = true;
+        gids = static_cast<const unsigned*>(view.buf);
+        size = view.len;
+    } else {
+#if PY_VERSION_HEX < 0x03000000
+        // Old-style buffers, like array.array on Python 2
+        const void *buffer;
+        if (PyObject_AsReadBuffer(data, &buffer, &size) < 0)
+            return NULL;
+        gids = static_cast<const unsigned*>(buffer);
+#else
+        PyErr_SetString(PyExc_TypeError, "data does not support the buffer protocol");
+        return NULL;
+#endif
+    }
+
+    if (size != expectedSize) {
+        if (haveView)
+            PyBuffer_Release(&view);
+        PyErr_Format(PyExc_ValueError, "expected %zd bytes of data, got %zd",
+                     expectedSize, size);
+        return NULL;
+    }
+
+    const Tiled::GidMapper gidMapper(map->tilesets());
+    QVector<Tiled::Cell> cells(layer->width() * layer->height());
+
+    for (int i = 0; i < cells.size(); ++i) {
+        unsigned gid;
+        memcpy(&gid, gids + i, sizeof(unsigned));   // may be unaligned
+
+        bool ok;
+        cells[i] = gidMapper.gidToCell(gid, ok);
+        if (!ok) {
+            if (haveView)
+                PyBuffer_Release(&view);
+            PyErr_Format(PyExc_ValueError, "invalid tile: %u", gid);
+            return NULL;
+        }
+    }
+
+    if (haveView)
+        PyBuffer_Release(&view);
+
+    // Only touch the layer once all GIDs are known to be valid
+    const int width = layer->width();
+    for (int i = 0; i < cells.size(); ++i)
+        layer->setCell(i % width, i / width, cells.at(i));
+
+    Py_INCREF(Py_None);
+    return Py_None;
+}
+""")
+
 """
  C++ class PythonScript is seen as Tiled.Plugin from Python script
  (naming describes the opposite side from either perspective)
@@ -79,24 +79,32 @@ bool TenginePlugin::write(const Tiled::Map *map, const QString &fileName)
     Properties emptyTile;
     emptyTile["display"] = "?";
     cachedTiles["?"] = emptyTile;
+    // Determine the tile property of each layer up front, since the layer
+    // names are otherwise checked again for each tile
+    QList<QString> layerKeys;
+    foreach (Layer *layer, map->layers()) {
+        QString layerKey;
+        QListIterator<QString> propertyIterator = propertyOrder;
+        while (propertyIterator.hasNext()) {
+            QString currentProperty = propertyIterator.next();
+            if (layer->name().startsWith(currentProperty, Qt::CaseInsensitive)) {
+                layerKey = currentProperty;
+                break;
+            }
+        }
+        layerKeys.append(layerKey);
+    }
     // Process the map, collecting used display strings as we go
     for (int y = 0; y < height; ++y) {
         for (int x = 0; x < width; ++x) {
             Properties currentTile = cachedTiles["?"];
-            foreach (Layer *layer, map->layers()) {
+            for (int layerIndex = 0; layerIndex < map->layerCount(); ++layerIndex) {
                 // If the layer name does not start with one of the tile properties, skip it
-                QString layerKey;
-                QListIterator<QString> propertyIterator = propertyOrder;
-                while (propertyIterator.hasNext()) {
-                    QString currentProperty = propertyIterator.next();
-                    if (layer->name().startsWith(currentProperty, Qt::CaseInsensitive)) {
-                        layerKey = currentProperty;
-                        break;
-                    }
-                }
+                const QString &layerKey = layerKeys.at(layerIndex);
                 if (layerKey.isEmpty()) {
                     continue;
                 }
+                Layer *layer = map->layerAt(layerIndex);
                 TileLayer *tileLayer = layer->asTileLayer();
                 ObjectGroup *objectLayer = layer->asObjectGroup();
                 // Process the Tile Layer
@@ -278,7 +286,7 @@ bool TenginePlugin::write(const Tiled::Map *map, const QString &fileName)
         if (y == height - 1) {
             out << lineStop << returnStop;
         } else {
-            out << lineStop << endl;
+            out << lineStop << "\n";
         }
     }
 
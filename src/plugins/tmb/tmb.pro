@@ -0,0 +1,17 @@
+include(../plugin.pri)
+
+DEFINES += TMB_LIBRARY
+
+HEADERS += \
+    tmb_global.h \
+    tmbformat.h \
+    tmbplugin.h \
+    tmbreader.h \
+    tmbwriter.h
+
+SOURCES += \
+    tmbplugin.cpp \
+    tmbreader.cpp \
+    tmbwriter.cpp
+
+OTHER_FILES = plugin.json
@@ -0,0 +1,87 @@
+/*
+ * tmbformat.h
+ * Copyright 2016, Tiled contributors
+ *
+ * This file is part of Tiled.
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation; either version 2 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef TMBFORMAT_H
+#define TMBFORMAT_H
+
+#include <QtGlobal>
+
+namespace Tmb {
+
+/*
+ * Layout of the binary map format, version 1.
+ *
+ * All values are little-endian. The file starts with a header, followed by
+ * the data blocks, the map record and the string table:
+ *
+ *   Header (32 bytes)
+ *     char[4]  magic ("TMB\0")
+ *     quint32  version
+ *     quint32  map record offset
+ *     quint32  map record size
+ *     quint32  string table offset
+ *     quint32  string count
+ *     quint32  string data size
+ *     quint32  reserved (0)
+ *
+ *   Data blocks
+ *     Tile layer data chunks and embedded tilesets (in TSX format), each
+ *     aligned to DataAlignment bytes. Uncompressed chunks contain one
+ *     quint32 global tile ID for each cell, row by row, so that they can be
+ *     used directly from a memory mapped file.
+ *
+ *   Map record
+ *     A sequence of quint32, qint32 and double values describing the map,
+ *     its tilesets and its layers, in the order read by TmbReader. Data
+ *     blocks are referenced by offset and size.
+ *
+ *   String table
+ *     string count * (quint32 offset, quint32 size) relative to the start of
+ *     the UTF-8 string data that follows. Strings are referenced by their
+ *     index in this table. Index 0 is always the empty string.
+ */
+
+static const char Magic[4] = { 'T', 'M', 'B', '\0' };
+static const quint32 Version = 1;
+static const int HeaderSize = 32;
+static const int DataAlignment = 16;
+
+// Number of cells stored in each tile layer data chunk (at least one row)
+static const int ChunkCells = 64 * 1024;
+
+enum TilesetKind {
+    ExternalTileset = 0,
+    EmbeddedTileset = 1
+};
+
+enum LayerKind {
+    TileLayerKind   = 1,
+    ObjectGroupKind = 2,
+    ImageLayerKind  = 3
+};
+
+enum ChunkCompression {
+    Uncompressed    = 0,
+    ZlibCompressed  = 1
+};
+
+} // namespace Tmb
+
+#endif // TMBFORMAT_H
@@ -0,0 +1,117 @@
+/*
+ * tmbplugin.cpp
+ * Copyright 2016, Tiled contributors
+ *
+ * This file is part of Tiled.
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation; either version 2 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "tmbplugin.h"
+
+#include "tmbformat.h"
+#include "tmbreader.h"
+#include "tmbwriter.h"
+
+#include "map.h"
+
+#include <QFile>
+#include <QFileInfo>
+#include <QSaveFile>
+
+#include <cstring>
+
+using namespace Tmb;
+using namespace Tiled;
+
+TmbPlugin::TmbPlugin()
+{
+}
+
+Tiled::Map *TmbPlugin::read(const QString &fileName)
+{
+    QFile file(fileName);
+
+    if (!file.open(QIODevice::ReadOnly)) {
+        mError = tr("Could not open file for reading.");
+        return nullptr;
+    }
+
+    const QDir mapDir = QFileInfo(fileName).dir();
+    TmbReader reader;
+    Map *map;
+
+    // Map the file when possible, so that layer data is read in place
+    if (uchar *data = file.map(0, file.size())) {
+        map = reader.read(data, file.size(), mapDir);
+        file.unmap(data);
+    } else {
+        const QByteArray contents = file.readAll();
+        map = reader.read(reinterpret_cast<const uchar*>(contents.constData()),
+                          contents.size(), mapDir);
+    }
+
+    if (!map)
+        mError = reader.errorString();
+
+    return map;
+}
+
+bool TmbPlugin::supportsFile(const QString &fileName) const
+{
+    if (QFileInfo(fileName).suffix() != QLatin1String("tmb"))
+        return false;
+
+    QFile file(fileName);
+    if (!file.open(QIODevice::ReadOnly))
+        return false;
+
+    const QByteArray magic = file.read(sizeof(Magic));
+    return magic.size() == int(sizeof(Magic)) &&
+            std::memcmp(magic.constData(), Magic, sizeof(Magic)) == 0;
+}
+
+bool TmbPlugin::write(const Tiled::Map *map, const QString &fileName)
+{
+    QSaveFile file(fileName);
+
+    if (!file.open(QIODevice::WriteOnly)) {
+        mError = tr("Could not open file for writing.");
+        return false;
+    }
+
+    TmbWriter writer;
+    if (!writer.write(map, &file, QFileInfo(fileName).dir())) {
+        mError = writer.errorString();
+        file.cancelWriting();
+        return false;
+    }
+
+    if (!file.commit()) {
+        mError = file.errorString();
+        return false;
+    }
+
+    return true;
+}
+
+QString TmbPlugin::nameFilter() const
+{
+    return tr("Tiled binary map files (*.tmb)");
+}
+
+QString TmbPlugin::errorString() const
+{
+    return mError;
+}
@@ -0,0 +1,58 @@
+/*
+ * tmbplugin.h
+ * Copyright 2016, Tiled contributors
+ *
+ * This file is part of Tiled.
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation; either version 2 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef TMBPLUGIN_H
+#define TMBPLUGIN_H
+
+#include "tmb_global.h"
+
+#include "mapformat.h"
+
+#include <QObject>
+
+namespace Tmb {
+
+/**
+ * A compact binary map format, meant for fast loading and saving of large
+ * maps. See tmbformat.h for a description of the layout.
+ */
+class TMBSHARED_EXPORT TmbPlugin : public Tiled::MapFormat
+{
+    Q_OBJECT
+    Q_INTERFACES(Tiled::MapFormat)
+    Q_PLUGIN_METADATA(IID "org.mapeditor.MapFormat" FILE "plugin.json")
+
+public:
+    TmbPlugin();
+
+    Tiled::Map *read(const QString &fileName) override;
+    bool supportsFile(const QString &fileName) const override;
+
+    bool write(const Tiled::Map *map, const QString &fileName) override;
+    QString nameFilter() const override;
+    QString errorString() const override;
+
+private:
+    QString mError;
+};
+
+} // namespace Tmb
+
+#endif // TMBPLUGIN_H
@@ -0,0 +1,535 @@
+/*
+ * tmbreader.cpp
+ * Copyright 2016, Tiled contributors
+ *
+ * This file is part of Tiled.
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation; either version 2 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "tmbreader.h"
+
+#include "tmbformat.h"
+
+#include "compression.h"
+#include "imagelayer.h"
+#include "map.h"
+#include "mapobject.h"
+#include "mapreader.h"
+#include "objectgroup.h"
+#include "tilelayer.h"
+#include "tilesetformat.h"
+
+#include <QBuffer>
+#include <QFileInfo>
+#include <QScopedPointer>
+#include <QtEndian>
+
+#include <climits>
+#include <cstring>
+
+using namespace Tiled;
+using namespace Tmb;
+
+TmbReader::TmbReader()
+    : mData(nullptr)
+    , mSize(0)
+    , mCursor(nullptr)
+    , mEnd(nullptr)
+    , mCompressed(false)
+{
+}
+
+Map *TmbReader::read(const uchar *data, qint64 size, const QDir &mapDir)
+{
+    mData = data;
+    mSize = quint32(qMin<qint64>(size, 0xFFFFFFFF));
+    mMapDir = mapDir;
+    mStrings.clear();
+    mGidMapper.clear();
+    mCompressed = false;
+    mError.clear();
+
+    if (!readHeader())
+        return nullptr;
+
+    const QString orientationString = readString();
+    const QString renderOrderString = readString();
+    const QString staggerAxisString = readString();
+    const QString staggerIndexString = readString();
+    const int width = readInt();
+    const int height = readInt();
+    const int tileWidth = readInt();
+    const int tileHeight = readInt();
+    const int hexSideLength = readInt();
+    const int nextObjectId = readInt();
+    const QString backgroundColor = readString();
+
+    const Map::Orientation orientation = orientationFromString(orientationString);
+    if (orientation == Map::Unknown) {
+        raiseError(tr("Unsupported map orientation: \"%1\"")
+                   .arg(orientationString));
+    }
+
+    if (hasError())
+        return nullptr;
+
+    QScopedPointer<Map> map(new Map(orientation, width, height,
+                                    tileWidth, tileHeight));
+    map->setRenderOrder(renderOrderFromString(renderOrderString));
+    map->setStaggerAxis(staggerAxisFromString(staggerAxisString));
+    map->setStaggerIndex(staggerIndexFromString(staggerIndexString));
+    map->setHexSideLength(hexSideLength);
+    map->setNextObjectId(nextObjectId);
+    if (QColor::isValidColor(backgroundColor))
+        map->setBackgroundColor(QColor(backgroundColor));
+    map->setProperties(readProperties());
+
+    const quint32 tilesetCount = readUInt();
+    for (quint32 i = 0; i < tilesetCount && !hasError(); ++i) {
+        const SharedTileset tileset = readTileset();
+        if (tileset)
+            map->addTileset(tileset);
+    }
+
+    const quint32 layerCount = readUInt();
+    for (quint32 i = 0; i < layerCount && !hasError(); ++i) {
+        if (Layer *layer = readLayer())
+            map->addLayer(layer);
+    }
+
+    if (hasError())
+        return nullptr;
+
+    map->setLayerDataFormat(mCompressed ? Map::Base64Zlib : Map::Base64);
+
+    return map.take();
+}
+
+/**
+ * Checks the header, decodes the string table and moves the cursor to the
+ * start of the map record.
+ */
+bool TmbReader::readHeader()
+{
+    if (mSize < quint32(HeaderSize) ||
+            std::memcmp(mData, Magic, sizeof(Magic)) != 0) {
+        raiseError(tr("Not a binary map file."));
+        return false;
+    }
+
+    const quint32 version = qFromLittleEndian<quint32>(mData + 4);
+    if (version > Version) {
+        raiseError(tr("Unsupported binary map version: %1").arg(version));
+        return false;
+    }
+
+    const quint32 recordOffset = qFromLittleEndian<quint32>(mData + 8);
+    const quint32 recordSize = qFromLittleEndian<quint32>(mData + 12);
+    const quint32 stringTableOffset = qFromLittleEndian<quint32>(mData + 16);
+    const quint32 stringCount = qFromLittleEndian<quint32>(mData + 20);
+    const quint32 stringDataSize = qFromLittleEndian<quint32>(mData + 24);
+
+    const quint64 stringTableSize = quint64(stringCount) * 8 + stringDataSize;
+
+    if (quint64(recordOffset) + recordSize > mSize ||
+            quint64(stringTableOffset) + stringTableSize > mSize) {
+        raiseError(tr("The file is truncated or corrupt."));
+        return false;
+    }
+
+    const uchar *entry = mData + stringTableOffset;
+    const char *stringData = reinterpret_cast<const char*>(entry + stringCount * 8);
+
+    mStrings.resize(stringCount);
+    for (quint32 i = 0; i < stringCount; ++i, entry += 8) {
+        const quint32 offset = qFromLittleEndian<quint32>(entry);
+        const quint32 size = qFromLittleEndian<quint32>(entry + 4);
+
+        if (quint64(offset) + size > stringDataSize) {
+            raiseError(tr("The file is truncated or corrupt."));
+            return false;
+        }
+
+        mStrings[i] = QString::fromUtf8(stringData + offset, size);
+    }
+
+    mCursor = mData + recordOffset;
+    mEnd = mCursor + recordSize;
+    return true;
+}
+
+SharedTileset TmbReader::readTileset()
+{
+    const unsigned firstGid = readUInt();
+    const quint32 kind = readUInt();
+
+    SharedTileset tileset;
+
+    switch (kind) {
+    case ExternalTileset: {
+        const QString source = resolvePath(readString());
+        if (hasError())
+            return tileset;
+
+        QString error;
+        tileset = Tiled::readTileset(source, &error);
+
+        if (!tileset) {
+            // Insert a placeholder to allow the map to load
+            tileset = Tileset::create(QFileInfo(source).completeBaseName(), 32, 32);
+            tileset->setFileName(source);
+            tileset->setLoaded(false);
+        }
+        break;
+    }
+    case EmbeddedTileset: {
+        quint32 size;
+        const uchar *data = readBlock(size);
+        if (!data)
+            return tileset;
+
+        QByteArray tsx = QByteArray::fromRawData(reinterpret_cast<const char*>(data), size);
+        QBuffer buffer(&tsx);
+        buffer.open(QIODevice::ReadOnly);
+
+        MapReader reader;
+        tileset = reader.readTileset(&buffer, mMapDir.absolutePath());
+        if (!tileset) {
+            raiseError(tr("Error reading embedded tileset: %1")
+                       .arg(reader.errorString()));
+        }
+        break;
+    }
+    default:
+        raiseError(tr("Unknown tileset kind: %1").arg(kind));
+        break;
+    }
+
+    if (tileset)
+        mGidMapper.insert(firstGid, tileset.data());
+
+    return tileset;
+}
+
+Layer *TmbReader::readLayer()
+{
+    const quint32 kind = readUInt();
+    const QString name = readString();
+    const int x = readInt();
+    const int y = readInt();
+    const int width = readInt();
+    const int height = readInt();
+    const double opacity = readDouble();
+    const bool visible = readUInt();
+    const double offsetX = readDouble();
+    const double offsetY = readDouble();
+    const Properties properties = readProperties();
+
+    if (hasError())
+        return nullptr;
+
+    QScopedPointer<Layer> layer;
+
+    switch (kind) {
+    case TileLayerKind: {
+        // Also guards against the cell count overflowing in TileLayer
+        if (width < 0 || height < 0 || qint64(width) * height > INT_MAX / 4) {
+            raiseError(tr("Invalid tile layer size: %1x%2").arg(width).arg(height));
+            return nullptr;
+        }
+
+        TileLayer *tileLayer = new TileLayer(name, x, y, width, height);
+        layer.reset(tileLayer);
+        readTileLayerData(*tileLayer);
+        break;
+    }
+    case ObjectGroupKind: {
+        ObjectGroup *objectGroup = new ObjectGroup(name, x, y, width, height);
+        layer.reset(objectGroup);
+
+        const QString color = readString();
+        if (QColor::isValidColor(color))
+            objectGroup->setColor(QColor(color));
+
+        const QString drawOrder = readString();
+        if (!drawOrder.isEmpty())
+            objectGroup->setDrawOrder(drawOrderFromString(drawOrder));
+
+        readObjects(*objectGroup);
+        break;
+    }
+    case ImageLayerKind: {
+        ImageLayer *imageLayer = new ImageLayer(name, x, y, width, height);
+        layer.reset(imageLayer);
+
+        const QString source = resolvePath(readString());
+        const QString transparentColor = readString();
+
+        if (QColor::isValidColor(transparentColor))
+            imageLayer->setTransparentColor(QColor(transparentColor));
+        if (!source.isEmpty())
+            imageLayer->loadFromImage(source);
+        break;
+    }
+    default:
+        raiseError(tr("Unknown layer kind: %1").arg(kind));
+        return nullptr;
+    }
+
+    if (hasError())
+        return nullptr;
+
+    layer->setOpacity(opacity);
+    layer->setVisible(visible);
+    layer->setOffset(QPointF(offsetX, offsetY));
+    layer->setProperties(properties);
+
+    return layer.take();
+}
+
+/**
+ * Reads the chunks of tile layer data. Uncompressed chunks are converted
+ * straight from the file data, without copying them first.
+ */
+void TmbReader::readTileLayerData(TileLayer &tileLayer)
+{
+    const int width = tileLayer.width();
+    const int height = tileLayer.height();
+    const quint32 rowsPerChunk = readUInt();
+    const quint32 chunkCount = readUInt();
+
+    if (hasError())
+        return;
+
+    if (width > 0 && height > 0 &&
+            (rowsPerChunk == 0 ||
+             chunkCount != (quint64(height) + rowsPerChunk - 1) / rowsPerChunk)) {
+        raiseError(tr("Corrupt layer data for layer '%1'").arg(tileLayer.name()));
+        return;
+    }
+
+    // Cache the last looked up gid, since tiles tend to repeat
+    unsigned lastGid = 0;
+    Cell lastCell;
+
+    for (quint32 chunk = 0; chunk < chunkCount && !hasError(); ++chunk) {
+        const quint32 compression = readUInt();
+        quint32 size;
+        const uchar *data = readBlock(size);
+        if (!data)
+            return;
+
+        const int firstRow = int(chunk * rowsPerChunk);
+        const int rows = qMin(int(rowsPerChunk), height - firstRow);
+        const qint64 byteCount = qint64(rows) * width * 4;
+
+        QByteArray uncompressed;
+
+        switch (compression) {
+        case Uncompressed:
+            break;
+        case ZlibCompressed:
+            mCompressed = true;
+            uncompressed = decompress(QByteArray::fromRawData(reinterpret_cast<const char*>(data), size),
+                                      int(byteCount));
+            data = reinterpret_cast<const uchar*>(uncompressed.constData());
+            size = quint32(uncompressed.size());
+            break;
+        default:
+            raiseError(tr("Unknown compression method: %1").arg(compression));
+            return;
+        }
+
+        if (size != byteCount) {
+            raiseError(tr("Corrupt layer data for layer '%1'").arg(tileLayer.name()));
+            return;
+        }
+
+        for (int y = firstRow; y < firstRow + rows; ++y) {
+            for (int x = 0; x < width; ++x, data += 4) {
+                const unsigned gid = qFromLittleEndian<quint32>(data);
+
+                if (gid != lastGid) {
+                    bool ok;
+                    lastCell = mGidMapper.gidToCell(gid, ok);
+                    if (!ok) {
+                        raiseError(tr("Invalid tile: %1").arg(gid));
+                        return;
+                    }
+                    lastGid = gid;
+                }
+
+                if (!lastCell.isEmpty())
+                    tileLayer.setCell(x, y, lastCell);
+            }
+        }
+    }
+}
+
+void TmbReader::readObjects(ObjectGroup &objectGroup)
+{
+    const quint32 objectCount = readUInt();
+
+    for (quint32 i = 0; i < objectCount && !hasError(); ++i) {
+        const int id = readInt();
+        const QString name = readString();
+        const QString type = readString();
+        const double x = readDouble();
+        const double y = readDouble();
+        const double width = readDouble();
+        const double height = readDouble();
+        const double rotation = readDouble();
+        const unsigned gid = readUInt();
+        const bool visible = readUInt();
+        const quint32 shape = readUInt();
+
+        QPolygonF polygon;
+        const quint32 pointCount = readUInt();
+        for (quint32 p = 0; p < pointCount && !hasError(); ++p) {
+            const double pointX = readDouble();
+            const double pointY = readDouble();
+            polygon.append(QPointF(pointX, pointY));
+        }
+
+        const Properties properties = readProperties();
+
+        if (hasError())
+            return;
+
+        if (shape > MapObject::Ellipse) {
+            raiseError(tr("Unknown object shape: %1").arg(shape));
+            return;
+        }
+
+        MapObject *object = new MapObject(name, type, QPointF(x, y),
+                                          QSizeF(width, height));
+        object->setId(id);
+        object->setRotation(rotation);
+        object->setVisible(visible);
+        object->setShape(static_cast<MapObject::Shape>(shape));
+        object->setPolygon(polygon);
+        object->setProperties(properties);
+
+        if (gid) {
+            bool ok;
+            object->setCell(mGidMapper.gidToCell(gid, ok));
+
+            if (!object->cell().isEmpty()) {
+                const QSizeF &tileSize = object->cell().tile->size();
+                if (width == 0)
+                    object->setWidth(tileSize.width());
+                if (height == 0)
+                    object->setHeight(tileSize.height());
+            }
+        }
+
+        objectGroup.addObject(object);
+    }
+}
+
+Properties TmbReader::readProperties()
+{
+    Properties properties;
+
+    const quint32 count = readUInt();
+    for (quint32 i = 0; i < count && !hasError(); ++i) {
+        const QString name = readString();
+        QVariant::Type type = nameToType(readString());
+        QVariant value = readString();
+
+        if (type == QVariant::Invalid)
+            type = QVariant::String;
+
+        value.convert(type);
+        properties[name] = value;
+    }
+
+    return properties;
+}
+
+/**
+ * Reads the offset and size of a data block from the map record. Returns a
+ * pointer to the block data, or 0 when the block is out of bounds.
+ */
+const uchar *TmbReader::readBlock(quint32 &size)
+{
+    const quint32 offset = readUInt();
+    size = readUInt();
+
+    if (hasError())
+        return nullptr;
+
+    if (quint64(offset) + size > mSize) {
+        raiseError(tr("The file is truncated or corrupt."));
+        return nullptr;
+    }
+
+    return mData + offset;
+}
+
+QString TmbReader::resolvePath(const QString &fileName) const
+{
+    if (!fileName.isEmpty() && QDir::isRelativePath(fileName))
+        return QDir::cleanPath(mMapDir.absoluteFilePath(fileName));
+    return fileName;
+}
+
+quint32 TmbReader::readUInt()
+{
+    if (mEnd - mCursor < 4) {
+        raiseError(tr("The file is truncated or corrupt."));
+        mCursor = mEnd;
+        return 0;
+    }
+
+    const quint32 value = qFromLittleEndian<quint32>(mCursor);
+    mCursor += 4;
+    return value;
+}
+
+double TmbReader::readDouble()
+{
+    if (mEnd - mCursor < 8) {
+        raiseError(tr("The file is truncated or corrupt."));
+        mCursor = mEnd;
+        return 0;
+    }
+
+    const quint64 bits = qFromLittleEndian<quint64>(mCursor);
+    mCursor += 8;
+
+    double value;
+    std::memcpy(&value, &bits, sizeof(value));
+    return value;
+}
+
+QString TmbReader::readString()
+{
+    const quint32 index = readUInt();
+    if (index < quint32(mStrings.size()))
+        return mStrings.at(index);
+
+    raiseError(tr("The file is truncated or corrupt."));
+    return QString();
+}
+
+/**
+ * Sets the error message, unless an earlier error was already raised.
+ */
+void TmbReader::raiseError(const QString &message)
+{
+    if (mError.isEmpty())
+        mError = message;
+}
@@ -0,0 +1,97 @@
+/*
+ * tmbreader.h
+ * Copyright 2016, Tiled contributors
+ *
+ * This file is part of Tiled.
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation; either version 2 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef TMBREADER_H
+#define TMBREADER_H
+
+#include "gidmapper.h"
+#include "properties.h"
+#include "tileset.h"
+
+#include <QCoreApplication>
+#include <QDir>
+#include <QString>
+#include <QVector>
+
+namespace Tiled {
+class Layer;
+class Map;
+class ObjectGroup;
+class TileLayer;
+}
+
+namespace Tmb {
+
+/**
+ * Reads a map in the binary map format from memory, usually a memory mapped
+ * file. Uncompressed tile layer data is read in place.
+ */
+class TmbReader
+{
+    Q_DECLARE_TR_FUNCTIONS(TmbReader)
+
+public:
+    TmbReader();
+
+    /**
+     * Reads the map stored in the \a size bytes at \a data. Relative
+     * references are resolved against \a mapDir.
+     *
+     * Returns 0 and sets errorString() when reading failed.
+     */
+    Tiled::Map *read(const uchar *data, qint64 size, const QDir &mapDir);
+
+    QString errorString() const { return mError; }
+
+private:
+    bool readHeader();
+    Tiled::SharedTileset readTileset();
+    Tiled::Layer *readLayer();
+    void readTileLayerData(Tiled::TileLayer &tileLayer);
+    void readObjects(Tiled::ObjectGroup &objectGroup);
+    Tiled::Properties readProperties();
+
+    const uchar *readBlock(quint32 &size);
+    QString resolvePath(const QString &fileName) const;
+
+    quint32 readUInt();
+    qint32 readInt() { return qint32(readUInt()); }
+    double readDouble();
+    QString readString();
+
+    void raiseError(const QString &message);
+    bool hasError() const { return !mError.isEmpty(); }
+
+    const uchar *mData;
+    quint32 mSize;
+    const uchar *mCursor;
+    const uchar *mEnd;
+
+    QDir mMapDir;
+    QVector<QString> mStrings;
+    Tiled::GidMapper mGidMapper;
+    bool mCompressed;
+
+    QString mError;
+};
+
+} // namespace Tmb
+
+#endif // TMBREADER_H
@@ -0,0 +1,345 @@
+/*
+ * tmbwriter.cpp
+ * Copyright 2016, Tiled contributors
+ *
+ * This file is part of Tiled.
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation; either version 2 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "tmbwriter.h"
+
+#include "tmbformat.h"
+
+#include "compression.h"
+#include "imagelayer.h"
+#include "map.h"
+#include "mapobject.h"
+#include "mapwriter.h"
+#include "objectgroup.h"
+#include "properties.h"
+#include "tilelayer.h"
+#include "tileset.h"
+
+#include <QBuffer>
+#include <QIODevice>
+#include <QtEndian>
+
+#include <cstring>
+
+using namespace Tiled;
+using namespace Tmb;
+
+TmbWriter::TmbWriter()
+    : mDevice(nullptr)
+    , mCompressed(false)
+{
+}
+
+bool TmbWriter::write(const Map *map, QIODevice *device, const QDir &mapDir)
+{
+    mDevice = device;
+    mMapDir = mapDir;
+    mGidMapper.clear();
+    mRecord.clear();
+    mStrings.clear();
+    mStringIndexes.clear();
+    mError.clear();
+
+    // Index 0 is reserved for the empty string
+    mStrings.append(QByteArray());
+    mStringIndexes.insert(QString(), 0);
+
+    // Compression is used when the map was set up to use it
+    const Map::LayerDataFormat format = map->layerDataFormat();
+    mCompressed = format == Map::Base64Zlib || format == Map::Base64Gzip;
+
+    // The header is written last, when all the offsets are known
+    mDevice->write(QByteArray(HeaderSize, '\0'));
+
+    appendString(orientationToString(map->orientation()));
+    appendString(renderOrderToString(map->renderOrder()));
+    appendString(staggerAxisToString(map->staggerAxis()));
+    appendString(staggerIndexToString(map->staggerIndex()));
+    appendInt(map->width());
+    appendInt(map->height());
+    appendInt(map->tileWidth());
+    appendInt(map->tileHeight());
+    appendInt(map->hexSideLength());
+    appendInt(map->nextObjectId());
+    appendString(toExportValue(map->backgroundColor()).toString());
+    writeProperties(map->properties());
+
+    appendUInt(map->tilesetCount());
+    unsigned firstGid = 1;
+    for (const SharedTileset &tileset : map->tilesets()) {
+        writeTileset(*tileset, firstGid);
+        mGidMapper.insert(firstGid, tileset.data());
+        firstGid += tileset->nextTileId();
+    }
+
+    appendUInt(map->layerCount());
+    for (const Layer *layer : map->layers())
+        writeLayer(*layer);
+
+    const qint64 recordOffset = mDevice->pos();
+    mDevice->write(mRecord);
+
+    quint32 stringDataSize;
+    const qint64 stringTableOffset = mDevice->pos();
+    mDevice->write(stringTable(stringDataSize));
+
+    if (mDevice->pos() > 0xFFFFFFFF) {
+        mError = tr("The map is too large to be saved in this format.");
+        return false;
+    }
+
+    QByteArray header(HeaderSize, '\0');
+    uchar *data = reinterpret_cast<uchar*>(header.data());
+    std::memcpy(data, Magic, sizeof(Magic));
+    qToLittleEndian<quint32>(Version, data + 4);
+    qToLittleEndian<quint32>(quint32(recordOffset), data + 8);
+    qToLittleEndian<quint32>(quint32(mRecord.size()), data + 12);
+    qToLittleEndian<quint32>(quint32(stringTableOffset), data + 16);
+    qToLittleEndian<quint32>(quint32(mStrings.size()), data + 20);
+    qToLittleEndian<quint32>(stringDataSize, data + 24);
+
+    if (!mDevice->seek(0) || mDevice->write(header) != HeaderSize) {
+        mError = tr("Could not write the file header.");
+        return false;
+    }
+
+    return true;
+}
+
+void TmbWriter::writeTileset(const Tileset &tileset, unsigned firstGid)
+{
+    appendUInt(firstGid);
+
+    if (!tileset.fileName().isEmpty()) {
+        appendUInt(ExternalTileset);
+        appendString(mMapDir.relativeFilePath(tileset.fileName()));
+        return;
+    }
+
+    // Embedded tilesets are stored in TSX format
+    QBuffer buffer;
+    buffer.open(QIODevice::WriteOnly);
+
+    MapWriter writer;
+    writer.writeTileset(tileset, &buffer, mMapDir.absolutePath());
+
+    appendUInt(EmbeddedTileset);
+    writeBlock(buffer.data());
+}
+
+void TmbWriter::writeLayer(const Layer &layer)
+{
+    switch (layer.layerType()) {
+    case Layer::TileLayerType:      appendUInt(TileLayerKind);      break;
+    case Layer::ObjectGroupType:    appendUInt(ObjectGroupKind);    break;
+    case Layer::ImageLayerType:     appendUInt(ImageLayerKind);     break;
+    default:
+        Q_ASSERT(false);
+        break;
+    }
+
+    appendString(layer.name());
+    appendInt(layer.x());
+    appendInt(layer.y());
+    appendInt(layer.width());
+    appendInt(layer.height());
+    appendDouble(layer.opacity());
+    appendUInt(layer.isVisible());
+    appendDouble(layer.offset().x());
+    appendDouble(layer.offset().y());
+    writeProperties(layer.properties());
+
+    switch (layer.layerType()) {
+    case Layer::TileLayerType:
+        writeTileLayer(static_cast<const TileLayer&>(layer));
+        break;
+    case Layer::ObjectGroupType:
+        writeObjectGroup(static_cast<const ObjectGroup&>(layer));
+        break;
+    case Layer::ImageLayerType:
+        writeImageLayer(static_cast<const ImageLayer&>(layer));
+        break;
+    default:
+        break;
+    }
+}
+
+/**
+ * Writes the tile layer data as a number of chunks, each consisting of whole
+ * rows. Chunks are only compressed when that makes them smaller.
+ */
+void TmbWriter::writeTileLayer(const TileLayer &tileLayer)
+{
+    const QVector<unsigned> gids = mGidMapper.cellsToGids(tileLayer);
+    const int width = tileLayer.width();
+    const int height = tileLayer.height();
+
+    const int rowsPerChunk = qMax(1, ChunkCells / qMax(1, width));
+    const int chunkCount = width > 0 ? (height + rowsPerChunk - 1) / rowsPerChunk : 0;
+
+    appendUInt(rowsPerChunk);
+    appendUInt(chunkCount);
+
+    QByteArray chunk;
+
+    for (int chunkIndex = 0; chunkIndex < chunkCount; ++chunkIndex) {
+        const int y = chunkIndex * rowsPerChunk;
+        const int cellCount = qMin(rowsPerChunk, height - y) * width;
+        const unsigned *in = gids.constData() + y * width;
+
+        chunk.resize(cellCount * 4);
+        uchar *out = reinterpret_cast<uchar*>(chunk.data());
+        for (int i = 0; i < cellCount; ++i)
+            qToLittleEndian<quint32>(in[i], out + i * 4);
+
+        QByteArray compressed;
+        if (mCompressed)
+            compressed = compress(chunk, Zlib);
+
+        if (!compressed.isEmpty() && compressed.size() < chunk.size()) {
+            appendUInt(ZlibCompressed);
+            writeBlock(compressed);
+        } else {
+            appendUInt(Uncompressed);
+            writeBlock(chunk);
+        }
+    }
+}
+
+void TmbWriter::writeObjectGroup(const ObjectGroup &objectGroup)
+{
+    appendString(toExportValue(objectGroup.color()).toString());
+    appendString(drawOrderToString(objectGroup.drawOrder()));
+
+    appendUInt(objectGroup.objectCount());
+    for (const MapObject *object : objectGroup.objects()) {
+        appendInt(object->id());
+        appendString(object->name());
+        appendString(object->type());
+        appendDouble(object->x());
+        appendDouble(object->y());
+        appendDouble(object->width());
+        appendDouble(object->height());
+        appendDouble(object->rotation());
+        appendUInt(mGidMapper.cellToGid(object->cell()));
+        appendUInt(object->isVisible());
+        appendUInt(object->shape());
+
+        const QPolygonF &polygon = object->polygon();
+        appendUInt(polygon.size());
+        for (const QPointF &point : polygon) {
+            appendDouble(point.x());
+            appendDouble(point.y());
+        }
+
+        writeProperties(object->properties());
+    }
+}
+
+void TmbWriter::writeImageLayer(const ImageLayer &imageLayer)
+{
+    const QString &imageSource = imageLayer.imageSource();
+    appendString(imageSource.isEmpty() ? QString()
+                                       : mMapDir.relativeFilePath(imageSource));
+    appendString(toExportValue(imageLayer.transparentColor()).toString());
+}
+
+void TmbWriter::writeProperties(const Properties &properties)
+{
+    appendUInt(properties.size());
+
+    Properties::const_iterator it = properties.constBegin();
+    Properties::const_iterator it_end = properties.constEnd();
+    for (; it != it_end; ++it) {
+        appendString(it.key());
+        appendString(typeToName(it.value().type()));
+        appendString(toExportValue(it.value()).toString());
+    }
+}
+
+/**
+ * Writes \a data at the next aligned position in the file and appends its
+ * offset and size to the map record.
+ */
+void TmbWriter::writeBlock(const QByteArray &data)
+{
+    const int misalignment = int(mDevice->pos() % DataAlignment);
+    if (misalignment)
+        mDevice->write(QByteArray(DataAlignment - misalignment, '\0'));
+
+    appendUInt(quint32(mDevice->pos()));
+    appendUInt(data.size());
+    mDevice->write(data);
+}
+
+/**
+ * Returns the string table, and its size without the offsets in
+ * \a dataSize.
+ */
+QByteArray TmbWriter::stringTable(quint32 &dataSize) const
+{
+    QByteArray table(mStrings.size() * 8, '\0');
+    uchar *entry = reinterpret_cast<uchar*>(table.data());
+
+    quint32 offset = 0;
+    for (const QByteArray &string : mStrings) {
+        qToLittleEndian<quint32>(offset, entry);
+        qToLittleEndian<quint32>(quint32(string.size()), entry + 4);
+        offset += string.size();
+        entry += 8;
+    }
+
+    for (const QByteArray &string : mStrings)
+        table.append(string);
+
+    dataSize = offset;
+    return table;
+}
+
+void TmbWriter::appendUInt(quint32 value)
+{
+    uchar bytes[4];
+    qToLittleEndian<quint32>(value, bytes);
+    mRecord.append(reinterpret_cast<const char*>(bytes), 4);
+}
+
+void TmbWriter::appendDouble(double value)
+{
+    quint64 bits;
+    std::memcpy(&bits, &value, sizeof(bits));
+
+    uchar bytes[8];
+    qToLittleEndian<quint64>(bits, bytes);
+    mRecord.append(reinterpret_cast<const char*>(bytes), 8);
+}
+
+void TmbWriter::appendString(const QString &string)
+{
+    QHash<QString, quint32>::const_iterator it = mStringIndexes.find(string);
+    if (it != mStringIndexes.end()) {
+        appendUInt(it.value());
+        return;
+    }
+
+    const quint32 index = mStrings.size();
+    mStrings.append(string.toUtf8());
+    mStringIndexes.insert(string, index);
+    appendUInt(index);
+}
@@ -0,0 +1,92 @@
+/*
+ * tmbwriter.h
+ * Copyright 2016, Tiled contributors
+ *
+ * This file is part of Tiled.
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation; either version 2 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef TMBWRITER_H
+#define TMBWRITER_H
+
+#include "gidmapper.h"
+
+#include <QByteArray>
+#include <QCoreApplication>
+#include <QDir>
+#include <QHash>
+#include <QList>
+#include <QString>
+
+class QIODevice;
+
+namespace Tiled {
+class ImageLayer;
+class Layer;
+class Map;
+class ObjectGroup;
+class Properties;
+class TileLayer;
+class Tileset;
+}
+
+namespace Tmb {
+
+/**
+ * Writes a map in the binary map format to a device. The device needs to be
+ * seekable, since the header is written last.
+ */
+class TmbWriter
+{
+    Q_DECLARE_TR_FUNCTIONS(TmbWriter)
+
+public:
+    TmbWriter();
+
+    bool write(const Tiled::Map *map, QIODevice *device, const QDir &mapDir);
+
+    QString errorString() const { return mError; }
+
+private:
+    void writeTileset(const Tiled::Tileset &tileset, unsigned firstGid);
+    void writeLayer(const Tiled::Layer &layer);
+    void writeTileLayer(const Tiled::TileLayer &tileLayer);
+    void writeObjectGroup(const Tiled::ObjectGroup &objectGroup);
+    void writeImageLayer(const Tiled::ImageLayer &imageLayer);
+    void writeProperties(const Tiled::Properties &properties);
+
+    void writeBlock(const QByteArray &data);
+    QByteArray stringTable(quint32 &dataSize) const;
+
+    void appendUInt(quint32 value);
+    void appendInt(qint32 value) { appendUInt(quint32(value)); }
+    void appendDouble(double value);
+    void appendString(const QString &string);
+
+    QIODevice *mDevice;
+    QDir mMapDir;
+    Tiled::GidMapper mGidMapper;
+    bool mCompressed;
+
+    QByteArray mRecord;
+    QList<QByteArray> mStrings;
+    QHash<QString, quint32> mStringIndexes;
+
+    QString mError;
+};
+
+} // namespace Tmb
+
+#endif // TMBWRITER_H
@@ -3,6 +3,7 @@ CONFIG   += ordered
 
 SUBDIRS = libtiled tiled plugins \
     tmxviewer \
+    tmxconverter \
     tmxrasterizer \
     automappingconverter \
     terraingenerator
@@ -34,8 +34,11 @@
 #include <QDebug>
 #include <QFile>
 #include <QFileInfo>
+#include <QHash>
 #include <QPainter>
+#include <QRunnable>
 #include <QStringList>
+#include <QThreadPool>
 
 using namespace Tiled;
 
@@ -311,6 +314,45 @@ static QDebug operator<<(QDebug dbg, const TileTerrainNames &t)
     return dbg.space();
 }
 
+/**
+ * A tile to generate by drawing the given layers on top of each other.
+ */
+struct CompositeJob
+{
+    QVector<QImage> layers;
+    QImage result;
+};
+
+/**
+ * Composites the layers of a job. Only uses QImage, so that it can run in a
+ * worker thread.
+ */
+class CompositeTask : public QRunnable
+{
+public:
+    CompositeTask(CompositeJob &job, const QSize &tileSize)
+        : mJob(job)
+        , mTileSize(tileSize)
+    {}
+
+    void run() override
+    {
+        QImage tileImage(mTileSize, QImage::Format_ARGB32);
+        tileImage.fill(Qt::transparent);
+
+        QPainter painter(&tileImage);
+        for (const QImage &layer : mJob.layers)
+            painter.drawImage(0, 0, layer);
+        painter.end();
+
+        mJob.result = tileImage;
+    }
+
+private:
+    CompositeJob &mJob;
+    const QSize mTileSize;
+};
+
 static bool isEmpty(const QImage &image)
 {
     if (image.format() == QImage::Format_RGB32)
@@ -528,33 +570,54 @@ int main(int argc, char *argv[])
         }
     }
 
-    // Go through each combination of terrains and add the tile to the target
-    // tileset if it's not in there yet.
+    // Pixmaps can only be used in the main thread, so the images needed for
+    // generating tiles are converted up front, once for each tile.
+    QHash<const Tile*, QImage> tileImages;
+    auto imageOf = [&] (const Tile *tile) {
+        auto it = tileImages.find(tile);
+        if (it == tileImages.end())
+            it = tileImages.insert(tile, tile->image().toImage());
+        return it.value();
+    };
+
+    struct PendingTile
+    {
+        TileTerrainNames terrainNames;
+        QPixmap image;      // for copied tiles
+        int job;            // for generated tiles, or -1
+    };
+
+    QVector<PendingTile> pending;
+    QVector<CompositeJob> jobs;
+    QMap<TileTerrainNames, bool> queued;
+
+    // Go through each combination of terrains and queue the tile for adding
+    // to the target tileset if it's not in there yet.
     foreach (TileTerrainNames terrainNames, process) {
+        if (queued.contains(terrainNames))
+            continue;
+
         Tile *tile = terrainToTile.value(terrainNames);
 
         if (tile && tile->tileset() == targetTileset)
             continue;
 
-        QPixmap image;
+        queued.insert(terrainNames, true);
+
+        PendingTile pendingTile;
+        pendingTile.terrainNames = terrainNames;
+        pendingTile.job = -1;
 
         if (!tile) {
             qWarning() << "Generating" << terrainNames;
 
-            // Start a new image
-            QImage tileImage = QImage(targetTileset->tileWidth(),
-                                      targetTileset->tileHeight(),
-                                      QImage::Format_ARGB32);
-            tileImage.fill(Qt::transparent);
-            QPainter painter(&tileImage);
-
             QStringList terrainList = terrainNames.terrainList();
             qSort(terrainList.begin(), terrainList.end(), lessThan);
 
             // Draw the lowest terrain to avoid pixel gaps
+            CompositeJob job;
             QString baseTerrain = terrainList.first();
-            QPixmap baseImage = terrains[baseTerrain]->imageTile()->image();
-            painter.drawPixmap(0, 0, baseImage);
+            job.layers.append(imageOf(terrains[baseTerrain]->imageTile()));
 
             foreach (const QString &terrainName, terrainList) {
                 TileTerrainNames filtered = terrainNames.filter(terrainName);
@@ -564,20 +627,37 @@ int main(int argc, char *argv[])
                     continue;
                 }
 
-                painter.drawPixmap(0, 0, tile->image());
+                job.layers.append(imageOf(tile));
             }
 
-            image = QPixmap::fromImage(tileImage);
+            pendingTile.job = jobs.size();
+            jobs.append(job);
         } else {
             qWarning() << "Copying" << terrainNames << "from"
                        << QFileInfo(tile->tileset()->fileName()).fileName();
 
-            image = tile->image();
+            pendingTile.image = tile->image();
         }
 
+        pending.append(pendingTile);
+    }
+
+    // Generate the new tiles in parallel
+    const QSize tileSize = targetTileset->tileSize();
+    QThreadPool *threadPool = QThreadPool::globalInstance();
+    for (CompositeJob &job : jobs)
+        threadPool->start(new CompositeTask(job, tileSize));
+    threadPool->waitForDone();
+
+    // Add the tiles in the order they were queued, to keep tile IDs stable
+    foreach (const PendingTile &pendingTile, pending) {
+        QPixmap image = pendingTile.image;
+        if (pendingTile.job != -1)
+            image = QPixmap::fromImage(jobs.at(pendingTile.job).result);
+
         Tile *newTile = targetTileset->addTile(image);
-        newTile->setTerrain(terrainNames.toTerrain(*targetTileset));
-        terrainToTile.insert(terrainNames, newTile);
+        newTile->setTerrain(pendingTile.terrainNames.toTerrain(*targetTileset));
+        terrainToTile.insert(pendingTile.terrainNames, newTile);
     }
 
     if (targetTileset->tileCount() == 0)
@@ -23,7 +23,6 @@
 #include "map.h"
 #include "mapdocument.h"
 #include "mapobject.h"
-#include "mapobjectitem.h"
 #include "maprenderer.h"
 #include "mapscene.h"
 #include "objectgroup.h"
@@ -92,7 +91,7 @@ void AbstractObjectTool::mouseMoved(const QPointF &pos,
 void AbstractObjectTool::mousePressed(QGraphicsSceneMouseEvent *event)
 {
     if (event->button() == Qt::RightButton) {
-        showContextMenu(topMostObjectItemAt(event->scenePos()),
+        showContextMenu(topMostObjectAt(event->scenePos()),
                         event->screenPos());
     }
 }
@@ -110,13 +109,9 @@ ObjectGroup *AbstractObjectTool::currentObjectGroup() const
     return dynamic_cast<ObjectGroup*>(mapDocument()->currentLayer());
 }
 
-MapObjectItem *AbstractObjectTool::topMostObjectItemAt(QPointF pos) const
+MapObject *AbstractObjectTool::topMostObjectAt(QPointF pos) const
 {
-    foreach (QGraphicsItem *item, mMapScene->items(pos)) {
-        if (MapObjectItem *objectItem = qgraphicsitem_cast<MapObjectItem*>(item))
-            return objectItem;
-    }
-    return nullptr;
+    return mMapScene->objectAt(pos);
 }
 
 void AbstractObjectTool::duplicateObjects()
@@ -163,25 +158,22 @@ void AbstractObjectTool::lowerToBottom()
  * Shows the context menu for map objects. The menu allows you to duplicate and
  * remove the map objects, or to edit their properties.
  */
-void AbstractObjectTool::showContextMenu(MapObjectItem *clickedObjectItem,
+void AbstractObjectTool::showContextMenu(MapObject *clickedObject,
                                          QPoint screenPos)
 {
-    QSet<MapObjectItem *> selection = mMapScene->selectedObjectItems();
-    if (clickedObjectItem && !selection.contains(clickedObjectItem)) {
-        selection.clear();
-        selection.insert(clickedObjectItem);
-        mMapScene->setSelectedObjectItems(selection);
-    }
-    if (selection.isEmpty())
-        return;
+    if (clickedObject && !mapDocument()->selectedObjects().contains(clickedObject))
+        mapDocument()->setSelectedObjects(QList<MapObject*>() << clickedObject);
 
     const QList<MapObject*> &selectedObjects = mapDocument()->selectedObjects();
+    if (selectedObjects.isEmpty())
+        return;
+
     const QList<ObjectGroup*> objectGroups = mapDocument()->map()->objectGroups();
 
     QMenu menu;
-    QAction *duplicateAction = menu.addAction(tr("Duplicate %n Object(s)", "", selection.size()),
+    QAction *duplicateAction = menu.addAction(tr("Duplicate %n Object(s)", "", selectedObjects.size()),
                                               this, SLOT(duplicateObjects()));
-    QAction *removeAction = menu.addAction(tr("Remove %n Object(s)", "", selection.size()),
+    QAction *removeAction = menu.addAction(tr("Remove %n Object(s)", "", selectedObjects.size()),
                                            this, SLOT(removeObjects()));
 
     duplicateAction->setIcon(QIcon(QLatin1String(":/images/16x16/stock-duplicate-16.png")));
@@ -191,7 +183,7 @@ void AbstractObjectTool::showContextMenu(MapObjectItem *clickedObjectItem,
     menu.addAction(tr("Flip Horizontally"), this, SLOT(flipHorizontally()), QKeySequence(tr("X")));
     menu.addAction(tr("Flip Vertically"), this, SLOT(flipVertically()), QKeySequence(tr("Y")));
 
-    ObjectGroup *objectGroup = RaiseLowerHelper::sameObjectGroup(selection);
+    ObjectGroup *objectGroup = RaiseLowerHelper::sameObjectGroup(selectedObjects);
     if (objectGroup && objectGroup->drawOrder() == ObjectGroup::IndexOrder) {
         menu.addSeparator();
         menu.addAction(tr("Raise Object"), this, SLOT(raise()), QKeySequence(tr("PgUp")));
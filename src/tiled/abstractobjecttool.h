@@ -30,8 +30,6 @@ class ObjectGroup;
 
 namespace Internal {
 
-class MapObjectItem;
-
 /**
  * A convenient base class for tools that work on object layers. Implements
  * the standard context menu.
@@ -66,7 +64,7 @@ protected:
 
     MapScene *mapScene() const { return mMapScene; }
     ObjectGroup *currentObjectGroup() const;
-    MapObjectItem *topMostObjectItemAt(QPointF pos) const;
+    MapObject *topMostObjectAt(QPointF pos) const;
 
 private slots:
     void duplicateObjects();
@@ -81,7 +79,7 @@ private slots:
     void lowerToBottom();
 
 private:
-    void showContextMenu(MapObjectItem *clickedObject,
+    void showContextMenu(MapObject *clickedObject,
                          QPoint screenPos);
 
     MapScene *mMapScene;
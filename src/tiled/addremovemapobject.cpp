@@ -30,61 +30,112 @@
 using namespace Tiled;
 using namespace Tiled::Internal;
 
-AddRemoveMapObject::AddRemoveMapObject(MapDocument *mapDocument,
-                                       ObjectGroup *objectGroup,
-                                       MapObject *mapObject,
-                                       bool ownObject,
-                                       QUndoCommand *parent)
+static MapObjectModel::ObjectEntries toEntries(const QList<MapObject*> &objects,
+                                               ObjectGroup *objectGroup)
+{
+    MapObjectModel::ObjectEntries entries;
+    entries.reserve(objects.size());
+
+    for (MapObject *object : objects) {
+        ObjectGroup *og = objectGroup ? objectGroup : object->objectGroup();
+        entries.append(MapObjectModel::ObjectEntry { object, og, -1 });
+    }
+
+    return entries;
+}
+
+
+AddRemoveMapObjects::AddRemoveMapObjects(MapDocument *mapDocument,
+                                         const MapObjectModel::ObjectEntries &entries,
+                                         bool ownObjects,
+                                         QUndoCommand *parent)
     : QUndoCommand(parent)
     , mMapDocument(mapDocument)
-    , mMapObject(mapObject)
-    , mObjectGroup(objectGroup)
-    , mIndex(-1)
-    , mOwnsObject(ownObject)
+    , mEntries(entries)
+    , mOwnsObjects(ownObjects)
 {
 }
 
-AddRemoveMapObject::~AddRemoveMapObject()
+AddRemoveMapObjects::~AddRemoveMapObjects()
 {
-    if (mOwnsObject)
-        delete mMapObject;
+    if (mOwnsObjects)
+        for (const MapObjectModel::ObjectEntry &entry : mEntries)
+            delete entry.mapObject;
 }
 
-void AddRemoveMapObject::addObject()
+void AddRemoveMapObjects::addObjects()
 {
-    mMapDocument->mapObjectModel()->insertObject(mObjectGroup, mIndex,
-                                                 mMapObject);
-    mOwnsObject = false;
+    mMapDocument->mapObjectModel()->insertObjects(mEntries);
+    mOwnsObjects = false;
 }
 
-void AddRemoveMapObject::removeObject()
+void AddRemoveMapObjects::removeObjects()
 {
-    mIndex = mMapDocument->mapObjectModel()->removeObject(mObjectGroup,
-                                                          mMapObject);
-    mOwnsObject = true;
+    QList<MapObject*> objects;
+    objects.reserve(mEntries.size());
+    for (const MapObjectModel::ObjectEntry &entry : mEntries)
+        objects.append(entry.mapObject);
+
+    // Remembers the indexes, so that the objects can be put back in place
+    mEntries = mMapDocument->mapObjectModel()->removeObjects(objects);
+    mOwnsObjects = true;
 }
 
 
-AddMapObject::AddMapObject(MapDocument *mapDocument, ObjectGroup *objectGroup,
-                           MapObject *mapObject, QUndoCommand *parent)
-    : AddRemoveMapObject(mapDocument,
-                         objectGroup,
-                         mapObject,
-                         true,
-                         parent)
+AddMapObjects::AddMapObjects(MapDocument *mapDocument,
+                             ObjectGroup *objectGroup,
+                             MapObject *mapObject,
+                             QUndoCommand *parent)
+    : AddRemoveMapObjects(mapDocument,
+                          toEntries(QList<MapObject*>() << mapObject, objectGroup),
+                          true,
+                          parent)
 {
     setText(QCoreApplication::translate("Undo Commands", "Add Object"));
 }
 
+AddMapObjects::AddMapObjects(MapDocument *mapDocument,
+                             ObjectGroup *objectGroup,
+                             const QList<MapObject*> &mapObjects,
+                             QUndoCommand *parent)
+    : AddRemoveMapObjects(mapDocument,
+                          toEntries(mapObjects, objectGroup),
+                          true,
+                          parent)
+{
+    setText(QCoreApplication::translate("Undo Commands", "Add %n Object(s)",
+                                        nullptr, mapObjects.size()));
+}
+
+AddMapObjects::AddMapObjects(MapDocument *mapDocument,
+                             const MapObjectModel::ObjectEntries &entries,
+                             QUndoCommand *parent)
+    : AddRemoveMapObjects(mapDocument, entries, true, parent)
+{
+    setText(QCoreApplication::translate("Undo Commands", "Add %n Object(s)",
+                                        nullptr, entries.size()));
+}
+
 
-RemoveMapObject::RemoveMapObject(MapDocument *mapDocument,
-                                 MapObject *mapObject,
-                                 QUndoCommand *parent)
-    : AddRemoveMapObject(mapDocument,
-                         mapObject->objectGroup(),
-                         mapObject,
-                         false,
-                         parent)
+RemoveMapObjects::RemoveMapObjects(MapDocument *mapDocument,
+                                   MapObject *mapObject,
+                                   QUndoCommand *parent)
+    : AddRemoveMapObjects(mapDocument,
+                          toEntries(QList<MapObject*>() << mapObject, nullptr),
+                          false,
+                          parent)
 {
     setText(QCoreApplication::translate("Undo Commands", "Remove Object"));
 }
+
+RemoveMapObjects::RemoveMapObjects(MapDocument *mapDocument,
+                                   const QList<MapObject*> &mapObjects,
+                                   QUndoCommand *parent)
+    : AddRemoveMapObjects(mapDocument,
+                          toEntries(mapObjects, nullptr),
+                          false,
+                          parent)
+{
+    setText(QCoreApplication::translate("Undo Commands", "Remove %n Object(s)",
+                                        nullptr, mapObjects.size()));
+}
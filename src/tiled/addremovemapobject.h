@@ -21,6 +21,9 @@
 #ifndef ADDREMOVEMAPOBJECT_H
 #define ADDREMOVEMAPOBJECT_H
 
+#include "mapobjectmodel.h"
+
+#include <QList>
 #include <QUndoCommand>
 
 namespace Tiled {
@@ -33,60 +36,69 @@ namespace Internal {
 class MapDocument;
 
 /**
- * Abstract base class for AddMapObject and RemoveMapObject.
+ * Abstract base class for AddMapObjects and RemoveMapObjects.
  */
-class AddRemoveMapObject : public QUndoCommand
+class AddRemoveMapObjects : public QUndoCommand
 {
 public:
-    AddRemoveMapObject(MapDocument *mapDocument,
-                       ObjectGroup *objectGroup,
-                       MapObject *mapObject,
-                       bool ownObject,
-                       QUndoCommand *parent = nullptr);
-    ~AddRemoveMapObject();
+    AddRemoveMapObjects(MapDocument *mapDocument,
+                        const MapObjectModel::ObjectEntries &entries,
+                        bool ownObjects,
+                        QUndoCommand *parent = nullptr);
+    ~AddRemoveMapObjects();
 
 protected:
-    void addObject();
-    void removeObject();
+    void addObjects();
+    void removeObjects();
 
 private:
     MapDocument *mMapDocument;
-    MapObject *mMapObject;
-    ObjectGroup *mObjectGroup;
-    int mIndex;
-    bool mOwnsObject;
+    MapObjectModel::ObjectEntries mEntries;
+    bool mOwnsObjects;
 };
 
 /**
- * Undo command that adds an object to a map.
+ * Undo command that adds objects to a map.
  */
-class AddMapObject : public AddRemoveMapObject
+class AddMapObjects : public AddRemoveMapObjects
 {
 public:
-    AddMapObject(MapDocument *mapDocument, ObjectGroup *objectGroup,
-                 MapObject *mapObject, QUndoCommand *parent = nullptr);
+    AddMapObjects(MapDocument *mapDocument, ObjectGroup *objectGroup,
+                  MapObject *mapObject, QUndoCommand *parent = nullptr);
+
+    AddMapObjects(MapDocument *mapDocument, ObjectGroup *objectGroup,
+                  const QList<MapObject*> &mapObjects,
+                  QUndoCommand *parent = nullptr);
+
+    AddMapObjects(MapDocument *mapDocument,
+                  const MapObjectModel::ObjectEntries &entries,
+                  QUndoCommand *parent = nullptr);
 
     void undo() override
-    { removeObject(); }
+    { removeObjects(); }
 
     void redo() override
-    { addObject(); }
+    { addObjects(); }
 };
 
 /**
- * Undo command that removes an object from a map.
+ * Undo command that removes objects from a map.
  */
-class RemoveMapObject : public AddRemoveMapObject
+class RemoveMapObjects : public AddRemoveMapObjects
 {
 public:
-    RemoveMapObject(MapDocument *mapDocument, MapObject *mapObject,
-                    QUndoCommand *parent = nullptr);
+    RemoveMapObjects(MapDocument *mapDocument, MapObject *mapObject,
+                     QUndoCommand *parent = nullptr);
+
+    RemoveMapObjects(MapDocument *mapDocument,
+                     const QList<MapObject*> &mapObjects,
+                     QUndoCommand *parent = nullptr);
 
     void undo() override
-    { addObject(); }
+    { addObjects(); }
 
     void redo() override
-    { removeObject(); }
+    { removeObjects(); }
 };
 
 } // namespace Internal
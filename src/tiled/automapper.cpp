@@ -854,13 +854,19 @@ void AutoMapper::copyObjectRegion(ObjectGroup *srcLayer, int srcX, int srcY,
     QPointF pixelOffset = mMapDocument->renderer()->tileToPixelCoords(dstX, dstY);
     pixelOffset -= pixelRect.topLeft();
 
+    QList<MapObject*> clones;
+    clones.reserve(objects.size());
+
     for (MapObject *obj : objects) {
         MapObject *clone = obj->clone();
         clone->resetId();
         clone->setX(clone->x() + pixelOffset.x());
         clone->setY(clone->y() + pixelOffset.y());
-        undo->push(new AddMapObject(mMapDocument, dstLayer, clone));
+        clones.append(clone);
     }
+
+    if (!clones.isEmpty())
+        undo->push(new AddMapObjects(mMapDocument, dstLayer, clones));
 }
 
 void AutoMapper::cleanAll()
@@ -36,7 +36,7 @@ void eraseRegionObjectGroup(MapDocument *mapDocument,
                                         ObjectGroup *layer,
                                         const QRegion &where)
 {
-    QUndoStack *undo = mapDocument->undoStack();
+    QList<MapObject*> objectsToRemove;
 
     foreach (MapObject *obj, layer->objects()) {
         // TODO: we are checking bounds, which is only correct for rectangles and
@@ -59,7 +59,12 @@ void eraseRegionObjectGroup(MapDocument *mapDocument,
 
         const QRect objAlignedRect = objInTileSpace.toAlignedRect();
         if (where.intersects(objAlignedRect))
-            undo->push(new RemoveMapObject(mapDocument, obj));
+            objectsToRemove.append(obj);
+    }
+
+    if (!objectsToRemove.isEmpty()) {
+        QUndoStack *undo = mapDocument->undoStack();
+        undo->push(new RemoveMapObjects(mapDocument, objectsToRemove));
     }
 }
 
@@ -133,7 +133,7 @@ void BucketFillTool::tilePositionChanged(const QPoint &tilePos)
             mFillRegion = regionComputer.computePaintableFillRegion(tilePos);
         } else {
             // If holding shift, the region is the selection bounds
-            mFillRegion = mapDocument()->selectedArea();
+            mFillRegion = mapDocument()->selectedArea().toRegion();
 
             // Fill region is the whole map if there is no selection
             if (mFillRegion.isEmpty())
@@ -351,4 +351,6 @@ void BucketFillTool::updateRandomListAndMissingTilesets()
             }
         }
     }
+
+    mRandomCellPicker.build();
 }
@@ -27,7 +27,7 @@
 using namespace Tiled::Internal;
 
 ChangeSelectedArea::ChangeSelectedArea(MapDocument *mapDocument,
-                                         const QRegion &newSelection)
+                                         const SelectionMask &newSelection)
     : QUndoCommand(QCoreApplication::translate("Undo Commands",
                                                "Change Selection"))
     , mMapDocument(mapDocument)
@@ -47,7 +47,7 @@ void ChangeSelectedArea::redo()
 
 void ChangeSelectedArea::swapSelection()
 {
-    const QRegion oldSelection = mMapDocument->selectedArea();
+    const SelectionMask oldSelection = mMapDocument->selectedArea();
     mMapDocument->setSelectedArea(mSelection);
     mSelection = oldSelection;
 }
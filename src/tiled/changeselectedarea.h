@@ -21,7 +21,8 @@
 #ifndef CHANGESELECTEDAREA_H
 #define CHANGESELECTEDAREA_H
 
-#include <QRegion>
+#include "selectionmask.h"
+
 #include <QUndoCommand>
 
 namespace Tiled {
@@ -37,7 +38,7 @@ public:
      * the given \a selection.
      */
     ChangeSelectedArea(MapDocument *mapDocument,
-                        const QRegion &selection);
+                        const SelectionMask &selection);
 
     void undo() override;
     void redo() override;
@@ -46,7 +47,7 @@ private:
     void swapSelection();
 
     MapDocument *mMapDocument;
-    QRegion mSelection;
+    SelectionMask mSelection;
 };
 
 } // namespace Internal
@@ -23,23 +23,20 @@
 #include "addremovemapobject.h"
 #include "map.h"
 #include "mapdocument.h"
+#include "mapmimedata.h"
 #include "mapobject.h"
 #include "maprenderer.h"
 #include "mapview.h"
 #include "objectgroup.h"
 #include "snaphelper.h"
-#include "tmxmapformat.h"
 #include "tile.h"
 #include "tilelayer.h"
 
 #include <QApplication>
 #include <QClipboard>
-#include <QMimeData>
 #include <QSet>
 #include <QUndoStack>
 
-static const char * const TMX_MIMETYPE = "text/tmx";
-
 using namespace Tiled;
 using namespace Tiled::Internal;
 
@@ -54,6 +51,13 @@ ClipboardManager::ClipboardManager() :
     updateHasMap();
 }
 
+ClipboardManager::~ClipboardManager()
+{
+    // Other applications can't get the map from us anymore after this
+    if (mMimeData && mClipboard->ownsClipboard())
+        mClipboard->setMimeData(mMimeData->toSerializedMimeData());
+}
+
 ClipboardManager *ClipboardManager::instance()
 {
     if (!mInstance)
@@ -69,23 +73,14 @@ void ClipboardManager::deleteInstance()
 
 Map *ClipboardManager::map() const
 {
-    const QMimeData *mimeData = mClipboard->mimeData();
-    const QByteArray data = mimeData->data(QLatin1String(TMX_MIMETYPE));
-    if (data.isEmpty())
-        return nullptr;
-
-    TmxMapFormat format;
-    return format.fromByteArray(data);
+    return MapMimeData::readMap(mClipboard->mimeData());
 }
 
 void ClipboardManager::setMap(const Map *map)
 {
-    TmxMapFormat format;
-
-    QMimeData *mimeData = new QMimeData;
-    mimeData->setData(QLatin1String(TMX_MIMETYPE), format.toByteArray(map));
-
-    mClipboard->setMimeData(mimeData);
+    // The map is only serialized when another application asks for it
+    mMimeData = new MapMimeData(map);
+    mClipboard->setMimeData(mMimeData);
 }
 
 void ClipboardManager::copySelection(const MapDocument *mapDocument)
@@ -95,15 +90,15 @@ void ClipboardManager::copySelection(const MapDocument *mapDocument)
         return;
 
     const Map *map = mapDocument->map();
-    const QRegion &selectedArea = mapDocument->selectedArea();
+    const SelectionMask &selectedArea = mapDocument->selectedArea();
     const QList<MapObject*> &selectedObjects = mapDocument->selectedObjects();
     const TileLayer *tileLayer = dynamic_cast<const TileLayer*>(currentLayer);
     Layer *copyLayer = nullptr;
 
     if (!selectedArea.isEmpty() && tileLayer) {
         // Copy the selected part of the layer
-        copyLayer = tileLayer->copy(selectedArea.translated(-tileLayer->x(),
-                                                             -tileLayer->y()));
+        const QPoint offset(-tileLayer->x(), -tileLayer->y());
+        copyLayer = tileLayer->copy(selectedArea.translated(offset).toRegion());
     } else if (!selectedObjects.isEmpty()) {
         // Create a new object group with clones of the selected objects
         ObjectGroup *objectGroup = new ObjectGroup;
@@ -168,7 +163,6 @@ void ClipboardManager::pasteObjectGroup(const ObjectGroup *objectGroup,
     QList<MapObject*> pastedObjects;
     pastedObjects.reserve(objectGroup->objectCount());
 
-    undoStack->beginMacro(tr("Paste Objects"));
     for (const MapObject *mapObject : objectGroup->objects()) {
         if (flags & PasteNoTileObjects && !mapObject->cell().isEmpty())
             continue;
@@ -177,20 +171,22 @@ void ClipboardManager::pasteObjectGroup(const ObjectGroup *objectGroup,
         objectClone->resetId();
         objectClone->setPosition(objectClone->position() + insertPos);
         pastedObjects.append(objectClone);
-        undoStack->push(new AddMapObject(mapDocument,
-                                         currentObjectGroup,
-                                         objectClone));
     }
-    undoStack->endMacro();
+
+    if (!pastedObjects.isEmpty()) {
+        AddMapObjects *command = new AddMapObjects(mapDocument,
+                                                   currentObjectGroup,
+                                                   pastedObjects);
+        command->setText(tr("Paste Objects"));
+        undoStack->push(command);
+    }
 
     mapDocument->setSelectedObjects(pastedObjects);
 }
 
 void ClipboardManager::updateHasMap()
 {
-    const QMimeData *data = mClipboard->mimeData();
-    const bool mapInClipboard =
-            data && data->hasFormat(QLatin1String(TMX_MIMETYPE));
+    const bool mapInClipboard = MapMimeData::hasMap(mClipboard->mimeData());
 
     if (mapInClipboard != mHasMap) {
         mHasMap = mapInClipboard;
@@ -22,6 +22,7 @@
 #define CLIPBOARDMANAGER_H
 
 #include <QObject>
+#include <QPointer>
 
 class QClipboard;
 
@@ -33,6 +34,7 @@ class Map;
 namespace Internal {
 
 class MapDocument;
+class MapMimeData;
 class MapView;
 
 /**
@@ -104,10 +106,12 @@ private slots:
 
 private:
     ClipboardManager();
+    ~ClipboardManager();
 
     Q_DISABLE_COPY(ClipboardManager)
 
     QClipboard *mClipboard;
+    QPointer<MapMimeData> mMimeData;
     bool mHasMap;
 
     static ClipboardManager *mInstance;
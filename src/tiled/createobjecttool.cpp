@@ -203,9 +203,9 @@ void CreateObjectTool::finishNewMapObject()
     ObjectGroup *objectGroup = newMapObject->objectGroup();
     clearNewMapObjectItem();
 
-    mapDocument()->undoStack()->push(new AddMapObject(mapDocument(),
-                                                      objectGroup,
-                                                      newMapObject));
+    mapDocument()->undoStack()->push(new AddMapObjects(mapDocument(),
+                                                       objectGroup,
+                                                       newMapObject));
 
     mapDocument()->setSelectedObjects(QList<MapObject*>() << newMapObject);
 }
@@ -133,7 +133,7 @@ EditPolygonTool::EditPolygonTool(QObject *parent)
     , mSelectionRectangle(new SelectionRectangle)
     , mMousePressed(false)
     , mClickedHandle(nullptr)
-    , mClickedObjectItem(nullptr)
+    , mClickedObject(nullptr)
     , mMode(NoMode)
 {
 }
@@ -246,7 +246,7 @@ void EditPolygonTool::mousePressed(QGraphicsSceneMouseEvent *event)
                                                                Qt::DescendingOrder,
                                                                viewTransform(event));
 
-        mClickedObjectItem = first<MapObjectItem>(items);
+        mClickedObject = mapScene()->objectAt(mStart);
         mClickedHandle = first<PointHandle>(items);
         break;
     }
@@ -291,26 +291,26 @@ void EditPolygonTool::mouseReleased(QGraphicsSceneMouseEvent *event)
                 selection.insert(mClickedHandle);
             }
             setSelectedHandles(selection);
-        } else if (mClickedObjectItem) {
-            QSet<MapObjectItem*> selection = mapScene()->selectedObjectItems();
+        } else if (mClickedObject) {
+            QList<MapObject*> selection = mapDocument()->selectedObjects();
             const Qt::KeyboardModifiers modifiers = event->modifiers();
             if (modifiers & (Qt::ShiftModifier | Qt::ControlModifier)) {
-                if (selection.contains(mClickedObjectItem))
-                    selection.remove(mClickedObjectItem);
+                if (selection.contains(mClickedObject))
+                    selection.removeOne(mClickedObject);
                 else
-                    selection.insert(mClickedObjectItem);
+                    selection.append(mClickedObject);
             } else {
                 selection.clear();
-                selection.insert(mClickedObjectItem);
+                selection.append(mClickedObject);
             }
-            mapScene()->setSelectedObjectItems(selection);
+            mapDocument()->setSelectedObjects(selection);
             updateHandles();
         } else if (!mSelectedHandles.isEmpty()) {
             // First clear the handle selection
             setSelectedHandles(QSet<PointHandle*>());
         } else {
             // If there is no handle selection, clear the object selection
-            mapScene()->setSelectedObjectItems(QSet<MapObjectItem*>());
+            mapDocument()->setSelectedObjects(QList<MapObject*>());
             updateHandles();
         }
         break;
@@ -325,6 +325,7 @@ void EditPolygonTool::mouseReleased(QGraphicsSceneMouseEvent *event)
     }
 
     mMousePressed = false;
+    mClickedObject = nullptr;
     mClickedHandle = nullptr;
 }
 
@@ -434,31 +435,12 @@ void EditPolygonTool::updateSelection(QGraphicsSceneMouseEvent *event)
     rect.setWidth(qMax(qreal(1), rect.width()));
     rect.setHeight(qMax(qreal(1), rect.height()));
 
-    const QSet<MapObjectItem*> oldSelection = mapScene()->selectedObjectItems();
-
-    if (oldSelection.isEmpty()) {
+    if (mapDocument()->selectedObjects().isEmpty()) {
         // Allow selecting some map objects only when there aren't any selected
-        QSet<MapObjectItem*> selectedItems;
-
-        foreach (QGraphicsItem *item, mapScene()->items(rect,
-                                                        Qt::IntersectsItemShape,
-                                                        Qt::DescendingOrder,
-                                                        viewTransform(event))) {
-            MapObjectItem *mapObjectItem = dynamic_cast<MapObjectItem*>(item);
-            if (mapObjectItem)
-                selectedItems.insert(mapObjectItem);
-        }
+        QPainterPath path;
+        path.addRect(rect);
 
-
-        QSet<MapObjectItem*> newSelection;
-
-        if (event->modifiers() & (Qt::ControlModifier | Qt::ShiftModifier)) {
-            newSelection = oldSelection | selectedItems;
-        } else {
-            newSelection = selectedItems;
-        }
-
-        mapScene()->setSelectedObjectItems(newSelection);
+        mapDocument()->setSelectedObjects(mapScene()->objectsIn(path));
         updateHandles();
     } else {
         // Update the selected handles
@@ -637,6 +619,8 @@ void EditPolygonTool::deleteNodes()
     QString delText = tr("Delete %n Node(s)", "", mSelectedHandles.size());
     undoStack->beginMacro(delText);
 
+    QList<MapObject*> removedObjects;
+
     while (i.hasNext()) {
         MapObject *object = i.next().key();
         const RangeSet<int> &indexRanges = i.value();
@@ -655,7 +639,7 @@ void EditPolygonTool::deleteNodes()
 
         if (newPolygon.size() < 2) {
             // We've removed the entire object
-            undoStack->push(new RemoveMapObject(mapDocument(), object));
+            removedObjects.append(object);
         } else {
             undoStack->push(new ChangePolygon(mapDocument(), object,
                                               newPolygon,
@@ -663,6 +647,9 @@ void EditPolygonTool::deleteNodes()
         }
     }
 
+    if (!removedObjects.isEmpty())
+        undoStack->push(new RemoveMapObjects(mapDocument(), removedObjects));
+
     undoStack->endMacro();
 }
 
@@ -91,7 +91,7 @@ private:
     SelectionRectangle *mSelectionRectangle;
     bool mMousePressed;
     PointHandle *mClickedHandle;
-    MapObjectItem *mClickedObjectItem;
+    MapObject *mClickedObject;
     QVector<QPointF> mOldHandlePositions;
     QMap<MapObject*, QPolygonF> mOldPolygons;
     QPointF mAlignPosition;
@@ -22,14 +22,11 @@
 #include "ui_exportasimagedialog.h"
 
 #include "map.h"
+#include "mapcompositor.h"
 #include "mapdocument.h"
-#include "mapobject.h"
 #include "mapobjectitem.h"
 #include "maprenderer.h"
-#include "imagelayer.h"
-#include "objectgroup.h"
 #include "preferences.h"
-#include "tilelayer.h"
 #include "utils.h"
 
 #include <QFileDialog>
@@ -114,11 +111,6 @@ ExportAsImageDialog::~ExportAsImageDialog()
     delete mUi;
 }
 
-static bool objectLessThan(const MapObject *a, const MapObject *b)
-{
-    return a->y() < b->y();
-}
-
 static bool smoothTransform(qreal scale)
 {
     return scale != qreal(1) && scale < qreal(2);
@@ -216,55 +208,12 @@ void ExportAsImageDialog::accept()
 
     painter.translate(margins.left(), margins.top());
 
-    for (const Layer *layer : mMapDocument->map()->layers()) {
-        if (visibleLayersOnly && !layer->isVisible())
-            continue;
-
-        painter.setOpacity(layer->opacity());
-        painter.translate(layer->offset());
-
-        switch (layer->layerType()) {
-        case Layer::TileLayerType: {
-            const TileLayer *tileLayer = static_cast<const TileLayer*>(layer);
-            renderer->drawTileLayer(&painter, tileLayer);
-            break;
-        }
-
-        case Layer::ObjectGroupType: {
-            const ObjectGroup *objectGroup = static_cast<const ObjectGroup*>(layer);
-            QList<MapObject*> objects = objectGroup->objects();
-
-            if (objectGroup->drawOrder() == ObjectGroup::TopDownOrder)
-                qStableSort(objects.begin(), objects.end(), objectLessThan);
-
-            foreach (const MapObject *object, objects) {
-                if (object->isVisible()) {
-                    if (object->rotation() != qreal(0)) {
-                        QPointF origin = renderer->pixelToScreenCoords(object->position());
-                        painter.save();
-                        painter.translate(origin);
-                        painter.rotate(object->rotation());
-                        painter.translate(-origin);
-                    }
-
-                    const QColor color = MapObjectItem::objectColor(object);
-                    renderer->drawMapObject(&painter, object, color);
-
-                    if (object->rotation() != qreal(0))
-                        painter.restore();
-                }
-            }
-            break;
-        }
-        case Layer::ImageLayerType: {
-            const ImageLayer *imageLayer = static_cast<const ImageLayer*>(layer);
-            renderer->drawImageLayer(&painter, imageLayer);
-            break;
-        }
-        }
-
-        painter.translate(-layer->offset());
-    }
+    MapCompositor compositor(renderer);
+    compositor.setLayerFilter([=] (const Layer *layer) {
+        return !visibleLayersOnly || layer->isVisible();
+    });
+    compositor.setObjectColorFunction(&MapObjectItem::objectColor);
+    compositor.render(&painter);
 
     if (drawTileGrid) {
         Preferences *prefs = Preferences::instance();
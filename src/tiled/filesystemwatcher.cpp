@@ -43,7 +43,7 @@ void FileSystemWatcher::addPath(const QString &path)
     if (!QFile::exists(path))
         return;
 
-    QMap<QString, int>::iterator entry = mWatchCount.find(path);
+    QHash<QString, int>::iterator entry = mWatchCount.find(path);
     if (entry == mWatchCount.end()) {
         mWatcher->addPath(path);
         mWatchCount.insert(path, 1);
@@ -55,7 +55,7 @@ void FileSystemWatcher::addPath(const QString &path)
 
 void FileSystemWatcher::removePath(const QString &path)
 {
-    QMap<QString, int>::iterator entry = mWatchCount.find(path);
+    QHash<QString, int>::iterator entry = mWatchCount.find(path);
     if (entry == mWatchCount.end()) {
         if (QFile::exists(path))
             qWarning() << "FileSystemWatcher: Path was never added:" << path;
@@ -21,7 +21,7 @@
 #ifndef FILESYSTEMWATCHER_H
 #define FILESYSTEMWATCHER_H
 
-#include <QMap>
+#include <QHash>
 #include <QObject>
 
 class QFileSystemWatcher;
@@ -56,7 +56,7 @@ private slots:
 
 private:
     QFileSystemWatcher *mWatcher;
-    QMap<QString, int> mWatchCount;
+    QHash<QString, int> mWatchCount;
 };
 
 } // namespace Internal
@@ -53,7 +53,7 @@ void MagicWandTool::tilePositionChanged(const QPoint &tilePos)
 
     TilePainter regionComputer(mapDocument(), tileLayer);
     mSelectedRegion = regionComputer.computeFillRegion(tilePos);
-    brushItem()->setTileRegion(mSelectedRegion);
+    brushItem()->setTileRegion(mSelectedRegion.toRegion());
 }
 
 void MagicWandTool::mousePressed(QGraphicsSceneMouseEvent *event)
@@ -65,10 +65,10 @@ void MagicWandTool::mousePressed(QGraphicsSceneMouseEvent *event)
 
     MapDocument *document = mapDocument();
 
-    QRegion selection = document->selectedArea();
+    SelectionMask selection = document->selectedArea();
 
     if (modifiers == Qt::ShiftModifier)
-        selection += mSelectedRegion;
+        selection |= mSelectedRegion;
     else if (modifiers == Qt::ControlModifier)
         selection -= mSelectedRegion;
     else if (modifiers == (Qt::ControlModifier | Qt::ShiftModifier))
@@ -27,6 +27,7 @@
 
 #include "abstracttiletool.h"
 
+#include "selectionmask.h"
 #include "tilelayer.h"
 
 namespace Tiled {
@@ -54,7 +55,7 @@ protected:
 
 private:
 
-    QRegion mSelectedRegion;
+    SelectionMask mSelectedRegion;
 };
 
 } // namespace Internal
@@ -244,13 +244,13 @@ MainWindow::MainWindow(QWidget *parent, Qt::WindowFlags flags)
     undoAction->setIconText(tr("Undo"));
     connect(undoGroup, SIGNAL(cleanChanged(bool)), SLOT(updateWindowTitle()));
 
-    UndoDock *undoDock = new UndoDock(undoGroup, this);
+    mUndoDock = new UndoDock(undoGroup, this);
     mPropertiesDock = new PropertiesDock(this);
     TileStampsDock *tileStampsDock = new TileStampsDock(mTileStampManager, this);
 
     addDockWidget(Qt::RightDockWidgetArea, mLayerDock);
     addDockWidget(Qt::LeftDockWidgetArea, mPropertiesDock);
-    addDockWidget(Qt::LeftDockWidgetArea, undoDock);
+    addDockWidget(Qt::LeftDockWidgetArea, mUndoDock);
     addDockWidget(Qt::LeftDockWidgetArea, mMapsDock);
     addDockWidget(Qt::RightDockWidgetArea, mObjectsDock);
     addDockWidget(Qt::RightDockWidgetArea, mMiniMapDock);
@@ -262,12 +262,12 @@ MainWindow::MainWindow(QWidget *parent, Qt::WindowFlags flags)
     tabifyDockWidget(mMiniMapDock, mObjectsDock);
     tabifyDockWidget(mObjectsDock, mLayerDock);
     tabifyDockWidget(mTerrainDock, mTilesetDock);
-    tabifyDockWidget(undoDock, mMapsDock);
-    tabifyDockWidget(tileStampsDock, undoDock);
+    tabifyDockWidget(mUndoDock, mMapsDock);
+    tabifyDockWidget(tileStampsDock, mUndoDock);
 
     // These dock widgets may not be immediately useful to many people, so
     // they are hidden by default.
-    undoDock->setVisible(false);
+    mUndoDock->setVisible(false);
     mMapsDock->setVisible(false);
     mConsoleDock->setVisible(false);
     tileStampsDock->setVisible(false);
@@ -1154,7 +1154,7 @@ void MainWindow::cut()
         return;
 
     TileLayer *tileLayer = dynamic_cast<TileLayer*>(currentLayer);
-    const QRegion &selectedArea = mMapDocument->selectedArea();
+    const SelectionMask &selectedArea = mMapDocument->selectedArea();
     const QList<MapObject*> &selectedObjects = mMapDocument->selectedObjects();
 
     copy();
@@ -1163,10 +1163,9 @@ void MainWindow::cut()
     stack->beginMacro(tr("Cut"));
 
     if (tileLayer && !selectedArea.isEmpty()) {
-        stack->push(new EraseTiles(mMapDocument, tileLayer, selectedArea));
+        stack->push(new EraseTiles(mMapDocument, tileLayer, selectedArea.toRegion()));
     } else if (!selectedObjects.isEmpty()) {
-        foreach (MapObject *mapObject, selectedObjects)
-            stack->push(new RemoveMapObject(mMapDocument, mapObject));
+        stack->push(new RemoveMapObjects(mMapDocument, selectedObjects));
     }
 
     mActionHandler->selectNone();
@@ -1242,17 +1241,16 @@ void MainWindow::delete_()
         return;
 
     TileLayer *tileLayer = dynamic_cast<TileLayer*>(currentLayer);
-    const QRegion &selectedArea = mMapDocument->selectedArea();
+    const SelectionMask &selectedArea = mMapDocument->selectedArea();
     const QList<MapObject*> &selectedObjects = mMapDocument->selectedObjects();
 
     QUndoStack *undoStack = mMapDocument->undoStack();
     undoStack->beginMacro(tr("Delete"));
 
     if (tileLayer && !selectedArea.isEmpty()) {
-        undoStack->push(new EraseTiles(mMapDocument, tileLayer, selectedArea));
+        undoStack->push(new EraseTiles(mMapDocument, tileLayer, selectedArea.toRegion()));
     } else if (!selectedObjects.isEmpty()) {
-        foreach (MapObject *mapObject, selectedObjects)
-            undoStack->push(new RemoveMapObject(mMapDocument, mapObject));
+        undoStack->push(new RemoveMapObjects(mMapDocument, selectedObjects));
     }
 
     mActionHandler->selectNone();
@@ -1581,7 +1579,7 @@ void MainWindow::updateActions()
     Map *map = nullptr;
     bool tileLayerSelected = false;
     bool objectsSelected = false;
-    QRegion selection;
+    SelectionMask selection;
     int layerComboIndex = -1;
 
     if (mMapDocument) {
@@ -1819,6 +1817,7 @@ void MainWindow::mapDocumentChanged(MapDocument *mapDocument)
     mTilesetDock->setMapDocument(mapDocument);
     mTerrainDock->setMapDocument(mapDocument);
     mMiniMapDock->setMapDocument(mapDocument);
+    mUndoDock->setMapDocument(mapDocument);
     mTileAnimationEditor->setMapDocument(mapDocument);
     mTileCollisionEditor->setMapDocument(mapDocument);
     mToolManager->setMapDocument(mapDocument);
@@ -1829,7 +1828,7 @@ void MainWindow::mapDocumentChanged(MapDocument *mapDocument)
                 SLOT(updateWindowTitle()));
         connect(mapDocument, SIGNAL(currentLayerIndexChanged(int)),
                 SLOT(updateActions()));
-        connect(mapDocument, SIGNAL(selectedAreaChanged(QRegion,QRegion)),
+        connect(mapDocument, SIGNAL(selectedAreaChanged(SelectionMask,SelectionMask)),
                 SLOT(updateActions()));
         connect(mapDocument, SIGNAL(selectedObjectsChanged()),
                 SLOT(updateActions()));
@@ -70,6 +70,7 @@ class TilesetDock;
 class TileStamp;
 class TileStampManager;
 class ToolManager;
+class UndoDock;
 class Zoomable;
 
 /**
@@ -235,6 +236,7 @@ private:
     TerrainDock *mTerrainDock;
     MiniMapDock* mMiniMapDock;
     ConsoleDock *mConsoleDock;
+    UndoDock *mUndoDock;
     ObjectTypesEditor *mObjectTypesEditor;
     TileAnimationEditor *mTileAnimationEditor;
     TileCollisionEditor *mTileCollisionEditor;
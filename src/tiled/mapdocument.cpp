@@ -43,6 +43,7 @@
 #include "orthogonalrenderer.h"
 #include "painttilelayer.h"
 #include "pluginmanager.h"
+#include "preferences.h"
 #include "resizemap.h"
 #include "resizetilelayer.h"
 #include "rotatemapobject.h"
@@ -53,11 +54,15 @@
 #include "tilelayer.h"
 #include "tilesetmanager.h"
 #include "tmxmapformat.h"
+#include "undomemorymanager.h"
 
 #include <QFileInfo>
 #include <QRect>
+#include <QSet>
 #include <QUndoStack>
 
+#include <algorithm>
+
 using namespace Tiled;
 using namespace Tiled::Internal;
 
@@ -69,7 +74,9 @@ MapDocument::MapDocument(Map *map, const QString &fileName):
     mRenderer(nullptr),
     mMapObjectModel(new MapObjectModel(this)),
     mTerrainModel(new TerrainModel(this, this)),
-    mUndoStack(new QUndoStack(this))
+    mUndoStack(new QUndoStack(this)),
+    mUndoMemoryManager(new UndoMemoryManager(mUndoStack, this)),
+    mRegionChangeFlushScheduled(false)
 {
     createRenderer();
 
@@ -109,6 +116,11 @@ MapDocument::MapDocument(Map *map, const QString &fileName):
 
     connect(mUndoStack, SIGNAL(cleanChanged(bool)), SIGNAL(modifiedChanged()));
 
+    Preferences *prefs = Preferences::instance();
+    undoMemoryLimitChanged(prefs->undoMemoryLimit());
+    connect(prefs, &Preferences::undoMemoryLimitChanged,
+            this, &MapDocument::undoMemoryLimitChanged);
+
     // Register tileset references
     TilesetManager *tilesetManager = TilesetManager::instance();
     tilesetManager->addReferences(mMap->tilesets());
@@ -116,6 +128,10 @@ MapDocument::MapDocument(Map *map, const QString &fileName):
 
 MapDocument::~MapDocument()
 {
+    // Delete the undo commands while the document is still intact, since they
+    // unregister themselves from the undo memory manager
+    delete mUndoStack;
+
     // Unregister tileset references
     TilesetManager *tilesetManager = TilesetManager::instance();
     tilesetManager->removeReferences(mMap->tilesets());
@@ -322,7 +338,7 @@ static bool visibleIn(const QRectF &area, MapObject *object,
 
 void MapDocument::resizeMap(const QSize &size, const QPoint &offset, bool removeObjects)
 {
-    const QRegion movedSelection = mSelectedArea.translated(offset);
+    const SelectionMask movedSelection = mSelectedArea.translated(offset);
     const QRect newArea = QRect(-offset, size);
     const QRectF visibleArea = mRenderer->boundingRect(newArea);
 
@@ -346,15 +362,18 @@ void MapDocument::resizeMap(const QSize &size, const QPoint &offset, bool remove
 
             // Remove objects that will fall outside of the map
             if (removeObjects) {
+                QList<MapObject*> objectsToRemove;
                 foreach (MapObject *o, objectGroup->objects()) {
                     if (!visibleIn(visibleArea, o, mRenderer)) {
-                        mUndoStack->push(new RemoveMapObject(this, o));
+                        objectsToRemove.append(o);
                     } else {
                         QPointF oldPos = o->position();
                         QPointF newPos = oldPos + pixelOffset;
                         mUndoStack->push(new MoveMapObject(this, o, newPos, oldPos));
                     }
                 }
+                if (!objectsToRemove.isEmpty())
+                    mUndoStack->push(new RemoveMapObjects(this, objectsToRemove));
             }
             break;
         }
@@ -659,10 +678,10 @@ SharedTileset MapDocument::replaceTileset(int index, const SharedTileset &tilese
     return oldTileset;
 }
 
-void MapDocument::setSelectedArea(const QRegion &selection)
+void MapDocument::setSelectedArea(const SelectionMask &selection)
 {
     if (mSelectedArea != selection) {
-        const QRegion oldSelectedArea = mSelectedArea;
+        const SelectionMask oldSelectedArea = mSelectedArea;
         mSelectedArea = selection;
         emit selectedAreaChanged(mSelectedArea, oldSelectedArea);
     }
@@ -812,6 +831,29 @@ void MapDocument::emitTilesetChanged(Tileset *tileset)
     emit tilesetChanged(tileset);
 }
 
+/**
+ * Reports a change to the specified region, which should be in tile
+ * coordinates. This method is used by the TilePainter.
+ *
+ * The regionChanged signal is not emitted right away. Instead, the changed
+ * regions are merged per layer and reported once control returns to the
+ * event loop, so that many small edits cause only a single repaint.
+ */
+void MapDocument::emitRegionChanged(const QRegion &region, Layer *layer)
+{
+    if (region.isEmpty())
+        return;
+
+    QRegion &pending = mPendingRegionChanges[layer];
+    pending |= region;
+
+    if (!mRegionChangeFlushScheduled) {
+        mRegionChangeFlushScheduled = true;
+        QMetaObject::invokeMethod(this, "flushRegionChanges",
+                                  Qt::QueuedConnection);
+    }
+}
+
 /**
  * Before forwarding the signal, the objects are removed from the list of
  * selected objects, triggering a selectedObjectsChanged signal when
@@ -879,6 +921,9 @@ void MapDocument::onLayerAboutToBeRemoved(int index)
     if (layer == mCurrentObject)
         setCurrentObject(nullptr);
 
+    // Changes to a layer that is no longer part of the map are not reported
+    mPendingRegionChanges.remove(layer);
+
     // Deselect any objects on this layer when necessary
     if (ObjectGroup *og = dynamic_cast<ObjectGroup*>(layer))
         deselectObjects(og->objects());
@@ -906,6 +951,33 @@ void MapDocument::onTerrainRemoved(Terrain *terrain)
         setCurrentObject(nullptr);
 }
 
+void MapDocument::undoMemoryLimitChanged(int megabytes)
+{
+    mUndoMemoryManager->setMemoryLimit(qint64(megabytes) * 1024 * 1024);
+}
+
+/**
+ * Emits the regionChanged signal for all changes collected since the last
+ * flush.
+ */
+void MapDocument::flushRegionChanges()
+{
+    mRegionChangeFlushScheduled = false;
+
+    if (mPendingRegionChanges.isEmpty())
+        return;
+
+    // Swap out the pending changes in case a receiver reports new ones
+    QHash<Layer*, QRegion> changes;
+    changes.swap(mPendingRegionChanges);
+
+    QHashIterator<Layer*, QRegion> it(changes);
+    while (it.hasNext()) {
+        it.next();
+        emit regionChanged(it.value(), it.key());
+    }
+}
+
 void MapDocument::deselectObjects(const QList<MapObject *> &objects)
 {
     // Unset the current object when it was part of this list of objects
@@ -913,12 +985,21 @@ void MapDocument::deselectObjects(const QList<MapObject *> &objects)
         if (objects.contains(static_cast<MapObject*>(mCurrentObject)))
             setCurrentObject(nullptr);
 
-    int removedCount = 0;
-    foreach (MapObject *object, objects)
-        removedCount += mSelectedObjects.removeAll(object);
+    if (mSelectedObjects.isEmpty())
+        return;
+
+    // Filter the selection in one pass, since many objects may be removed
+    const QSet<MapObject*> removedObjects = objects.toSet();
+    const auto end = std::remove_if(mSelectedObjects.begin(),
+                                    mSelectedObjects.end(),
+                                    [&] (MapObject *object) {
+        return removedObjects.contains(object);
+    });
 
-    if (removedCount > 0)
+    if (end != mSelectedObjects.end()) {
+        mSelectedObjects.erase(end, mSelectedObjects.end());
         emit selectedObjectsChanged();
+    }
 }
 
 void MapDocument::setTilesetFileName(Tileset *tileset,
@@ -947,19 +1028,22 @@ void MapDocument::duplicateObjects(const QList<MapObject *> &objects)
     if (objects.isEmpty())
         return;
 
-    mUndoStack->beginMacro(tr("Duplicate %n Object(s)", "", objects.size()));
-
     QList<MapObject*> clones;
+    MapObjectModel::ObjectEntries entries;
+    clones.reserve(objects.size());
+    entries.reserve(objects.size());
+
     for (const MapObject *mapObject : objects) {
         MapObject *clone = mapObject->clone();
         clone->resetId();
         clones.append(clone);
-        mUndoStack->push(new AddMapObject(this,
-                                          mapObject->objectGroup(),
-                                          clone));
+        entries.append(MapObjectModel::ObjectEntry { clone, mapObject->objectGroup(), -1 });
     }
 
-    mUndoStack->endMacro();
+    AddMapObjects *command = new AddMapObjects(this, entries);
+    command->setText(tr("Duplicate %n Object(s)", "", objects.size()));
+    mUndoStack->push(command);
+
     setSelectedObjects(clones);
 }
 
@@ -968,30 +1052,28 @@ void MapDocument::removeObjects(const QList<MapObject *> &objects)
     if (objects.isEmpty())
         return;
 
-    mUndoStack->beginMacro(tr("Remove %n Object(s)", "", objects.size()));
-    foreach (MapObject *mapObject, objects)
-        mUndoStack->push(new RemoveMapObject(this, mapObject));
-    mUndoStack->endMacro();
+    RemoveMapObjects *command = new RemoveMapObjects(this, objects);
+    command->setText(tr("Remove %n Object(s)", "", objects.size()));
+    mUndoStack->push(command);
 }
 
 void MapDocument::moveObjectsToGroup(const QList<MapObject *> &objects,
                                      ObjectGroup *objectGroup)
 {
-    if (objects.isEmpty())
-        return;
+    QList<MapObject*> movingObjects;
+    for (MapObject *mapObject : objects)
+        if (mapObject->objectGroup() != objectGroup)
+            movingObjects.append(mapObject);
 
-    mUndoStack->beginMacro(tr("Move %n Object(s) to Layer", "",
-                              objects.size()));
-
-    foreach (MapObject *mapObject, objects) {
-        if (mapObject->objectGroup() == objectGroup)
-            continue;
+    if (movingObjects.isEmpty())
+        return;
 
-        mUndoStack->push(new MoveMapObjectToGroup(this,
-                                                  mapObject,
-                                                  objectGroup));
-    }
-    mUndoStack->endMacro();
+    MoveMapObjectsToGroup *command = new MoveMapObjectsToGroup(this,
+                                                               movingObjects,
+                                                               objectGroup);
+    command->setText(tr("Move %n Object(s) to Layer", "",
+                        movingObjects.size()));
+    mUndoStack->push(command);
 }
 
 void MapDocument::setProperty(Object *object,
@@ -24,10 +24,12 @@
 #define MAPDOCUMENT_H
 
 #include "layer.h"
+#include "selectionmask.h"
 #include "tiled.h"
 #include "tileset.h"
 
 #include <QDateTime>
+#include <QHash>
 #include <QList>
 #include <QObject>
 #include <QPointer>
@@ -55,6 +57,7 @@ class LayerModel;
 class MapObjectModel;
 class TerrainModel;
 class TileSelectionModel;
+class UndoMemoryManager;
 
 /**
  * Represents an editable map. The purpose of this class is to make sure that
@@ -222,15 +225,21 @@ public:
      */
     QUndoStack *undoStack() const { return mUndoStack; }
 
+    /**
+     * Returns the object keeping track of the memory used by the commands on
+     * the undo stack.
+     */
+    UndoMemoryManager *undoMemoryManager() const { return mUndoMemoryManager; }
+
     /**
      * Returns the selected area of tiles.
      */
-    const QRegion &selectedArea() const { return mSelectedArea; }
+    const SelectionMask &selectedArea() const { return mSelectedArea; }
 
     /**
      * Sets the selected area of tiles.
      */
-    void setSelectedArea(const QRegion &selection);
+    void setSelectedArea(const SelectionMask &selection);
 
     /**
      * Returns the list of selected objects.
@@ -290,8 +299,8 @@ signals:
      * Emitted when the selected tile region changes. Sends the currently
      * selected region and the previously selected region.
      */
-    void selectedAreaChanged(const QRegion &newSelection,
-                             const QRegion &oldSelection);
+    void selectedAreaChanged(const SelectionMask &newSelection,
+                             const SelectionMask &oldSelection);
 
     /**
      * Emitted when the list of selected objects changes.
@@ -332,6 +341,9 @@ signals:
     /**
      * Emitted when a certain region of the map changes. The region is given in
      * tile coordinates.
+     *
+     * Changes are collected per layer and delivered once per iteration of
+     * the event loop, so the region may combine several edits.
      */
     void regionChanged(const QRegion &region, Layer *layer);
 
@@ -391,6 +403,10 @@ private slots:
 
     void onTerrainRemoved(Terrain *terrain);
 
+    void undoMemoryLimitChanged(int megabytes);
+
+    void flushRegionChanges();
+
 private:
     void setFileName(const QString &fileName);
     void deselectObjects(const QList<MapObject*> &objects);
@@ -407,7 +423,7 @@ private:
     QPointer<MapFormat> mExportFormat;
     Map *mMap;
     LayerModel *mLayerModel;
-    QRegion mSelectedArea;
+    SelectionMask mSelectedArea;
     QList<MapObject*> mSelectedObjects;
     QList<Tile*> mSelectedTiles;
     Object *mCurrentObject;             /**< Current properties object. */
@@ -416,7 +432,11 @@ private:
     MapObjectModel *mMapObjectModel;
     TerrainModel *mTerrainModel;
     QUndoStack *mUndoStack;
+    UndoMemoryManager *mUndoMemoryManager;
     QDateTime mLastSaved;
+
+    QHash<Layer*, QRegion> mPendingRegionChanges;
+    bool mRegionChangeFlushScheduled;
 };
 
 
@@ -464,18 +484,10 @@ inline void MapDocument::setLastExportFileName(const QString &fileName)
  */
 inline void MapDocument::emitMapChanged()
 {
+    flushRegionChanges();
     emit mapChanged();
 }
 
-/**
- * Emits the region changed signal for the specified region. The region
- * should be in tile coordinates. This method is used by the TilePainter.
- */
-inline void MapDocument::emitRegionChanged(const QRegion &region, Layer *layer)
-{
-    emit regionChanged(region, layer);
-}
-
 /**
  * Emits the region edited signal for the specified region and tile layer.
  * The region should be in tile coordinates. This should be called from
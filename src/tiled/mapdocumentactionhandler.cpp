@@ -179,7 +179,7 @@ void MapDocumentActionHandler::setMapDocument(MapDocument *mapDocument)
                 SLOT(updateActions()));
         connect(mapDocument, SIGNAL(currentLayerIndexChanged(int)),
                 SLOT(updateActions()));
-        connect(mapDocument, SIGNAL(selectedAreaChanged(QRegion,QRegion)),
+        connect(mapDocument, SIGNAL(selectedAreaChanged(SelectionMask,SelectionMask)),
                 SLOT(updateActions()));
         connect(mapDocument, SIGNAL(selectedObjectsChanged()),
                 SLOT(updateActions()));
@@ -219,7 +219,7 @@ void MapDocumentActionHandler::selectNone()
     if (mMapDocument->selectedArea().isEmpty())
         return;
 
-    QUndoCommand *command = new ChangeSelectedArea(mMapDocument, QRegion());
+    QUndoCommand *command = new ChangeSelectedArea(mMapDocument, SelectionMask());
     mMapDocument->undoStack()->push(command);
 }
 
@@ -359,7 +359,7 @@ void MapDocumentActionHandler::updateActions()
 {
     Map *map = nullptr;
     int currentLayerIndex = -1;
-    QRegion selection;
+    SelectionMask selection;
     int selectedObjectsCount = 0;
     bool canMergeDown = false;
 
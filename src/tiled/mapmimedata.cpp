@@ -0,0 +1,239 @@
+/*
+ * mapmimedata.cpp
+ * Copyright 2016, Tiled contributors
+ *
+ * This file is part of Tiled.
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation; either version 2 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "mapmimedata.h"
+
+#include "gidmapper.h"
+#include "map.h"
+#include "mapobject.h"
+#include "mapreader.h"
+#include "mapwriter.h"
+#include "objectgroup.h"
+#include "tilelayer.h"
+#include "tilelayerbinaryformat.h"
+#include "tilesetmanager.h"
+#include "tmxmapformat.h"
+
+#include <QBuffer>
+
+using namespace Tiled;
+using namespace Tiled::Internal;
+
+static const char * const TMX_MIMETYPE = "text/tmx";
+static const char * const TILE_LAYER_MIMETYPE = "application/x-tiled-tile-layer";
+
+static Map *readBinaryMap(const QByteArray &data)
+{
+    return readBinaryTileLayer(data, [] (const QString &fileName) {
+        // Check if this tileset is already loaded
+        SharedTileset tileset = TilesetManager::instance()->findTileset(fileName);
+        if (!tileset)
+            tileset = TsxTilesetFormat().read(fileName);
+        return tileset;
+    });
+}
+
+/**
+ * Returns a copy of the given embedded \a tileset, made by writing it as TSX
+ * and reading it back.
+ */
+static SharedTileset copyTileset(const Tileset &tileset)
+{
+    QBuffer buffer;
+    buffer.open(QIODevice::ReadWrite);
+    MapWriter().writeTileset(tileset, &buffer);
+    buffer.seek(0);
+    return MapReader().readTileset(&buffer);
+}
+
+
+MapMimeData::MapMimeData(const Map *map)
+    : mMap(new Map(*map))
+    , mTilesets(map->tilesets())
+{
+    const GidMapper gidMapper(mTilesets);
+
+    unsigned firstGid = 1;
+    for (const SharedTileset &tileset : mTilesets) {
+        mFirstGids.append(firstGid);
+        firstGid += tileset->nextTileId();
+    }
+
+    // The cells only refer to tiles by GID from here on
+    for (Layer *layer : mMap->layers()) {
+        QVector<unsigned> gids;
+
+        if (TileLayer *tileLayer = layer->asTileLayer()) {
+            gids = gidMapper.cellsToGids(*tileLayer);
+            for (Cell &cell : *tileLayer)
+                cell = Cell();
+        } else if (ObjectGroup *objectGroup = layer->asObjectGroup()) {
+            for (MapObject *object : objectGroup->objects()) {
+                gids.append(gidMapper.cellToGid(object->cell()));
+                object->setCell(Cell());
+            }
+        }
+
+        mLayerGids.append(gids);
+    }
+
+    while (mMap->tilesetCount() > 0)
+        mMap->removeTilesetAt(0);
+}
+
+MapMimeData::~MapMimeData()
+{
+}
+
+QMimeData *MapMimeData::toSerializedMimeData() const
+{
+    QMimeData *mimeData = new QMimeData;
+    for (const QString &format : formats())
+        mimeData->setData(format, serialized(format));
+    return mimeData;
+}
+
+QStringList MapMimeData::formats() const
+{
+    QStringList formats;
+    if (canWriteBinaryTileLayer(mMap.get()))
+        formats.append(QLatin1String(TILE_LAYER_MIMETYPE));
+    formats.append(QLatin1String(TMX_MIMETYPE));
+    return formats;
+}
+
+bool MapMimeData::hasMap(const QMimeData *mimeData)
+{
+    return mimeData &&
+            (mimeData->hasFormat(QLatin1String(TILE_LAYER_MIMETYPE)) ||
+             mimeData->hasFormat(QLatin1String(TMX_MIMETYPE)));
+}
+
+Map *MapMimeData::readMap(const QMimeData *mimeData)
+{
+    if (!mimeData)
+        return nullptr;
+
+    // Within this instance, the map is created from the snapshot directly
+    if (auto mapMimeData = dynamic_cast<const MapMimeData*>(mimeData))
+        return mapMimeData->createMap();
+
+    if (mimeData->hasFormat(QLatin1String(TILE_LAYER_MIMETYPE))) {
+        const QByteArray data = mimeData->data(QLatin1String(TILE_LAYER_MIMETYPE));
+        if (Map *map = readBinaryMap(data))
+            return map;
+    }
+
+    const QByteArray data = mimeData->data(QLatin1String(TMX_MIMETYPE));
+    if (data.isEmpty())
+        return nullptr;
+
+    TmxMapFormat format;
+    return format.fromByteArray(data);
+}
+
+QVariant MapMimeData::retrieveData(const QString &mimeType,
+                                   QVariant::Type type) const
+{
+    if (formats().contains(mimeType))
+        return serialized(mimeType);
+
+    return QMimeData::retrieveData(mimeType, type);
+}
+
+/**
+ * Creates a map from the snapshot, looking up the tiles by GID. Embedded
+ * tilesets are copied, since the map may be pasted more than once.
+ *
+ * Returns nullptr when a tileset could not be copied or a tile was removed
+ * since the snapshot was taken. No tiles are created for missing GIDs.
+ */
+Map *MapMimeData::createMap() const
+{
+    std::unique_ptr<Map> map(new Map(*mMap));
+    GidMapper gidMapper;
+
+    for (int i = 0; i < mTilesets.size(); ++i) {
+        SharedTileset tileset = mTilesets.at(i);
+        if (!tileset->isExternal()) {
+            tileset = copyTileset(*tileset);
+            if (!tileset)
+                return nullptr;
+        }
+
+        map->addTileset(tileset);
+        gidMapper.insert(mFirstGids.at(i), tileset.data());
+    }
+
+    for (int i = 0; i < map->layerCount(); ++i) {
+        Layer *layer = map->layerAt(i);
+        const QVector<unsigned> &gids = mLayerGids.at(i);
+
+        if (TileLayer *tileLayer = layer->asTileLayer()) {
+            const int width = tileLayer->width();
+            for (int j = 0; j < gids.size(); ++j) {
+                if (gids.at(j) == 0)
+                    continue;
+
+                bool ok;
+                const Cell cell = gidMapper.findCell(gids.at(j), ok);
+                if (!ok)
+                    return nullptr;
+
+                tileLayer->setCell(j % width, j / width, cell);
+            }
+        } else if (ObjectGroup *objectGroup = layer->asObjectGroup()) {
+            const QList<MapObject*> &objects = objectGroup->objects();
+            for (int j = 0; j < objects.size(); ++j) {
+                bool ok;
+                const Cell cell = gidMapper.findCell(gids.at(j), ok);
+                if (!ok)
+                    return nullptr;
+
+                objects.at(j)->setCell(cell);
+            }
+        }
+    }
+
+    return map.release();
+}
+
+/**
+ * Serializes the snapshot on first request, since other applications may
+ * never ask for it.
+ */
+QByteArray MapMimeData::serialized(const QString &mimeType) const
+{
+    const bool binary = mimeType == QLatin1String(TILE_LAYER_MIMETYPE);
+    QByteArray &data = binary ? mBinaryData : mTmxData;
+
+    if (data.isNull()) {
+        std::unique_ptr<Map> map(createMap());
+        if (map) {
+            if (binary) {
+                data = writeBinaryTileLayer(map.get());
+            } else {
+                TmxMapFormat format;
+                data = format.toByteArray(map.get());
+            }
+        }
+    }
+    return data;
+}
@@ -0,0 +1,99 @@
+/*
+ * mapmimedata.h
+ * Copyright 2016, Tiled contributors
+ *
+ * This file is part of Tiled.
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation; either version 2 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef MAPMIMEDATA_H
+#define MAPMIMEDATA_H
+
+#include "tileset.h"
+
+#include <QMimeData>
+#include <QVector>
+
+#include <memory>
+
+namespace Tiled {
+
+class Map;
+
+namespace Internal {
+
+/**
+ * Mime data holding a snapshot of a map.
+ *
+ * The snapshot is a copy of the map in which all cells, including those of
+ * tile objects, are stored as GIDs. This way it doesn't refer to any tiles
+ * that may be removed later, while pasting within the same application
+ * instance only needs to look up the tiles again.
+ *
+ * For other applications the map is serialized on request, either in a
+ * compact binary form or as TMX. The binary form is only available for maps
+ * with a single tile layer.
+ */
+class MapMimeData : public QMimeData
+{
+public:
+    /**
+     * Constructs mime data holding a snapshot of the given \a map.
+     */
+    explicit MapMimeData(const Map *map);
+    ~MapMimeData();
+
+    /**
+     * Returns a new mime data object with the serialized formats, which
+     * does not depend on this application anymore.
+     */
+    QMimeData *toSerializedMimeData() const;
+
+    QStringList formats() const override;
+
+    /**
+     * Returns whether the given \a mimeData contains a map.
+     */
+    static bool hasMap(const QMimeData *mimeData);
+
+    /**
+     * Reads the map from the given \a mimeData, using the most efficient
+     * format that is available. Returns nullptr when there was no map or
+     * reading failed.
+     *
+     * The caller takes ownership of the map.
+     */
+    static Map *readMap(const QMimeData *mimeData);
+
+protected:
+    QVariant retrieveData(const QString &mimeType,
+                          QVariant::Type type) const override;
+
+private:
+    Map *createMap() const;
+    QByteArray serialized(const QString &mimeType) const;
+
+    std::unique_ptr<Map> mMap;              // Without tilesets and cells
+    QVector<SharedTileset> mTilesets;
+    QVector<unsigned> mFirstGids;
+    QVector<QVector<unsigned>> mLayerGids;  // Cells or objects, per layer
+    mutable QByteArray mBinaryData;
+    mutable QByteArray mTmxData;
+};
+
+} // namespace Internal
+} // namespace Tiled
+
+#endif // MAPMIMEDATA_H
@@ -68,11 +68,7 @@ void MapObjectItem::syncWithMapObject()
         update();
     }
 
-    QString toolTip = mName;
-    const QString &type = mObject->type();
-    if (!type.isEmpty())
-        toolTip += QLatin1String(" (") + type + QLatin1String(")");
-    setToolTip(toolTip);
+    setToolTip(objectToolTip(mObject));
 
     MapRenderer *renderer = mMapDocument->renderer();
     const QPointF pixelPos = renderer->pixelToScreenCoords(mObject->position());
@@ -134,6 +130,15 @@ void MapObjectItem::setPolygon(const QPolygonF &polygon)
     syncWithMapObject();
 }
 
+QString MapObjectItem::objectToolTip(const MapObject *object)
+{
+    QString toolTip = object->name();
+    const QString &type = object->type();
+    if (!type.isEmpty())
+        toolTip += QLatin1String(" (") + type + QLatin1String(")");
+    return toolTip;
+}
+
 QColor MapObjectItem::objectColor(const MapObject *object)
 {
     // See if this object type has a color associated with it
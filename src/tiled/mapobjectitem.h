@@ -91,6 +91,12 @@ public:
      */
     static QColor objectColor(const MapObject *object);
 
+    /**
+     * Returns the tool tip shown for the given \a object, which consists of
+     * its name and type.
+     */
+    static QString objectToolTip(const MapObject *object);
+
 private:
     MapDocument *mapDocument() const { return mMapDocument; }
     QColor color() const { return mColor; }
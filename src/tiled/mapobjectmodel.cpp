@@ -29,6 +29,10 @@
 #include "renamelayer.h"
 
 #include <QCoreApplication>
+#include <QSet>
+
+#include <algorithm>
+#include <functional>
 
 #define GROUPS_IN_DISPLAY_ORDER 1
 
@@ -348,28 +352,131 @@ void MapObjectModel::layerAboutToBeRemoved(int index)
     }
 }
 
-void MapObjectModel::insertObject(ObjectGroup *og, int index, MapObject *o)
+/**
+ * Inserts the given objects into their object group at their index. The
+ * objects are inserted in order of index, so that passing the entries
+ * returned by removeObjects puts the objects back where they were.
+ *
+ * Consecutive objects are inserted as a single range of rows and the
+ * objectsAdded signal is emitted only once.
+ */
+void MapObjectModel::insertObjects(const ObjectEntries &entries)
 {
-    const int row = (index >= 0) ? index : og->objectCount();
-    beginInsertRows(this->index(og), row, row);
-    og->insertObject(row, o);
-    mObjects.insert(o, new ObjectOrGroup(o));
-    endInsertRows();
-    emit objectsAdded(QList<MapObject*>() << o);
+    if (entries.isEmpty())
+        return;
+
+    // Appended objects go after those inserted at a specific index
+    ObjectEntries sorted = entries;
+    std::stable_sort(sorted.begin(), sorted.end(),
+                     [] (const ObjectEntry &a, const ObjectEntry &b) {
+        if (a.objectGroup != b.objectGroup)
+            return std::less<ObjectGroup*>()(a.objectGroup, b.objectGroup);
+        if (a.index == -1 || b.index == -1)
+            return b.index == -1 && a.index != -1;
+        return a.index < b.index;
+    });
+
+    QList<MapObject*> insertedObjects;
+    insertedObjects.reserve(sorted.size());
+
+    int first = 0;
+    while (first < sorted.size()) {
+        ObjectGroup *og = sorted.at(first).objectGroup;
+        const int index = sorted.at(first).index;
+
+        // Find the objects that end up directly after the first one
+        int last = first;
+        while (last + 1 < sorted.size()) {
+            const ObjectEntry &next = sorted.at(last + 1);
+            if (next.objectGroup != og)
+                break;
+            if (index == -1 ? next.index != -1
+                            : next.index != index + last + 1 - first)
+                break;
+            ++last;
+        }
+
+        QList<MapObject*> objects;
+        objects.reserve(last - first + 1);
+        for (int i = first; i <= last; ++i)
+            objects.append(sorted.at(i).mapObject);
+
+        const int row = (index >= 0) ? index : og->objectCount();
+        beginInsertRows(this->index(og), row, row + objects.size() - 1);
+        og->insertObjects(row, objects);
+        for (MapObject *o : objects)
+            mObjects.insert(o, new ObjectOrGroup(o));
+        endInsertRows();
+
+        insertedObjects.append(objects);
+        first = last + 1;
+    }
+
+    emit objectsAdded(insertedObjects);
 }
 
-int MapObjectModel::removeObject(ObjectGroup *og, MapObject *o)
+/**
+ * Removes the given objects from their object groups. Ownership of the
+ * objects is transferred to the caller.
+ *
+ * Consecutive objects are removed as a single range of rows and the
+ * objectsRemoved signal is emitted only once.
+ *
+ * @return the removed objects along with the group and index they were at,
+ *         sorted by index
+ */
+MapObjectModel::ObjectEntries MapObjectModel::removeObjects(const QList<MapObject*> &objects)
 {
-    QList<MapObject*> objects;
-    objects << o;
-
-    const int row = og->objects().indexOf(o);
-    beginRemoveRows(index(og), row, row);
-    og->removeObjectAt(row);
-    delete mObjects.take(o);
-    endRemoveRows();
-    emit objectsRemoved(objects);
-    return row;
+    ObjectEntries entries;
+    if (objects.isEmpty())
+        return entries;
+
+    // Look up the indexes with a single pass over each affected group
+    const QSet<MapObject*> objectSet = objects.toSet();
+    QList<ObjectGroup*> objectGroups;
+    for (MapObject *o : objects)
+        if (!objectGroups.contains(o->objectGroup()))
+            objectGroups.append(o->objectGroup());
+
+    entries.reserve(objectSet.size());
+    for (ObjectGroup *og : objectGroups) {
+        for (int i = 0; i < og->objectCount(); ++i) {
+            MapObject *o = og->objectAt(i);
+            if (objectSet.contains(o))
+                entries.append(ObjectEntry { o, og, i });
+        }
+    }
+
+    // Remove back to front to keep the indexes valid
+    int last = entries.size() - 1;
+    while (last >= 0) {
+        ObjectGroup *og = entries.at(last).objectGroup;
+
+        int first = last;
+        while (first > 0 &&
+               entries.at(first - 1).objectGroup == og &&
+               entries.at(first - 1).index == entries.at(first).index - 1)
+            --first;
+
+        const int row = entries.at(first).index;
+        const int count = last - first + 1;
+
+        beginRemoveRows(index(og), row, row + count - 1);
+        og->removeObjectsAt(row, count);
+        for (int i = first; i <= last; ++i)
+            delete mObjects.take(entries.at(i).mapObject);
+        endRemoveRows();
+
+        last = first - 1;
+    }
+
+    QList<MapObject*> removedObjects;
+    removedObjects.reserve(entries.size());
+    for (const ObjectEntry &entry : entries)
+        removedObjects.append(entry.mapObject);
+
+    emit objectsRemoved(removedObjects);
+    return entries;
 }
 
 void MapObjectModel::moveObjects(ObjectGroup *og, int from, int to, int count)
@@ -23,6 +23,7 @@
 
 #include <QAbstractItemModel>
 #include <QIcon>
+#include <QVector>
 
 namespace Tiled {
 
@@ -64,6 +65,20 @@ public:
         MapObject *mObject;
     };
 
+    /**
+     * An object along with the object group it is in or is to be inserted
+     * into, and its index in that group. An index of -1 means the object is
+     * appended to the group.
+     */
+    struct ObjectEntry
+    {
+        MapObject *mapObject;
+        ObjectGroup *objectGroup;
+        int index;
+    };
+
+    typedef QVector<ObjectEntry> ObjectEntries;
+
     MapObjectModel(QObject *parent = nullptr);
 
     QModelIndex index(int row, int column, const QModelIndex &parent = QModelIndex()) const override;
@@ -89,8 +104,8 @@ public:
     void setMapDocument(MapDocument *mapDocument);
     MapDocument *mapDocument() const { return mMapDocument; }
 
-    void insertObject(ObjectGroup *og, int index, MapObject *o);
-    int removeObject(ObjectGroup *og, MapObject *o);
+    void insertObjects(const ObjectEntries &entries);
+    ObjectEntries removeObjects(const QList<MapObject*> &objects);
     void moveObjects(ObjectGroup *og, int from, int to, int count);
     void emitObjectsChanged(const QList<MapObject *> &objects);
 
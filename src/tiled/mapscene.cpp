@@ -43,10 +43,13 @@
 #include "toolmanager.h"
 #include "tilesetmanager.h"
 
+#include <QGraphicsSceneHelpEvent>
+#include <QHash>
 #include <QGraphicsSceneMouseEvent>
 #include <QPainter>
 #include <QKeyEvent>
 #include <QApplication>
+#include <QToolTip>
 
 #include <cmath>
 
@@ -55,6 +58,7 @@ using namespace Tiled::Internal;
 
 static const qreal darkeningFactor = 0.6;
 static const qreal opacityFactor = 0.4;
+static const int maxRepaintRects = 8;
 
 MapScene::MapScene(QObject *parent):
     QGraphicsScene(parent),
@@ -73,7 +77,9 @@ MapScene::MapScene(QObject *parent):
     connect(tilesetManager, SIGNAL(tilesetChanged(Tileset*)),
             this, SLOT(tilesetChanged(Tileset*)));
     connect(tilesetManager, SIGNAL(repaintTileset(Tileset*)),
-            this, SLOT(tilesetChanged(Tileset*)));
+            this, SLOT(repaintTileset(Tileset*)));
+    connect(tilesetManager, &TilesetManager::tileImagesChanged,
+            this, &MapScene::tileImagesChanged);
 
     Preferences *prefs = Preferences::instance();
     connect(prefs, SIGNAL(showGridChanged(bool)), SLOT(setGridVisible(bool)));
@@ -82,6 +88,8 @@ MapScene::MapScene(QObject *parent):
     connect(prefs, SIGNAL(objectTypesChanged()), SLOT(syncAllObjectItems()));
     connect(prefs, SIGNAL(highlightCurrentLayerChanged(bool)),
             SLOT(setHighlightCurrentLayer(bool)));
+    connect(prefs, SIGNAL(threadedRenderingChanged(bool)),
+            SLOT(setThreadedRendering(bool)));
     connect(prefs, SIGNAL(gridColorChanged(QColor)), SLOT(update()));
     connect(prefs, SIGNAL(objectLineWidthChanged(qreal)),
             SLOT(setObjectLineWidth(qreal)));
@@ -95,6 +103,7 @@ MapScene::MapScene(QObject *parent):
     mObjectLineWidth = prefs->objectLineWidth();
     mShowTileObjectOutlines = prefs->showTileObjectOutlines();
     mHighlightCurrentLayer = prefs->highlightCurrentLayer();
+    mThreadedRendering = prefs->threadedRendering();
 
     // Install an event filter so that we can get key events on behalf of the
     // active tool without having to have the current focus.
@@ -127,7 +136,7 @@ void MapScene::setMapDocument(MapDocument *mapDocument)
         connect(mMapDocument, SIGNAL(mapChanged()),
                 this, SLOT(mapChanged()));
         connect(mMapDocument, &MapDocument::regionChanged,
-                this, &MapScene::repaintRegion);
+                this, &MapScene::regionChanged);
         connect(mMapDocument, SIGNAL(tileLayerDrawMarginsChanged(TileLayer*)),
                 this, SLOT(tileLayerDrawMarginsChanged(TileLayer*)));
         connect(mMapDocument, SIGNAL(layerAdded(int)),
@@ -148,6 +157,8 @@ void MapScene::setMapDocument(MapDocument *mapDocument)
                 this, &MapScene::adaptToTileSizeChanges);
         connect(mMapDocument, &MapDocument::tilesetReplaced,
                 this, &MapScene::tilesetReplaced);
+        connect(mMapDocument, &MapDocument::tileAnimationChanged,
+                this, &MapScene::tileAnimationChanged);
         connect(mMapDocument, SIGNAL(objectsInserted(ObjectGroup*,int,int)),
                 this, SLOT(objectsInserted(ObjectGroup*,int,int)));
         connect(mMapDocument, SIGNAL(objectsRemoved(QList<MapObject*>)),
@@ -163,18 +174,6 @@ void MapScene::setMapDocument(MapDocument *mapDocument)
     refreshScene();
 }
 
-void MapScene::setSelectedObjectItems(const QSet<MapObjectItem *> &items)
-{
-    // Inform the map document about the newly selected objects
-    QList<MapObject*> selectedObjects;
-    selectedObjects.reserve(items.size());
-
-    for (const MapObjectItem *item : items)
-        selectedObjects.append(item->mapObject());
-
-    mMapDocument->setSelectedObjects(selectedObjects);
-}
-
 void MapScene::setSelectedTool(AbstractTool *tool)
 {
     mSelectedTool = tool;
@@ -184,6 +183,7 @@ void MapScene::refreshScene()
 {
     mLayerItems.clear();
     mObjectItems.clear();
+    mAnimatedCells.clear();
 
     removeItem(mDarkRectangle);
     clear();
@@ -229,23 +229,11 @@ QGraphicsItem *MapScene::createLayerItem(Layer *layer)
     QGraphicsItem *layerItem = nullptr;
 
     if (TileLayer *tl = layer->asTileLayer()) {
-        layerItem = new TileLayerItem(tl, mMapDocument);
+        TileLayerItem *tileLayerItem = new TileLayerItem(tl, mMapDocument);
+        tileLayerItem->setThreadedRendering(mThreadedRendering);
+        layerItem = tileLayerItem;
     } else if (ObjectGroup *og = layer->asObjectGroup()) {
-        const ObjectGroup::DrawOrder drawOrder = og->drawOrder();
-        ObjectGroupItem *ogItem = new ObjectGroupItem(og);
-        int objectIndex = 0;
-        for (MapObject *object : og->objects()) {
-            MapObjectItem *item = new MapObjectItem(object, mMapDocument,
-                                                    ogItem);
-            if (drawOrder == ObjectGroup::TopDownOrder)
-                item->setZValue(item->y());
-            else
-                item->setZValue(objectIndex);
-
-            mObjectItems.insert(object, item);
-            ++objectIndex;
-        }
-        layerItem = ogItem;
+        layerItem = new ObjectGroupItem(og, mMapDocument);
     } else if (ImageLayer *il = layer->asImageLayer()) {
         layerItem = new ImageLayerItem(il, mMapDocument);
     }
@@ -256,6 +244,39 @@ QGraphicsItem *MapScene::createLayerItem(Layer *layer)
     return layerItem;
 }
 
+ObjectGroupItem *MapScene::objectGroupItem(ObjectGroup *objectGroup) const
+{
+    const int index = mMapDocument->map()->layers().indexOf(objectGroup);
+    return dynamic_cast<ObjectGroupItem*>(mLayerItems.value(index));
+}
+
+MapObject *MapScene::objectAt(const QPointF &pos) const
+{
+    for (int i = mLayerItems.size() - 1; i >= 0; --i) {
+        ObjectGroupItem *ogItem = dynamic_cast<ObjectGroupItem*>(mLayerItems.at(i));
+        if (!ogItem || !ogItem->isVisible())
+            continue;
+
+        if (MapObject *object = ogItem->objectAt(ogItem->mapFromScene(pos)))
+            return object;
+    }
+
+    return nullptr;
+}
+
+QList<MapObject*> MapScene::objectsIn(const QPainterPath &area) const
+{
+    QList<MapObject*> objects;
+
+    for (QGraphicsItem *item : mLayerItems) {
+        ObjectGroupItem *ogItem = dynamic_cast<ObjectGroupItem*>(item);
+        if (ogItem && ogItem->isVisible())
+            objects.append(ogItem->objectsIn(ogItem->mapFromScene(area)));
+    }
+
+    return objects;
+}
+
 void MapScene::updateSceneRect()
 {
     const QSize mapSize = mMapDocument->renderer()->mapSize();
@@ -304,21 +325,83 @@ void MapScene::updateCurrentLayerHighlight()
 
 void MapScene::repaintRegion(const QRegion &region, Layer *layer)
 {
+    repaintRects(region.rects(), layer);
+}
+
+/**
+ * Repaints the given \a rects of \a layer, in tile coordinates.
+ *
+ * With threaded rendering, only the chunks covering these rects are rendered
+ * again, even when their scene updates are merged.
+ */
+void MapScene::repaintRects(const QVector<QRect> &rects, Layer *layer)
+{
+    if (rects.isEmpty())
+        return;
+
     const MapRenderer *renderer = mMapDocument->renderer();
     const QMargins margins = mMapDocument->map()->drawMargins();
 
-    for (const QRect &r : region.rects()) {
-        QRectF boundingRect = renderer->boundingRect(r);
+    auto boundingRect = [&] (const QRect &rect) {
+        return renderer->boundingRect(rect).adjusted(-margins.left(),
+                                                     -margins.top(),
+                                                     margins.right(),
+                                                     margins.bottom());
+    };
+
+    if (mThreadedRendering) {
+        const int index = mMapDocument->map()->layers().indexOf(layer);
+        if (TileLayerItem *tileLayerItem = dynamic_cast<TileLayerItem*>(mLayerItems.value(index)))
+            for (const QRect &r : rects)
+                tileLayerItem->invalidate(boundingRect(r));
+    }
+
+    // A region collected from many edits can consist of lots of small
+    // rectangles. Beyond a handful, repainting their bounds is cheaper than
+    // scheduling an update for each of them.
+    if (rects.size() > maxRepaintRects) {
+        QRect bounds;
+        for (const QRect &r : rects)
+            bounds |= r;
 
-        boundingRect.adjust(-margins.left(),
-                            -margins.top(),
-                            margins.right(),
-                            margins.bottom());
+        update(boundingRect(bounds).translated(layer->offset()));
+        return;
+    }
 
-        boundingRect.translate(layer->offset());
+    for (const QRect &r : rects)
+        update(boundingRect(r).translated(layer->offset()));
+}
 
-        update(boundingRect);
+void MapScene::regionChanged(const QRegion &region, Layer *layer)
+{
+    mAnimatedCells.remove(layer);
+    repaintRegion(region, layer);
+}
+
+/**
+ * Returns the cells of \a tileLayer that show animated tiles from
+ * \a tileset. These are determined on first request and cached until the
+ * layer or the animations change.
+ */
+const QVector<QRect> &MapScene::animatedCells(const TileLayer *tileLayer,
+                                              const Tileset *tileset)
+{
+    AnimatedCells &cells = mAnimatedCells[tileLayer];
+
+    AnimatedCells::iterator it = cells.find(tileset);
+    if (it == cells.end()) {
+        QVector<QRect> rects;
+        if (tileLayer->referencesTileset(tileset)) {
+            rects = tileLayer->region([tileset] (const Cell &cell) {
+                return cell.tile &&
+                        cell.tile->tileset() == tileset &&
+                        cell.tile->isAnimated();
+            }).rects();
+        }
+        it = cells.insert(tileset, rects);
     }
+
+    return it.value();
 }
 
 void MapScene::enableSelectedTool()
@@ -365,6 +448,7 @@ void MapScene::currentLayerIndexChanged()
  */
 void MapScene::mapChanged()
 {
+    mAnimatedCells.clear();
     updateSceneRect();
 
     for (QGraphicsItem *item : mLayerItems) {
@@ -372,8 +456,7 @@ void MapScene::mapChanged()
             tli->syncWithTileLayer();
     }
 
-    for (MapObjectItem *item : mObjectItems)
-        item->syncWithMapObject();
+    syncAllObjectItems();
 
     const Map *map = mMapDocument->map();
     if (map->backgroundColor().isValid())
@@ -387,10 +470,119 @@ void MapScene::tilesetChanged(Tileset *tileset)
     if (!mMapDocument)
         return;
 
-    if (contains(mMapDocument->map()->tilesets(), tileset))
+    const Map *map = mMapDocument->map();
+    if (!contains(map->tilesets(), tileset))
+        return;
+
+    // The animations may have changed as well
+    mAnimatedCells.clear();
+
+    if (mThreadedRendering) {
+        for (int i = 0; i < mLayerItems.size(); ++i) {
+            const Layer *layer = map->layerAt(i);
+            if (layer->isTileLayer() && layer->referencesTileset(tileset))
+                static_cast<TileLayerItem*>(mLayerItems.at(i))->invalidateAll();
+        }
+    }
+
+    update();
+}
+
+/**
+ * Called when the animated tiles of the given \a tileset advanced to their
+ * next frame. Only the cells displaying animated tiles are repainted, so
+ * that with threaded rendering only their chunks are rendered again.
+ *
+ * Since this happens many times per second, the animated cells are cached.
+ */
+void MapScene::repaintTileset(Tileset *tileset)
+{
+    if (!mMapDocument)
+        return;
+
+    const Map *map = mMapDocument->map();
+    if (!contains(map->tilesets(), tileset))
+        return;
+
+    bool repaintObjects = false;
+
+    for (Layer *layer : map->layers()) {
+        if (layer->isObjectGroup()) {
+            repaintObjects |= layer->referencesTileset(tileset);
+            continue;
+        }
+
+        if (!layer->isTileLayer())
+            continue;
+
+        const TileLayer *tileLayer = static_cast<TileLayer*>(layer);
+        repaintRects(animatedCells(tileLayer, tileset), layer);
+    }
+
+    // Tile objects are not cached, so they are simply repainted
+    if (repaintObjects)
+        update();
+}
+
+/**
+ * Repaints only the parts of the map that display any of the given \a tiles.
+ */
+void MapScene::tileImagesChanged(Tileset *tileset, const QList<Tile*> &tiles)
+{
+    if (!mMapDocument)
+        return;
+
+    const Map *map = mMapDocument->map();
+    if (!contains(map->tilesets(), tileset))
+        return;
+
+    QSet<const Tile*> changedTiles;
+    for (const Tile *tile : tiles)
+        changedTiles.insert(tile);
+
+    // Animated tiles may display any of the changed tiles as one of their frames
+    for (const Tile *tile : tileset->tiles()) {
+        for (const Frame &frame : tile->frames()) {
+            if (changedTiles.contains(tileset->findTile(frame.tileId))) {
+                changedTiles.insert(tile);
+                break;
+            }
+        }
+    }
+
+    bool repaintObjects = false;
+
+    for (Layer *layer : map->layers()) {
+        if (!layer->referencesTileset(tileset))
+            continue;
+
+        if (layer->isObjectGroup()) {
+            repaintObjects = true;
+            continue;
+        }
+
+        if (!layer->isTileLayer())
+            continue;
+
+        const TileLayer *tileLayer = static_cast<TileLayer*>(layer);
+        const QRegion region = tileLayer->region([&] (const Cell &cell) {
+            return cell.tile && changedTiles.contains(cell.tile);
+        });
+
+        if (!region.isEmpty())
+            repaintRegion(region, layer);
+    }
+
+    // Tile objects are not cached, so they are simply repainted
+    if (repaintObjects)
         update();
 }
 
+void MapScene::tileAnimationChanged()
+{
+    mAnimatedCells.clear();
+}
+
 void MapScene::tileLayerDrawMarginsChanged(TileLayer *tileLayer)
 {
     const int index = mMapDocument->map()->layers().indexOf(tileLayer);
@@ -400,6 +592,8 @@ void MapScene::tileLayerDrawMarginsChanged(TileLayer *tileLayer)
 
 void MapScene::layerAdded(int index)
 {
+    mAnimatedCells.clear();
+
     Layer *layer = mMapDocument->map()->layerAt(index);
     QGraphicsItem *layerItem = createLayerItem(layer);
     addItem(layerItem);
@@ -412,7 +606,22 @@ void MapScene::layerAdded(int index)
 
 void MapScene::layerRemoved(int index)
 {
-    delete mLayerItems.at(index);
+    mAnimatedCells.clear();
+
+    QGraphicsItem *layerItem = mLayerItems.at(index);
+
+    // Forget about the object items that are deleted along with the layer
+    ObjectItems::iterator it = mObjectItems.begin();
+    while (it != mObjectItems.end()) {
+        if (it.value()->parentItem() == layerItem) {
+            mSelectedObjectItems.remove(it.value());
+            it = mObjectItems.erase(it);
+        } else {
+            ++it;
+        }
+    }
+
+    delete layerItem;
     mLayerItems.remove(index);
 }
 
@@ -446,8 +655,12 @@ void MapScene::layerChanged(int index)
  */
 void MapScene::objectGroupChanged(ObjectGroup *objectGroup)
 {
-    objectsChanged(objectGroup->objects());
-    objectsIndexChanged(objectGroup, 0, objectGroup->objectCount() - 1);
+    if (ObjectGroupItem *ogItem = objectGroupItem(objectGroup))
+        ogItem->syncWithObjectGroup();
+
+    for (MapObjectItem *item : mObjectItems)
+        if (item->mapObject()->objectGroup() == objectGroup)
+            item->syncWithMapObject();
 }
 
 /**
@@ -475,11 +688,16 @@ void MapScene::adaptToTilesetTileSizeChanges(Tileset *tileset)
         if (TileLayerItem *tli = dynamic_cast<TileLayerItem*>(item))
             tli->syncWithTileLayer();
 
-    for (MapObjectItem *item : mObjectItems) {
-        const Cell &cell = item->mapObject()->cell();
-        if (!cell.isEmpty() && cell.tile->tileset() == tileset)
-            item->syncWithMapObject();
+    QList<MapObject*> changedObjects;
+    for (ObjectGroup *objectGroup : mMapDocument->map()->objectGroups()) {
+        for (MapObject *object : objectGroup->objects()) {
+            const Cell &cell = object->cell();
+            if (!cell.isEmpty() && cell.tile->tileset() == tileset)
+                changedObjects.append(object);
+        }
     }
+
+    objectsChanged(changedObjects);
 }
 
 void MapScene::adaptToTileSizeChanges(Tile *tile)
@@ -490,98 +708,94 @@ void MapScene::adaptToTileSizeChanges(Tile *tile)
         if (TileLayerItem *tli = dynamic_cast<TileLayerItem*>(item))
             tli->syncWithTileLayer();
 
-    for (MapObjectItem *item : mObjectItems) {
-        const Cell &cell = item->mapObject()->cell();
-        if (cell.tile == tile)
-            item->syncWithMapObject();
-    }
+    QList<MapObject*> changedObjects;
+    for (ObjectGroup *objectGroup : mMapDocument->map()->objectGroups())
+        for (MapObject *object : objectGroup->objects())
+            if (object->cell().tile == tile)
+                changedObjects.append(object);
+
+    objectsChanged(changedObjects);
 }
 
 void MapScene::tilesetReplaced(int index, Tileset *tileset)
 {
     Q_UNUSED(index)
+    mAnimatedCells.clear();
     adaptToTilesetTileSizeChanges(tileset);
 }
 
 /**
- * Inserts map object items for the given objects.
+ * Adds the given objects to the item of their object group.
  */
 void MapScene::objectsInserted(ObjectGroup *objectGroup, int first, int last)
 {
-    ObjectGroupItem *ogItem = nullptr;
-
-    // Find the object group item for the object group
-    for (QGraphicsItem *item : mLayerItems) {
-        if (ObjectGroupItem *ogi = dynamic_cast<ObjectGroupItem*>(item)) {
-            if (ogi->objectGroup() == objectGroup) {
-                ogItem = ogi;
-                break;
-            }
-        }
-    }
-
+    ObjectGroupItem *ogItem = objectGroupItem(objectGroup);
     Q_ASSERT(ogItem);
 
-    const ObjectGroup::DrawOrder drawOrder = objectGroup->drawOrder();
-
-    for (int i = first; i <= last; ++i) {
-        MapObject *object = objectGroup->objectAt(i);
-
-        MapObjectItem *item = new MapObjectItem(object, mMapDocument, ogItem);
-        if (drawOrder == ObjectGroup::TopDownOrder)
-            item->setZValue(item->y());
-        else
-            item->setZValue(i);
-
-        mObjectItems.insert(object, item);
-    }
+    ogItem->objectsInserted(first, last);
 }
 
 /**
- * Removes the map object items related to the given objects.
+ * Removes the given objects, along with their items if they had any.
  */
 void MapScene::objectsRemoved(const QList<MapObject*> &objects)
 {
     for (MapObject *o : objects) {
         ObjectItems::iterator i = mObjectItems.find(o);
-        Q_ASSERT(i != mObjectItems.end());
+        if (i == mObjectItems.end())
+            continue;
 
         mSelectedObjectItems.remove(i.value());
         delete i.value();
         mObjectItems.erase(i);
     }
+
+    // The objects no longer know their object group at this point
+    for (QGraphicsItem *item : mLayerItems)
+        if (ObjectGroupItem *ogItem = dynamic_cast<ObjectGroupItem*>(item))
+            ogItem->objectsRemoved(objects);
 }
 
 /**
- * Updates the map object items related to the given objects.
+ * Updates the drawing of the given objects, and their items if they have any.
  */
 void MapScene::objectsChanged(const QList<MapObject*> &objects)
 {
+    QHash<ObjectGroup*, QList<MapObject*>> objectsByGroup;
+
     for (MapObject *object : objects) {
-        MapObjectItem *item = itemForObject(object);
-        Q_ASSERT(item);
+        objectsByGroup[object->objectGroup()].append(object);
 
-        item->syncWithMapObject();
+        if (MapObjectItem *item = itemForObject(object))
+            item->syncWithMapObject();
+    }
+
+    QHashIterator<ObjectGroup*, QList<MapObject*>> it(objectsByGroup);
+    while (it.hasNext()) {
+        it.next();
+        if (it.key())
+            if (ObjectGroupItem *ogItem = objectGroupItem(it.key()))
+                ogItem->objectsChanged(it.value());
     }
 }
 
 /**
- * Updates the Z value of the objects when appropriate.
+ * Updates the drawing order of the objects when appropriate.
  */
 void MapScene::objectsIndexChanged(ObjectGroup *objectGroup,
                                    int first, int last)
 {
-    if (objectGroup->drawOrder() != ObjectGroup::IndexOrder)
-        return;
+    Q_UNUSED(first)
+    Q_UNUSED(last)
 
-    for (int i = first; i <= last; ++i) {
-        MapObjectItem *item = itemForObject(objectGroup->objectAt(i));
-        Q_ASSERT(item);
-
-        item->setZValue(i);
-    }
+    if (ObjectGroupItem *ogItem = objectGroupItem(objectGroup))
+        ogItem->objectsIndexChanged();
 }
 
+/**
+ * Creates items for the selected objects, and deletes the items of objects
+ * that are no longer selected.
+ */
 void MapScene::updateSelectedObjectItems()
 {
     const QList<MapObject *> &objects = mMapDocument->selectedObjects();
@@ -589,17 +803,48 @@ void MapScene::updateSelectedObjectItems()
     QSet<MapObjectItem*> items;
     for (MapObject *object : objects) {
         MapObjectItem *item = itemForObject(object);
-        Q_ASSERT(item);
+
+        if (!item) {
+            ObjectGroupItem *ogItem = objectGroupItem(object->objectGroup());
+            Q_ASSERT(ogItem);
+            if (!ogItem)
+                continue;
+
+            // The object group item does the drawing
+            item = new MapObjectItem(object, mMapDocument, ogItem);
+            item->setFlag(QGraphicsItem::ItemHasNoContents);
+            mObjectItems.insert(object, item);
+        }
 
         items.insert(item);
     }
 
+    // Items of deselected objects are only deleted after the change has been
+    // announced, so that they can still be looked at and their addresses are
+    // not reused by the new items in the meantime.
+    QList<MapObjectItem*> deselectedItems;
+    ObjectItems::iterator it = mObjectItems.begin();
+    while (it != mObjectItems.end()) {
+        if (!items.contains(it.value())) {
+            deselectedItems.append(it.value());
+            it = mObjectItems.erase(it);
+        } else {
+            ++it;
+        }
+    }
+
     mSelectedObjectItems = items;
     emit selectedObjectItemsChanged();
+
+    qDeleteAll(deselectedItems);
 }
 
 void MapScene::syncAllObjectItems()
 {
+    for (QGraphicsItem *item : mLayerItems)
+        if (ObjectGroupItem *ogItem = dynamic_cast<ObjectGroupItem*>(item))
+            ogItem->syncWithObjectGroup();
+
     for (MapObjectItem *item : mObjectItems)
         item->syncWithMapObject();
 }
@@ -626,13 +871,9 @@ void MapScene::setObjectLineWidth(qreal lineWidth)
     if (mMapDocument) {
         mMapDocument->renderer()->setObjectLineWidth(lineWidth);
 
-        // Changing the line width can change the size of the object items
-        if (!mObjectItems.isEmpty()) {
-            for (MapObjectItem *item : mObjectItems)
-                item->syncWithMapObject();
-
-            update();
-        }
+        // Changing the line width can change the size of the objects
+        syncAllObjectItems();
+        update();
     }
 }
 
@@ -645,8 +886,7 @@ void MapScene::setShowTileObjectOutlines(bool enabled)
 
     if (mMapDocument) {
         mMapDocument->renderer()->setFlag(ShowTileObjectOutlines, enabled);
-        if (!mObjectItems.isEmpty())
-            update();
+        update();
     }
 }
 
@@ -659,6 +899,18 @@ void MapScene::setHighlightCurrentLayer(bool highlightCurrentLayer)
     updateCurrentLayerHighlight();
 }
 
+void MapScene::setThreadedRendering(bool threadedRendering)
+{
+    if (mThreadedRendering == threadedRendering)
+        return;
+
+    mThreadedRendering = threadedRendering;
+
+    for (QGraphicsItem *item : mLayerItems)
+        if (TileLayerItem *tli = dynamic_cast<TileLayerItem*>(item))
+            tli->setThreadedRendering(mThreadedRendering);
+}
+
 void MapScene::drawForeground(QPainter *painter, const QRectF &rect)
 {
     if (!mMapDocument || !mGridVisible)
@@ -698,6 +950,21 @@ bool MapScene::event(QEvent *event)
     return QGraphicsScene::event(event);
 }
 
+void MapScene::helpEvent(QGraphicsSceneHelpEvent *event)
+{
+    // Most map objects don't have an item that could provide the tool tip
+    if (MapObject *object = objectAt(event->scenePos())) {
+        const QString toolTip = MapObjectItem::objectToolTip(object);
+        if (!toolTip.isEmpty()) {
+            QToolTip::showText(event->screenPos(), toolTip, event->widget());
+            event->setAccepted(true);
+            return;
+        }
+    }
+
+    QGraphicsScene::helpEvent(event);
+}
+
 void MapScene::keyPressEvent(QKeyEvent *event)
 {
     if (mActiveTool)
@@ -26,7 +26,9 @@
 
 #include <QColor>
 #include <QGraphicsScene>
+#include <QHash>
 #include <QMap>
+#include <QPainterPath>
 #include <QSet>
 
 namespace Tiled {
@@ -87,18 +89,27 @@ public:
     const QSet<MapObjectItem*> &selectedObjectItems() const
     { return mSelectedObjectItems; }
 
-    /**
-     * Sets the set of selected map object items. This translates to a call to
-     * MapDocument::setSelectedObjects.
-     */
-    void setSelectedObjectItems(const QSet<MapObjectItem*> &items);
-
     /**
      * Returns the MapObjectItem associated with the given \a mapObject.
+     *
+     * Items only exist for the selected objects. All other objects are drawn
+     * by the ObjectGroupItem of their object group.
      */
     MapObjectItem *itemForObject(MapObject *object) const
     { return mObjectItems.value(object); }
 
+    /**
+     * Returns the top-most visible map object at the given scene position,
+     * or nullptr when there is no object at that position.
+     */
+    MapObject *objectAt(const QPointF &pos) const;
+
+    /**
+     * Returns the visible map objects that intersect with the given \a area
+     * in scene coordinates, from bottom to top.
+     */
+    QList<MapObject*> objectsIn(const QPainterPath &area) const;
+
     /**
      * Enables the selected tool at this map scene.
      * Therefore it tells that tool, that this is the active map scene.
@@ -125,6 +136,11 @@ protected:
      */
     bool event(QEvent *event) override;
 
+    /**
+     * Override that shows the tool tips of map objects.
+     */
+    void helpEvent(QGraphicsSceneHelpEvent *event) override;
+
     void keyPressEvent(QKeyEvent *event) override;
     void mouseMoveEvent(QGraphicsSceneMouseEvent *mouseEvent) override;
     void mousePressEvent(QGraphicsSceneMouseEvent *mouseEvent) override;
@@ -142,6 +158,11 @@ private slots:
      */
     void setHighlightCurrentLayer(bool highlightCurrentLayer);
 
+    /**
+     * Sets whether tile layers are rasterized on background threads.
+     */
+    void setThreadedRendering(bool threadedRendering);
+
     /**
      * Refreshes the map scene.
      */
@@ -152,10 +173,15 @@ private slots:
      */
     void repaintRegion(const QRegion &region, Layer *layer);
 
+    void regionChanged(const QRegion &region, Layer *layer);
+
     void currentLayerIndexChanged();
 
     void mapChanged();
     void tilesetChanged(Tileset *tileset);
+    void repaintTileset(Tileset *tileset);
+    void tileAnimationChanged();
+    void tileImagesChanged(Tileset *tileset, const QList<Tile*> &tiles);
     void tileLayerDrawMarginsChanged(TileLayer *tileLayer);
 
     void layerAdded(int index);
@@ -180,10 +206,15 @@ private slots:
 
 private:
     QGraphicsItem *createLayerItem(Layer *layer);
+    ObjectGroupItem *objectGroupItem(ObjectGroup *objectGroup) const;
 
     void updateSceneRect();
     void updateCurrentLayerHighlight();
 
+    void repaintRects(const QVector<QRect> &rects, Layer *layer);
+    const QVector<QRect> &animatedCells(const TileLayer *tileLayer,
+                                        const Tileset *tileset);
+
     bool eventFilter(QObject *object, QEvent *event) override;
 
     MapDocument *mMapDocument;
@@ -193,6 +224,7 @@ private:
     qreal mObjectLineWidth;
     bool mShowTileObjectOutlines;
     bool mHighlightCurrentLayer;
+    bool mThreadedRendering;
     bool mUnderMouse;
     Qt::KeyboardModifiers mCurrentModifiers;
     QPointF mLastMousePos;
@@ -204,6 +236,10 @@ private:
     typedef QMap<MapObject*, MapObjectItem*> ObjectItems;
     ObjectItems mObjectItems;
     QSet<MapObjectItem*> mSelectedObjectItems;
+
+    // The cells showing animated tiles, per tile layer and tileset
+    typedef QHash<const Tileset*, QVector<QRect>> AnimatedCells;
+    QHash<const Layer*, AnimatedCells> mAnimatedCells;
 };
 
 } // namespace Internal
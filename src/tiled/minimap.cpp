@@ -22,16 +22,13 @@
 #include "minimap.h"
 
 #include "documentmanager.h"
-#include "imagelayer.h"
 #include "map.h"
+#include "mapcompositor.h"
 #include "mapdocument.h"
-#include "mapobject.h"
 #include "mapobjectitem.h"
 #include "maprenderer.h"
 #include "mapview.h"
-#include "objectgroup.h"
 #include "preferences.h"
-#include "tilelayer.h"
 #include "zoomable.h"
 
 #include <QCursor>
@@ -163,11 +160,6 @@ void MiniMap::updateImageRect()
     mImageRect = imageRect;
 }
 
-static bool objectLessThan(const MapObject *a, const MapObject *b)
-{
-    return a->y() < b->y();
-}
-
 void MiniMap::renderMapToImage()
 {
     if (!mMapDocument) {
@@ -219,48 +211,21 @@ void MiniMap::renderMapToImage()
     painter.translate(margins.left(), margins.top());
     renderer->setPainterScale(scale);
 
-    foreach (const Layer *layer, mMapDocument->map()->layers()) {
+    MapCompositor compositor(renderer);
+    compositor.setLayerFilter([=] (const Layer *layer) -> bool {
         if (visibleLayersOnly && !layer->isVisible())
-            continue;
-
-        painter.setOpacity(layer->opacity());
-        painter.translate(layer->offset());
-
-        const TileLayer *tileLayer = dynamic_cast<const TileLayer*>(layer);
-        const ObjectGroup *objGroup = dynamic_cast<const ObjectGroup*>(layer);
-        const ImageLayer *imageLayer = dynamic_cast<const ImageLayer*>(layer);
-
-        if (tileLayer && drawTiles) {
-            renderer->drawTileLayer(&painter, tileLayer);
-        } else if (objGroup && drawObjects) {
-            QList<MapObject*> objects = objGroup->objects();
-
-            if (objGroup->drawOrder() == ObjectGroup::TopDownOrder)
-                qStableSort(objects.begin(), objects.end(), objectLessThan);
-
-            foreach (const MapObject *object, objects) {
-                if (object->isVisible()) {
-                    if (object->rotation() != qreal(0)) {
-                        QPointF origin = renderer->pixelToScreenCoords(object->position());
-                        painter.save();
-                        painter.translate(origin);
-                        painter.rotate(object->rotation());
-                        painter.translate(-origin);
-                    }
-
-                    const QColor color = MapObjectItem::objectColor(object);
-                    renderer->drawMapObject(&painter, object, color);
-
-                    if (object->rotation() != qreal(0))
-                        painter.restore();
-                }
-            }
-        } else if (imageLayer && drawImages) {
-            renderer->drawImageLayer(&painter, imageLayer);
+            return false;
+
+        switch (layer->layerType()) {
+        case Layer::TileLayerType:      return drawTiles;
+        case Layer::ObjectGroupType:    return drawObjects;
+        case Layer::ImageLayerType:     return drawImages;
         }
 
-        painter.translate(-layer->offset());
-    }
+        return false;
+    });
+    compositor.setObjectColorFunction(&MapObjectItem::objectColor);
+    compositor.render(&painter);
 
     if (drawTileGrid) {
         Preferences *prefs = Preferences::instance();
@@ -30,26 +30,34 @@
 using namespace Tiled;
 using namespace Tiled::Internal;
 
-MoveMapObjectToGroup::MoveMapObjectToGroup(MapDocument *mapDocument,
-                                           MapObject *mapObject,
-                                           ObjectGroup *objectGroup)
+MoveMapObjectsToGroup::MoveMapObjectsToGroup(MapDocument *mapDocument,
+                                             const QList<MapObject*> &mapObjects,
+                                             ObjectGroup *objectGroup)
     : mMapDocument(mapDocument)
-    , mMapObject(mapObject)
-    , mOldObjectGroup(mapObject->objectGroup())
+    , mMapObjects(mapObjects)
     , mNewObjectGroup(objectGroup)
 {
     setText(QCoreApplication::translate("Undo Commands",
-                                        "Move Object to Layer"));
+                                        "Move %n Object(s) to Layer",
+                                        nullptr, mapObjects.size()));
 }
 
-void MoveMapObjectToGroup::undo()
+void MoveMapObjectsToGroup::undo()
 {
-    mMapDocument->mapObjectModel()->removeObject(mNewObjectGroup, mMapObject);
-    mMapDocument->mapObjectModel()->insertObject(mOldObjectGroup, -1, mMapObject);
+    MapObjectModel *mapObjectModel = mMapDocument->mapObjectModel();
+    mapObjectModel->removeObjects(mMapObjects);
+    mapObjectModel->insertObjects(mOldEntries);
 }
 
-void MoveMapObjectToGroup::redo()
+void MoveMapObjectsToGroup::redo()
 {
-    mMapDocument->mapObjectModel()->removeObject(mOldObjectGroup, mMapObject);
-    mMapDocument->mapObjectModel()->insertObject(mNewObjectGroup, -1, mMapObject);
+    MapObjectModel *mapObjectModel = mMapDocument->mapObjectModel();
+    mOldEntries = mapObjectModel->removeObjects(mMapObjects);
+
+    MapObjectModel::ObjectEntries newEntries;
+    newEntries.reserve(mMapObjects.size());
+    for (MapObject *mapObject : mMapObjects)
+        newEntries.append(MapObjectModel::ObjectEntry { mapObject, mNewObjectGroup, -1 });
+
+    mapObjectModel->insertObjects(newEntries);
 }
@@ -21,6 +21,9 @@
 #ifndef MOVEMAPOBJECTTOGROUP_H
 #define MOVEMAPOBJECTTOGROUP_H
 
+#include "mapobjectmodel.h"
+
+#include <QList>
 #include <QUndoCommand>
 
 namespace Tiled {
@@ -32,20 +35,24 @@ namespace Internal {
 
 class MapDocument;
 
-class MoveMapObjectToGroup : public QUndoCommand
+/**
+ * Undo command that moves objects to another object group. The objects are
+ * appended to the new group and return to their old index on undo.
+ */
+class MoveMapObjectsToGroup : public QUndoCommand
 {
 public:
-    MoveMapObjectToGroup(MapDocument *mapDocument,
-                         MapObject *mapObject,
-                         ObjectGroup *objectGroup);
+    MoveMapObjectsToGroup(MapDocument *mapDocument,
+                          const QList<MapObject*> &mapObjects,
+                          ObjectGroup *objectGroup);
 
     void undo() override;
     void redo() override;
 
 private:
     MapDocument *mMapDocument;
-    MapObject *mMapObject;
-    ObjectGroup *mOldObjectGroup;
+    QList<MapObject*> mMapObjects;
+    MapObjectModel::ObjectEntries mOldEntries;
     ObjectGroup *mNewObjectGroup;
 };
 
@@ -21,17 +21,77 @@
 #include "objectgroupitem.h"
 
 #include "map.h"
+#include "mapdocument.h"
+#include "mapobject.h"
 #include "mapobjectitem.h"
+#include "maprenderer.h"
+#include "mapview.h"
 #include "objectgroup.h"
+#include "zoomable.h"
+
+#include <QPainter>
+#include <QStyleOptionGraphicsItem>
+#include <QtMath>
+
+#include <algorithm>
 
 using namespace Tiled;
 using namespace Tiled::Internal;
 
-ObjectGroupItem::ObjectGroupItem(ObjectGroup *objectGroup):
-    mObjectGroup(objectGroup)
+namespace {
+
+/**
+ * The size in pixels of the cells of the grid used to look up objects.
+ */
+const qreal CellSize = 256;
+
+/**
+ * Objects covering more cells than this are not put in the grid, but are
+ * always considered instead.
+ */
+const int MaxCellsPerObject = 64;
+
+quint64 cellKey(int x, int y)
 {
-    // Since we don't do any painting, we can spare us the call to paint()
-    setFlag(QGraphicsItem::ItemHasNoContents);
+    return (quint64(quint32(x)) << 32) | quint32(y);
+}
+
+QRect cellRange(const QRectF &rect)
+{
+    return QRect(QPoint(qFloor(rect.left() / CellSize),
+                        qFloor(rect.top() / CellSize)),
+                 QPoint(qFloor(rect.right() / CellSize),
+                        qFloor(rect.bottom() / CellSize)));
+}
+
+QTransform rotationTransform(const QPointF &origin, qreal rotation)
+{
+    QTransform transform;
+    transform.translate(origin.x(), origin.y());
+    transform.rotate(rotation);
+    transform.translate(-origin.x(), -origin.y());
+    return transform;
+}
+
+} // anonymous namespace
+
+
+ObjectGroupItem::ObjectGroupItem(ObjectGroup *objectGroup,
+                                 MapDocument *mapDocument)
+    : mObjectGroup(objectGroup)
+    , mMapDocument(mapDocument)
+    , mIndexesDirty(true)
+{
+    if (mMapDocument) {
+        // Needed to only draw the objects in the exposed area
+        setFlag(QGraphicsItem::ItemUsesExtendedStyleOption);
+
+        for (MapObject *object : objectGroup->objects())
+            insertObject(object);
+    } else {
+        // Since we don't do any painting, we can spare us the call to paint()
+        setFlag(QGraphicsItem::ItemHasNoContents);
+    }
 
     setOpacity(objectGroup->opacity());
     setPos(objectGroup->offset());
@@ -49,15 +109,306 @@ void ObjectGroupItem::setObjectGroup(ObjectGroup *objectGroup)
     mObjectGroup = objectGroup;
     setOpacity(mObjectGroup->opacity());
     setPos(mObjectGroup->offset());
+
+    if (mMapDocument)
+        syncWithObjectGroup();
+}
+
+void ObjectGroupItem::objectsInserted(int first, int last)
+{
+    for (int i = first; i <= last; ++i)
+        insertObject(mObjectGroup->objectAt(i));
+
+    mIndexesDirty = true;
+}
+
+void ObjectGroupItem::objectsRemoved(const QList<MapObject *> &objects)
+{
+    for (MapObject *object : objects)
+        removeObject(object);
+
+    mIndexesDirty = true;
+}
+
+void ObjectGroupItem::objectsChanged(const QList<MapObject *> &objects)
+{
+    for (MapObject *object : objects) {
+        if (mEntries.contains(object)) {
+            removeObject(object);
+            insertObject(object);
+        }
+    }
+}
+
+void ObjectGroupItem::objectsIndexChanged()
+{
+    mIndexesDirty = true;
+    update();
+}
+
+void ObjectGroupItem::syncWithObjectGroup()
+{
+    if (!mMapDocument)
+        return;
+
+    update();
+    prepareGeometryChange();
+
+    mEntries.clear();
+    mGrid.clear();
+    mLargeObjects.clear();
+    mBoundingRect = QRectF();
+    mIndexesDirty = true;
+
+    for (MapObject *object : mObjectGroup->objects())
+        insertObject(object);
+}
+
+MapObject *ObjectGroupItem::objectAt(const QPointF &pos) const
+{
+    const QRect cells = cellRange(QRectF(pos, pos));
+
+    QList<MapObject*> objects;
+    for (MapObject *object : mGrid.value(cellKey(cells.left(), cells.top())))
+        if (mEntries.value(object).bounds.contains(pos))
+            objects.append(object);
+    for (MapObject *object : mLargeObjects)
+        if (mEntries.value(object).bounds.contains(pos))
+            objects.append(object);
+
+    sortByDrawOrder(objects);
+
+    for (int i = objects.size() - 1; i >= 0; --i) {
+        MapObject *object = objects.at(i);
+        if (object->isVisible() && objectShape(object).contains(pos))
+            return object;
+    }
+
+    return nullptr;
+}
+
+QList<MapObject*> ObjectGroupItem::objectsIn(const QPainterPath &area) const
+{
+    QList<MapObject*> objects;
+
+    for (MapObject *object : candidates(area.boundingRect()))
+        if (objectShape(object).intersects(area))
+            objects.append(object);
+
+    sortByDrawOrder(objects);
+    return objects;
+}
+
+QPainterPath ObjectGroupItem::objectShape(const MapObject *object) const
+{
+    const MapRenderer *renderer = mMapDocument->renderer();
+    const QPainterPath shape = renderer->shape(object);
+
+    if (object->rotation() == 0)
+        return shape;
+
+    const QPointF origin = renderer->pixelToScreenCoords(object->position());
+    return rotationTransform(origin, object->rotation()).map(shape);
 }
 
 QRectF ObjectGroupItem::boundingRect() const
 {
-    return QRectF();
+    return mBoundingRect;
 }
 
-void ObjectGroupItem::paint(QPainter *,
-                            const QStyleOptionGraphicsItem *,
-                            QWidget *)
+void ObjectGroupItem::paint(QPainter *painter,
+                            const QStyleOptionGraphicsItem *option,
+                            QWidget *widget)
 {
+    QList<MapObject*> objects = candidates(option->exposedRect);
+    if (objects.isEmpty())
+        return;
+
+    sortByDrawOrder(objects);
+
+    MapRenderer *renderer = mMapDocument->renderer();
+    if (widget)
+        renderer->setPainterScale(static_cast<MapView*>(widget->parent())->zoomable()->scale());
+
+    for (MapObject *object : objects) {
+        const QColor color = mEntries.value(object).color;
+
+        if (object->rotation() == 0) {
+            renderer->drawMapObject(painter, object, color);
+            continue;
+        }
+
+        const QPointF origin = renderer->pixelToScreenCoords(object->position());
+
+        painter->save();
+        painter->setTransform(rotationTransform(origin, object->rotation()), true);
+        renderer->drawMapObject(painter, object, color);
+        painter->restore();
+    }
+}
+
+void ObjectGroupItem::insertObject(MapObject *object)
+{
+    const MapRenderer *renderer = mMapDocument->renderer();
+    QRectF bounds = renderer->boundingRect(object);
+
+    if (object->rotation() != 0) {
+        const QPointF origin = renderer->pixelToScreenCoords(object->position());
+        bounds = rotationTransform(origin, object->rotation()).mapRect(bounds);
+    }
+
+    ObjectEntry &entry = mEntries[object];
+    entry.bounds = bounds;
+    entry.color = MapObjectItem::objectColor(object);
+
+    addToGrid(object, bounds);
+
+    if (!mBoundingRect.contains(bounds)) {
+        prepareGeometryChange();
+        mBoundingRect |= bounds;
+    }
+
+    update(bounds);
+}
+
+void ObjectGroupItem::removeObject(MapObject *object)
+{
+    auto it = mEntries.find(object);
+    if (it == mEntries.end())
+        return;
+
+    // The bounding rect is not shrunk, it is recomputed on full syncs only
+    removeFromGrid(object, it.value().bounds);
+    update(it.value().bounds);
+
+    mEntries.erase(it);
+}
+
+void ObjectGroupItem::addToGrid(MapObject *object, const QRectF &bounds)
+{
+    const QRect cells = cellRange(bounds);
+
+    if (qint64(cells.width()) * cells.height() > MaxCellsPerObject) {
+        mLargeObjects.append(object);
+        return;
+    }
+
+    for (int y = cells.top(); y <= cells.bottom(); ++y)
+        for (int x = cells.left(); x <= cells.right(); ++x)
+            mGrid[cellKey(x, y)].append(object);
+}
+
+void ObjectGroupItem::removeFromGrid(MapObject *object, const QRectF &bounds)
+{
+    const QRect cells = cellRange(bounds);
+
+    if (qint64(cells.width()) * cells.height() > MaxCellsPerObject) {
+        const int index = mLargeObjects.indexOf(object);
+        if (index != -1)
+            mLargeObjects.remove(index);
+        return;
+    }
+
+    for (int y = cells.top(); y <= cells.bottom(); ++y) {
+        for (int x = cells.left(); x <= cells.right(); ++x) {
+            auto it = mGrid.find(cellKey(x, y));
+            if (it == mGrid.end())
+                continue;
+
+            QVector<MapObject*> &cellObjects = it.value();
+            const int index = cellObjects.indexOf(object);
+            if (index != -1)
+                cellObjects.remove(index);
+            if (cellObjects.isEmpty())
+                mGrid.erase(it);
+        }
+    }
+}
+
+/**
+ * Returns the visible objects whose bounds intersect with \a rect, in no
+ * particular order.
+ */
+QList<MapObject*> ObjectGroupItem::candidates(const QRectF &rect) const
+{
+    QList<MapObject*> objects;
+    const QRect cells = cellRange(rect);
+
+    // When looking at a large area, checking all objects is cheaper
+    if (qint64(cells.width()) * cells.height() > mEntries.size()) {
+        for (auto it = mEntries.constBegin(); it != mEntries.constEnd(); ++it)
+            if (it.key()->isVisible() && it.value().bounds.intersects(rect))
+                objects.append(it.key());
+        return objects;
+    }
+
+    for (int y = cells.top(); y <= cells.bottom(); ++y) {
+        for (int x = cells.left(); x <= cells.right(); ++x) {
+            for (MapObject *object : mGrid.value(cellKey(x, y))) {
+                const QRectF bounds = mEntries.value(object).bounds;
+
+                // Objects spanning several cells are only taken from the
+                // first cell they share with the given area
+                const QRect objectCells = cellRange(bounds) & cells;
+                if (objectCells.left() != x || objectCells.top() != y)
+                    continue;
+
+                if (object->isVisible() && bounds.intersects(rect))
+                    objects.append(object);
+            }
+        }
+    }
+
+    for (MapObject *object : mLargeObjects)
+        if (object->isVisible() && mEntries.value(object).bounds.intersects(rect))
+            objects.append(object);
+
+    return objects;
+}
+
+void ObjectGroupItem::sortByDrawOrder(QList<MapObject*> &objects) const
+{
+    if (objects.size() < 2)
+        return;
+
+    if (mIndexesDirty) {
+        mIndexes.clear();
+        mIndexes.reserve(mObjectGroup->objectCount());
+
+        int index = 0;
+        for (const MapObject *object : mObjectGroup->objects())
+            mIndexes.insert(object, index++);
+
+        mIndexesDirty = false;
+    }
+
+    struct SortKey {
+        qreal y;
+        int index;
+        MapObject *object;
+
+        bool operator<(const SortKey &other) const
+        {
+            if (y != other.y)
+                return y < other.y;
+            return index < other.index;
+        }
+    };
+
+    const bool topDown = mObjectGroup->drawOrder() == ObjectGroup::TopDownOrder;
+    const MapRenderer *renderer = mMapDocument->renderer();
+
+    QVector<SortKey> keys;
+    keys.reserve(objects.size());
+
+    for (MapObject *object : objects) {
+        const qreal y = topDown ? renderer->pixelToScreenCoords(object->position()).y() : 0;
+        const SortKey key = { y, mIndexes.value(object), object };
+        keys.append(key);
+    }
+
+    std::sort(keys.begin(), keys.end());
+
+    for (int i = 0; i < keys.size(); ++i)
+        objects[i] = keys.at(i).object;
 }
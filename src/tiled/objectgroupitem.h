@@ -21,28 +21,87 @@
 #ifndef OBJECTGROUPITEM_H
 #define OBJECTGROUPITEM_H
 
+#include <QColor>
 #include <QGraphicsItem>
+#include <QHash>
+#include <QList>
+#include <QVector>
 
 namespace Tiled {
 
+class MapObject;
 class ObjectGroup;
 
 namespace Internal {
 
+class MapDocument;
+
 /**
- * A graphics item representing an object group in a QGraphicsView. It only
- * serves to group together the objects belonging to the same object group.
+ * A graphics item representing an object group in a QGraphicsView.
+ *
+ * When a map document is given, the item draws the objects of the group
+ * itself, looking up the objects in the exposed area through a grid. This
+ * avoids the cost of a separate graphics item for each object, which only
+ * exist for the selected objects (see MapScene).
+ *
+ * Without a map document, it only serves to group together other items, like
+ * the MapObjectItem instances used while creating new objects.
  *
  * @see MapObjectItem
  */
 class ObjectGroupItem : public QGraphicsItem
 {
 public:
-    ObjectGroupItem(ObjectGroup *objectGroup);
+    ObjectGroupItem(ObjectGroup *objectGroup,
+                    MapDocument *mapDocument = nullptr);
 
     void setObjectGroup(ObjectGroup *objectGroup);
     ObjectGroup *objectGroup() const;
 
+    /**
+     * Should be called when the objects in the given range were inserted.
+     */
+    void objectsInserted(int first, int last);
+
+    /**
+     * Should be called when the given objects were removed. Objects that are
+     * not part of this item are ignored.
+     */
+    void objectsRemoved(const QList<MapObject*> &objects);
+
+    /**
+     * Should be called when the given objects have changed.
+     */
+    void objectsChanged(const QList<MapObject*> &objects);
+
+    /**
+     * Should be called when the order of the objects has changed.
+     */
+    void objectsIndexChanged();
+
+    /**
+     * Updates all objects, for example after the renderer, the object types
+     * or the color of the group have changed.
+     */
+    void syncWithObjectGroup();
+
+    /**
+     * Returns the top-most visible object at \a pos, in item coordinates.
+     */
+    MapObject *objectAt(const QPointF &pos) const;
+
+    /**
+     * Returns the visible objects that intersect with \a area, in item
+     * coordinates. The objects are returned in drawing order.
+     */
+    QList<MapObject*> objectsIn(const QPainterPath &area) const;
+
+    /**
+     * Returns the shape of the given \a object in item coordinates, taking
+     * into account its rotation.
+     */
+    QPainterPath objectShape(const MapObject *object) const;
+
     // QGraphicsItem
     QRectF boundingRect() const override;
     void paint(QPainter *painter,
@@ -50,7 +109,30 @@ public:
                QWidget *widget = nullptr) override;
 
 private:
+    struct ObjectEntry
+    {
+        QRectF bounds;      // Including rotation, in item coordinates
+        QColor color;
+    };
+
+    void insertObject(MapObject *object);
+    void removeObject(MapObject *object);
+    void addToGrid(MapObject *object, const QRectF &bounds);
+    void removeFromGrid(MapObject *object, const QRectF &bounds);
+
+    QList<MapObject*> candidates(const QRectF &rect) const;
+    void sortByDrawOrder(QList<MapObject*> &objects) const;
+
     ObjectGroup *mObjectGroup;
+    MapDocument *mMapDocument;
+
+    QHash<MapObject*, ObjectEntry> mEntries;
+    QHash<quint64, QVector<MapObject*>> mGrid;
+    QVector<MapObject*> mLargeObjects;  // Objects covering many grid cells
+    QRectF mBoundingRect;
+
+    mutable QHash<const MapObject*, int> mIndexes;
+    mutable bool mIndexesDirty;
 };
 
 inline ObjectGroup *ObjectGroupItem::objectGroup() const
@@ -25,7 +25,6 @@
 #include "map.h"
 #include "mapdocument.h"
 #include "mapobject.h"
-#include "mapobjectitem.h"
 #include "mapobjectmodel.h"
 #include "maprenderer.h"
 #include "mapscene.h"
@@ -320,8 +319,8 @@ ObjectSelectionTool::ObjectSelectionTool(QObject *parent)
     , mSelectionRectangle(new SelectionRectangle)
     , mOriginIndicator(new OriginIndicator)
     , mMousePressed(false)
-    , mHoveredObjectItem(nullptr)
-    , mClickedObjectItem(nullptr)
+    , mHoveredObject(nullptr)
+    , mClickedObject(nullptr)
     , mClickedRotateHandle(nullptr)
     , mClickedResizeHandle(nullptr)
     , mResizingLimitHorizontal(false)
@@ -406,10 +405,10 @@ void ObjectSelectionTool::keyPressed(QKeyEvent *event)
         return;
     }
 
-    const QSet<MapObjectItem*> &items = mapScene()->selectedObjectItems();
+    const QList<MapObject*> &objects = mapDocument()->selectedObjects();
     const Qt::KeyboardModifiers modifiers = event->modifiers();
 
-    if (moveBy.isNull() || items.isEmpty() || (modifiers & Qt::ControlModifier)) {
+    if (moveBy.isNull() || objects.isEmpty() || (modifiers & Qt::ControlModifier)) {
         event->ignore();
         return;
     }
@@ -426,10 +425,9 @@ void ObjectSelectionTool::keyPressed(QKeyEvent *event)
     }
 
     QUndoStack *undoStack = mapDocument()->undoStack();
-    undoStack->beginMacro(tr("Move %n Object(s)", "", items.size()));
+    undoStack->beginMacro(tr("Move %n Object(s)", "", objects.size()));
     int i = 0;
-    foreach (MapObjectItem *objectItem, items) {
-        MapObject *object = objectItem->mapObject();
+    foreach (MapObject *object, objects) {
         const QPointF oldPos = object->position();
         const QPointF newPos = oldPos + moveBy;
         undoStack->push(new MoveMapObject(mapDocument(), object, newPos, oldPos));
@@ -451,7 +449,7 @@ void ObjectSelectionTool::mouseMoved(const QPointF &pos,
     {
         RotateHandle *hoveredRotateHandle = nullptr;
         ResizeHandle *hoveredResizeHandle = nullptr;
-        MapObjectItem *hoveredObjectItem = nullptr;
+        MapObject *hoveredObject = nullptr;
 
         if (QGraphicsView *view = mapScene()->views().first()) {
             QGraphicsItem *hoveredItem = mapScene()->itemAt(pos,
@@ -462,20 +460,20 @@ void ObjectSelectionTool::mouseMoved(const QPointF &pos,
         }
 
         if (!hoveredRotateHandle && !hoveredResizeHandle)
-            hoveredObjectItem = topMostObjectItemAt(pos);
+            hoveredObject = topMostObjectAt(pos);
 
-        mHoveredObjectItem = hoveredObjectItem;
+        mHoveredObject = hoveredObject;
     }
 
     if (mAction == NoAction && mMousePressed) {
         QPoint screenPos = QCursor::pos();
         const int dragDistance = (mScreenStart - screenPos).manhattanLength();
         if (dragDistance >= QApplication::startDragDistance()) {
-            const bool hasSelection = !mapScene()->selectedObjectItems().isEmpty();
+            const bool hasSelection = !mapDocument()->selectedObjects().isEmpty();
 
             // Holding Alt forces moving current selection
             // Holding Shift forces selection rectangle
-            if ((mClickedObjectItem || ((modifiers & Qt::AltModifier) && hasSelection)) &&
+            if ((mClickedObject || ((modifiers & Qt::AltModifier) && hasSelection)) &&
                     !(modifiers & Qt::ShiftModifier)) {
                 startMoving(modifiers);
             } else if (mClickedRotateHandle) {
@@ -540,7 +538,7 @@ void ObjectSelectionTool::mousePressed(QGraphicsSceneMouseEvent *event)
         mClickedRotateHandle = clickedRotateHandle;
         mClickedResizeHandle = clickedResizeHandle;
         if (!clickedRotateHandle && !clickedResizeHandle)
-            mClickedObjectItem = topMostObjectItemAt(mStart);
+            mClickedObject = topMostObjectAt(mStart);
 
         break;
     }
@@ -562,24 +560,24 @@ void ObjectSelectionTool::mouseReleased(QGraphicsSceneMouseEvent *event)
             break;
         }
         const Qt::KeyboardModifiers modifiers = event->modifiers();
-        if (mClickedObjectItem) {
-            QSet<MapObjectItem*> selection = mapScene()->selectedObjectItems();
+        if (mClickedObject) {
+            QList<MapObject*> selection = mapDocument()->selectedObjects();
             if (modifiers & (Qt::ShiftModifier | Qt::ControlModifier)) {
-                if (selection.contains(mClickedObjectItem))
-                    selection.remove(mClickedObjectItem);
+                if (selection.contains(mClickedObject))
+                    selection.removeOne(mClickedObject);
                 else
-                    selection.insert(mClickedObjectItem);
-            } else if (selection.contains(mClickedObjectItem)) {
+                    selection.append(mClickedObject);
+            } else if (selection.contains(mClickedObject)) {
                 // Clicking one of the selected items changes the edit mode
                 setMode((mMode == Resize) ? Rotate : Resize);
             } else {
                 selection.clear();
-                selection.insert(mClickedObjectItem);
+                selection.append(mClickedObject);
                 setMode(Resize);
             }
-            mapScene()->setSelectedObjectItems(selection);
+            mapDocument()->setSelectedObjects(selection);
         } else if (!(modifiers & Qt::ShiftModifier)) {
-            mapScene()->setSelectedObjectItems(QSet<MapObjectItem*>());
+            mapDocument()->setSelectedObjects(QList<MapObject*>());
         }
         break;
     }
@@ -600,7 +598,7 @@ void ObjectSelectionTool::mouseReleased(QGraphicsSceneMouseEvent *event)
     }
 
     mMousePressed = false;
-    mClickedObjectItem = nullptr;
+    mClickedObject = nullptr;
     mClickedRotateHandle = nullptr;
     mClickedResizeHandle = nullptr;
 
@@ -874,7 +872,7 @@ void ObjectSelectionTool::objectsRemoved(const QList<MapObject *> &objects)
     // since it breaks the undo history, for example.
     for (int i = mMovingObjects.size() - 1; i >= 0; --i) {
         const MovingObject &object = mMovingObjects.at(i);
-        MapObject *mapObject = object.item->mapObject();
+        MapObject *mapObject = object.mapObject;
 
         if (objects.contains(mapObject)) {
             // Avoid referencing the removed object
@@ -901,20 +899,20 @@ void ObjectSelectionTool::updateSelection(const QPointF &pos,
     rect.setWidth(qMax(qreal(1), rect.width()));
     rect.setHeight(qMax(qreal(1), rect.height()));
 
-    QSet<MapObjectItem*> selectedItems;
+    QPainterPath path;
+    path.addRect(rect);
 
-    foreach (QGraphicsItem *item, mapScene()->items(rect)) {
-        MapObjectItem *mapObjectItem = dynamic_cast<MapObjectItem*>(item);
-        if (mapObjectItem)
-            selectedItems.insert(mapObjectItem);
-    }
+    QList<MapObject*> selectedObjects = mapScene()->objectsIn(path);
 
-    if (modifiers & (Qt::ControlModifier | Qt::ShiftModifier))
-        selectedItems |= mapScene()->selectedObjectItems();
-    else
+    if (modifiers & (Qt::ControlModifier | Qt::ShiftModifier)) {
+        foreach (MapObject *mapObject, mapDocument()->selectedObjects())
+            if (!selectedObjects.contains(mapObject))
+                selectedObjects.append(mapObject);
+    } else {
         setMode(Resize);
+    }
 
-    mapScene()->setSelectedObjectItems(selectedItems);
+    mapDocument()->setSelectedObjects(selectedObjects);
 }
 
 void ObjectSelectionTool::startSelecting()
@@ -926,9 +924,9 @@ void ObjectSelectionTool::startSelecting()
 void ObjectSelectionTool::startMoving(Qt::KeyboardModifiers modifiers)
 {
     // Move only the clicked item, if it was not part of the selection
-    if (mClickedObjectItem && !(modifiers & Qt::AltModifier)) {
-        if (!mapScene()->selectedObjectItems().contains(mClickedObjectItem))
-            mapScene()->setSelectedObjectItems(QSet<MapObjectItem*>() << mClickedObjectItem);
+    if (mClickedObject && !(modifiers & Qt::AltModifier)) {
+        if (!mapDocument()->selectedObjects().contains(mClickedObject))
+            mapDocument()->setSelectedObjects(QList<MapObject*>() << mClickedObject);
     }
 
     saveSelectionState();
@@ -957,7 +955,7 @@ void ObjectSelectionTool::updateMovingItems(const QPointF &pos,
         const QPointF newPixelPos = object.oldItemPosition + diff;
         const QPointF newPos = renderer->screenToPixelCoords(newPixelPos);
 
-        MapObject *mapObject = object.item->mapObject();
+        MapObject *mapObject = object.mapObject;
         mapObject->setPosition(newPos);
     }
 
@@ -977,7 +975,7 @@ void ObjectSelectionTool::finishMoving(const QPointF &pos)
     undoStack->beginMacro(tr("Move %n Object(s)", "", mMovingObjects.size()));
     foreach (const MovingObject &object, mMovingObjects) {
         undoStack->push(new MoveMapObject(mapDocument(),
-                                          object.item->mapObject(),
+                                          object.mapObject,
                                           object.oldPosition));
     }
     undoStack->endMacro();
@@ -1011,7 +1009,7 @@ void ObjectSelectionTool::updateRotatingItems(const QPointF &pos,
         angleDiff = std::floor((angleDiff + snap / 2) / snap) * snap;
 
     foreach (const MovingObject &object, mMovingObjects) {
-        MapObject *mapObject = object.item->mapObject();
+        MapObject *mapObject = object.mapObject;
         const QPointF offset = mapObject->objectGroup()->offset();
 
         const QPointF oldRelPos = object.oldItemPosition + offset - mOrigin;
@@ -1043,7 +1041,7 @@ void ObjectSelectionTool::finishRotating(const QPointF &pos)
     QUndoStack *undoStack = mapDocument()->undoStack();
     undoStack->beginMacro(tr("Rotate %n Object(s)", "", mMovingObjects.size()));
     foreach (const MovingObject &object, mMovingObjects) {
-        MapObject *mapObject = object.item->mapObject();
+        MapObject *mapObject = object.mapObject;
         undoStack->push(new MoveMapObject(mapDocument(), mapObject, object.oldPosition));
         undoStack->push(new RotateMapObject(mapDocument(), mapObject, object.oldRotation));
     }
@@ -1118,7 +1116,7 @@ void ObjectSelectionTool::updateResizingItems(const QPointF &pos,
         scale = 1;
 
     foreach (const MovingObject &object, mMovingObjects) {
-        MapObject *mapObject = object.item->mapObject();
+        MapObject *mapObject = object.mapObject;
         const QPointF offset = mapObject->objectGroup()->offset();
 
         const QPointF oldRelPos = object.oldItemPosition + offset - resizingOrigin;
@@ -1132,7 +1130,7 @@ void ObjectSelectionTool::updateResizingItems(const QPointF &pos,
 
         if (mapObject->polygon().isEmpty() == false) {
             // For polygons, we have to scale in object space.
-            qreal rotation = object.item->rotation() * M_PI / -180;
+            qreal rotation = object.mapObject->rotation() * M_PI / -180;
             const qreal sn = std::sin(rotation);
             const qreal cs = std::cos(rotation);
             
@@ -1163,7 +1161,7 @@ void ObjectSelectionTool::updateResizingSingleItem(const QPointF &resizingOrigin
 {
     const MapRenderer *renderer = mapDocument()->renderer();
     const MovingObject &object = mMovingObjects.first();
-    MapObject *mapObject = object.item->mapObject();
+    MapObject *mapObject = object.mapObject;
 
     /* The resizingOrigin, screenPos and mStart are affected by the ObjectGroup
      * offset. We will un-apply it to these variables since the resize for
@@ -1309,7 +1307,7 @@ void ObjectSelectionTool::finishResizing(const QPointF &pos)
     QUndoStack *undoStack = mapDocument()->undoStack();
     undoStack->beginMacro(tr("Resize %n Object(s)", "", mMovingObjects.size()));
     foreach (const MovingObject &object, mMovingObjects) {
-        MapObject *mapObject = object.item->mapObject();
+        MapObject *mapObject = object.mapObject;
         undoStack->push(new MoveMapObject(mapDocument(), mapObject, object.oldPosition));
         undoStack->push(new ResizeMapObject(mapDocument(), mapObject, object.oldSize));
         
@@ -1334,11 +1332,12 @@ void ObjectSelectionTool::saveSelectionState()
     mMovingObjects.clear();
 
     // Remember the initial state before moving, resizing or rotating
-    foreach (MapObjectItem *item, mapScene()->selectedObjectItems()) {
-        MapObject *mapObject = item->mapObject();
+    MapRenderer *renderer = mapDocument()->renderer();
+
+    foreach (MapObject *mapObject, mapDocument()->selectedObjects()) {
         MovingObject object = {
-            item,
-            item->pos(),
+            mapObject,
+            renderer->pixelToScreenCoords(mapObject->position()),
             mapObject->position(),
             mapObject->size(),
             mapObject->polygon(),
@@ -1354,9 +1353,9 @@ void ObjectSelectionTool::refreshCursor()
 
     switch (mAction) {
     case NoAction: {
-        const bool hasSelection = !mapScene()->selectedObjectItems().isEmpty();
+        const bool hasSelection = !mapDocument()->selectedObjects().isEmpty();
 
-        if ((mHoveredObjectItem || ((mModifiers & Qt::AltModifier) && hasSelection)) &&
+        if ((mHoveredObject || ((mModifiers & Qt::AltModifier) && hasSelection)) &&
                 !(mModifiers & Qt::ShiftModifier)) {
             cursorShape = Qt::SizeAllCursor;
         }
@@ -1399,7 +1398,7 @@ QList<MapObject *> ObjectSelectionTool::changingObjects() const
     changingObjects.reserve(mMovingObjects.size());
 
     foreach (const MovingObject &movingObject, mMovingObjects)
-        changingObjects.append(movingObject.item->mapObject());
+        changingObjects.append(movingObject.mapObject);
 
     return changingObjects;
 }
@@ -34,7 +34,6 @@ namespace Internal {
 
 class RotateHandle;
 class ResizeHandle;
-class MapObjectItem;
 class SelectionRectangle;
 
 class ObjectSelectionTool : public AbstractObjectTool
@@ -113,7 +112,7 @@ private:
 
     struct MovingObject
     {
-        MapObjectItem *item;
+        MapObject *mapObject;
         QPointF oldItemPosition;
 
         QPointF oldPosition;
@@ -127,8 +126,8 @@ private:
     RotateHandle *mRotateHandles[4];
     ResizeHandle *mResizeHandles[8];
     bool mMousePressed;
-    MapObjectItem *mHoveredObjectItem;
-    MapObjectItem *mClickedObjectItem;
+    MapObject *mHoveredObject;
+    MapObject *mClickedObject;
     RotateHandle *mClickedRotateHandle;
     ResizeHandle *mClickedResizeHandle;
 
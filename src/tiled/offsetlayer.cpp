@@ -66,26 +66,62 @@ OffsetLayer::OffsetLayer(MapDocument *mapDocument,
         // Nothing done for the image layer at the moment
         break;
     }
+
+    mMapDocument->undoMemoryManager()->addCommand(this);
 }
 
 OffsetLayer::~OffsetLayer()
 {
+    mMapDocument->undoMemoryManager()->removeCommand(this);
+
     delete mOriginalLayer;
     delete mOffsetLayer;
 }
 
 void OffsetLayer::undo()
 {
+    if (isDiscarded())
+        return;
+
     Q_ASSERT(!mOffsetLayer);
+    mLayerData.uncompress(mOriginalLayer);
     mOffsetLayer = swapLayer(mOriginalLayer);
     mOriginalLayer = nullptr;
+
+    mMapDocument->undoMemoryManager()->commandChanged(this);
 }
 
 void OffsetLayer::redo()
 {
+    if (isDiscarded())
+        return;
+
     Q_ASSERT(!mOriginalLayer);
+    mLayerData.uncompress(mOffsetLayer);
     mOriginalLayer = swapLayer(mOffsetLayer);
     mOffsetLayer = nullptr;
+
+    mMapDocument->undoMemoryManager()->commandChanged(this);
+}
+
+qint64 OffsetLayer::memoryUsage() const
+{
+    const Layer *layer = mOriginalLayer ? mOriginalLayer : mOffsetLayer;
+    return sizeof(OffsetLayer) + mLayerData.memoryUsage(layer);
+}
+
+void OffsetLayer::compress()
+{
+    mLayerData.compress(mOriginalLayer ? mOriginalLayer : mOffsetLayer);
+}
+
+void OffsetLayer::discard()
+{
+    delete mOriginalLayer;
+    delete mOffsetLayer;
+    mOriginalLayer = nullptr;
+    mOffsetLayer = nullptr;
+    mLayerData.clear();
 }
 
 Layer *OffsetLayer::swapLayer(Layer *layer)
@@ -22,6 +22,8 @@
 #ifndef OFFSETLAYER_H
 #define OFFSETLAYER_H
 
+#include "undomemorymanager.h"
+
 #include <QRect>
 #include <QPoint>
 #include <QUndoCommand>
@@ -37,7 +39,7 @@ class MapDocument;
 /**
  * Undo command that offsets a map layer.
  */
-class OffsetLayer : public QUndoCommand
+class OffsetLayer : public QUndoCommand, public MemoryTrackedCommand
 {
 public:
     /**
@@ -56,6 +58,10 @@ public:
     void undo() override;
     void redo() override;
 
+    qint64 memoryUsage() const override;
+    void compress() override;
+    void discard() override;
+
 private:
     Layer *swapLayer(Layer *layer);
 
@@ -63,6 +69,7 @@ private:
     int mIndex;
     Layer *mOriginalLayer;
     Layer *mOffsetLayer;
+    CompressedLayerData mLayerData;
 };
 
 } // namespace Internal
@@ -79,7 +79,7 @@ QRect OffsetMapDialog::affectedBoundingRect() const
         boundingRect = QRect(QPoint(0, 0), mMapDocument->map()->size());
         break;
     case CurrentSelectionArea: {
-        const QRegion &selection = mMapDocument->selectedArea();
+        const SelectionMask &selection = mMapDocument->selectedArea();
 
         Q_ASSERT_X(!selection.isEmpty(),
                    "OffsetMapDialog::affectedBoundingRect()",
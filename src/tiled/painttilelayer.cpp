@@ -39,15 +39,11 @@ PaintTileLayer::PaintTileLayer(MapDocument *mapDocument,
     : QUndoCommand(parent)
     , mMapDocument(mapDocument)
     , mTarget(target)
-    , mSource(static_cast<TileLayer*>(source->clone()))
-    , mX(x)
-    , mY(y)
     , mPaintedRegion(source->region().translated(QPoint(x, y) - source->position()))
     , mMergeable(false)
 {
-    mErased = mTarget->copy(mX - mTarget->x(),
-                            mY - mTarget->y(),
-                            mSource->width(), mSource->height());
+    mDelta.record(mTarget, x, y, source, mPaintedRegion);
+    mMapDocument->undoMemoryManager()->addCommand(this);
     setText(QCoreApplication::translate("Undo Commands", "Paint"));
 }
 
@@ -61,28 +57,25 @@ PaintTileLayer::PaintTileLayer(MapDocument *mapDocument,
     : QUndoCommand(parent)
     , mMapDocument(mapDocument)
     , mTarget(target)
-    , mSource(static_cast<TileLayer*>(source->clone()))
-    , mX(x)
-    , mY(y)
     , mPaintedRegion(paintRegion)
     , mMergeable(false)
 {
-    mErased = mTarget->copy(mX - mTarget->x(),
-                            mY - mTarget->y(),
-                            mSource->width(), mSource->height());
+    mDelta.record(mTarget, x, y, source, mPaintedRegion);
+    mMapDocument->undoMemoryManager()->addCommand(this);
     setText(QCoreApplication::translate("Undo Commands", "Paint"));
 }
 
 PaintTileLayer::~PaintTileLayer()
 {
-    delete mSource;
-    delete mErased;
+    mMapDocument->undoMemoryManager()->removeCommand(this);
 }
 
 void PaintTileLayer::undo()
 {
+    uncompress();
+
     TilePainter painter(mMapDocument, mTarget);
-    painter.setCells(mX, mY, mErased, mPaintedRegion);
+    painter.applyDelta(mDelta, TileLayerDelta::Undo, mPaintedRegion);
 
     QUndoCommand::undo(); // undo child commands
 }
@@ -91,8 +84,10 @@ void PaintTileLayer::redo()
 {
     QUndoCommand::redo(); // redo child commands
 
+    uncompress();
+
     TilePainter painter(mMapDocument, mTarget);
-    painter.setCells(mX, mY, mSource, mPaintedRegion);
+    painter.applyDelta(mDelta, TileLayerDelta::Redo, mPaintedRegion);
 }
 
 bool PaintTileLayer::mergeWith(const QUndoCommand *other)
@@ -100,36 +95,42 @@ bool PaintTileLayer::mergeWith(const QUndoCommand *other)
     const PaintTileLayer *o = static_cast<const PaintTileLayer*>(other);
     if (!(mMapDocument == o->mMapDocument &&
           mTarget == o->mTarget &&
-          o->mMergeable))
+          o->mMergeable &&
+          !isDiscarded()))
         return false;
 
-    const QRegion newRegion = o->mPaintedRegion.subtracted(mPaintedRegion);
-    const QRegion combinedRegion = mPaintedRegion.united(o->mPaintedRegion);
-    const QRect bounds = QRect(mX, mY, mSource->width(), mSource->height());
-    const QRect combinedBounds = combinedRegion.boundingRect();
-
-    // Resize the erased tiles and source layers when necessary
-    if (bounds != combinedBounds) {
-        const QPoint shift = bounds.topLeft() - combinedBounds.topLeft();
-        mErased->resize(combinedBounds.size(), shift);
-        mSource->resize(combinedBounds.size(), shift);
-    }
-
-    mX = combinedBounds.left();
-    mY = combinedBounds.top();
-    mPaintedRegion = combinedRegion;
-
-    // Copy the painted tiles from the other command over
-    const QPoint pos = QPoint(o->mX, o->mY) - combinedBounds.topLeft();
-    mSource->merge(pos, o->mSource);
-
-    // Copy the newly erased tiles from the other command over
-    foreach (const QRect &rect, newRegion.rects())
-        for (int y = rect.top(); y <= rect.bottom(); ++y)
-            for (int x = rect.left(); x <= rect.right(); ++x)
-                mErased->setCell(x - mX,
-                                 y - mY,
-                                 o->mErased->cellAt(x - o->mX, y - o->mY));
+    uncompress();
 
+    mPaintedRegion |= o->mPaintedRegion;
+    mDelta.append(o->mDelta);
+
+    mMapDocument->undoMemoryManager()->commandChanged(this);
     return true;
 }
+
+qint64 PaintTileLayer::memoryUsage() const
+{
+    return sizeof(PaintTileLayer)
+            + mDelta.memoryUsage()
+            + qint64(mPaintedRegion.rectCount()) * sizeof(QRect);
+}
+
+void PaintTileLayer::compress()
+{
+    mDelta.compress();
+}
+
+void PaintTileLayer::discard()
+{
+    mDelta.clear();
+    mPaintedRegion = QRegion();
+}
+
+void PaintTileLayer::uncompress()
+{
+    if (!mDelta.isCompressed())
+        return;
+
+    mDelta.uncompress();
+    mMapDocument->undoMemoryManager()->commandChanged(this);
+}
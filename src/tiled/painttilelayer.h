@@ -21,7 +21,9 @@
 #ifndef PAINTTILELAYER_H
 #define PAINTTILELAYER_H
 
+#include "tilelayerdelta.h"
 #include "undocommands.h"
+#include "undomemorymanager.h"
 
 #include <QRegion>
 #include <QUndoCommand>
@@ -36,8 +38,11 @@ class MapDocument;
 
 /**
  * A command that paints one tile layer on top of another tile layer.
+ *
+ * Only the cells that are actually changed are remembered, so that long
+ * brush strokes don't need to keep copies of large parts of the layer.
  */
-class PaintTileLayer : public QUndoCommand
+class PaintTileLayer : public QUndoCommand, public MemoryTrackedCommand
 {
 public:
     /**
@@ -85,12 +90,16 @@ public:
     int id() const override { return Cmd_PaintTileLayer; }
     bool mergeWith(const QUndoCommand *other) override;
 
+    qint64 memoryUsage() const override;
+    void compress() override;
+    void discard() override;
+
 private:
+    void uncompress();
+
     MapDocument *mMapDocument;
     TileLayer *mTarget;
-    TileLayer *mSource;
-    TileLayer *mErased;
-    int mX, mY;
+    TileLayerDelta mDelta;
     QRegion mPaintedRegion;
     bool mMergeable;
 };
@@ -62,6 +62,7 @@ Preferences::Preferences()
     mReloadTilesetsOnChange = boolValue("ReloadTilesets", true);
     mStampsDirectory = stringValue("StampsDirectory");
     mObjectTypesFile = stringValue("ObjectTypesFile");
+    mUndoMemoryLimit = intValue("UndoMemoryLimit", 1024);
     mSettings->endGroup();
 
     // Retrieve interface settings
@@ -78,6 +79,7 @@ Preferences::Preferences()
     mShowTilesetGrid = boolValue("ShowTilesetGrid", true);
     mLanguage = stringValue("Language");
     mUseOpenGL = boolValue("OpenGL");
+    mThreadedRendering = boolValue("ThreadedRendering");
     mObjectLabelVisibility = static_cast<ObjectLabelVisiblity>
             (intValue("ObjectLabelVisibility", AllObjectLabels));
     mSettings->endGroup();
@@ -352,6 +354,30 @@ void Preferences::setUseOpenGL(bool useOpenGL)
     emit useOpenGLChanged(mUseOpenGL);
 }
 
+void Preferences::setThreadedRendering(bool threadedRendering)
+{
+    if (mThreadedRendering == threadedRendering)
+        return;
+
+    mThreadedRendering = threadedRendering;
+    mSettings->setValue(QLatin1String("Interface/ThreadedRendering"),
+                        mThreadedRendering);
+
+    emit threadedRenderingChanged(mThreadedRendering);
+}
+
+void Preferences::setUndoMemoryLimit(int megabytes)
+{
+    if (mUndoMemoryLimit == megabytes)
+        return;
+
+    mUndoMemoryLimit = megabytes;
+    mSettings->setValue(QLatin1String("Storage/UndoMemoryLimit"),
+                        mUndoMemoryLimit);
+
+    emit undoMemoryLimitChanged(mUndoMemoryLimit);
+}
+
 void Preferences::setObjectTypes(const ObjectTypes &objectTypes)
 {
     mObjectTypes = objectTypes;
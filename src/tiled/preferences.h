@@ -84,6 +84,15 @@ public:
     bool useOpenGL() const { return mUseOpenGL; }
     void setUseOpenGL(bool useOpenGL);
 
+    bool threadedRendering() const { return mThreadedRendering; }
+    void setThreadedRendering(bool threadedRendering);
+
+    /**
+     * The memory limit of the undo history of each map in megabytes, or 0
+     * when there is no limit.
+     */
+    int undoMemoryLimit() const { return mUndoMemoryLimit; }
+
     const ObjectTypes &objectTypes() const { return mObjectTypes; }
     void setObjectTypes(const ObjectTypes &objectTypes);
 
@@ -139,6 +148,7 @@ public slots:
     void setAutomappingDrawing(bool enabled);
     void setOpenLastFilesOnStartup(bool load);
     void setPluginEnabled(const QString &fileName, bool enabled);
+    void setUndoMemoryLimit(int megabytes);
 
 signals:
     void showGridChanged(bool showGrid);
@@ -154,6 +164,8 @@ signals:
     void objectLabelVisibilityChanged(ObjectLabelVisiblity);
 
     void useOpenGLChanged(bool useOpenGL);
+    void threadedRenderingChanged(bool threadedRendering);
+    void undoMemoryLimitChanged(int megabytes);
 
     void objectTypesChanged();
 
@@ -194,6 +206,8 @@ private:
     QString mLanguage;
     bool mReloadTilesetsOnChange;
     bool mUseOpenGL;
+    bool mThreadedRendering;
+    int mUndoMemoryLimit;
     ObjectTypes mObjectTypes;
 
     bool mAutoMapDrawing;
@@ -80,6 +80,8 @@ PreferencesDialog::PreferencesDialog(QWidget *parent)
             preferences, &Preferences::setReloadTilesetsOnChanged);
     connect(mUi->openLastFiles, &QCheckBox::toggled,
             preferences, &Preferences::setOpenLastFilesOnStartup);
+    connect(mUi->undoMemoryLimit, SIGNAL(valueChanged(int)),
+            preferences, SLOT(setUndoMemoryLimit(int)));
 
     connect(mUi->languageCombo, SIGNAL(currentIndexChanged(int)),
             SLOT(languageSelected(int)));
@@ -91,6 +93,8 @@ PreferencesDialog::PreferencesDialog(QWidget *parent)
             preferences, SLOT(setObjectLineWidth(qreal)));
     connect(mUi->openGL, &QCheckBox::toggled,
             preferences, &Preferences::setUseOpenGL);
+    connect(mUi->threadedRendering, &QCheckBox::toggled,
+            preferences, &Preferences::setThreadedRendering);
 
     connect(mUi->autoUpdateCheckBox, &QPushButton::toggled,
             this, &PreferencesDialog::autoUpdateToggled);
@@ -133,8 +137,10 @@ void PreferencesDialog::fromPreferences()
     mUi->reloadTilesetImages->setChecked(prefs->reloadTilesetsOnChange());
     mUi->enableDtd->setChecked(prefs->dtdEnabled());
     mUi->openLastFiles->setChecked(prefs->openLastFilesOnStartup());
+    mUi->undoMemoryLimit->setValue(prefs->undoMemoryLimit());
     if (mUi->openGL->isEnabled())
         mUi->openGL->setChecked(prefs->useOpenGL());
+    mUi->threadedRendering->setChecked(prefs->threadedRendering());
 
     // Not found (-1) ends up at index 0, system default
     int languageIndex = mUi->languageCombo->findData(prefs->language());
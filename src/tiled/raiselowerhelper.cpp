@@ -53,11 +53,11 @@ void RaiseLowerHelper::raise()
         if (it.last() == mRelatedObjects.size() - 1)
             continue;
 
-        MapObjectItem *movingItem = mRelatedObjects.at(it.last());
-        MapObjectItem *targetItem = mRelatedObjects.at(it.last() + 1);
+        MapObject *movingObject = mRelatedObjects.at(it.last());
+        MapObject *targetObject = mRelatedObjects.at(it.last() + 1);
 
-        const int from = static_cast<int>(movingItem->zValue());
-        const int to = static_cast<int>(targetItem->zValue()) + 1;
+        const int from = objectIndex(movingObject);
+        const int to = objectIndex(targetObject) + 1;
 
         commands.append(new ChangeMapObjectsOrder(mMapDocument, mObjectGroup,
                                                   from, to, 1));
@@ -82,11 +82,11 @@ void RaiseLowerHelper::lower()
         if (it.first() == 0)
             continue;
 
-        MapObjectItem *movingItem = mRelatedObjects.at(it.first());
-        MapObjectItem *targetItem = mRelatedObjects.at(it.first() - 1);
+        MapObject *movingObject = mRelatedObjects.at(it.first());
+        MapObject *targetObject = mRelatedObjects.at(it.first() - 1);
 
-        const int from = static_cast<int>(movingItem->zValue());
-        const int to = static_cast<int>(targetItem->zValue());
+        const int from = objectIndex(movingObject);
+        const int to = objectIndex(targetObject);
 
         commands.append(new ChangeMapObjectsOrder(mMapDocument, mObjectGroup,
                                                   from, to, 1));
@@ -98,16 +98,16 @@ void RaiseLowerHelper::lower()
 
 void RaiseLowerHelper::raiseToTop()
 {
-    const QSet<MapObjectItem*> &selectedItems = mMapScene->selectedObjectItems();
-    ObjectGroup *objectGroup = sameObjectGroup(selectedItems);
+    const QList<MapObject*> &selectedObjects = mMapDocument->selectedObjects();
+    ObjectGroup *objectGroup = sameObjectGroup(selectedObjects);
     if (!objectGroup)
         return;
     if (objectGroup->drawOrder() != ObjectGroup::IndexOrder)
         return;
 
     RangeSet<int> ranges;
-    foreach (MapObjectItem *item, selectedItems)
-        ranges.insert(static_cast<int>(item->zValue()));
+    foreach (MapObject *object, selectedObjects)
+        ranges.insert(objectGroup->objects().indexOf(object));
 
     // Iterate backwards over the ranges in order to keep the indexes valid
     RangeSet<int>::Range firstRange = ranges.begin();
@@ -141,16 +141,16 @@ void RaiseLowerHelper::raiseToTop()
 
 void RaiseLowerHelper::lowerToBottom()
 {
-    const QSet<MapObjectItem*> &selectedItems = mMapScene->selectedObjectItems();
-    ObjectGroup *objectGroup = sameObjectGroup(selectedItems);
+    const QList<MapObject*> &selectedObjects = mMapDocument->selectedObjects();
+    ObjectGroup *objectGroup = sameObjectGroup(selectedObjects);
     if (!objectGroup)
         return;
     if (objectGroup->drawOrder() != ObjectGroup::IndexOrder)
         return;
 
     RangeSet<int> ranges;
-    foreach (MapObjectItem *item, selectedItems)
-        ranges.insert(static_cast<int>(item->zValue()));
+    foreach (MapObject *object, selectedObjects)
+        ranges.insert(objectGroup->objects().indexOf(object));
 
     RangeSet<int>::Range it = ranges.begin();
     RangeSet<int>::Range it_end = ranges.end();
@@ -176,16 +176,16 @@ void RaiseLowerHelper::lowerToBottom()
          QCoreApplication::translate("Undo Commands", "Lower Object To Bottom"));
 }
 
-ObjectGroup *RaiseLowerHelper::sameObjectGroup(const QSet<MapObjectItem *> &items)
+ObjectGroup *RaiseLowerHelper::sameObjectGroup(const QList<MapObject *> &objects)
 {
-    if (items.isEmpty())
+    if (objects.isEmpty())
         return nullptr;
 
     // All selected objects need to be in the same group
-    ObjectGroup *group = (*items.begin())->mapObject()->objectGroup();
+    ObjectGroup *group = objects.first()->objectGroup();
 
-    foreach (const MapObjectItem *item, items)
-        if (item->mapObject()->objectGroup() != group)
+    foreach (const MapObject *object, objects)
+        if (object->objectGroup() != group)
             return nullptr;
 
     return group;
@@ -222,21 +222,15 @@ bool RaiseLowerHelper::initContext()
         shape |= item->mapToScene(item->shape());
     }
 
-    // The list of related items are all items from the same object group
-    // that share space with the selected items.
-    QList<QGraphicsItem*> items = mMapScene->items(shape,
-                                                   Qt::IntersectsItemShape,
-                                                   Qt::AscendingOrder);
-
-    foreach (QGraphicsItem *item, items) {
-        if (MapObjectItem *mapObjectItem = dynamic_cast<MapObjectItem*>(item)) {
-            if (mapObjectItem->mapObject()->objectGroup() == mObjectGroup)
-                mRelatedObjects.append(mapObjectItem);
-        }
+    // The list of related objects are all objects from the same object group
+    // that share space with the selected objects.
+    foreach (MapObject *object, mMapScene->objectsIn(shape)) {
+        if (object->objectGroup() == mObjectGroup)
+            mRelatedObjects.append(object);
     }
 
-    foreach (MapObjectItem *item, selectedItems) {
-        int index = mRelatedObjects.indexOf(item);
+    foreach (const MapObjectItem *item, selectedItems) {
+        int index = mRelatedObjects.indexOf(item->mapObject());
         Q_ASSERT(index != -1);
         mSelectionRanges.insert(index);
     }
@@ -244,6 +238,11 @@ bool RaiseLowerHelper::initContext()
     return true;
 }
 
+int RaiseLowerHelper::objectIndex(MapObject *object) const
+{
+    return mObjectGroup->objects().indexOf(object);
+}
+
 void RaiseLowerHelper::push(const QList<QUndoCommand*> &commands,
                             const QString &text)
 {
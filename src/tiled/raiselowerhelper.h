@@ -30,12 +30,12 @@ class QUndoCommand;
 
 namespace Tiled {
 
+class MapObject;
 class ObjectGroup;
 
 namespace Internal {
 
 class MapDocument;
-class MapObjectItem;
 class MapScene;
 
 /**
@@ -59,10 +59,11 @@ public:
     void raiseToTop();
     void lowerToBottom();
 
-    static ObjectGroup *sameObjectGroup(const QSet<MapObjectItem*> &items);
+    static ObjectGroup *sameObjectGroup(const QList<MapObject*> &objects);
 
 private:
     bool initContext();
+    int objectIndex(MapObject *object) const;
     void push(const QList<QUndoCommand *> &commands, const QString &text);
 
     MapDocument *mMapDocument;
@@ -70,7 +71,7 @@ private:
 
     // Context
     ObjectGroup *mObjectGroup;
-    QList<MapObjectItem*> mRelatedObjects;
+    QList<MapObject*> mRelatedObjects;
     RangeSet<int> mSelectionRanges;
 };
 
@@ -0,0 +1,46 @@
+/*
+ * randompicker.cpp
+ * Copyright 2016, Tiled contributors
+ *
+ * This file is part of Tiled.
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation; either version 2 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "randompicker.h"
+
+#include <QThreadStorage>
+
+namespace Tiled {
+namespace Internal {
+
+static QThreadStorage<RandomEngine*> engines;
+
+RandomEngine &randomEngine()
+{
+    if (!engines.hasLocalData()) {
+        std::random_device device;
+        engines.setLocalData(new RandomEngine(device()));
+    }
+
+    return *engines.localData();
+}
+
+void seedRandomEngine(quint32 seed)
+{
+    randomEngine().seed(seed);
+}
+
+} // namespace Internal
+} // namespace Tiled
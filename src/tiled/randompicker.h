@@ -1,6 +1,7 @@
 /*
  * randompicker.h
  * Copyright 2015, Thorbjørn Lindeijer <thorbjorn@lindeijer.nl>
+ * Copyright 2016, Tiled contributors
  *
  * This file is part of Tiled.
  *
@@ -21,14 +22,35 @@
 #ifndef TILED_INTERNAL_RANDOMPICKER_H
 #define TILED_INTERNAL_RANDOMPICKER_H
 
-#include <QMap>
+#include <QVector>
+
+#include <random>
 
 namespace Tiled {
 namespace Internal {
 
+typedef std::mt19937 RandomEngine;
+
+/**
+ * Returns the random number engine of the calling thread. Each thread has
+ * its own engine, so picking random values doesn't need any locking.
+ */
+RandomEngine &randomEngine();
+
+/**
+ * Seeds the random number engine of the calling thread, which makes the
+ * following random picks on this thread reproducible.
+ */
+void seedRandomEngine(quint32 seed);
+
 /**
  * A class that helps pick random things that each have a probability
  * assigned.
+ *
+ * Picking uses the alias method, which takes constant time regardless of the
+ * number of values. The alias table needs to be built by calling build()
+ * after adding values. Since picking doesn't change the picker, it may then
+ * be used from several threads, as long as no values are added.
  */
 template<typename T>
 class RandomPicker
@@ -36,44 +58,121 @@ class RandomPicker
 public:
     RandomPicker()
         : mSum(0.0)
+        , mDirty(false)
     {}
 
     void add(const T &value, qreal probability = 1.0)
     {
         if (probability > 0) {
             mSum += probability;
-            mThresholds.insert(mSum, value);
+            mValues.append(value);
+            mProbabilities.append(probability);
+            mDirty = true;
         }
     }
 
     bool isEmpty() const
     {
-        return mThresholds.isEmpty();
+        return mValues.isEmpty();
     }
 
     const T &pick() const
+    {
+        return pick(randomEngine());
+    }
+
+    const T &pick(RandomEngine &engine) const
     {
         Q_ASSERT(!isEmpty());
+        Q_ASSERT(!mDirty);
 
-        const qreal random = ((qreal)rand() / RAND_MAX) * mSum;
-        const auto it = mThresholds.lowerBound(random);
-        if (it != mThresholds.end())
-            return it.value();
-        else
-            return (mThresholds.end() - 1).value();
+        std::uniform_int_distribution<int> column(0, mValues.size() - 1);
+        std::uniform_real_distribution<qreal> coin(0.0, 1.0);
+
+        const int index = column(engine);
+        if (coin(engine) < mThresholds.at(index))
+            return mValues.at(index);
+        return mValues.at(mAliases.at(index));
     }
 
     void clear()
     {
         mSum = 0.0;
+        mValues.clear();
+        mProbabilities.clear();
         mThresholds.clear();
+        mAliases.clear();
+        mDirty = false;
     }
 
+    void build();
+
 private:
     qreal mSum;
-    QMap<qreal, T> mThresholds;
+    QVector<T> mValues;
+    QVector<qreal> mProbabilities;
+    QVector<qreal> mThresholds;
+    QVector<int> mAliases;
+    bool mDirty;
 };
 
+/**
+ * Builds the alias table using Vose's method. Each column gets a threshold
+ * below which its own value is picked, and an alias that is picked
+ * otherwise.
+ *
+ * Needs to be called after adding values and before picking.
+ */
+template<typename T>
+void RandomPicker<T>::build()
+{
+    if (!mDirty)
+        return;
+
+    const int count = mValues.size();
+
+    mThresholds.resize(count);
+    mAliases.resize(count);
+
+    QVector<qreal> scaled(count);
+    QVector<int> small;
+    QVector<int> large;
+
+    for (int i = 0; i < count; ++i) {
+        scaled[i] = mProbabilities.at(i) * count / mSum;
+        if (scaled.at(i) < 1.0)
+            small.append(i);
+        else
+            large.append(i);
+    }
+
+    while (!small.isEmpty() && !large.isEmpty()) {
+        const int less = small.takeLast();
+        const int more = large.takeLast();
+
+        mThresholds[less] = scaled.at(less);
+        mAliases[less] = more;
+
+        scaled[more] = (scaled.at(more) + scaled.at(less)) - 1.0;
+        if (scaled.at(more) < 1.0)
+            small.append(more);
+        else
+            large.append(more);
+    }
+
+    // The remaining columns are full, apart from rounding errors
+    for (int i : large) {
+        mThresholds[i] = 1.0;
+        mAliases[i] = i;
+    }
+    for (int i : small) {
+        mThresholds[i] = 1.0;
+        mAliases[i] = i;
+    }
+
+    mDirty = false;
+}
+
 } // namespace Internal
 } // namespace Tiled
 
@@ -45,26 +45,62 @@ ResizeTileLayer::ResizeTileLayer(MapDocument *mapDocument,
     // Create the resized layer (once)
     mResizedLayer = static_cast<TileLayer*>(layer->clone());
     mResizedLayer->resize(size, offset);
+
+    mMapDocument->undoMemoryManager()->addCommand(this);
 }
 
 ResizeTileLayer::~ResizeTileLayer()
 {
+    mMapDocument->undoMemoryManager()->removeCommand(this);
+
     delete mOriginalLayer;
     delete mResizedLayer;
 }
 
 void ResizeTileLayer::undo()
 {
+    if (isDiscarded())
+        return;
+
     Q_ASSERT(!mResizedLayer);
+    mLayerData.uncompress(mOriginalLayer);
     mResizedLayer = static_cast<TileLayer*>(swapLayer(mOriginalLayer));
     mOriginalLayer = nullptr;
+
+    mMapDocument->undoMemoryManager()->commandChanged(this);
 }
 
 void ResizeTileLayer::redo()
 {
+    if (isDiscarded())
+        return;
+
     Q_ASSERT(!mOriginalLayer);
+    mLayerData.uncompress(mResizedLayer);
     mOriginalLayer = static_cast<TileLayer*>(swapLayer(mResizedLayer));
     mResizedLayer = nullptr;
+
+    mMapDocument->undoMemoryManager()->commandChanged(this);
+}
+
+qint64 ResizeTileLayer::memoryUsage() const
+{
+    const Layer *layer = mOriginalLayer ? mOriginalLayer : mResizedLayer;
+    return sizeof(ResizeTileLayer) + mLayerData.memoryUsage(layer);
+}
+
+void ResizeTileLayer::compress()
+{
+    mLayerData.compress(mOriginalLayer ? mOriginalLayer : mResizedLayer);
+}
+
+void ResizeTileLayer::discard()
+{
+    delete mOriginalLayer;
+    delete mResizedLayer;
+    mOriginalLayer = nullptr;
+    mResizedLayer = nullptr;
+    mLayerData.clear();
 }
 
 Layer *ResizeTileLayer::swapLayer(Layer *layer)
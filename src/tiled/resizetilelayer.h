@@ -21,6 +21,8 @@
 #ifndef RESIZELAYER_H
 #define RESIZELAYER_H
 
+#include "undomemorymanager.h"
+
 #include <QPoint>
 #include <QSize>
 #include <QUndoCommand>
@@ -37,7 +39,7 @@ class MapDocument;
 /**
  * Undo command that resizes a map layer.
  */
-class ResizeTileLayer : public QUndoCommand
+class ResizeTileLayer : public QUndoCommand, public MemoryTrackedCommand
 {
 public:
     /**
@@ -54,6 +56,10 @@ public:
     void undo() override;
     void redo() override;
 
+    qint64 memoryUsage() const override;
+    void compress() override;
+    void discard() override;
+
 private:
     Layer *swapLayer(Layer *layer);
 
@@ -61,6 +67,7 @@ private:
     int mIndex;
     TileLayer *mOriginalLayer;
     TileLayer *mResizedLayer;
+    CompressedLayerData mLayerData;
 };
 
 } // namespace Internal
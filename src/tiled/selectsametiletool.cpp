@@ -45,13 +45,13 @@ void SelectSameTileTool::tilePositionChanged(const QPoint &tilePos)
     if (!tileLayer)
         return;
 
-    QRegion resultRegion;
+    SelectionMask resultRegion;
     if (tileLayer->contains(tilePos)) {
         const Cell &matchCell = tileLayer->cellAt(tilePos);
-        resultRegion = tileLayer->region([&] (const Cell &cell) { return cell == matchCell; });
+        resultRegion = tileLayer->cellsMatching(matchCell);
     }
     mSelectedRegion = resultRegion;
-    brushItem()->setTileRegion(mSelectedRegion);
+    brushItem()->setTileRegion(mSelectedRegion.toRegion());
 }
 
 void SelectSameTileTool::mousePressed(QGraphicsSceneMouseEvent *event)
@@ -63,10 +63,10 @@ void SelectSameTileTool::mousePressed(QGraphicsSceneMouseEvent *event)
 
     MapDocument *document = mapDocument();
 
-    QRegion selection = document->selectedArea();
+    SelectionMask selection = document->selectedArea();
 
     if (modifiers == Qt::ShiftModifier)
-        selection += mSelectedRegion;
+        selection |= mSelectedRegion;
     else if (modifiers == Qt::ControlModifier)
         selection -= mSelectedRegion;
     else if (modifiers == (Qt::ControlModifier | Qt::ShiftModifier))
@@ -25,6 +25,7 @@
 
 #include "abstracttiletool.h"
 
+#include "selectionmask.h"
 #include "tilelayer.h"
 
 namespace Tiled {
@@ -52,7 +53,7 @@ protected:
 
 private:
 
-    QRegion mSelectedRegion;
+    SelectionMask mSelectedRegion;
 };
 
 } // namespace Internal
@@ -205,6 +205,8 @@ void StampBrush::updateRandomList()
             }
         }
     }
+
+    mRandomCellPicker.build();
 }
 
 void StampBrush::setStamp(const TileStamp &stamp)
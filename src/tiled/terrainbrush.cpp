@@ -28,14 +28,16 @@
 #include "mapscene.h"
 #include "painttilelayer.h"
 #include "randompicker.h"
+#include "regionbuilder.h"
 #include "tilelayer.h"
 #include "tileset.h"
 #include "tile.h"
 #include "terrain.h"
+#include "terrainmatchindex.h"
 
 #include <math.h>
+#include <QHash>
 #include <QVector>
-#include <climits>
 
 using namespace Tiled;
 using namespace Tiled::Internal;
@@ -237,38 +239,14 @@ static Tile *findBestTile(const Tileset &tileset, unsigned terrain, unsigned con
     // we should have hooked 0xFFFFFFFF terrains outside this function
     Q_ASSERT(terrain != 0xFFFFFFFF);
 
-    RandomPicker<Tile*> matches;
-    int penalty = INT_MAX;
-
-    // TODO: this is a slow linear search, perhaps we could use a better find algorithm...
-    for (Tile *t : tileset.tiles()) {
-        if ((t->terrain() & considerationMask) != (terrain & considerationMask))
-            continue;
-
-        // calculate the tile transition penalty based on shortest distance to target terrain type
-        int tr = tileset.terrainTransitionPenalty(t->terrain() >> 24, terrain >> 24);
-        int tl = tileset.terrainTransitionPenalty((t->terrain() >> 16) & 0xFF, (terrain >> 16) & 0xFF);
-        int br = tileset.terrainTransitionPenalty((t->terrain() >> 8) & 0xFF, (terrain >> 8) & 0xFF);
-        int bl = tileset.terrainTransitionPenalty(t->terrain() & 0xFF, terrain & 0xFF);
-
-        // if there is no path to the destination terrain, this isn't a useful transition
-        if (tr < 0 || tl < 0 || br < 0 || bl < 0)
-            continue;
-
-        // add tile to the candidate list
-        int transitionPenalty = tr + tl + br + bl;
-        if (transitionPenalty <= penalty) {
-            if (transitionPenalty < penalty)
-                matches.clear();
-            penalty = transitionPenalty;
-
-            matches.add(t, t->probability());
-        }
-    }
+    const TerrainMatchIndex::Matches &matches =
+            tileset.terrainMatchIndex().matches(terrain, considerationMask);
 
     // choose a candidate at random, with consideration for probability
-    if (!matches.isEmpty())
-        return matches.pick();
+    if (!matches.isEmpty()) {
+        std::uniform_real_distribution<qreal> random(0.0, 1.0);
+        return matches.pick(random(randomEngine()));
+    }
 
     // TODO: conveniently, the null tile doesn't currently work, but when it does, we need to signal a failure to find any matches some other way
     return nullptr;
@@ -312,7 +290,6 @@ void TerrainBrush::updateBrush(QPoint cursorPos, const QVector<QPoint> *list)
 
     int layerWidth = currentLayer->width();
     int layerHeight = currentLayer->height();
-    int numTiles = layerWidth * layerHeight;
     int paintCorner = 0;
 
     // if we are in vertex paint mode, the bottom right corner on the map will appear as an invalid tile offset...
@@ -340,40 +317,37 @@ void TerrainBrush::updateBrush(QPoint cursorPos, const QVector<QPoint> *list)
         terrainId = mTerrain->id();
     }
 
-    // allocate a buffer to build the terrain tilemap (TODO: this could be retained per layer to save regular allocation)
-    Tile **newTerrain = new Tile*[numTiles];
+    // the tiles chosen for each considered position, by index in the layer
+    // only the affected area is stored, so the work doesn't depend on the layer size
+    QHash<int, Tile*> newTerrain;
+    auto checked = [&] (int index) { return newTerrain.contains(index); };
 
-    // allocate a buffer of flags for each tile that may be considered (TODO: this could be retained per layer to save regular allocation)
-    char *checked = new char[numTiles];
-    memset(checked, 0, numTiles);
-
-    // create a consideration list, and push the start points
-    QList<QPoint> transitionList;
+    // create a consideration queue, and push the start points
+    // processed points are not removed, but skipped by advancing the head index
+    QVector<QPoint> transitionQueue;
     int initialTiles = 0;
 
     if (list) {
         // if we were supplied a list of start points
-        foreach (const QPoint &p, *list) {
-            transitionList.append(p);
-            ++initialTiles;
-        }
+        transitionQueue = *list;
+        initialTiles = list->size();
     } else {
-        transitionList.append(cursorPos);
+        transitionQueue.append(cursorPos);
         initialTiles = 1;
     }
 
     QRect brushRect(cursorPos, cursorPos);
 
     // produce terrain with transitions using a simple, relative naive approach (considers each tile once, and doesn't allow re-consideration if selection was bad)
-    while (!transitionList.isEmpty()) {
-        // get the next point in the consideration list
-        QPoint p = transitionList.takeFirst();
+    for (int head = 0; head < transitionQueue.size(); ++head) {
+        // get the next point in the consideration queue
+        const QPoint p = transitionQueue.at(head);
         int x = p.x(), y = p.y();
         int i = y*layerWidth + x;
 
         // if we have already considered this point, skip to the next
         // TODO: we might want to allow re-consideration if prior tiles... but not for now, this would risk infinite loops
-        if (checked[i])
+        if (checked(i))
             continue;
 
         const Tile *tile = currentLayer->cellAt(p).tile;
@@ -429,20 +403,20 @@ void TerrainBrush::updateBrush(QPoint cursorPos, const QVector<QPoint> *list)
             mask = 0;
 
             // depending which connections have been set, we update the preferred terrain of the tile accordingly
-            if (y > 0 && checked[i - layerWidth]) {
-                preferredTerrain = (::terrain(newTerrain[i - layerWidth]) << 16) | (preferredTerrain & 0x0000FFFF);
+            if (y > 0 && checked(i - layerWidth)) {
+                preferredTerrain = (::terrain(newTerrain.value(i - layerWidth)) << 16) | (preferredTerrain & 0x0000FFFF);
                 mask |= 0xFFFF0000;
             }
-            if (y < layerHeight - 1 && checked[i + layerWidth]) {
-                preferredTerrain = (::terrain(newTerrain[i + layerWidth]) >> 16) | (preferredTerrain & 0xFFFF0000);
+            if (y < layerHeight - 1 && checked(i + layerWidth)) {
+                preferredTerrain = (::terrain(newTerrain.value(i + layerWidth)) >> 16) | (preferredTerrain & 0xFFFF0000);
                 mask |= 0x0000FFFF;
             }
-            if (x > 0 && checked[i - 1]) {
-                preferredTerrain = ((::terrain(newTerrain[i - 1]) << 8) & 0xFF00FF00) | (preferredTerrain & 0x00FF00FF);
+            if (x > 0 && checked(i - 1)) {
+                preferredTerrain = ((::terrain(newTerrain.value(i - 1)) << 8) & 0xFF00FF00) | (preferredTerrain & 0x00FF00FF);
                 mask |= 0xFF00FF00;
             }
-            if (x < layerWidth - 1 && checked[i + 1]) {
-                preferredTerrain = ((::terrain(newTerrain[i + 1]) >> 8) & 0x00FF00FF) | (preferredTerrain & 0xFF00FF00);
+            if (x < layerWidth - 1 && checked(i + 1)) {
+                preferredTerrain = ((::terrain(newTerrain.value(i + 1)) >> 8) & 0x00FF00FF) | (preferredTerrain & 0xFF00FF00);
                 mask |= 0x00FF00FF;
             }
         }
@@ -457,37 +431,36 @@ void TerrainBrush::updateBrush(QPoint cursorPos, const QVector<QPoint> *list)
         }
 
         // add tile to the brush
-        newTerrain[i] = paste;
-        checked[i] = true;
+        newTerrain.insert(i, paste);
 
         // expand the brush rect to fit the edit set
         brushRect |= QRect(p, p);
 
         // consider surrounding tiles if terrain constraints were not satisfied
-        if (y > 0 && !checked[i - layerWidth]) {
+        if (y > 0 && !checked(i - layerWidth)) {
             const Tile *above = currentLayer->cellAt(x, y - 1).tile;
             if (topEdge(paste) != bottomEdge(above))
-                transitionList.append(QPoint(x, y - 1));
+                transitionQueue.append(QPoint(x, y - 1));
         }
-        if (y < layerHeight - 1 && !checked[i + layerWidth]) {
+        if (y < layerHeight - 1 && !checked(i + layerWidth)) {
             const Tile *below = currentLayer->cellAt(x, y + 1).tile;
             if (bottomEdge(paste) != topEdge(below))
-                transitionList.append(QPoint(x, y + 1));
+                transitionQueue.append(QPoint(x, y + 1));
         }
-        if (x > 0 && !checked[i - 1]) {
+        if (x > 0 && !checked(i - 1)) {
             const Tile *left = currentLayer->cellAt(x - 1, y).tile;
             if (leftEdge(paste) != rightEdge(left))
-                transitionList.append(QPoint(x - 1, y));
+                transitionQueue.append(QPoint(x - 1, y));
         }
-        if (x < layerWidth - 1 && !checked[i + 1]) {
+        if (x < layerWidth - 1 && !checked(i + 1)) {
             const Tile *right = currentLayer->cellAt(x + 1, y).tile;
             if (rightEdge(paste) != leftEdge(right))
-                transitionList.append(QPoint(x + 1, y));
+                transitionQueue.append(QPoint(x + 1, y));
         }
     }
 
     // create a stamp for the terrain block
-    QRegion brushRegion;
+    RegionBuilder brushRegion;
     SharedTileLayer stamp = SharedTileLayer(new TileLayer(QString(),
                                                           brushRect.left(),
                                                           brushRect.top(),
@@ -497,35 +470,31 @@ void TerrainBrush::updateBrush(QPoint cursorPos, const QVector<QPoint> *list)
     for (int y = brushRect.top(); y <= brushRect.bottom(); ++y) {
         for (int x = brushRect.left(); x <= brushRect.right(); ++x) {
             int i = y * layerWidth + x;
-            if (!checked[i])
+            if (!checked(i))
                 continue;
 
             stamp->setCell(x - brushRect.left(),
                            y - brushRect.top(),
-                           Cell(newTerrain[i]));
+                           Cell(newTerrain.value(i)));
 
             // detect the affected region in ranges, which makes things faster
             const int rangeStart = x;
 
             for (++x; x <= brushRect.right() + 1; ++x) {
                 i = y * layerWidth + x;
-                if (x == brushRect.right() + 1 || !checked[i]) {
+                if (x == brushRect.right() + 1 || !checked(i)) {
                     const int rangeEnd = x;
-                    brushRegion += QRect(rangeStart, y,
-                                         rangeEnd - rangeStart, 1);
+                    brushRegion.addRun(rangeStart, y, rangeEnd - rangeStart);
                     break;
                 } else {
                     stamp->setCell(x - brushRect.left(),
                                    y - brushRect.top(),
-                                   Cell(newTerrain[i]));
+                                   Cell(newTerrain.value(i)));
                 }
             }
         }
     }
 
     // set the new tile layer as the brush
-    brushItem()->setTileLayer(stamp, brushRegion);
-
-    delete[] checked;
-    delete[] newTerrain;
+    brushItem()->setTileLayer(stamp, brushRegion.region());
 }
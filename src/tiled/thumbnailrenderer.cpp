@@ -21,12 +21,10 @@
 #include "thumbnailrenderer.h"
 
 #include "hexagonalrenderer.h"
-#include "imagelayer.h"
 #include "isometricrenderer.h"
 #include "map.h"
-#include "mapobject.h"
+#include "mapcompositor.h"
 #include "mapobjectitem.h"
-#include "objectgroup.h"
 #include "orthogonalrenderer.h"
 #include "staggeredrenderer.h"
 #include "tile.h"
@@ -62,11 +60,6 @@ ThumbnailRenderer::~ThumbnailRenderer()
     delete mRenderer;
 }
 
-static bool objectLessThan(const MapObject *a, const MapObject *b)
-{
-    return a->y() < b->y();
-}
-
 static bool smoothTransform(qreal scale)
 {
     return scale != qreal(1) && scale < qreal(2);
@@ -156,55 +149,12 @@ QImage ThumbnailRenderer::render(const QSize &size) const
 
     mRenderer->setPainterScale(scale);
 
-    for (const Layer *layer : mMap->layers()) {
-        if (mVisibleLayersOnly && !layer->isVisible())
-            continue;
-
-        painter.setOpacity(layer->opacity());
-        painter.translate(layer->offset());
-
-        switch (layer->layerType()) {
-        case Layer::TileLayerType: {
-            const TileLayer *tileLayer = static_cast<const TileLayer*>(layer);
-            mRenderer->drawTileLayer(&painter, tileLayer);
-            break;
-        }
-
-        case Layer::ObjectGroupType: {
-            const ObjectGroup *objectGroup = static_cast<const ObjectGroup*>(layer);
-            QList<MapObject*> objects = objectGroup->objects();
-
-            if (objectGroup->drawOrder() == ObjectGroup::TopDownOrder)
-                qStableSort(objects.begin(), objects.end(), objectLessThan);
-
-            foreach (const MapObject *object, objects) {
-                if (object->isVisible()) {
-                    if (object->rotation() != qreal(0)) {
-                        QPointF origin = mRenderer->pixelToScreenCoords(object->position());
-                        painter.save();
-                        painter.translate(origin);
-                        painter.rotate(object->rotation());
-                        painter.translate(-origin);
-                    }
-
-                    const QColor color = MapObjectItem::objectColor(object);
-                    mRenderer->drawMapObject(&painter, object, color);
-
-                    if (object->rotation() != qreal(0))
-                        painter.restore();
-                }
-            }
-            break;
-        }
-        case Layer::ImageLayerType: {
-            const ImageLayer *imageLayer = static_cast<const ImageLayer*>(layer);
-            mRenderer->drawImageLayer(&painter, imageLayer);
-            break;
-        }
-        }
-
-        painter.translate(-layer->offset());
-    }
+    MapCompositor compositor(mRenderer);
+    compositor.setLayerFilter([this] (const Layer *layer) {
+        return !mVisibleLayersOnly || layer->isVisible();
+    });
+    compositor.setObjectColorFunction(&MapObjectItem::objectColor);
+    compositor.render(&painter);
 
     return image;
 }
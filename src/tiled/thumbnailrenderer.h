@@ -30,8 +30,6 @@ class MapRenderer;
 
 namespace Internal {
 
-// TODO: Look into using this class in ExportAsImageDialog, MiniMap and
-//       possibly even the tmxrasterizer.
 class ThumbnailRenderer
 {
 public:
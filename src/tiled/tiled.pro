@@ -126,6 +126,7 @@ SOURCES += aboutdialog.cpp \
     mainwindow.cpp \
     mapdocumentactionhandler.cpp \
     mapdocument.cpp \
+    mapmimedata.cpp \
     mapobjectitem.cpp \
     mapobjectmodel.cpp \
     mapscene.cpp \
@@ -157,6 +158,7 @@ SOURCES += aboutdialog.cpp \
     propertiesdock.cpp \
     propertybrowser.cpp \
     raiselowerhelper.cpp \
+    randompicker.cpp \
     renamelayer.cpp \
     renameterrain.cpp \
     replacetileset.cpp \
@@ -182,6 +184,9 @@ SOURCES += aboutdialog.cpp \
     tileanimationeditor.cpp \
     tilecollisioneditor.cpp \
     tiledapplication.cpp \
+    tilelayerbinaryformat.cpp \
+    tilelayerchunkcache.cpp \
+    tilelayerdelta.cpp \
     tilelayeritem.cpp \
     tilepainter.cpp \
     tileselectionitem.cpp \
@@ -193,12 +198,14 @@ SOURCES += aboutdialog.cpp \
     tilesetparametersedit.cpp \
     tilesetview.cpp \
     tilestamp.cpp \
+    tilestampindex.cpp \
     tilestampmanager.cpp \
     tilestampmodel.cpp \
     tilestampsdock.cpp \
     tmxmapformat.cpp \
     toolmanager.cpp \
     undodock.cpp \
+    undomemorymanager.cpp \
     utils.cpp \
     varianteditorfactory.cpp \
     variantpropertymanager.cpp \
@@ -276,6 +283,7 @@ HEADERS += aboutdialog.h \
     mainwindow.h \
     mapdocumentactionhandler.h \
     mapdocument.h \
+    mapmimedata.h \
     mapobjectitem.h \
     mapobjectmodel.h \
     mapscene.h \
@@ -335,6 +343,9 @@ HEADERS += aboutdialog.h \
     tileanimationeditor.h \
     tilecollisioneditor.h \
     tiledapplication.h \
+    tilelayerbinaryformat.h \
+    tilelayerchunkcache.h \
+    tilelayerdelta.h \
     tilelayeritem.h \
     tilepainter.h \
     tileselectionitem.h \
@@ -346,6 +357,7 @@ HEADERS += aboutdialog.h \
     tilesetparametersedit.h \
     tilesetview.h \
     tilestamp.h \
+    tilestampindex.h \
     tilestampmanager.h \
     tilestampmodel.h \
     tilestampsdock.h \
@@ -353,6 +365,7 @@ HEADERS += aboutdialog.h \
     toolmanager.h \
     undocommands.h \
     undodock.h \
+    undomemorymanager.h \
     utils.h \
     varianteditorfactory.h \
     variantpropertymanager.h \
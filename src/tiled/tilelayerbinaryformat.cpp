@@ -0,0 +1,241 @@
+/*
+ * tilelayerbinaryformat.cpp
+ * Copyright 2016, Tiled contributors
+ *
+ * This file is part of Tiled.
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation; either version 2 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "tilelayerbinaryformat.h"
+
+#include "compression.h"
+#include "gidmapper.h"
+#include "map.h"
+#include "mapreader.h"
+#include "mapwriter.h"
+#include "tilelayer.h"
+#include "tilesetformat.h"
+
+#include <QBuffer>
+#include <QDataStream>
+#include <QtEndian>
+
+#include <climits>
+#include <memory>
+
+namespace Tiled {
+namespace Internal {
+
+static const quint32 BinaryMagic = 0x544c4159;  // "TLAY"
+static const quint32 BinaryVersion = 1;
+
+bool canWriteBinaryTileLayer(const Map *map)
+{
+    return map->layerCount() == 1 && map->layerAt(0)->isTileLayer();
+}
+
+QByteArray writeBinaryTileLayer(const Map *map)
+{
+    Q_ASSERT(canWriteBinaryTileLayer(map));
+
+    const TileLayer *tileLayer = static_cast<const TileLayer*>(map->layerAt(0));
+
+    QByteArray data;
+    QDataStream stream(&data, QIODevice::WriteOnly);
+    stream.setVersion(QDataStream::Qt_5_0);
+
+    stream << BinaryMagic << BinaryVersion;
+    stream << qint32(map->orientation())
+           << qint32(map->renderOrder())
+           << qint32(map->width())
+           << qint32(map->height())
+           << qint32(map->tileWidth())
+           << qint32(map->tileHeight())
+           << qint32(map->hexSideLength())
+           << qint32(map->staggerAxis())
+           << qint32(map->staggerIndex());
+
+    const QVector<SharedTileset> &tilesets = map->tilesets();
+    const GidMapper gidMapper(tilesets);
+
+    stream << quint32(tilesets.size());
+
+    unsigned firstGid = 1;
+    for (const SharedTileset &tileset : tilesets) {
+        stream << quint32(firstGid) << tileset->isExternal();
+
+        if (tileset->isExternal()) {
+            stream << tileset->fileName();
+        } else {
+            QBuffer buffer;
+            buffer.open(QIODevice::WriteOnly);
+            MapWriter().writeTileset(*tileset, &buffer);
+            stream << buffer.data();
+        }
+
+        firstGid += tileset->nextTileId();
+    }
+
+    stream << tileLayer->name()
+           << qint32(tileLayer->x())
+           << qint32(tileLayer->y())
+           << qint32(tileLayer->width())
+           << qint32(tileLayer->height())
+           << double(tileLayer->opacity())
+           << tileLayer->isVisible()
+           << static_cast<const QMap<QString, QVariant>&>(tileLayer->properties());
+
+    const QVector<unsigned> gids = gidMapper.cellsToGids(*tileLayer);
+    QByteArray cellData(gids.size() * 4, Qt::Uninitialized);
+    uchar *cells = reinterpret_cast<uchar*>(cellData.data());
+    for (int i = 0; i < gids.size(); ++i)
+        qToLittleEndian<quint32>(gids.at(i), cells + i * 4);
+
+    stream << compress(cellData, Zlib);
+
+    return data;
+}
+
+static SharedTileset readTileset(QDataStream &stream,
+                                 const ExternalTilesetReader &readExternalTileset)
+{
+    bool external;
+    stream >> external;
+
+    if (external) {
+        QString fileName;
+        stream >> fileName;
+        if (stream.status() != QDataStream::Ok)
+            return SharedTileset();
+
+        if (readExternalTileset)
+            return readExternalTileset(fileName);
+        return Tiled::readTileset(fileName);
+    }
+
+    QByteArray tsx;
+    stream >> tsx;
+    if (stream.status() != QDataStream::Ok)
+        return SharedTileset();
+
+    QBuffer buffer(&tsx);
+    buffer.open(QIODevice::ReadOnly);
+    return MapReader().readTileset(&buffer);
+}
+
+Map *readBinaryTileLayer(const QByteArray &data,
+                         const ExternalTilesetReader &readExternalTileset)
+{
+    QDataStream stream(data);
+    stream.setVersion(QDataStream::Qt_5_0);
+
+    quint32 magic, version;
+    stream >> magic >> version;
+    if (stream.status() != QDataStream::Ok ||
+            magic != BinaryMagic || version != BinaryVersion)
+        return nullptr;
+
+    qint32 orientation, renderOrder, width, height, tileWidth, tileHeight;
+    qint32 hexSideLength, staggerAxis, staggerIndex;
+    quint32 tilesetCount;
+
+    stream >> orientation >> renderOrder
+           >> width >> height
+           >> tileWidth >> tileHeight
+           >> hexSideLength >> staggerAxis >> staggerIndex
+           >> tilesetCount;
+
+    if (stream.status() != QDataStream::Ok)
+        return nullptr;
+
+    std::unique_ptr<Map> map(new Map(static_cast<Map::Orientation>(orientation),
+                                     width, height,
+                                     tileWidth, tileHeight));
+    map->setRenderOrder(static_cast<Map::RenderOrder>(renderOrder));
+    map->setHexSideLength(hexSideLength);
+    map->setStaggerAxis(static_cast<Map::StaggerAxis>(staggerAxis));
+    map->setStaggerIndex(static_cast<Map::StaggerIndex>(staggerIndex));
+
+    GidMapper gidMapper;
+
+    for (quint32 i = 0; i < tilesetCount; ++i) {
+        quint32 firstGid;
+        stream >> firstGid;
+        if (stream.status() != QDataStream::Ok || firstGid == 0)
+            return nullptr;
+
+        const SharedTileset tileset = readTileset(stream, readExternalTileset);
+        if (!tileset)
+            return nullptr;
+
+        map->addTileset(tileset);
+        gidMapper.insert(firstGid, tileset.data());
+    }
+
+    QString name;
+    qint32 x, y, layerWidth, layerHeight;
+    double opacity;
+    bool visible;
+    Properties properties;
+    QByteArray cellData;
+
+    stream >> name
+           >> x >> y
+           >> layerWidth >> layerHeight
+           >> opacity
+           >> visible
+           >> static_cast<QMap<QString, QVariant>&>(properties)
+           >> cellData;
+
+    if (stream.status() != QDataStream::Ok)
+        return nullptr;
+    if (layerWidth < 0 || layerHeight < 0 ||
+            qint64(layerWidth) * layerHeight > INT_MAX / 4)
+        return nullptr;
+
+    const int cellCount = layerWidth * layerHeight;
+    cellData = decompress(cellData, cellCount * 4);
+    if (cellData.size() != cellCount * 4)
+        return nullptr;
+
+    std::unique_ptr<TileLayer> tileLayer(new TileLayer(name, x, y,
+                                                       layerWidth, layerHeight));
+    tileLayer->setOpacity(float(opacity));
+    tileLayer->setVisible(visible);
+    tileLayer->setProperties(properties);
+
+    const uchar *cells = reinterpret_cast<const uchar*>(cellData.constData());
+    for (int i = 0; i < cellCount; ++i) {
+        const unsigned gid = qFromLittleEndian<quint32>(cells + i * 4);
+        if (gid == 0)
+            continue;
+
+        // Tiles are never created, since external tilesets may be shared
+        // with open maps
+        bool ok;
+        const Cell cell = gidMapper.findCell(gid, ok);
+        if (!ok)
+            return nullptr;
+
+        tileLayer->setCell(i % layerWidth, i / layerWidth, cell);
+    }
+
+    map->addLayer(tileLayer.release());
+
+    return map.release();
+}
+
+} // namespace Internal
+} // namespace Tiled
@@ -0,0 +1,72 @@
+/*
+ * tilelayerbinaryformat.h
+ * Copyright 2016, Tiled contributors
+ *
+ * This file is part of Tiled.
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation; either version 2 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef TILELAYERBINARYFORMAT_H
+#define TILELAYERBINARYFORMAT_H
+
+#include "tileset.h"
+
+#include <QByteArray>
+
+#include <functional>
+
+namespace Tiled {
+
+class Map;
+
+namespace Internal {
+
+/**
+ * Loads the external tileset with the given file name. Returns a null
+ * tileset when it could not be loaded.
+ */
+typedef std::function<SharedTileset (const QString &fileName)> ExternalTilesetReader;
+
+/**
+ * Returns whether the given \a map can be written in the binary tile layer
+ * form, which is the case when it consists of a single tile layer.
+ */
+bool canWriteBinaryTileLayer(const Map *map);
+
+/**
+ * Writes a map with a single tile layer in the binary form. The tilesets are
+ * referred to by file name when they are external and embedded as TSX
+ * otherwise. The cells are stored as a zlib compressed array of little
+ * endian GIDs, so the data does not refer to any live tiles.
+ */
+QByteArray writeBinaryTileLayer(const Map *map);
+
+/**
+ * Reads a map written by writeBinaryTileLayer. External tilesets are loaded
+ * using the given \a readExternalTileset function, or from disk when none is
+ * given. Embedded tilesets are always read as new instances.
+ *
+ * Returns nullptr when the data is invalid, a tileset could not be loaded or
+ * a GID does not refer to an existing tile. The caller takes ownership of
+ * the map.
+ */
+Map *readBinaryTileLayer(const QByteArray &data,
+                         const ExternalTilesetReader &readExternalTileset =
+                                 ExternalTilesetReader());
+
+} // namespace Internal
+} // namespace Tiled
+
+#endif // TILELAYERBINARYFORMAT_H
@@ -0,0 +1,512 @@
+/*
+ * tilelayerchunkcache.cpp
+ * Copyright 2016, Tiled contributors
+ *
+ * This file is part of Tiled.
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation; either version 2 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "tilelayerchunkcache.h"
+
+#include "hexagonalrenderer.h"
+#include "isometricrenderer.h"
+#include "map.h"
+#include "mapdocument.h"
+#include "orthogonalrenderer.h"
+#include "staggeredrenderer.h"
+#include "tile.h"
+#include "tilelayer.h"
+#include "tileset.h"
+
+#include <QMutex>
+#include <QMutexLocker>
+#include <QPainter>
+#include <QPolygonF>
+#include <QRunnable>
+#include <QThread>
+#include <QThreadPool>
+#include <QtMath>
+
+#include <algorithm>
+
+using namespace Tiled;
+using namespace Tiled::Internal;
+
+namespace Tiled {
+namespace Internal {
+
+/**
+ * The part of a chunk cache that is shared with its render tasks. Allows the
+ * tasks to find out whether their result is still wanted.
+ */
+struct ChunkRenderState
+{
+    ChunkRenderState(TileLayerChunkCache *cache)
+        : cache(cache)
+        , generation(0)
+    {}
+
+    QMutex mutex;
+    TileLayerChunkCache *cache; // reset when the cache is destroyed
+    int generation;
+};
+
+} // namespace Internal
+} // namespace Tiled
+
+/**
+ * The size of the chunks in device pixels.
+ */
+static const int ChunkSize = 256;
+
+/**
+ * The number of chunks kept per level of detail. Chunks that have not been
+ * painted for the longest time are dropped first.
+ */
+static const int MaxChunkCount = 128;
+
+static quint64 chunkKey(int x, int y)
+{
+    return (quint64(quint32(x)) << 32) | quint32(y);
+}
+
+static QPoint chunkPosition(quint64 key)
+{
+    return QPoint(int(quint32(key >> 32)), int(quint32(key)));
+}
+
+/**
+ * The thread pool used for rendering chunks. One thread is left for the GUI
+ * when possible.
+ */
+class ChunkRenderPool : public QThreadPool
+{
+public:
+    ChunkRenderPool()
+    {
+        setMaxThreadCount(qMax(1, QThread::idealThreadCount() - 1));
+    }
+};
+
+Q_GLOBAL_STATIC(ChunkRenderPool, chunkRenderPool)
+
+static MapRenderer *createRenderer(const Map *map)
+{
+    switch (map->orientation()) {
+    case Map::Isometric:
+        return new IsometricRenderer(map);
+    case Map::Staggered:
+        return new StaggeredRenderer(map);
+    case Map::Hexagonal:
+        return new HexagonalRenderer(map);
+    default:
+        return new OrthogonalRenderer(map);
+    }
+}
+
+/**
+ * Renders a chunk from a copy of the map parameters and of the cells in and
+ * around the chunk. The task owns these copies.
+ *
+ * Since pixmaps can't be used outside of the GUI thread, the copied tiles
+ * have no pixmap. Instead, their images are passed along.
+ */
+class ChunkRenderTask : public QRunnable
+{
+public:
+    ChunkRenderTask(const QSharedPointer<ChunkRenderState> &state,
+                    int generation,
+                    quint64 key,
+                    int request,
+                    const QRectF &rect,
+                    qreal levelOfDetail,
+                    Map *map,
+                    TileLayer *layer,
+                    const QList<SharedTileset> &tilesets,
+                    const TileImages &tileImages)
+        : mState(state)
+        , mGeneration(generation)
+        , mKey(key)
+        , mRequest(request)
+        , mRect(rect)
+        , mLevelOfDetail(levelOfDetail)
+        , mMap(map)
+        , mLayer(layer)
+        , mTilesets(tilesets)
+        , mTileImages(tileImages)
+    {}
+
+    ~ChunkRenderTask()
+    {
+        delete mLayer;
+        delete mMap;
+    }
+
+    void run() override
+    {
+        if (!isWanted())
+            return;
+
+        QImage image(ChunkSize, ChunkSize, QImage::Format_ARGB32_Premultiplied);
+        image.fill(Qt::transparent);
+
+        QPainter painter(&image);
+        painter.scale(mLevelOfDetail, mLevelOfDetail);
+        painter.translate(-mRect.topLeft());
+
+        MapRenderer *renderer = createRenderer(mMap);
+        renderer->setTileImages(&mTileImages);
+        renderer->drawTileLayer(&painter, mLayer, mRect);
+        delete renderer;
+
+        painter.end();
+
+        QMutexLocker locker(&mState->mutex);
+        if (mState->cache) {
+            QMetaObject::invokeMethod(mState->cache, "renderFinished",
+                                      Qt::QueuedConnection,
+                                      Q_ARG(int, mGeneration),
+                                      Q_ARG(quint64, mKey),
+                                      Q_ARG(int, mRequest),
+                                      Q_ARG(QImage, image));
+        }
+    }
+
+private:
+    bool isWanted() const
+    {
+        QMutexLocker locker(&mState->mutex);
+        return mState->cache && mState->generation == mGeneration;
+    }
+
+    QSharedPointer<ChunkRenderState> mState;
+    int mGeneration;
+    quint64 mKey;
+    int mRequest;
+    QRectF mRect;
+    qreal mLevelOfDetail;
+    Map *mMap;
+    TileLayer *mLayer;
+    QList<SharedTileset> mTilesets;
+    TileImages mTileImages;
+};
+
+
+TileLayerChunkCache::TileLayerChunkCache(TileLayer *layer,
+                                         MapDocument *mapDocument,
+                                         QObject *parent)
+    : QObject(parent)
+    , mLayer(layer)
+    , mMapDocument(mapDocument)
+    , mState(new ChunkRenderState(this))
+    , mLevelOfDetail(0)
+    , mPreviousLevelOfDetail(0)
+    , mGeneration(0)
+    , mLastRequest(0)
+    , mPaintCount(0)
+{
+}
+
+TileLayerChunkCache::~TileLayerChunkCache()
+{
+    // Tasks still in the queue will skip their work
+    QMutexLocker locker(&mState->mutex);
+    mState->cache = nullptr;
+}
+
+void TileLayerChunkCache::paint(QPainter *painter,
+                                const QRectF &exposed,
+                                qreal levelOfDetail)
+{
+    if (levelOfDetail <= 0)
+        return;
+
+    setLevelOfDetail(levelOfDetail);
+    ++mPaintCount;
+
+    const QRect range = chunkRange(exposed, mLevelOfDetail);
+
+    for (int y = range.top(); y <= range.bottom(); ++y) {
+        for (int x = range.left(); x <= range.right(); ++x) {
+            const quint64 key = chunkKey(x, y);
+            Chunk &chunk = mChunks[key];
+            chunk.lastUsed = mPaintCount;
+
+            if ((!chunk.rendered || chunk.dirty) && chunk.request == 0)
+                requestChunk(key, chunk);
+
+            const QRectF rect = chunkRect(key, mLevelOfDetail);
+
+            // Out of date chunks are painted until they are replaced
+            if (chunk.rendered) {
+                if (!chunk.image.isNull())
+                    painter->drawImage(rect, chunk.image);
+                continue;
+            }
+
+            if (mPreviousChunks.isEmpty())
+                continue;
+
+            // Fill in with the chunks of the previous level of detail
+            const QRect previousRange = chunkRange(rect, mPreviousLevelOfDetail);
+
+            painter->save();
+            painter->setClipRect(rect, Qt::IntersectClip);
+
+            for (int py = previousRange.top(); py <= previousRange.bottom(); ++py) {
+                for (int px = previousRange.left(); px <= previousRange.right(); ++px) {
+                    const quint64 previousKey = chunkKey(px, py);
+                    const auto it = mPreviousChunks.constFind(previousKey);
+                    if (it != mPreviousChunks.constEnd() && !it->image.isNull())
+                        painter->drawImage(chunkRect(previousKey, mPreviousLevelOfDetail),
+                                           it->image);
+                }
+            }
+
+            painter->restore();
+        }
+    }
+
+    trim();
+}
+
+void TileLayerChunkCache::invalidate(const QRectF &rect)
+{
+    for (auto it = mChunks.begin(), end = mChunks.end(); it != end; ++it) {
+        if (chunkRect(it.key(), mLevelOfDetail).intersects(rect)) {
+            it->dirty = true;
+            it->request = 0;
+        }
+    }
+
+    // Chunks of the previous level of detail are not updated anymore
+    auto it = mPreviousChunks.begin();
+    while (it != mPreviousChunks.end()) {
+        if (chunkRect(it.key(), mPreviousLevelOfDetail).intersects(rect))
+            it = mPreviousChunks.erase(it);
+        else
+            ++it;
+    }
+}
+
+void TileLayerChunkCache::invalidateAll()
+{
+    for (Chunk &chunk : mChunks) {
+        chunk.dirty = true;
+        chunk.request = 0;
+    }
+
+    mPreviousChunks.clear();
+}
+
+void TileLayerChunkCache::renderFinished(int generation, quint64 key,
+                                         int request, const QImage &image)
+{
+    if (generation != mGeneration)
+        return;
+
+    const auto it = mChunks.find(key);
+    if (it == mChunks.end() || it->request != request)
+        return;
+
+    it->image = image;
+    it->request = 0;
+    it->rendered = true;
+
+    emit chunkRendered(chunkRect(key, mLevelOfDetail));
+}
+
+/**
+ * Returns the area covered by the chunk with the given \a key, in layer
+ * coordinates.
+ */
+QRectF TileLayerChunkCache::chunkRect(quint64 key, qreal levelOfDetail) const
+{
+    const QPoint pos = chunkPosition(key);
+    const qreal size = ChunkSize / levelOfDetail;
+    return QRectF(pos.x() * size, pos.y() * size, size, size);
+}
+
+/**
+ * Returns the range of chunks intersecting \a rect, which is in layer
+ * coordinates.
+ */
+QRect TileLayerChunkCache::chunkRange(const QRectF &rect,
+                                      qreal levelOfDetail) const
+{
+    const qreal scale = levelOfDetail / ChunkSize;
+    const int left = qFloor(rect.left() * scale);
+    const int top = qFloor(rect.top() * scale);
+    const int right = qMax(left, qCeil(rect.right() * scale) - 1);
+    const int bottom = qMax(top, qCeil(rect.bottom() * scale) - 1);
+    return QRect(QPoint(left, top), QPoint(right, bottom));
+}
+
+/**
+ * Switches to a different level of detail. The chunks of the current level
+ * of detail are kept around as placeholders.
+ */
+void TileLayerChunkCache::setLevelOfDetail(qreal levelOfDetail)
+{
+    if (qFuzzyCompare(levelOfDetail, mLevelOfDetail))
+        return;
+
+    if (qFuzzyCompare(levelOfDetail, mPreviousLevelOfDetail)) {
+        mChunks.swap(mPreviousChunks);
+    } else {
+        mPreviousChunks.swap(mChunks);
+        mChunks.clear();
+    }
+
+    mPreviousLevelOfDetail = mLevelOfDetail;
+    mLevelOfDetail = levelOfDetail;
+
+    // Requests made for the previous level of detail are abandoned
+    ++mGeneration;
+    {
+        QMutexLocker locker(&mState->mutex);
+        mState->generation = mGeneration;
+    }
+
+    for (Chunk &chunk : mChunks)
+        chunk.request = 0;
+}
+
+/**
+ * Takes a copy of the cells that may be visible in the chunk with the given
+ * \a key and starts a task rendering them.
+ */
+void TileLayerChunkCache::requestChunk(quint64 key, Chunk &chunk)
+{
+    const Map *map = mMapDocument->map();
+    const MapRenderer *renderer = mMapDocument->renderer();
+    const QRectF rect = chunkRect(key, mLevelOfDetail);
+
+    chunk.dirty = false;
+
+    // Determine the tiles of which the images may reach into the chunk
+    const QMargins margins = mLayer->drawMargins();
+    const QRectF area = rect.adjusted(-margins.right(),
+                                      -margins.bottom(),
+                                      margins.left(),
+                                      margins.top());
+
+    QPolygonF tileArea;
+    tileArea << renderer->screenToTileCoords(area.topLeft())
+             << renderer->screenToTileCoords(area.topRight())
+             << renderer->screenToTileCoords(area.bottomRight())
+             << renderer->screenToTileCoords(area.bottomLeft());
+
+    // One tile extra on each side, since tiles may be staggered
+    const QRectF tileBounds = tileArea.boundingRect();
+    const QRect tileRect = QRect(QPoint(qFloor(tileBounds.left()) - 1,
+                                        qFloor(tileBounds.top()) - 1),
+                                 QPoint(qCeil(tileBounds.right()) + 1,
+                                        qCeil(tileBounds.bottom()) + 1))
+            .intersected(mLayer->bounds());
+
+    TileLayer *layer = nullptr;
+    QHash<Tile*, Tile*> tiles;
+    QHash<Tileset*, SharedTileset> tilesets;
+    TileImages tileImages;
+
+    for (int y = tileRect.top(); y <= tileRect.bottom(); ++y) {
+        for (int x = tileRect.left(); x <= tileRect.right(); ++x) {
+            const Cell &cell = mLayer->cellAt(x - mLayer->x(), y - mLayer->y());
+            if (cell.isEmpty())
+                continue;
+
+            // Copy the current frame of each tile, since animations go on
+            Tile *&tile = tiles[cell.tile];
+            if (!tile) {
+                Tileset *tileset = cell.tile->tileset();
+                SharedTileset &tilesetCopy = tilesets[tileset];
+                if (!tilesetCopy) {
+                    tilesetCopy = Tileset::create(tileset->name(),
+                                                  tileset->tileWidth(),
+                                                  tileset->tileHeight());
+                    tilesetCopy->setTileOffset(tileset->tileOffset());
+                }
+                tile = tilesetCopy->addTile(QPixmap());
+                tileImages.insert(tile, cell.tile->currentFrameImage().toImage());
+            }
+
+            if (!layer) {
+                layer = new TileLayer(QString(),
+                                      tileRect.x(), tileRect.y(),
+                                      tileRect.width(), tileRect.height());
+            }
+
+            Cell cellCopy = cell;
+            cellCopy.tile = tile;
+            layer->setCell(x - tileRect.x(), y - tileRect.y(), cellCopy);
+        }
+    }
+
+    // Nothing to render
+    if (!layer) {
+        chunk.image = QImage();
+        chunk.rendered = true;
+        return;
+    }
+
+    Map *mapCopy = new Map(map->orientation(),
+                           map->width(), map->height(),
+                           map->tileWidth(), map->tileHeight());
+    mapCopy->setRenderOrder(map->renderOrder());
+    mapCopy->setHexSideLength(map->hexSideLength());
+    mapCopy->setStaggerAxis(map->staggerAxis());
+    mapCopy->setStaggerIndex(map->staggerIndex());
+
+    chunk.request = ++mLastRequest;
+
+    chunkRenderPool()->start(new ChunkRenderTask(mState,
+                                                 mGeneration,
+                                                 key,
+                                                 chunk.request,
+                                                 rect,
+                                                 mLevelOfDetail,
+                                                 mapCopy,
+                                                 layer,
+                                                 tilesets.values(),
+                                                 tileImages));
+}
+
+/**
+ * Drops the chunks that have not been painted for the longest time, when
+ * there are too many.
+ */
+void TileLayerChunkCache::trim()
+{
+    if (mChunks.size() <= MaxChunkCount)
+        return;
+
+    QVector<int> lastUsed;
+    lastUsed.reserve(mChunks.size());
+    for (const Chunk &chunk : mChunks)
+        lastUsed.append(chunk.lastUsed);
+
+    const auto nth = lastUsed.begin() + (lastUsed.size() - MaxChunkCount);
+    std::nth_element(lastUsed.begin(), nth, lastUsed.end());
+    const int threshold = *nth;
+
+    auto it = mChunks.begin();
+    while (it != mChunks.end()) {
+        if (it->lastUsed < threshold)
+            it = mChunks.erase(it);
+        else
+            ++it;
+    }
+}
@@ -0,0 +1,129 @@
+/*
+ * tilelayerchunkcache.h
+ * Copyright 2016, Tiled contributors
+ *
+ * This file is part of Tiled.
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation; either version 2 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef TILELAYERCHUNKCACHE_H
+#define TILELAYERCHUNKCACHE_H
+
+#include <QHash>
+#include <QImage>
+#include <QObject>
+#include <QRectF>
+#include <QSharedPointer>
+
+class QPainter;
+
+namespace Tiled {
+
+class Tile;
+class TileLayer;
+class Tileset;
+
+namespace Internal {
+
+class MapDocument;
+struct ChunkRenderState;
+
+/**
+ * Rasterizes a tile layer into chunk images on background threads.
+ *
+ * The layer is divided into square chunks of a fixed size in device pixels,
+ * which are rendered for the level of detail at which they are painted. Only
+ * finished chunks are painted. Until a chunk is ready, the previous contents
+ * of the chunk or the chunks rendered at the previous level of detail are
+ * painted in its place.
+ *
+ * The render tasks only work on copies of the cells and tiles they need,
+ * taken on the GUI thread, so the map can be changed while they run.
+ */
+class TileLayerChunkCache : public QObject
+{
+    Q_OBJECT
+
+public:
+    TileLayerChunkCache(TileLayer *layer,
+                        MapDocument *mapDocument,
+                        QObject *parent = nullptr);
+    ~TileLayerChunkCache();
+
+    /**
+     * Paints the chunks intersecting \a exposed, which is in layer
+     * coordinates, at the given \a levelOfDetail. Render tasks are started
+     * for the chunks that are missing or out of date.
+     */
+    void paint(QPainter *painter, const QRectF &exposed, qreal levelOfDetail);
+
+    /**
+     * Marks the chunks intersecting \a rect, in layer coordinates, as out
+     * of date.
+     */
+    void invalidate(const QRectF &rect);
+
+    /**
+     * Marks all chunks as out of date.
+     */
+    void invalidateAll();
+
+signals:
+    /**
+     * Emitted when a chunk covering \a rect, in layer coordinates, has
+     * finished rendering.
+     */
+    void chunkRendered(const QRectF &rect);
+
+private slots:
+    void renderFinished(int generation, quint64 key, int request,
+                        const QImage &image);
+
+private:
+    struct Chunk {
+        Chunk() : request(0), lastUsed(0), rendered(false), dirty(false) {}
+
+        QImage image;
+        int request;        // id of the render task in flight, or 0
+        int lastUsed;
+        bool rendered;
+        bool dirty;
+    };
+
+    QRectF chunkRect(quint64 key, qreal levelOfDetail) const;
+    QRect chunkRange(const QRectF &rect, qreal levelOfDetail) const;
+
+    void setLevelOfDetail(qreal levelOfDetail);
+    void requestChunk(quint64 key, Chunk &chunk);
+    void trim();
+
+    TileLayer *mLayer;
+    MapDocument *mMapDocument;
+    QSharedPointer<ChunkRenderState> mState;
+
+    qreal mLevelOfDetail;
+    qreal mPreviousLevelOfDetail;
+    QHash<quint64, Chunk> mChunks;
+    QHash<quint64, Chunk> mPreviousChunks;
+
+    int mGeneration;
+    int mLastRequest;
+    int mPaintCount;
+};
+
+} // namespace Internal
+} // namespace Tiled
+
+#endif // TILELAYERCHUNKCACHE_H
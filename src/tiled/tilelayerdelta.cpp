@@ -0,0 +1,213 @@
+/*
+ * tilelayerdelta.cpp
+ * Copyright 2016, Tiled contributors
+ *
+ * This file is part of Tiled.
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation; either version 2 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "tilelayerdelta.h"
+
+#include "compression.h"
+
+#include <cstring>
+
+using namespace Tiled;
+using namespace Tiled::Internal;
+
+TileLayerDelta::TileLayerDelta()
+    : mSpanCount(0)
+    , mBeforeCount(0)
+    , mAfterCount(0)
+{
+}
+
+void TileLayerDelta::record(const TileLayer *target,
+                            int x, int y,
+                            const TileLayer *source,
+                            const QRegion &region)
+{
+    QRegion area = region;
+    area &= QRect(x, y, source->width(), source->height());
+    area &= target->bounds();
+
+    for (const QRect &rect : area.rects()) {
+        for (int _y = rect.top(); _y <= rect.bottom(); ++_y) {
+            bool spanOpen = false;
+
+            for (int _x = rect.left(); _x <= rect.right(); ++_x) {
+                const Cell &before = target->cellAt(_x - target->x(),
+                                                     _y - target->y());
+                const Cell &after = source->cellAt(_x - x, _y - y);
+
+                // Unchanged cells don't need to be stored
+                if (before == after) {
+                    spanOpen = false;
+                    continue;
+                }
+
+                const bool startsSpan = !spanOpen;
+                if (startsSpan) {
+                    const Span span = { _x, _y, 0, mBefore.size(), mAfter.size() };
+                    mSpans.append(span);
+                    spanOpen = true;
+                }
+
+                ++mSpans.last().length;
+                appendCell(mBefore, before, startsSpan);
+                appendCell(mAfter, after, startsSpan);
+            }
+        }
+    }
+
+    mSpans.squeeze();
+    mBefore.squeeze();
+    mAfter.squeeze();
+}
+
+void TileLayerDelta::append(const TileLayerDelta &other)
+{
+    Q_ASSERT(!isCompressed() && !other.isCompressed());
+
+    const int beforeOffset = mBefore.size();
+    const int afterOffset = mAfter.size();
+
+    mSpans.reserve(mSpans.size() + other.mSpans.size());
+    for (Span span : other.mSpans) {
+        span.firstBefore += beforeOffset;
+        span.firstAfter += afterOffset;
+        mSpans.append(span);
+    }
+
+    mBefore += other.mBefore;
+    mAfter += other.mAfter;
+}
+
+void TileLayerDelta::apply(TileLayer *layer,
+                           Direction direction,
+                           const SelectionMask &mask) const
+{
+    Q_ASSERT(!isCompressed());
+
+    const bool undo = direction == Undo;
+    const QVector<CellRun> &runs = undo ? mBefore : mAfter;
+    const int spanCount = mSpans.size();
+    const bool masked = !mask.isEmpty();
+
+    // When undoing, the spans are reverted in reverse order, since appended
+    // deltas may overlap earlier ones.
+    for (int i = 0; i < spanCount; ++i) {
+        const Span &span = mSpans.at(undo ? spanCount - 1 - i : i);
+        const int layerY = span.y - layer->y();
+        int run = undo ? span.firstBefore : span.firstAfter;
+        int x = span.x;
+        const int end = span.x + span.length;
+
+        while (x < end) {
+            const CellRun &cellRun = runs.at(run++);
+
+            for (int n = 0; n < cellRun.count; ++n, ++x)
+                if (!masked || mask.contains(x, span.y))
+                    layer->setCell(x - layer->x(), layerY, cellRun.cell);
+        }
+    }
+}
+
+void TileLayerDelta::clear()
+{
+    mSpans = QVector<Span>();
+    mBefore = QVector<CellRun>();
+    mAfter = QVector<CellRun>();
+    mCompressed = QByteArray();
+}
+
+void TileLayerDelta::compress()
+{
+    if (isCompressed() || mSpans.isEmpty())
+        return;
+
+    const int spanBytes = mSpans.size() * sizeof(Span);
+    const int beforeBytes = mBefore.size() * sizeof(CellRun);
+    const int afterBytes = mAfter.size() * sizeof(CellRun);
+
+    QByteArray data;
+    data.reserve(spanBytes + beforeBytes + afterBytes);
+    data.append(reinterpret_cast<const char*>(mSpans.constData()), spanBytes);
+    data.append(reinterpret_cast<const char*>(mBefore.constData()), beforeBytes);
+    data.append(reinterpret_cast<const char*>(mAfter.constData()), afterBytes);
+
+    const QByteArray compressed = Tiled::compress(data, Zlib);
+    if (compressed.isNull())
+        return;
+
+    mSpanCount = mSpans.size();
+    mBeforeCount = mBefore.size();
+    mAfterCount = mAfter.size();
+
+    clear();
+    mCompressed = compressed;
+}
+
+void TileLayerDelta::uncompress()
+{
+    if (!isCompressed())
+        return;
+
+    const int spanBytes = mSpanCount * sizeof(Span);
+    const int beforeBytes = mBeforeCount * sizeof(CellRun);
+    const int afterBytes = mAfterCount * sizeof(CellRun);
+
+    const QByteArray data = decompress(mCompressed,
+                                       spanBytes + beforeBytes + afterBytes);
+    Q_ASSERT(data.size() == spanBytes + beforeBytes + afterBytes);
+
+    mCompressed = QByteArray();
+    if (data.size() != spanBytes + beforeBytes + afterBytes)
+        return;
+
+    const char *source = data.constData();
+
+    mSpans.resize(mSpanCount);
+    std::memcpy(mSpans.data(), source, spanBytes);
+    source += spanBytes;
+
+    mBefore.resize(mBeforeCount);
+    std::memcpy(mBefore.data(), source, beforeBytes);
+    source += beforeBytes;
+
+    mAfter.resize(mAfterCount);
+    std::memcpy(mAfter.data(), source, afterBytes);
+}
+
+qint64 TileLayerDelta::memoryUsage() const
+{
+    if (isCompressed())
+        return mCompressed.size();
+
+    return qint64(mSpans.capacity()) * sizeof(Span)
+            + qint64(mBefore.capacity() + mAfter.capacity()) * sizeof(CellRun);
+}
+
+void TileLayerDelta::appendCell(QVector<CellRun> &runs,
+                                const Cell &cell,
+                                bool startsSpan)
+{
+    if (!startsSpan && runs.last().cell == cell) {
+        ++runs.last().count;
+    } else {
+        const CellRun cellRun = { cell, 1 };
+        runs.append(cellRun);
+    }
+}
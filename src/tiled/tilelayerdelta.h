@@ -0,0 +1,131 @@
+/*
+ * tilelayerdelta.h
+ * Copyright 2016, Tiled contributors
+ *
+ * This file is part of Tiled.
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation; either version 2 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef TILELAYERDELTA_H
+#define TILELAYERDELTA_H
+
+#include "selectionmask.h"
+#include "tilelayer.h"
+
+#include <QByteArray>
+#include <QRegion>
+#include <QVector>
+
+namespace Tiled {
+namespace Internal {
+
+/**
+ * A sparse record of the cells changed on a tile layer, used by undo commands
+ * to avoid keeping copies of whole layers around.
+ *
+ * Only cells that actually change are stored. They are stored as horizontal
+ * spans, and the original and new cells of each span are run-length encoded.
+ * All coordinates are in map coordinates.
+ */
+class TileLayerDelta
+{
+public:
+    TileLayerDelta();
+
+    enum Direction {
+        Redo,   // Write the new cells
+        Undo    // Write the original cells
+    };
+
+    /**
+     * Records the changes that setting the cells of \a source at position
+     * (\a x, \a y) would make to \a target, limited to \a region. Has to be
+     * called before the change is actually made.
+     */
+    void record(const TileLayer *target,
+                int x, int y,
+                const TileLayer *source,
+                const QRegion &region);
+
+    /**
+     * Appends the changes recorded in \a other. They will be applied after
+     * the changes in this delta, and reverted before them. Neither delta
+     * should be compressed.
+     */
+    void append(const TileLayerDelta &other);
+
+    bool isEmpty() const { return mSpans.isEmpty() && !isCompressed(); }
+
+    /**
+     * Removes all recorded changes.
+     */
+    void clear();
+
+    /**
+     * Compresses the recorded changes. They need to be uncompressed before
+     * the delta can be applied or appended to.
+     */
+    void compress();
+    void uncompress();
+    bool isCompressed() const { return !mCompressed.isNull(); }
+
+    /**
+     * Writes the new or the original cells to \a layer, depending on the
+     * given \a direction. When \a mask is not empty, only cells within the
+     * mask are written.
+     *
+     * The delta should not be compressed.
+     */
+    void apply(TileLayer *layer,
+               Direction direction,
+               const SelectionMask &mask = SelectionMask()) const;
+
+    /**
+     * Returns the amount of memory in bytes allocated for the recorded cells.
+     */
+    qint64 memoryUsage() const;
+
+private:
+    struct CellRun {
+        Cell cell;
+        int count;
+    };
+
+    struct Span {
+        int x;
+        int y;
+        int length;
+        int firstBefore;    // index of the first run in mBefore
+        int firstAfter;     // index of the first run in mAfter
+    };
+
+    static void appendCell(QVector<CellRun> &runs,
+                           const Cell &cell,
+                           bool startsSpan);
+
+    QVector<Span> mSpans;
+    QVector<CellRun> mBefore;
+    QVector<CellRun> mAfter;
+
+    QByteArray mCompressed;
+    int mSpanCount;         // only used while compressed
+    int mBeforeCount;
+    int mAfterCount;
+};
+
+} // namespace Internal
+} // namespace Tiled
+
+#endif // TILELAYERDELTA_H
@@ -25,6 +25,7 @@
 #include "map.h"
 #include "mapdocument.h"
 #include "maprenderer.h"
+#include "tilelayerchunkcache.h"
 
 #include <QPainter>
 #include <QStyleOptionGraphicsItem>
@@ -43,6 +44,10 @@ TileLayerItem::TileLayerItem(TileLayer *layer, MapDocument *mapDocument)
     setPos(mLayer->offset());
 }
 
+TileLayerItem::~TileLayerItem()
+{
+}
+
 void TileLayerItem::syncWithTileLayer()
 {
     prepareGeometryChange();
@@ -60,6 +65,36 @@ void TileLayerItem::syncWithTileLayer()
                                           -margins.top(),
                                           margins.right(),
                                           margins.bottom());
+
+    invalidateAll();
+}
+
+void TileLayerItem::setThreadedRendering(bool threadedRendering)
+{
+    if (threadedRendering == bool(mChunkCache))
+        return;
+
+    if (threadedRendering) {
+        mChunkCache.reset(new TileLayerChunkCache(mLayer, mMapDocument));
+        QObject::connect(mChunkCache.data(), &TileLayerChunkCache::chunkRendered,
+                         [this] (const QRectF &rect) { update(rect); });
+    } else {
+        mChunkCache.reset();
+    }
+
+    update();
+}
+
+void TileLayerItem::invalidate(const QRectF &rect)
+{
+    if (mChunkCache)
+        mChunkCache->invalidate(rect);
+}
+
+void TileLayerItem::invalidateAll()
+{
+    if (mChunkCache)
+        mChunkCache->invalidateAll();
 }
 
 QRectF TileLayerItem::boundingRect() const
@@ -71,6 +106,13 @@ void TileLayerItem::paint(QPainter *painter,
                           const QStyleOptionGraphicsItem *option,
                           QWidget *)
 {
+    if (mChunkCache) {
+        const qreal levelOfDetail =
+                option->levelOfDetailFromTransform(painter->worldTransform());
+        mChunkCache->paint(painter, option->exposedRect, levelOfDetail);
+        return;
+    }
+
     MapRenderer *renderer = mMapDocument->renderer();
     // TODO: Display a border around the layer when selected
     renderer->drawTileLayer(painter, mLayer, option->exposedRect);
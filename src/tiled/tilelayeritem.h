@@ -22,6 +22,7 @@
 #define TILELAYERITEM_H
 
 #include <QGraphicsItem>
+#include <QScopedPointer>
 
 namespace Tiled {
 
@@ -30,6 +31,7 @@ class TileLayer;
 namespace Internal {
 
 class MapDocument;
+class TileLayerChunkCache;
 
 /**
  * A graphics item displaying a tile layer in a QGraphicsView.
@@ -44,6 +46,7 @@ public:
      * @param mapDocument the map document owning the map of this layer
      */
     TileLayerItem(TileLayer *layer, MapDocument *mapDocument);
+    ~TileLayerItem();
 
     /**
      * Updates the size and position of this item. Should be called when the
@@ -55,6 +58,24 @@ public:
      */
     void syncWithTileLayer();
 
+    /**
+     * Sets whether the layer is rasterized in chunks on background threads,
+     * rather than drawn directly when painting.
+     */
+    void setThreadedRendering(bool threadedRendering);
+
+    /**
+     * Should be called when the cells within \a rect, in layer coordinates,
+     * have changed. Only needed with threaded rendering.
+     */
+    void invalidate(const QRectF &rect);
+
+    /**
+     * Should be called when the tiles used by the layer may look differently.
+     * Only needed with threaded rendering.
+     */
+    void invalidateAll();
+
     // QGraphicsItem
     QRectF boundingRect() const override;
     void paint(QPainter *painter,
@@ -65,6 +86,7 @@ private:
     TileLayer *mLayer;
     MapDocument *mMapDocument;
     QRectF mBoundingRect;
+    QScopedPointer<TileLayerChunkCache> mChunkCache;
 };
 
 } // namespace Internal
@@ -74,8 +74,8 @@ Cell TilePainter::cellAt(int x, int y) const
 
 void TilePainter::setCell(int x, int y, const Cell &cell)
 {
-    const QRegion &selection = mMapDocument->selectedArea();
-    if (!(selection.isEmpty() || selection.contains(QPoint(x, y))))
+    const SelectionMask &selection = mMapDocument->selectedArea();
+    if (!(selection.isEmpty() || selection.contains(x, y)))
         return;
 
     const int layerX = x - mTileLayer->x();
@@ -110,6 +110,20 @@ void TilePainter::setCells(int x, int y,
     mMapDocument->emitRegionChanged(region, mTileLayer);
 }
 
+void TilePainter::applyDelta(const TileLayerDelta &delta,
+                             TileLayerDelta::Direction direction,
+                             const QRegion &region)
+{
+    const QRegion paintable = paintableRegion(region);
+    if (paintable.isEmpty())
+        return;
+
+    DrawMarginsWatcher watcher(mMapDocument, mTileLayer);
+    delta.apply(mTileLayer, direction, mMapDocument->selectedArea());
+
+    mMapDocument->emitRegionChanged(paintable, mTileLayer);
+}
+
 void TilePainter::drawCells(int x, int y, TileLayer *tileLayer)
 {
     const QRegion region = paintableRegion(x, y,
@@ -183,14 +197,11 @@ void TilePainter::erase(const QRegion &region)
     mMapDocument->emitRegionChanged(paintable, mTileLayer);
 }
 
-static QRegion fillRegion(const TileLayer *layer, QPoint fillOrigin)
+static SelectionMask fillRegion(const TileLayer *layer, QPoint fillOrigin)
 {
-    // Create that region that will hold the fill
-    QRegion fillRegion;
-
     // Silently quit if parameters are unsatisfactory
     if (!layer->contains(fillOrigin))
-        return fillRegion;
+        return SelectionMask();
 
     // Cache cell that we will match other cells against
     const Cell matchCell = layer->cellAt(fillOrigin);
@@ -204,11 +215,16 @@ static QRegion fillRegion(const TileLayer *layer, QPoint fillOrigin)
     QList<QPoint> fillPositions;
     fillPositions.append(fillOrigin);
 
-    // Create an array that will store which cells have been processed
-    // This is faster than checking if a given cell is in the region/list
+    // Create an array that will store which cells have been processed and
+    // which ones are part of the fill. This is faster than checking if a
+    // given cell is in the region/list.
+    enum { Processed = 1, Filled = 2 };
     QVector<quint8> processedCellsVec(layerSize);
     quint8 *processedCells = processedCellsVec.data();
 
+    // The area covered by the fill
+    QRect fillBounds;
+
     // Loop through queued positions and fill them, while at the same time
     // checking adjacent positions to see if they should be added
     while (!fillPositions.empty()) {
@@ -225,13 +241,14 @@ static QRegion fillRegion(const TileLayer *layer, QPoint fillOrigin)
         while (right + 1 < layerWidth && layer->cellAt(right + 1, currentPoint.y()) == matchCell)
             ++right;
 
-        // Add cells between left and right to the region
-        fillRegion += QRegion(left, currentPoint.y(), right - left + 1, 1);
+        // Add cells between left and right to the fill
+        const QRect strip(left, currentPoint.y(), right - left + 1, 1);
+        fillBounds = fillBounds.united(strip);
 
         // Add cell strip to processed cells
         memset(&processedCells[startOfLine + left],
-               1,
-               right - left);
+               Processed | Filled,
+               right - left + 1);
 
         // These variables cache whether the last cell was added to the queue
         // or not as an optimization, since adjacent cells on the x axis
@@ -260,7 +277,7 @@ static QRegion fillRegion(const TileLayer *layer, QPoint fillOrigin)
                     lastAboveCell = false;
                 }
 
-                processedCells[aboveCell.y() * layerWidth + aboveCell.x()] = 1;
+                processedCells[aboveCell.y() * layerWidth + aboveCell.x()] |= Processed;
             }
 
             // Check cell below
@@ -279,36 +296,38 @@ static QRegion fillRegion(const TileLayer *layer, QPoint fillOrigin)
                     lastBelowCell = false;
                 }
 
-                processedCells[belowCell.y() * layerWidth + belowCell.x()] = 1;
+                processedCells[belowCell.y() * layerWidth + belowCell.x()] |= Processed;
             }
         }
     }
 
-    return fillRegion;
+    return SelectionMask::fromCondition(fillBounds, [=] (int x, int y) {
+        return processedCells[y * layerWidth + x] & Filled;
+    });
 }
 
 QRegion TilePainter::computePaintableFillRegion(const QPoint &fillOrigin) const
 {
-    QRegion region = fillRegion(mTileLayer, fillOrigin - mTileLayer->position());
+    SelectionMask region = fillRegion(mTileLayer, fillOrigin - mTileLayer->position());
     region.translate(mTileLayer->position());
 
-    const QRegion &selection = mMapDocument->selectedArea();
+    const SelectionMask &selection = mMapDocument->selectedArea();
     if (!selection.isEmpty())
         region &= selection;
 
-    return region;
+    return region.toRegion();
 }
 
-QRegion TilePainter::computeFillRegion(const QPoint &fillOrigin) const
+SelectionMask TilePainter::computeFillRegion(const QPoint &fillOrigin) const
 {
-    QRegion region = fillRegion(mTileLayer, fillOrigin - mTileLayer->position());
+    SelectionMask region = fillRegion(mTileLayer, fillOrigin - mTileLayer->position());
     return region.translated(mTileLayer->position());
 }
 
 bool TilePainter::isDrawable(int x, int y) const
 {
-    const QRegion &selection = mMapDocument->selectedArea();
-    if (!(selection.isEmpty() || selection.contains(QPoint(x, y))))
+    const SelectionMask &selection = mMapDocument->selectedArea();
+    if (!(selection.isEmpty() || selection.contains(x, y)))
         return false;
 
     const int layerX = x - mTileLayer->x();
@@ -323,11 +342,13 @@ bool TilePainter::isDrawable(int x, int y) const
 QRegion TilePainter::paintableRegion(const QRegion &region) const
 {
     const QRegion bounds = QRegion(mTileLayer->bounds());
-    QRegion intersection = bounds.intersected(region);
+    const QRegion intersection = bounds.intersected(region);
 
-    const QRegion &selection = mMapDocument->selectedArea();
-    if (!selection.isEmpty())
-        intersection &= selection;
+    // The selection can be large and fragmented, so the intersection is done
+    // on masks, which only needs to consider the area of the painted region.
+    const SelectionMask &selection = mMapDocument->selectedArea();
+    if (!selection.isEmpty() && !intersection.isEmpty())
+        return (SelectionMask(intersection) & selection).toRegion();
 
     return intersection;
 }
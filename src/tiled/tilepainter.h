@@ -22,7 +22,9 @@
 #ifndef TILEPAINTER_H
 #define TILEPAINTER_H
 
+#include "selectionmask.h"
 #include "tilelayer.h"
+#include "tilelayerdelta.h"
 
 #include <QRegion>
 
@@ -73,6 +75,17 @@ public:
      */
     void setCells(int x, int y, TileLayer *tileLayer, const QRegion &mask);
 
+    /**
+     * Applies the changes recorded in \a delta, in the given \a direction.
+     * The \a region is the area touched by the delta, in map coordinates. It
+     * is used for the change notification.
+     *
+     * Only cells that fall within the current selection are changed.
+     */
+    void applyDelta(const TileLayerDelta &delta,
+                    TileLayerDelta::Direction direction,
+                    const QRegion &region);
+
     /**
      * Draws the cells in the given tile layer at the given coordinates. The
      * coordinates \a x and \a y are relative to the map origin.
@@ -103,7 +116,7 @@ public:
      * at \a fillOrigin that are connected. Does not take into account the
      * current selection.
      */
-    QRegion computeFillRegion(const QPoint &fillOrigin) const;
+    SelectionMask computeFillRegion(const QPoint &fillOrigin) const;
 
     /**
      * Returns true if the given cell is drawable.
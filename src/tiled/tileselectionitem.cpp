@@ -32,8 +32,19 @@
 using namespace Tiled;
 using namespace Tiled::Internal;
 
+/**
+ * The size in tiles of the parts in which the selection shape is cached.
+ */
+static const int ChunkSize = 32;
+
+static quint64 chunkKey(int x, int y)
+{
+    return (quint64(quint32(x)) << 32) | quint32(y);
+}
+
 TileSelectionItem::TileSelectionItem(MapDocument *mapDocument)
     : mMapDocument(mapDocument)
+    , mSelectionRegion(mapDocument->selectedArea().toRegion())
 {
     setFlag(QGraphicsItem::ItemUsesExtendedStyleOption);
 
@@ -41,8 +52,11 @@ TileSelectionItem::TileSelectionItem(MapDocument *mapDocument)
             this, &TileSelectionItem::selectionChanged);
     connect(mMapDocument, &MapDocument::currentLayerIndexChanged,
             this, &TileSelectionItem::currentLayerIndexChanged);
+    connect(mMapDocument, &MapDocument::mapChanged,
+            this, &TileSelectionItem::mapChanged);
 
     updateBoundingRect();
+    updateChunks(mSelectionRegion.boundingRect());
 }
 
 QRectF TileSelectionItem::boundingRect() const
@@ -54,23 +68,31 @@ void TileSelectionItem::paint(QPainter *painter,
                               const QStyleOptionGraphicsItem *option,
                               QWidget *)
 {
-    const QRegion &selection = mMapDocument->selectedArea();
     QColor highlight = QApplication::palette().highlight().color();
     highlight.setAlpha(128);
 
-    MapRenderer *renderer = mMapDocument->renderer();
-    renderer->drawTileSelection(painter, selection, highlight,
-                                option->exposedRect);
+    const QRectF &exposed = option->exposedRect;
+
+    for (const Chunk &chunk : mChunks)
+        if (chunk.bounds.intersects(exposed))
+            painter->fillPath(chunk.shape, highlight);
 }
 
-void TileSelectionItem::selectionChanged(const QRegion &newSelection,
-                                         const QRegion &oldSelection)
+void TileSelectionItem::selectionChanged(const SelectionMask &newSelection,
+                                         const SelectionMask &oldSelection)
 {
+    // The renderer needs the selection as a region. It is converted once
+    // here, rather than on each paint.
+    mSelectionRegion = newSelection.toRegion();
+
     prepareGeometryChange();
     updateBoundingRect();
 
-    // Make sure changes within the bounding rect are updated
+    // Only the shapes of the changed chunks need to be updated
     const QRect changedArea = newSelection.xored(oldSelection).boundingRect();
+    updateChunks(changedArea);
+
+    // Make sure changes within the bounding rect are updated
     update(mMapDocument->renderer()->boundingRect(changedArea));
 }
 
@@ -80,8 +102,56 @@ void TileSelectionItem::currentLayerIndexChanged()
         setPos(layer->offset());
 }
 
+void TileSelectionItem::mapChanged()
+{
+    // The tile size or orientation may have changed
+    prepareGeometryChange();
+    updateBoundingRect();
+
+    mChunks.clear();
+    updateChunks(mSelectionRegion.boundingRect());
+}
+
 void TileSelectionItem::updateBoundingRect()
 {
     const QRect b = mMapDocument->selectedArea().boundingRect();
     mBoundingRect = mMapDocument->renderer()->boundingRect(b);
 }
+
+/**
+ * Recomputes the shapes of the chunks overlapping the given \a tileArea.
+ */
+void TileSelectionItem::updateChunks(const QRect &tileArea)
+{
+    if (tileArea.isEmpty())
+        return;
+
+    const MapRenderer *renderer = mMapDocument->renderer();
+
+    // Division that rounds towards negative infinity
+    auto chunkIndex = [] (int tile) {
+        return tile >= 0 ? tile / ChunkSize : (tile + 1) / ChunkSize - 1;
+    };
+
+    const int startX = chunkIndex(tileArea.left());
+    const int startY = chunkIndex(tileArea.top());
+    const int endX = chunkIndex(tileArea.right());
+    const int endY = chunkIndex(tileArea.bottom());
+
+    for (int y = startY; y <= endY; ++y) {
+        for (int x = startX; x <= endX; ++x) {
+            const QRect chunkRect(x * ChunkSize, y * ChunkSize,
+                                  ChunkSize, ChunkSize);
+            const QRegion chunkRegion = mSelectionRegion.intersected(chunkRect);
+
+            if (chunkRegion.isEmpty()) {
+                mChunks.remove(chunkKey(x, y));
+                continue;
+            }
+
+            Chunk &chunk = mChunks[chunkKey(x, y)];
+            chunk.shape = renderer->tileRegionShape(chunkRegion);
+            chunk.bounds = chunk.shape.boundingRect();
+        }
+    }
+}
@@ -21,7 +21,12 @@
 #ifndef TILESELECTIONITEM_H
 #define TILESELECTIONITEM_H
 
+#include "selectionmask.h"
+
 #include <QGraphicsObject>
+#include <QHash>
+#include <QPainterPath>
+#include <QRegion>
 
 namespace Tiled {
 namespace Internal {
@@ -30,6 +35,10 @@ class MapDocument;
 
 /**
  * A graphics item displaying a tile selection.
+ *
+ * The shape of the selection is cached in chunks, so that painting only
+ * needs to fill the shapes of the visible chunks, and a change to the
+ * selection only needs to update the chunks it touches.
  */
 class TileSelectionItem : public QGraphicsObject
 {
@@ -46,16 +55,25 @@ public:
                QWidget *widget = nullptr) override;
 
 private slots:
-    void selectionChanged(const QRegion &newSelection,
-                          const QRegion &oldSelection);
+    void selectionChanged(const SelectionMask &newSelection,
+                          const SelectionMask &oldSelection);
 
     void currentLayerIndexChanged();
+    void mapChanged();
 
 private:
     void updateBoundingRect();
+    void updateChunks(const QRect &tileArea);
+
+    struct Chunk {
+        QPainterPath shape;
+        QRectF bounds;
+    };
 
     MapDocument *mMapDocument;
+    QRegion mSelectionRegion;
     QRectF mBoundingRect;
+    QHash<quint64, Chunk> mChunks;
 };
 
 } // namespace Internal
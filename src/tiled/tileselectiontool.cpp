@@ -90,12 +90,12 @@ void TileSelectionTool::mouseReleased(QGraphicsSceneMouseEvent *event)
         mSelecting = false;
 
         MapDocument *document = mapDocument();
-        QRegion selection = document->selectedArea();
+        SelectionMask selection = document->selectedArea();
         const QRect area = selectedArea();
 
         switch (mSelectionMode) {
         case Replace:   selection = area; break;
-        case Add:       selection += area; break;
+        case Add:       selection |= area; break;
         case Subtract:  selection -= area; break;
         case Intersect: selection &= area; break;
         }
@@ -190,10 +190,13 @@ static void removeTileReferences(MapDocument *mapDocument,
                 undoStack->push(new EraseTiles(mapDocument, tileLayer, refs));
 
         } else if (ObjectGroup *objectGroup = layer->asObjectGroup()) {
+            QList<MapObject*> objectsToRemove;
             for (MapObject *object : *objectGroup) {
                 if (condition(object->cell()))
-                    undoStack->push(new RemoveMapObject(mapDocument, object));
+                    objectsToRemove.append(object);
             }
+            if (!objectsToRemove.isEmpty())
+                undoStack->push(new RemoveMapObjects(mapDocument, objectsToRemove));
         }
     }
 }
@@ -307,6 +310,8 @@ TilesetDock::TilesetDock(QWidget *parent):
 
     connect(TilesetManager::instance(), SIGNAL(tilesetChanged(Tileset*)),
             this, SLOT(tilesetChanged(Tileset*)));
+    connect(TilesetManager::instance(), &TilesetManager::tileImagesChanged,
+            this, &TilesetDock::tileImagesChanged);
 
     connect(DocumentManager::instance(), SIGNAL(documentAboutToClose(MapDocument*)),
             SLOT(documentAboutToClose(MapDocument*)));
@@ -1073,6 +1078,17 @@ void TilesetDock::tileAnimationChanged(Tile *tile)
             model->tileChanged(tile);
 }
 
+void TilesetDock::tileImagesChanged(Tileset *tileset, const QList<Tile*> &tiles)
+{
+    const int index = indexOf(mTilesets, tileset);
+    if (index < 0)
+        return;
+
+    if (TilesetModel *model = tilesetViewAt(index)->tilesetModel())
+        for (Tile *tile : tiles)
+            model->tileChanged(tile);
+}
+
 void TilesetDock::documentAboutToClose(MapDocument *mapDocument)
 {
     mCurrentTilesets.remove(mapDocument);
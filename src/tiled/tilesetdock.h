@@ -124,6 +124,7 @@ private slots:
 
     void tileImageSourceChanged(Tile *tile);
     void tileAnimationChanged(Tile *tile);
+    void tileImagesChanged(Tileset *tileset, const QList<Tile*> &tiles);
 
     void removeTileset();
     void removeTileset(int index);
@@ -25,6 +25,8 @@
 #include "tileanimationdriver.h"
 #include "tile.h"
 
+#include <QCryptographicHash>
+#include <QFile>
 #include <QImage>
 
 using namespace Tiled;
@@ -32,6 +34,23 @@ using namespace Tiled::Internal;
 
 TilesetManager *TilesetManager::mInstance;
 
+/**
+ * Returns a hash of the contents of the given file, or an empty byte array
+ * when the file could not be read.
+ */
+static QByteArray fileHash(const QString &fileName)
+{
+    QFile file(fileName);
+    if (!file.open(QIODevice::ReadOnly))
+        return QByteArray();
+
+    QCryptographicHash hash(QCryptographicHash::Sha1);
+    if (!hash.addData(&file))
+        return QByteArray();
+
+    return hash.result();
+}
+
 TilesetManager::TilesetManager():
     mWatcher(new FileSystemWatcher(this)),
     mAnimationDriver(new TileAnimationDriver(this)),
@@ -89,7 +108,7 @@ void TilesetManager::addReference(const SharedTileset &tileset)
     } else {
         mTilesets.insert(tileset, 1);
         if (!tileset->imageSource().isEmpty())
-            mWatcher->addPath(tileset->imageSource());
+            watchImage(tileset->imageSource());
     }
 }
 
@@ -101,7 +120,7 @@ void TilesetManager::removeReference(const SharedTileset &tileset)
     if (mTilesets.value(tileset) == 0) {
         mTilesets.remove(tileset);
         if (!tileset->imageSource().isEmpty())
-            mWatcher->removePath(tileset->imageSource());
+            unwatchImage(tileset->imageSource());
     }
 }
 
@@ -158,8 +177,8 @@ void TilesetManager::tilesetImageSourceChanged(const Tileset &tileset,
     Q_ASSERT(!oldImageSource.isEmpty());
     Q_ASSERT(!tileset.imageSource().isEmpty());
 
-    mWatcher->removePath(oldImageSource);
-    mWatcher->addPath(tileset.imageSource());
+    unwatchImage(oldImageSource);
+    watchImage(tileset.imageSource());
 }
 
 void TilesetManager::fileChanged(const QString &path)
@@ -178,16 +197,61 @@ void TilesetManager::fileChanged(const QString &path)
 
 void TilesetManager::fileChangedTimeout()
 {
-    for (SharedTileset &tileset : tilesets()) {
-        QString fileName = tileset->imageSource();
-        if (mChangedFiles.contains(fileName))
-            if (tileset->loadFromImage(fileName))
+    const QList<SharedTileset> _tilesets = tilesets();
+
+    for (const QString &fileName : mChangedFiles) {
+        // Skip files that were touched or rewritten without being changed
+        const QByteArray hash = fileHash(fileName);
+        if (hash.isEmpty() || hash == mFileHashes.value(fileName))
+            continue;
+
+        const QImage image(fileName);
+        if (image.isNull())
+            continue;
+
+        mFileHashes.insert(fileName, hash);
+
+        for (const SharedTileset &tileset : _tilesets) {
+            if (tileset->imageSource() != fileName)
+                continue;
+
+            QList<Tile*> changedTiles;
+            if (tileset->updateFromImage(image, changedTiles)) {
+                if (!changedTiles.isEmpty())
+                    emit tileImagesChanged(tileset.data(), changedTiles);
+            } else if (tileset->loadFromImage(image, fileName)) {
                 emit tilesetChanged(tileset.data());
+            }
+        }
     }
 
     mChangedFiles.clear();
 }
 
+void TilesetManager::watchImage(const QString &fileName)
+{
+    mWatcher->addPath(fileName);
+
+    // Remember the current contents, to be able to tell whether a change
+    // notification actually changed anything
+    if (mReloadTilesetsOnChange && !mFileHashes.contains(fileName)) {
+        const QByteArray hash = fileHash(fileName);
+        if (!hash.isEmpty())
+            mFileHashes.insert(fileName, hash);
+    }
+}
+
+void TilesetManager::unwatchImage(const QString &fileName)
+{
+    mWatcher->removePath(fileName);
+
+    for (const SharedTileset &tileset : mTilesets.keys())
+        if (tileset->imageSource() == fileName)
+            return;
+
+    mFileHashes.remove(fileName);
+}
+
 void TilesetManager::advanceTileAnimations(int ms)
 {
     const QList<SharedTileset> &_tilesets = tilesets();
@@ -24,6 +24,8 @@
 
 #include "tileset.h"
 
+#include <QByteArray>
+#include <QHash>
 #include <QObject>
 #include <QList>
 #include <QMap>
@@ -41,6 +43,10 @@ class TileAnimationDriver;
  * The tileset manager keeps track of all tilesets used by loaded maps. It also
  * watches the tileset images for changes and will attempt to reload them when
  * they change.
+ *
+ * A hash of the contents of each watched image is kept, so that changes that
+ * leave the file the same don't cause a reload. When a reloaded image has the
+ * same size, only the tiles that actually changed are updated.
  */
 class TilesetManager : public QObject
 {
@@ -120,6 +126,12 @@ signals:
      */
     void tilesetChanged(Tileset *tileset);
 
+    /**
+     * Emitted when the images of the given \a tiles were reloaded, without
+     * otherwise affecting their \a tileset.
+     */
+    void tileImagesChanged(Tileset *tileset, const QList<Tile*> &tiles);
+
     /**
      * Emitted when any images of the tiles in the given \a tileset have
      * changed. This is used to trigger repaints for displaying tile
@@ -136,6 +148,9 @@ private slots:
 private:
     Q_DISABLE_COPY(TilesetManager)
 
+    void watchImage(const QString &fileName);
+    void unwatchImage(const QString &fileName);
+
     /**
      * Constructor. Only used by the tileset manager itself.
      */
@@ -154,6 +169,7 @@ private:
     QMap<SharedTileset, int> mTilesets;
     FileSystemWatcher *mWatcher;
     TileAnimationDriver *mAnimationDriver;
+    QHash<QString, QByteArray> mFileHashes;
     QSet<QString> mChangedFiles;
     QTimer mChangedFilesTimer;
     bool mReloadTilesetsOnChange;
@@ -27,7 +27,10 @@
 #include "varianttomapconverter.h"
 
 #include <QDebug>
+#include <QFile>
+#include <QFileInfo>
 #include <QJsonArray>
+#include <QJsonDocument>
 
 namespace Tiled {
 namespace Internal {
@@ -39,6 +42,66 @@ TileLayer *TileStampVariation::tileLayer() const
 }
 
 
+/**
+ * Reads the stamp file at \a filePath, which can be either binary or text
+ * JSON. Returns a null document when the file could not be read.
+ */
+static QJsonDocument readStampDocument(const QString &filePath)
+{
+    QFile stampFile(filePath);
+    if (!stampFile.open(QIODevice::ReadOnly))
+        return QJsonDocument();
+
+    QByteArray data = stampFile.readAll();
+
+    QJsonDocument document = QJsonDocument::fromBinaryData(data);
+    if (document.isNull()) {
+        // document not valid binary data, maybe it's an JSON text file
+        QJsonParseError error;
+        document = QJsonDocument::fromJson(data, &error);
+        if (error.error != QJsonParseError::NoError) {
+            qDebug() << "Failed to parse stamp file:" << qPrintable(error.errorString());
+            return QJsonDocument();
+        }
+    }
+
+    return document;
+}
+
+/**
+ * Reads the variations of the stamp stored in \a json. The tilesets used by
+ * the variations are referenced with the TilesetManager.
+ */
+static QVector<TileStampVariation> variationsFromJson(const QJsonObject &json,
+                                                      const QDir &mapDir)
+{
+    TilesetManager *tilesetManager = TilesetManager::instance();
+    QVector<TileStampVariation> result;
+
+    QJsonArray variations = json.value(QLatin1String("variations")).toArray();
+    for (const QJsonValue &value : variations) {
+        QJsonObject variationJson = value.toObject();
+
+        QVariant mapVariant = variationJson.value(QLatin1String("map")).toVariant();
+        VariantToMapConverter converter;
+        Map *map = converter.toMap(mapVariant, mapDir);
+        if (!map) {
+            qDebug() << "Failed to load map for stamp:" << converter.errorString();
+            continue;
+        }
+
+        qreal probability = variationJson.value(QLatin1String("probability")).toDouble(1);
+
+        // increase tileset reference counts to keep watching them
+        tilesetManager->addReferences(map->tilesets());
+
+        result.append(TileStampVariation(map, probability));
+    }
+
+    return result;
+}
+
+
 class TileStampData : public QSharedData
 {
 public:
@@ -46,14 +109,29 @@ public:
     TileStampData(const TileStampData &other);
     ~TileStampData();
 
+    bool isLoaded() const { return deferredFilePath.isEmpty(); }
+    void load();
+
     QString name;
     QString fileName;
     QVector<TileStampVariation> variations;
     int quickStampIndex;
+
+    // Picks variation indexes, rebuilt when the variations have changed
+    RandomPicker<int> randomPicker;
+    bool randomPickerDirty;
+
+    // Only used while the variations haven't been loaded yet
+    QString deferredFilePath;
+    int deferredVariationCount;
+    QSize deferredMaxSize;
+    QPixmap preview;
 };
 
 TileStampData::TileStampData()
     : quickStampIndex(-1)
+    , randomPickerDirty(true)
+    , deferredVariationCount(0)
 {}
 
 TileStampData::TileStampData(const TileStampData &other)
@@ -62,7 +140,11 @@ TileStampData::TileStampData(const TileStampData &other)
     , fileName()                        // not copied
     , variations(other.variations)
     , quickStampIndex(-1)
+    , randomPickerDirty(true)
+    , deferredVariationCount(0)
 {
+    Q_ASSERT(other.isLoaded());
+
     TilesetManager *tilesetManager = TilesetManager::instance();
 
     // deep-copy the map data
@@ -83,6 +165,28 @@ TileStampData::~TileStampData()
     }
 }
 
+/**
+ * Loads the variations from the stamp file, when they have been deferred.
+ */
+void TileStampData::load()
+{
+    if (isLoaded())
+        return;
+
+    const QFileInfo fileInfo(deferredFilePath);
+    deferredFilePath.clear();
+    deferredVariationCount = 0;
+    deferredMaxSize = QSize();
+    preview = QPixmap();
+
+    const QJsonDocument document = readStampDocument(fileInfo.filePath());
+    if (document.isNull())
+        return;
+
+    variations = variationsFromJson(document.object(), fileInfo.dir());
+    randomPickerDirty = true;
+}
+
 
 TileStamp::TileStamp()
     : d(new TileStampData)
@@ -138,16 +242,22 @@ void TileStamp::setFileName(const QString &fileName)
 
 qreal TileStamp::probability(int index) const
 {
+    d->load();
     return d->variations.at(index).probability;
 }
 
 void TileStamp::setProbability(int index, qreal probability)
 {
+    d->load();
     d->variations[index].probability = probability;
+    d->randomPickerDirty = true;
 }
 
 QSize TileStamp::maxSize() const
 {
+    if (!d->isLoaded())
+        return d->deferredMaxSize;
+
     QSize size;
     for (const TileStampVariation &variation : d->variations) {
         size.setWidth(qMax(size.width(), variation.map->width()));
@@ -158,9 +268,22 @@ QSize TileStamp::maxSize() const
 
 const QVector<TileStampVariation> &TileStamp::variations() const
 {
+    d->load();
     return d->variations;
 }
 
+/**
+ * Returns the number of variations, without loading them when they have been
+ * deferred.
+ */
+int TileStamp::variationCount() const
+{
+    if (!d->isLoaded())
+        return d->deferredVariationCount;
+
+    return d->variations.size();
+}
+
 /**
  * Adds a variation \a map to this tile stamp with a given \a probability.
  *
@@ -170,10 +293,13 @@ void TileStamp::addVariation(Map *map, qreal probability)
 {
     Q_ASSERT(map);
 
+    d->load();
+
     // increase tileset reference counts to keep watching them
     TilesetManager::instance()->addReferences(map->tilesets());
 
     d->variations.append(TileStampVariation(map, probability));
+    d->randomPickerDirty = true;
 }
 
 /**
@@ -182,6 +308,9 @@ void TileStamp::addVariation(Map *map, qreal probability)
  */
 Map *TileStamp::takeVariation(int index)
 {
+    d->load();
+    d->randomPickerDirty = true;
+
 #if QT_VERSION >= 0x050200
     return d->variations.takeAt(index).map;
 #else
@@ -203,7 +332,7 @@ void TileStamp::deleteVariation(int index)
  */
 bool TileStamp::isEmpty() const
 {
-    return d->variations.isEmpty();
+    return variationCount() == 0;
 }
 
 int TileStamp::quickStampIndex() const
@@ -216,15 +345,26 @@ void TileStamp::setQuickStampIndex(int quickStampIndex)
     d->quickStampIndex = quickStampIndex;
 }
 
+/**
+ * Returns a random variation, taking into account the probability of each
+ * variation. Returns an empty variation when the stamp has no variations,
+ * which can happen when its file could not be loaded.
+ */
 TileStampVariation TileStamp::randomVariation() const
 {
-    Q_ASSERT(!d->variations.isEmpty());
-
-    RandomPicker<const TileStampVariation *> randomPicker;
-    for (const TileStampVariation &variation : d->variations)
-        randomPicker.add(&variation, variation.probability);
+    d->load();
+    if (d->variations.isEmpty())
+        return TileStampVariation();
+
+    if (d->randomPickerDirty) {
+        d->randomPicker.clear();
+        for (int i = 0; i < d->variations.size(); ++i)
+            d->randomPicker.add(i, d->variations.at(i).probability);
+        d->randomPicker.build();
+        d->randomPickerDirty = false;
+    }
 
-    return randomPicker.pick()->map;
+    return d->variations.at(d->randomPicker.pick()).map;
 }
 
 /**
@@ -233,6 +373,8 @@ TileStampVariation TileStamp::randomVariation() const
  */
 TileStamp TileStamp::flipped(FlipDirection direction) const
 {
+    d->load();
+
     TileStamp flipped(*this);
     flipped.d.detach();
 
@@ -250,6 +392,8 @@ TileStamp TileStamp::flipped(FlipDirection direction) const
  */
 TileStamp TileStamp::rotated(RotateDirection direction) const
 {
+    d->load();
+
     TileStamp rotated(*this);
     rotated.d.detach();
 
@@ -270,13 +414,61 @@ TileStamp TileStamp::rotated(RotateDirection direction) const
  */
 TileStamp TileStamp::clone() const
 {
+    d->load();
+
     TileStamp clone(*this);
     clone.d.detach();
     return clone;
 }
 
+/**
+ * Returns whether the variations of this stamp have been loaded.
+ */
+bool TileStamp::isLoaded() const
+{
+    return d->isLoaded();
+}
+
+/**
+ * Loads the variations of this stamp, when they have been deferred.
+ */
+void TileStamp::load() const
+{
+    d->load();
+}
+
+/**
+ * Defers loading the variations of this stamp until they are needed. They
+ * will be read from \a filePath. Until then, the given \a variationCount and
+ * \a maxSize are reported, and \a preview can be displayed.
+ *
+ * Should only be called on a stamp without variations.
+ */
+void TileStamp::setDeferred(const QString &filePath,
+                            int variationCount,
+                            QSize maxSize,
+                            const QPixmap &preview)
+{
+    Q_ASSERT(d->variations.isEmpty());
+
+    d->deferredFilePath = filePath;
+    d->deferredVariationCount = variationCount;
+    d->deferredMaxSize = maxSize;
+    d->preview = preview;
+}
+
+/**
+ * Returns the preview image of a stamp that has not been loaded yet.
+ */
+QPixmap TileStamp::preview() const
+{
+    return d->preview;
+}
+
 QJsonObject TileStamp::toJson(const QDir &dir) const
 {
+    d->load();
+
     QJsonObject json;
     json.insert(QLatin1String("name"), d->name);
 
@@ -305,24 +497,25 @@ TileStamp TileStamp::fromJson(const QJsonObject &json, const QDir &mapDir)
 
     stamp.setName(json.value(QLatin1String("name")).toString());
     stamp.setQuickStampIndex(static_cast<int>(json.value(QLatin1String("quickStampIndex")).toDouble(-1)));
+    stamp.d->variations = variationsFromJson(json, mapDir);
 
-    QJsonArray variations = json.value(QLatin1String("variations")).toArray();
-    for (const QJsonValue &value : variations) {
-        QJsonObject variationJson = value.toObject();
-
-        QVariant mapVariant = variationJson.value(QLatin1String("map")).toVariant();
-        VariantToMapConverter converter;
-        Map *map = converter.toMap(mapVariant, mapDir);
-        if (!map) {
-            qDebug() << "Failed to load map for stamp:" << converter.errorString();
-            continue;
-        }
+    return stamp;
+}
 
-        qreal probability = variationJson.value(QLatin1String("probability")).toDouble(1);
+/**
+ * Reads the stamp from the file at \a filePath. Returns an empty stamp when
+ * the file could not be read.
+ */
+TileStamp TileStamp::fromFile(const QString &filePath)
+{
+    const QJsonDocument document = readStampDocument(filePath);
+    if (document.isNull())
+        return TileStamp();
 
-        stamp.addVariation(map, probability);
-    }
+    const QFileInfo fileInfo(filePath);
 
+    TileStamp stamp = fromJson(document.object(), fileInfo.dir());
+    stamp.setFileName(fileInfo.fileName());
     return stamp;
 }
 
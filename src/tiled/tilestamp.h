@@ -26,6 +26,7 @@
 
 #include <QDir>
 #include <QJsonObject>
+#include <QPixmap>
 #include <QSharedData>
 #include <QString>
 #include <QVector>
@@ -56,6 +57,13 @@ struct TileStampVariation
 class TileStampData;
 
 
+/**
+ * A tile stamp consists of one or more tile layer variations, of which a
+ * random one is used when painting.
+ *
+ * A stamp can be created from an entry in the stamp index without loading its
+ * variations. They are then loaded from the stamp file when first needed.
+ */
 class TileStamp
 {
 public:
@@ -81,6 +89,7 @@ public:
     QSize maxSize() const;
 
     const QVector<TileStampVariation> &variations() const;
+    int variationCount() const;
     void addVariation(Map *map, qreal probability = 1.0);
     void addVariation(const TileStampVariation &variation);
     Map *takeVariation(int index);
@@ -97,10 +106,19 @@ public:
 
     TileStamp clone() const;
 
+    bool isLoaded() const;
+    void load() const;
+    void setDeferred(const QString &filePath,
+                     int variationCount,
+                     QSize maxSize,
+                     const QPixmap &preview);
+    QPixmap preview() const;
+
     QJsonObject toJson(const QDir &dir) const;
 
     static TileStamp fromJson(const QJsonObject &json,
                               const QDir &mapDir);
+    static TileStamp fromFile(const QString &filePath);
 
 private:
     QExplicitlySharedDataPointer<TileStampData> d;
@@ -0,0 +1,269 @@
+/*
+ * tilestampindex.cpp
+ * Copyright 2016, Tiled contributors
+ *
+ * This file is part of Tiled.
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation; either version 2 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "tilestampindex.h"
+
+#include "map.h"
+#include "thumbnailrenderer.h"
+#include "tilestamp.h"
+#include "tileset.h"
+
+#include <QCryptographicHash>
+#include <QDataStream>
+#include <QDebug>
+#include <QFile>
+#include <QFileInfo>
+#include <QSaveFile>
+#include <QSet>
+#include <QStandardPaths>
+
+using namespace Tiled;
+using namespace Tiled::Internal;
+
+static const quint32 IndexMagic = 0x54535449;  // "TSTI"
+static const quint32 IndexVersion = 1;
+
+namespace Tiled {
+namespace Internal {
+
+static QDataStream &operator<<(QDataStream &out,
+                               const TileStampIndex::Entry &entry)
+{
+    out << entry.lastModified << entry.fileSize << entry.indexed
+        << entry.name << qint32(entry.quickStampIndex)
+        << qint32(entry.variationCount) << entry.maxSize
+        << entry.tilesetFiles << entry.preview;
+    return out;
+}
+
+static QDataStream &operator>>(QDataStream &in, TileStampIndex::Entry &entry)
+{
+    qint32 quickStampIndex;
+    qint32 variationCount;
+
+    in >> entry.lastModified >> entry.fileSize >> entry.indexed
+       >> entry.name >> quickStampIndex
+       >> variationCount >> entry.maxSize
+       >> entry.tilesetFiles >> entry.preview;
+
+    entry.quickStampIndex = quickStampIndex;
+    entry.variationCount = variationCount;
+    return in;
+}
+
+} // namespace Internal
+} // namespace Tiled
+
+
+TileStampIndex::TileStampIndex(const QString &stampsDirectory)
+    : mDirectory(stampsDirectory)
+    , mModified(false)
+{
+}
+
+/**
+ * Reads the index from disk, replacing any entries in memory. Returns whether
+ * an index was found and could be read.
+ */
+bool TileStampIndex::load()
+{
+    mEntries.clear();
+    mLastModifiedCache.clear();
+    mModified = false;
+
+    QFile file(indexFilePath());
+    if (!file.open(QIODevice::ReadOnly))
+        return false;
+
+    QDataStream in(&file);
+    in.setVersion(QDataStream::Qt_5_0);
+
+    quint32 magic, version, count;
+    in >> magic >> version >> count;
+    if (magic != IndexMagic || version != IndexVersion)
+        return false;
+
+    for (quint32 i = 0; i < count && in.status() == QDataStream::Ok; ++i) {
+        QString fileName;
+        Entry entry;
+        in >> fileName >> entry;
+        mEntries.insert(fileName, entry);
+    }
+
+    if (in.status() != QDataStream::Ok) {
+        qDebug() << "Failed to read stamp index" << file.fileName();
+        mEntries.clear();
+        return false;
+    }
+
+    return true;
+}
+
+/**
+ * Writes the index to disk when it has been modified.
+ */
+bool TileStampIndex::save()
+{
+    if (!mModified)
+        return true;
+
+    const QString filePath = indexFilePath();
+    if (!QFileInfo(filePath).dir().mkpath(QLatin1String(".")))
+        return false;
+
+    QSaveFile file(filePath);
+    if (!file.open(QIODevice::WriteOnly)) {
+        qDebug() << "Failed to open stamp index for writing" << filePath;
+        return false;
+    }
+
+    QDataStream out(&file);
+    out.setVersion(QDataStream::Qt_5_0);
+    out << IndexMagic << IndexVersion << quint32(mEntries.size());
+
+    QHashIterator<QString, Entry> it(mEntries);
+    while (it.hasNext()) {
+        it.next();
+        out << it.key() << it.value();
+    }
+
+    if (!file.commit()) {
+        qDebug() << "Failed to write stamp index" << filePath;
+        return false;
+    }
+
+    mModified = false;
+    return true;
+}
+
+/**
+ * Returns the entry for the given \a stampFile, or null when there is no
+ * entry or when the file or any of the tilesets it uses changed since it was
+ * indexed.
+ */
+const TileStampIndex::Entry *TileStampIndex::upToDateEntry(const QFileInfo &stampFile) const
+{
+    auto it = mEntries.constFind(stampFile.fileName());
+    if (it == mEntries.constEnd())
+        return nullptr;
+
+    const Entry &entry = it.value();
+    if (entry.fileSize != stampFile.size() ||
+            entry.lastModified != stampFile.lastModified())
+        return nullptr;
+
+    // The preview needs updating when a tileset changed
+    for (const QString &filePath : entry.tilesetFiles) {
+        const QDateTime lastModified = fileLastModified(filePath);
+        if (lastModified.isValid() && lastModified > entry.indexed)
+            return nullptr;
+    }
+
+    return &entry;
+}
+
+/**
+ * Forgets the modification times of tileset files looked up by
+ * upToDateEntry(), so that changes made since then are noticed.
+ */
+void TileStampIndex::clearFileCache()
+{
+    mLastModifiedCache.clear();
+}
+
+/**
+ * Updates the entry for the given loaded \a stamp, which has just been read
+ * from or written to \a stampFile.
+ */
+void TileStampIndex::update(const TileStamp &stamp, const QFileInfo &stampFile)
+{
+    Entry entry;
+    entry.lastModified = stampFile.lastModified();
+    entry.fileSize = stampFile.size();
+    entry.indexed = QDateTime::currentDateTime();
+    entry.name = stamp.name();
+    entry.quickStampIndex = stamp.quickStampIndex();
+    entry.variationCount = stamp.variationCount();
+    entry.maxSize = stamp.maxSize();
+
+    QSet<QString> tilesetFiles;
+    for (const TileStampVariation &variation : stamp.variations()) {
+        for (const SharedTileset &tileset : variation.map->tilesets()) {
+            if (!tileset->fileName().isEmpty())
+                tilesetFiles.insert(tileset->fileName());
+            if (!tileset->imageSource().isEmpty())
+                tilesetFiles.insert(tileset->imageSource());
+        }
+    }
+    entry.tilesetFiles = tilesetFiles.toList();
+
+    if (!stamp.isEmpty()) {
+        ThumbnailRenderer renderer(stamp.variations().first().map);
+        entry.preview = renderer.render(QSize(64, 64))
+                .scaled(32, 32, Qt::IgnoreAspectRatio, Qt::SmoothTransformation);
+    }
+
+    mEntries.insert(stampFile.fileName(), entry);
+    mModified = true;
+}
+
+void TileStampIndex::rename(const QString &fileName, const QString &newFileName)
+{
+    auto it = mEntries.find(fileName);
+    if (it == mEntries.end())
+        return;
+
+    const Entry entry = it.value();
+    mEntries.erase(it);
+    mEntries.insert(newFileName, entry);
+    mModified = true;
+}
+
+void TileStampIndex::remove(const QString &fileName)
+{
+    if (mEntries.remove(fileName))
+        mModified = true;
+}
+
+/**
+ * The index is stored in the cache location, under a name derived from the
+ * path of the stamps directory.
+ */
+QString TileStampIndex::indexFilePath() const
+{
+    const QByteArray path = mDirectory.absolutePath().toUtf8();
+    const QByteArray hash = QCryptographicHash::hash(path, QCryptographicHash::Sha1);
+
+    const QDir cacheDir(QStandardPaths::writableLocation(QStandardPaths::CacheLocation));
+    return cacheDir.filePath(QLatin1String("stamps/") +
+                             QString::fromLatin1(hash.toHex()) +
+                             QLatin1String(".index"));
+}
+
+QDateTime TileStampIndex::fileLastModified(const QString &filePath) const
+{
+    auto it = mLastModifiedCache.constFind(filePath);
+    if (it != mLastModifiedCache.constEnd())
+        return it.value();
+
+    const QDateTime lastModified = QFileInfo(filePath).lastModified();
+    mLastModifiedCache.insert(filePath, lastModified);
+    return lastModified;
+}
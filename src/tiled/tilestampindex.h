@@ -0,0 +1,100 @@
+/*
+ * tilestampindex.h
+ * Copyright 2016, Tiled contributors
+ *
+ * This file is part of Tiled.
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation; either version 2 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef TILED_INTERNAL_TILESTAMPINDEX_H
+#define TILED_INTERNAL_TILESTAMPINDEX_H
+
+#include <QDateTime>
+#include <QDir>
+#include <QHash>
+#include <QImage>
+#include <QSize>
+#include <QString>
+#include <QStringList>
+
+class QFileInfo;
+
+namespace Tiled {
+namespace Internal {
+
+class TileStamp;
+
+/**
+ * A persistent index of the stamps in a stamps directory. It stores enough
+ * information about each stamp file to list the stamp without loading its
+ * variations.
+ *
+ * The index is stored in the cache location rather than in the stamps
+ * directory, since the latter may be shared or read-only.
+ */
+class TileStampIndex
+{
+public:
+    struct Entry
+    {
+        Entry()
+            : fileSize(0)
+            , quickStampIndex(-1)
+            , variationCount(0)
+        {}
+
+        QDateTime lastModified;     // of the stamp file
+        qint64 fileSize;
+        QDateTime indexed;
+        QString name;
+        int quickStampIndex;
+        int variationCount;
+        QSize maxSize;
+        QStringList tilesetFiles;   // tileset files and images used
+        QImage preview;
+    };
+
+    explicit TileStampIndex(const QString &stampsDirectory);
+
+    const QDir &directory() const { return mDirectory; }
+
+    bool load();
+    bool save();
+
+    bool isModified() const { return mModified; }
+
+    const Entry *upToDateEntry(const QFileInfo &stampFile) const;
+    void clearFileCache();
+    QStringList fileNames() const { return mEntries.keys(); }
+
+    void update(const TileStamp &stamp, const QFileInfo &stampFile);
+    void rename(const QString &fileName, const QString &newFileName);
+    void remove(const QString &fileName);
+
+private:
+    QString indexFilePath() const;
+    QDateTime fileLastModified(const QString &filePath) const;
+
+    QDir mDirectory;
+    QHash<QString, Entry> mEntries;
+    bool mModified;
+
+    mutable QHash<QString, QDateTime> mLastModifiedCache;
+};
+
+} // namespace Internal
+} // namespace Tiled
+
+#endif // TILED_INTERNAL_TILESTAMPINDEX_H
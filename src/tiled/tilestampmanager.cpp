@@ -24,6 +24,7 @@
 #include "abstracttool.h"
 #include "bucketfilltool.h"
 #include "documentmanager.h"
+#include "filesystemwatcher.h"
 #include "mapdocument.h"
 #include "map.h"
 #include "preferences.h"
@@ -32,14 +33,16 @@
 #include "tileselectiontool.h"
 #include "tileset.h"
 #include "tilesetmanager.h"
+#include "tilestampindex.h"
 #include "tilestampmodel.h"
 #include "toolmanager.h"
 
 #include <QDebug>
-#include <QDirIterator>
+#include <QFileInfo>
 #include <QJsonDocument>
 #include <QRegularExpression>
 #include <QSaveFile>
+#include <QSet>
 
 using namespace Tiled;
 using namespace Tiled::Internal;
@@ -77,6 +80,8 @@ TileStampManager::TileStampManager(const ToolManager &toolManager,
     : QObject(parent)
     , mQuickStamps(quickStampKeys().length())
     , mTileStampModel(new TileStampModel(this))
+    , mWatcher(new FileSystemWatcher(this))
+    , mUpdatingStamps(false)
     , mToolManager(toolManager)
 {
     Preferences *prefs = Preferences::instance();
@@ -84,6 +89,15 @@ TileStampManager::TileStampManager(const ToolManager &toolManager,
     connect(prefs, &Preferences::stampsDirectoryChanged,
             this, &TileStampManager::stampsDirectoryChanged);
 
+    // Several changes are usually made to the directory at once
+    mUpdateStampsTimer.setInterval(500);
+    mUpdateStampsTimer.setSingleShot(true);
+
+    connect(mWatcher, &FileSystemWatcher::directoryChanged,
+            this, &TileStampManager::stampsDirectoryContentsChanged);
+    connect(&mUpdateStampsTimer, &QTimer::timeout,
+            this, &TileStampManager::updateStamps);
+
     connect(mTileStampModel, &TileStampModel::stampAdded,
             this, &TileStampManager::stampAdded);
     connect(mTileStampModel, &TileStampModel::stampRenamed,
@@ -92,6 +106,8 @@ TileStampManager::TileStampManager(const ToolManager &toolManager,
             this, &TileStampManager::saveStamp);
     connect(mTileStampModel, &TileStampModel::stampRemoved,
             this, &TileStampManager::deleteStamp);
+    connect(mTileStampModel, &TileStampModel::stampDropped,
+            this, &TileStampManager::stampDropped);
 
     loadStamps();
 }
@@ -99,6 +115,7 @@ TileStampManager::TileStampManager(const ToolManager &toolManager,
 TileStampManager::~TileStampManager()
 {
     // needs to be over here where the TileStamp type is complete
+    mIndex->save();
 }
 
 static TileStamp stampFromContext(AbstractTool *selectedTool)
@@ -118,12 +135,12 @@ static TileStamp stampFromContext(AbstractTool *selectedTool)
         if (!tileLayer)
             return stamp;
 
-        QRegion selection = mapDocument->selectedArea();
+        SelectionMask selection = mapDocument->selectedArea();
         if (selection.isEmpty())
             return stamp;
 
         selection.translate(-tileLayer->position());
-        QScopedPointer<TileLayer> copy(tileLayer->copy(selection));
+        QScopedPointer<TileLayer> copy(tileLayer->copy(selection.toRegion()));
 
         if (copy->size().isEmpty())
             return stamp;
@@ -171,7 +188,9 @@ void TileStampManager::addVariation(const TileStamp &targetStamp)
 
 void TileStampManager::selectQuickStamp(int index)
 {
-    const TileStamp &stamp = mQuickStamps.at(index);
+    const TileStamp stamp = mQuickStamps.at(index);
+    mTileStampModel->loadStamp(stamp);
+
     if (!stamp.isEmpty())
         emit setStamp(stamp);
 }
@@ -197,9 +216,14 @@ void TileStampManager::extendQuickStamp(int index)
 
 void TileStampManager::stampsDirectoryChanged()
 {
+    mIndex->save();
+    mWatcher->removePath(mIndex->directory().path());
+    mUpdateStampsTimer.stop();
+
     // erase current stamps
     mQuickStamps.fill(TileStamp());
     mStampsByName.clear();
+    mStampsByFileName.clear();
     mTileStampModel->clear();
 
     loadStamps();
@@ -231,44 +255,101 @@ void TileStampManager::setQuickStamp(int index, TileStamp stamp)
 void TileStampManager::loadStamps()
 {
     const Preferences *prefs = Preferences::instance();
-    const QString stampsDirectory = prefs->stampsDirectory();
-    const QDir stampsDir(stampsDirectory);
 
-    QDirIterator iterator(stampsDirectory,
-                          QStringList() << QLatin1String("*.stamp"),
-                          QDir::Files | QDir::Readable);
-    while (iterator.hasNext()) {
-        const QString &stampFileName = iterator.next();
+    mIndex.reset(new TileStampIndex(prefs->stampsDirectory()));
+    mIndex->load();
 
-        QFile stampFile(stampFileName);
-        if (!stampFile.open(QIODevice::ReadOnly))
-            continue;
+    mWatcher->addPath(mIndex->directory().path());
+
+    updateStamps();
+    mIndex->save();
+}
+
+/**
+ * Removes the given \a stamp without deleting its file.
+ */
+void TileStampManager::forgetStamp(const TileStamp &stamp)
+{
+    for (TileStamp &quickStamp : mQuickStamps)
+        if (quickStamp == stamp)
+            quickStamp = TileStamp();
+
+    mTileStampModel->removeStamp(stamp);
+}
+
+/**
+ * Synchronizes the stamps with the files in the stamps directory. Only new
+ * and changed files are read. Stamps for files that are up to date in the
+ * index are added without loading their variations.
+ */
+void TileStampManager::updateStamps()
+{
+    const QFileInfoList stampFiles =
+            mIndex->directory().entryInfoList(QStringList(QLatin1String("*.stamp")),
+                                              QDir::Files | QDir::Readable);
+
+    mUpdatingStamps = true;
+    mIndex->clearFileCache();
+
+    QSet<QString> fileNames;
 
-        QByteArray data = stampFile.readAll();
+    for (const QFileInfo &stampFile : stampFiles) {
+        const QString fileName = stampFile.fileName();
+        fileNames.insert(fileName);
 
-        QJsonDocument document = QJsonDocument::fromBinaryData(data);
-        if (document.isNull()) {
-            // document not valid binary data, maybe it's an JSON text file
-            QJsonParseError error;
-            document = QJsonDocument::fromJson(data, &error);
-            if (error.error != QJsonParseError::NoError) {
-                qDebug() << "Failed to parse stamp file:" << qPrintable(error.errorString());
+        const TileStampIndex::Entry *entry = mIndex->upToDateEntry(stampFile);
+
+        if (mStampsByFileName.contains(fileName)) {
+            if (entry)
                 continue;
-            }
+
+            // The file was changed by another application
+            forgetStamp(mStampsByFileName.value(fileName));
+        }
+
+        TileStamp stamp;
+
+        if (entry) {
+            stamp.setName(entry->name);
+            stamp.setFileName(fileName);
+            stamp.setQuickStampIndex(entry->quickStampIndex);
+            stamp.setDeferred(stampFile.filePath(),
+                              entry->variationCount,
+                              entry->maxSize,
+                              QPixmap::fromImage(entry->preview));
+        } else {
+            stamp = TileStamp::fromFile(stampFile.filePath());
+
+            // Also index files without a valid stamp, to skip them next time
+            mIndex->update(stamp, stampFile);
         }
 
-        TileStamp stamp = TileStamp::fromJson(document.object(), stampsDir);
         if (stamp.isEmpty())
             continue;
 
-        stamp.setFileName(iterator.fileInfo().fileName());
-
         mTileStampModel->addStamp(stamp);
 
         int index = stamp.quickStampIndex();
         if (index >= 0 && index < mQuickStamps.size())
             mQuickStamps[index] = stamp;
     }
+
+    // Forget about stamps of which the file was removed
+    const QList<TileStamp> stamps = mStampsByFileName.values();
+    for (const TileStamp &stamp : stamps)
+        if (!fileNames.contains(stamp.fileName()))
+            forgetStamp(stamp);
+
+    for (const QString &fileName : mIndex->fileNames())
+        if (!fileNames.contains(fileName))
+            mIndex->remove(fileName);
+
+    mUpdatingStamps = false;
+}
+
+void TileStampManager::stampsDirectoryContentsChanged()
+{
+    mUpdateStampsTimer.start();
 }
 
 void TileStampManager::stampAdded(TileStamp stamp)
@@ -291,6 +372,8 @@ void TileStampManager::stampAdded(TileStamp stamp)
         stamp.setFileName(findStampFileName(stamp.name()));
         saveStamp(stamp);
     }
+
+    mStampsByFileName.insert(stamp.fileName(), stamp);
 }
 
 void TileStampManager::stampRenamed(TileStamp stamp)
@@ -303,9 +386,16 @@ void TileStampManager::stampRenamed(TileStamp stamp)
     QString newFileName = findStampFileName(stamp.name(), existingFileName);
 
     if (existingFileName != newFileName) {
+        // A deferred stamp needs to be loaded before its file is moved
+        stamp.load();
+
         if (QFile::rename(stampFilePath(existingFileName),
                           stampFilePath(newFileName))) {
             stamp.setFileName(newFileName);
+
+            mStampsByFileName.remove(existingFileName);
+            mStampsByFileName.insert(newFileName, stamp);
+            mIndex->rename(existingFileName, newFileName);
         }
     }
 }
@@ -319,9 +409,14 @@ void TileStampManager::saveStamp(const TileStamp &stamp)
     const QString stampsDirectory(prefs->stampsDirectory());
     QDir stampsDir(stampsDirectory);
 
-    if (!stampsDir.exists() && !stampsDir.mkpath(QLatin1String("."))) {
-        qDebug() << "Failed to create stamps directory" << stampsDirectory;
-        return;
+    if (!stampsDir.exists()) {
+        if (!stampsDir.mkpath(QLatin1String("."))) {
+            qDebug() << "Failed to create stamps directory" << stampsDirectory;
+            return;
+        }
+
+        // The directory could not be watched while it didn't exist
+        mWatcher->addPath(stampsDir.path());
     }
 
     QString filePath = stampsDir.filePath(stamp.fileName());
@@ -334,8 +429,29 @@ void TileStampManager::saveStamp(const TileStamp &stamp)
     QJsonObject stampJson = stamp.toJson(QFileInfo(filePath).dir());
     file.write(QJsonDocument(stampJson).toJson(QJsonDocument::Compact));
 
-    if (!file.commit())
+    if (!file.commit()) {
         qDebug() << "Failed to write stamp" << filePath;
+        return;
+    }
+
+    // Keep the index up to date, so the file is not read again
+    mIndex->update(stamp, QFileInfo(filePath));
+}
+
+/**
+ * Forgets about a \a stamp of which the file turned out to have no variations.
+ * The file is kept, but indexed as empty so that it is skipped from now on.
+ */
+void TileStampManager::stampDropped(const TileStamp &stamp)
+{
+    for (TileStamp &quickStamp : mQuickStamps)
+        if (quickStamp == stamp)
+            quickStamp = TileStamp();
+
+    mStampsByName.remove(stamp.name());
+    mStampsByFileName.remove(stamp.fileName());
+
+    mIndex->update(stamp, QFileInfo(stampFilePath(stamp.fileName())));
 }
 
 void TileStampManager::deleteStamp(const TileStamp &stamp)
@@ -343,5 +459,13 @@ void TileStampManager::deleteStamp(const TileStamp &stamp)
     Q_ASSERT(!stamp.fileName().isEmpty());
 
     mStampsByName.remove(stamp.name());
+    mStampsByFileName.remove(stamp.fileName());
+
+    // Stamps are also removed when their file was changed or removed by
+    // another application
+    if (mUpdatingStamps)
+        return;
+
     QFile::remove(stampFilePath(stamp.fileName()));
+    mIndex->remove(stamp.fileName());
 }
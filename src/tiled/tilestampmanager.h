@@ -24,10 +24,14 @@
 
 #include "tilestamp.h"
 
+#include <QHash>
 #include <QMap>
 #include <QObject>
+#include <QTimer>
 #include <QVector>
 
+#include <memory>
+
 namespace Tiled {
 
 class Map;
@@ -35,8 +39,10 @@ class TileLayer;
 
 namespace Internal {
 
+class FileSystemWatcher;
 class MapDocument;
 class TileStamp;
+class TileStampIndex;
 class TileStampModel;
 class ToolManager;
 
@@ -44,6 +50,10 @@ class ToolManager;
  * Implements a manager which handles lots of copy&paste slots.
  * Ctrl + <1..9> will store tile layers, and just <1..9> will recall these
  * tile layers.
+ *
+ * Stamps are listed from a TileStampIndex, and their variations are only
+ * loaded when needed. The stamps directory is watched, so that stamps added
+ * or removed by other applications are picked up.
  */
 class TileStampManager : public QObject
 {
@@ -77,17 +87,27 @@ private:
     void setQuickStamp(int index, TileStamp stamp);
 
     void loadStamps();
+    void forgetStamp(const TileStamp &stamp);
 
 private slots:
+    void updateStamps();
+    void stampsDirectoryContentsChanged();
+
     void stampAdded(TileStamp stamp);
     void stampRenamed(TileStamp stamp);
     void saveStamp(const TileStamp &stamp);
+    void stampDropped(const TileStamp &stamp);
     void deleteStamp(const TileStamp &stamp);
 
 private:
     QVector<TileStamp> mQuickStamps;
     QMap<QString, TileStamp> mStampsByName;
+    QHash<QString, TileStamp> mStampsByFileName;
     TileStampModel *mTileStampModel;
+    std::unique_ptr<TileStampIndex> mIndex;
+    FileSystemWatcher *mWatcher;
+    QTimer mUpdateStampsTimer;
+    bool mUpdatingStamps;
 
     const ToolManager &mToolManager;
 };
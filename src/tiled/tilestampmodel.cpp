@@ -57,7 +57,7 @@ int TileStampModel::rowCount(const QModelIndex &parent) const
         return mStamps.size();
     } else if (isStamp(parent)) {
         const TileStamp &stamp = mStamps.at(parent.row());
-        const int count = stamp.variations().size();
+        const int count = stamp.variationCount();
         // it does not make much sense to expand single variations
         return count == 1 ? 0 : count;
     }
@@ -89,6 +89,14 @@ bool TileStampModel::setData(const QModelIndex &index, const QVariant &value, in
         if (index.column() == 0) {      // stamp name
             switch (role) {
             case Qt::EditRole:
+                // Renaming saves the stamp, which requires its variations
+                if (!stamp.isLoaded()) {
+                    const TileStamp loadedStamp = stamp;
+                    loadStamp(loadedStamp);
+                    if (loadedStamp.isEmpty())
+                        return false;
+                }
+
                 stamp.setName(value.toString());
                 emit dataChanged(index, index);
                 emit stampRenamed(stamp);
@@ -101,7 +109,7 @@ bool TileStampModel::setData(const QModelIndex &index, const QVariant &value, in
         }
     } else if (index.column() == 1) {   // variation probability
         QModelIndex parent = index.parent();
-        if (isStamp(parent)) {
+        if (variationAt(index)) {
             TileStamp &stamp = mStamps[parent.row()];
             stamp.setProbability(index.row(), value.toReal());
             emit dataChanged(index, index);
@@ -135,6 +143,12 @@ QVariant TileStampModel::data(const QModelIndex &index, int role) const
             case Qt::EditRole:
                 return stamp.name();
             case Qt::DecorationRole: {
+                // Avoid loading stamps just to display them
+                if (!stamp.isLoaded())
+                    return stamp.preview();
+                if (stamp.isEmpty())
+                    return QVariant();
+
                 Map *map = stamp.variations().first().map;
                 QPixmap thumbnail = mThumbnailCache.value(map);
                 if (thumbnail.isNull()) {
@@ -148,7 +162,10 @@ QVariant TileStampModel::data(const QModelIndex &index, int role) const
         } else if (index.column() == 1) {   // sum of probabilities
             switch (role) {
             case Qt::DisplayRole:
-                if (stamp.variations().size() > 1) {
+                if (!stamp.isLoaded()) {
+                    if (stamp.variationCount() > 1)
+                        requestLoad(stamp);
+                } else if (stamp.variationCount() > 1) {
                     qreal sum = 0;
                     for (const TileStampVariation &variation : stamp.variations())
                         sum += variation.probability;
@@ -197,6 +214,8 @@ bool TileStampModel::removeRows(int row, int count, const QModelIndex &parent)
     if (parent.isValid()) {
         // removing variations
         TileStamp &stamp = mStamps[parent.row()];
+        if (!stamp.isLoaded() || row + count > stamp.variationCount())
+            return false;
 
         // if only one variation is left, we make all variation rows disappear
         if (stamp.variations().size() - count == 1)
@@ -230,8 +249,9 @@ bool TileStampModel::removeRows(int row, int count, const QModelIndex &parent)
         // removing stamps
         beginRemoveRows(parent, row, row + count - 1);
         for (; count > 0; --count) {
-            for (const TileStampVariation &variation : mStamps.at(row).variations())
-                mThumbnailCache.remove(variation.map);
+            if (mStamps.at(row).isLoaded())
+                for (const TileStampVariation &variation : mStamps.at(row).variations())
+                    mThumbnailCache.remove(variation.map);
             emit stampRemoved(mStamps.at(row));
             mStamps.removeAt(row);
         }
@@ -264,7 +284,16 @@ const TileStampVariation *TileStampModel::variationAt(const QModelIndex &index)
     QModelIndex parent = index.parent();
     if (isStamp(parent)) {
         const TileStamp &stamp = mStamps.at(parent.row());
-        return &stamp.variations().at(index.row());
+
+        // Variations are only known once the stamp is loaded, after which
+        // their number may turn out to be different from what was indexed
+        if (!stamp.isLoaded()) {
+            requestLoad(stamp);
+            return nullptr;
+        }
+
+        if (index.row() < stamp.variationCount())
+            return &stamp.variations().at(index.row());
     }
 
     return nullptr;
@@ -291,8 +320,9 @@ void TileStampModel::removeStamp(const TileStamp &stamp)
     mStamps.removeAt(index);
     endRemoveRows();
 
-    for (const TileStampVariation &variation : stamp.variations())
-        mThumbnailCache.remove(variation.map);
+    if (stamp.isLoaded())
+        for (const TileStampVariation &variation : stamp.variations())
+            mThumbnailCache.remove(variation.map);
 
     emit stampRemoved(stamp);
 }
@@ -300,6 +330,8 @@ void TileStampModel::removeStamp(const TileStamp &stamp)
 void TileStampModel::addVariation(const TileStamp &stamp,
                                   const TileStampVariation &variation)
 {
+    loadStamp(stamp);
+
     int index = mStamps.indexOf(stamp);
     if (index == -1)
         return;
@@ -321,13 +353,76 @@ void TileStampModel::addVariation(const TileStamp &stamp,
     emit stampChanged(stamp);
 }
 
+/**
+ * Loads the variations of the given \a stamp, when they were deferred.
+ *
+ * The stamp file may contain a different number of variations than the index
+ * reported, in which case the model is reset. A stamp that turns out to have
+ * no variations is removed and stampDropped is emitted.
+ */
+void TileStampModel::loadStamp(TileStamp stamp)
+{
+    if (stamp.isLoaded())
+        return;
+
+    const int deferredCount = stamp.variationCount();
+    stamp.load();
+
+    const int row = mStamps.indexOf(stamp);
+    if (row == -1)
+        return;
+
+    if (stamp.isEmpty()) {
+        beginRemoveRows(QModelIndex(), row, row);
+        mStamps.removeAt(row);
+        endRemoveRows();
+
+        emit stampDropped(stamp);
+    } else if (stamp.variationCount() != deferredCount) {
+        beginResetModel();
+        endResetModel();
+    } else {
+        // The preview is replaced by a thumbnail
+        emit dataChanged(index(row, 0), index(row, 1));
+    }
+}
+
 void TileStampModel::clear()
 {
     beginResetModel();
     mStamps.clear();
     mThumbnailCache.clear();
+    mStampsToLoad.clear();
     endResetModel();
 }
 
+/**
+ * Schedules loading of the given \a stamp. This is used where the model can't
+ * change right away, like while the views are querying it.
+ */
+void TileStampModel::requestLoad(const TileStamp &stamp) const
+{
+    if (mStampsToLoad.contains(stamp))
+        return;
+
+    if (mStampsToLoad.isEmpty()) {
+        QMetaObject::invokeMethod(const_cast<TileStampModel*>(this),
+                                  "loadRequestedStamps",
+                                  Qt::QueuedConnection);
+    }
+
+    mStampsToLoad.append(stamp);
+}
+
+void TileStampModel::loadRequestedStamps()
+{
+    const QList<TileStamp> stamps = mStampsToLoad;
+    mStampsToLoad.clear();
+
+    for (const TileStamp &stamp : stamps)
+        if (mStamps.contains(stamp))
+            loadStamp(stamp);
+}
+
 } // namespace Internal
 } // namespace Tiled
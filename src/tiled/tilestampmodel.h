@@ -78,6 +78,8 @@ public:
     void addVariation(const TileStamp &stamp,
                       const TileStampVariation &variation);
 
+    void loadStamp(TileStamp stamp);
+
     void clear();
 
 signals:
@@ -86,10 +88,22 @@ signals:
     void stampChanged(const TileStamp &stamp);
     void stampRemoved(const TileStamp &stamp);
 
+    /**
+     * Emitted when a stamp was removed because its file turned out to have
+     * no variations. Unlike with stampRemoved, its file should be kept.
+     */
+    void stampDropped(const TileStamp &stamp);
+
+private slots:
+    void loadRequestedStamps();
+
 private:
+    void requestLoad(const TileStamp &stamp) const;
+
     QList<TileStamp> mStamps;
 
     mutable QHash<Map *, QPixmap> mThumbnailCache;
+    mutable QList<TileStamp> mStampsToLoad;
 };
 
 
@@ -173,7 +173,11 @@ void TileStampsDock::currentRowChanged(const QModelIndex &index)
     mAddVariation->setEnabled(isStamp);
 
     if (isStamp) {
-        emit setStamp(mTileStampModel->stampAt(sourceIndex));
+        const TileStamp stamp = mTileStampModel->stampAt(sourceIndex);
+        mTileStampModel->loadStamp(stamp);
+
+        if (!stamp.isEmpty())
+            emit setStamp(stamp);
     } else if (const TileStampVariation *variation = mTileStampModel->variationAt(sourceIndex)) {
         // single variation clicked, use it specifically
         emit setStamp(TileStamp(new Map(*variation->map)));
@@ -251,6 +255,10 @@ void TileStampsDock::duplicate()
         return;
 
     TileStamp stamp = mTileStampModel->stampAt(sourceIndex);
+    mTileStampModel->loadStamp(stamp);
+    if (stamp.isEmpty())
+        return;
+
     mTileStampModel->addStamp(stamp.clone());
 }
 
@@ -264,7 +272,11 @@ void TileStampsDock::addVariation()
     if (!mTileStampModel->isStamp(sourceIndex))
         return;
 
-    const TileStamp &stamp = mTileStampModel->stampAt(sourceIndex);
+    const TileStamp stamp = mTileStampModel->stampAt(sourceIndex);
+    mTileStampModel->loadStamp(stamp);
+    if (stamp.isEmpty())
+        return;
+
     mTileStampManager->addVariation(stamp);
 }
 
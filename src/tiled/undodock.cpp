@@ -21,7 +21,11 @@
 
 #include "undodock.h"
 
+#include "mapdocument.h"
+#include "undomemorymanager.h"
+
 #include <QEvent>
+#include <QLabel>
 #include <QUndoView>
 #include <QVBoxLayout>
 
@@ -30,6 +34,7 @@ using namespace Tiled::Internal;
 
 UndoDock::UndoDock(QUndoGroup *undoGroup, QWidget *parent)
     : QDockWidget(parent)
+    , mMapDocument(nullptr)
 {
     setObjectName(QLatin1String("undoViewDock"));
 
@@ -43,10 +48,34 @@ UndoDock::UndoDock(QUndoGroup *undoGroup, QWidget *parent)
     layout->setMargin(5);
     layout->addWidget(mUndoView);
 
+    mMemoryLabel = new QLabel(widget);
+    layout->addWidget(mMemoryLabel);
+
     setWidget(widget);
     retranslateUi();
 }
 
+void UndoDock::setMapDocument(MapDocument *mapDocument)
+{
+    if (mMapDocument == mapDocument)
+        return;
+
+    if (mMapDocument)
+        mMapDocument->undoMemoryManager()->disconnect(this);
+
+    mMapDocument = mapDocument;
+
+    if (mMapDocument) {
+        UndoMemoryManager *manager = mMapDocument->undoMemoryManager();
+        connect(manager, &UndoMemoryManager::memoryUsageChanged,
+                this, &UndoDock::updateMemoryLabel);
+        connect(manager, &UndoMemoryManager::memoryLimitChanged,
+                this, &UndoDock::updateMemoryLabel);
+    }
+
+    updateMemoryLabel();
+}
+
 void UndoDock::changeEvent(QEvent *e)
 {
     QDockWidget::changeEvent(e);
@@ -63,4 +92,28 @@ void UndoDock::retranslateUi()
 {
     setWindowTitle(tr("History"));
     mUndoView->setEmptyLabel(tr("<empty>"));
+    updateMemoryLabel();
+}
+
+static QString formatMegabytes(qint64 bytes)
+{
+    return UndoDock::tr("%1 MB").arg(bytes / (1024.0 * 1024.0), 0, 'f', 1);
+}
+
+void UndoDock::updateMemoryLabel()
+{
+    if (!mMapDocument) {
+        mMemoryLabel->clear();
+        return;
+    }
+
+    const UndoMemoryManager *manager = mMapDocument->undoMemoryManager();
+    const QString usage = formatMegabytes(manager->memoryUsage());
+
+    if (manager->memoryLimit() > 0) {
+        mMemoryLabel->setText(tr("Memory: %1 of %2").arg(usage,
+                                                        formatMegabytes(manager->memoryLimit())));
+    } else {
+        mMemoryLabel->setText(tr("Memory: %1").arg(usage));
+    }
 }
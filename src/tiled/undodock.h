@@ -24,15 +24,19 @@
 
 #include <QDockWidget>
 
+class QLabel;
 class QUndoGroup;
 class QUndoView;
 
 namespace Tiled {
 namespace Internal {
 
+class MapDocument;
+
 /**
  * A dock widget showing the undo stack. Mainly for debugging, but can also be
- * useful for the user.
+ * useful for the user. It also shows the memory used by the undo history of
+ * the current map.
  */
 class UndoDock : public QDockWidget
 {
@@ -41,12 +45,19 @@ class UndoDock : public QDockWidget
 public:
     UndoDock(QUndoGroup *undoGroup, QWidget *parent = nullptr);
 
+    void setMapDocument(MapDocument *mapDocument);
+
 protected:
     void changeEvent(QEvent *e) override;
 
+private slots:
+    void updateMemoryLabel();
+
 private:
     void retranslateUi();
     QUndoView *mUndoView;
+    QLabel *mMemoryLabel;
+    MapDocument *mMapDocument;
 };
 
 } // namespace Internal
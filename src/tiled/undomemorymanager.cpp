@@ -0,0 +1,218 @@
+/*
+ * undomemorymanager.cpp
+ * Copyright 2016, Tiled contributors
+ *
+ * This file is part of Tiled.
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation; either version 2 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "undomemorymanager.h"
+
+#include "compression.h"
+#include "tilelayer.h"
+
+#include <QUndoStack>
+
+#include <cstring>
+
+using namespace Tiled;
+using namespace Tiled::Internal;
+
+/**
+ * The number of commands around the current undo index that are kept
+ * uncompressed, so that undoing and redoing recent changes stays fast.
+ */
+static const int UncompressedCommandDistance = 16;
+
+MemoryTrackedCommand::MemoryTrackedCommand()
+    : mStackIndex(-1)
+    , mReportedUsage(0)
+    , mDiscarded(false)
+{
+}
+
+
+UndoMemoryManager::UndoMemoryManager(QUndoStack *undoStack, QObject *parent)
+    : QObject(parent)
+    , mUndoStack(undoStack)
+    , mMemoryUsage(0)
+    , mMemoryLimit(0)
+    , mUndoFloor(0)
+{
+    connect(mUndoStack, &QUndoStack::indexChanged,
+            this, &UndoMemoryManager::undoIndexChanged);
+}
+
+void UndoMemoryManager::addCommand(MemoryTrackedCommand *command)
+{
+    // The command will end up at the current index once it is pushed
+    command->mStackIndex = mUndoStack->index();
+    command->mReportedUsage = command->memoryUsage();
+    mCommands.append(command);
+
+    changeMemoryUsage(command->mReportedUsage);
+}
+
+void UndoMemoryManager::removeCommand(MemoryTrackedCommand *command)
+{
+    // Commands are usually removed from the end, hence the reverse search
+    const int index = mCommands.lastIndexOf(command);
+    if (index == -1)
+        return;
+
+    mCommands.removeAt(index);
+    changeMemoryUsage(-command->mReportedUsage);
+}
+
+void UndoMemoryManager::commandChanged(MemoryTrackedCommand *command)
+{
+    if (command->mDiscarded)
+        return;
+
+    const qint64 usage = command->memoryUsage();
+    changeMemoryUsage(usage - command->mReportedUsage);
+    command->mReportedUsage = usage;
+}
+
+void UndoMemoryManager::setMemoryLimit(qint64 bytes)
+{
+    if (mMemoryLimit == bytes)
+        return;
+
+    mMemoryLimit = bytes;
+    emit memoryLimitChanged(mMemoryLimit);
+
+    enforceLimits();
+}
+
+void UndoMemoryManager::undoIndexChanged(int index)
+{
+    // The floor is reset when the undo stack was cleared
+    if (mUndoFloor > mUndoStack->count())
+        mUndoFloor = 0;
+
+    // Don't allow going back to before the discarded commands
+    if (index < mUndoFloor) {
+        mUndoStack->setIndex(mUndoFloor);
+        return;
+    }
+
+    enforceLimits();
+}
+
+void UndoMemoryManager::enforceLimits()
+{
+    const int index = mUndoStack->index();
+
+    for (MemoryTrackedCommand *command : mCommands) {
+        if (qAbs(command->mStackIndex - index) > UncompressedCommandDistance) {
+            command->compress();
+            commandChanged(command);
+        }
+    }
+
+    if (mMemoryLimit <= 0)
+        return;
+
+    // Discard the oldest commands, but always keep the last one undoable
+    while (mMemoryUsage > mMemoryLimit && !mCommands.isEmpty()) {
+        MemoryTrackedCommand *oldest = mCommands.first();
+        if (oldest->mStackIndex >= index - 1)
+            break;
+
+        mUndoFloor = qMax(mUndoFloor, oldest->mStackIndex + 1);
+        discard(oldest);
+    }
+
+    // Other commands before the floor can't be reached anymore either
+    while (!mCommands.isEmpty() && mCommands.first()->mStackIndex < mUndoFloor)
+        discard(mCommands.first());
+}
+
+void UndoMemoryManager::discard(MemoryTrackedCommand *command)
+{
+    removeCommand(command);
+    command->discard();
+    command->mDiscarded = true;
+    command->mReportedUsage = 0;
+}
+
+void UndoMemoryManager::changeMemoryUsage(qint64 bytes)
+{
+    if (bytes == 0)
+        return;
+
+    mMemoryUsage += bytes;
+    emit memoryUsageChanged(mMemoryUsage);
+}
+
+
+void CompressedLayerData::compress(Layer *layer)
+{
+    if (isCompressed() || !layer || !layer->isTileLayer())
+        return;
+
+    TileLayer *tileLayer = static_cast<TileLayer*>(layer);
+    const QSize size = tileLayer->size();
+    if (size.isEmpty())
+        return;
+
+    const int byteCount = size.width() * size.height() * sizeof(Cell);
+    const QByteArray cells(reinterpret_cast<const char*>(&*tileLayer->begin()),
+                           byteCount);
+
+    mData = Tiled::compress(cells, Zlib);
+    if (mData.isNull())
+        return;
+
+    mSize = size;
+    tileLayer->resize(QSize(0, 0), QPoint());
+}
+
+void CompressedLayerData::uncompress(Layer *layer)
+{
+    if (!isCompressed())
+        return;
+
+    TileLayer *tileLayer = static_cast<TileLayer*>(layer);
+    const int byteCount = mSize.width() * mSize.height() * sizeof(Cell);
+    const QByteArray cells = decompress(mData, byteCount);
+
+    tileLayer->resize(mSize, QPoint());
+
+    Q_ASSERT(cells.size() == byteCount);
+    if (cells.size() == byteCount)
+        std::memcpy(&*tileLayer->begin(), cells.constData(), byteCount);
+
+    mData = QByteArray();
+}
+
+void CompressedLayerData::clear()
+{
+    mData = QByteArray();
+    mSize = QSize();
+}
+
+qint64 CompressedLayerData::memoryUsage(const Layer *layer) const
+{
+    if (isCompressed())
+        return mData.size();
+
+    if (!layer || !layer->isTileLayer())
+        return 0;
+
+    const QSize size = layer->size();
+    return qint64(size.width()) * size.height() * sizeof(Cell);
+}
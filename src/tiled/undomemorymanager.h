@@ -0,0 +1,180 @@
+/*
+ * undomemorymanager.h
+ * Copyright 2016, Tiled contributors
+ *
+ * This file is part of Tiled.
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation; either version 2 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef UNDOMEMORYMANAGER_H
+#define UNDOMEMORYMANAGER_H
+
+#include <QByteArray>
+#include <QList>
+#include <QObject>
+#include <QSize>
+
+class QUndoStack;
+
+namespace Tiled {
+
+class Layer;
+
+namespace Internal {
+
+/**
+ * Interface for undo commands that keep larger amounts of data around. These
+ * commands register themselves with the UndoMemoryManager of their document,
+ * which can ask them to compress or to discard their data.
+ */
+class MemoryTrackedCommand
+{
+public:
+    MemoryTrackedCommand();
+    virtual ~MemoryTrackedCommand() {}
+
+    /**
+     * Returns the approximate amount of memory in bytes used by this command.
+     */
+    virtual qint64 memoryUsage() const = 0;
+
+    /**
+     * Compresses the data kept by this command. The data should be
+     * uncompressed again transparently when the command is undone or redone.
+     */
+    virtual void compress() = 0;
+
+    /**
+     * Frees the data kept by this command. The command is not undone or
+     * redone after this.
+     */
+    virtual void discard() = 0;
+
+    /**
+     * Returns whether the data of this command has been discarded.
+     */
+    bool isDiscarded() const { return mDiscarded; }
+
+private:
+    friend class UndoMemoryManager;
+
+    int mStackIndex;
+    qint64 mReportedUsage;
+    bool mDiscarded;
+};
+
+
+/**
+ * Keeps track of the memory used by the commands on an undo stack.
+ *
+ * Commands further away from the current index than a certain threshold are
+ * compressed. When a memory limit is set and it is exceeded, the data of the
+ * oldest commands is discarded and the undo stack is not allowed to go back
+ * beyond those commands anymore.
+ */
+class UndoMemoryManager : public QObject
+{
+    Q_OBJECT
+
+public:
+    UndoMemoryManager(QUndoStack *undoStack, QObject *parent = nullptr);
+
+    /**
+     * Registers the given \a command. Should be called when constructing the
+     * command, before it is pushed on the undo stack.
+     */
+    void addCommand(MemoryTrackedCommand *command);
+
+    /**
+     * Unregisters the given \a command. Should be called from its destructor.
+     */
+    void removeCommand(MemoryTrackedCommand *command);
+
+    /**
+     * Should be called when the memory usage of the given \a command changed.
+     */
+    void commandChanged(MemoryTrackedCommand *command);
+
+    /**
+     * Returns the approximate amount of memory in bytes used by the
+     * registered commands.
+     */
+    qint64 memoryUsage() const { return mMemoryUsage; }
+
+    /**
+     * Returns the memory limit in bytes, or 0 when there is no limit.
+     */
+    qint64 memoryLimit() const { return mMemoryLimit; }
+    void setMemoryLimit(qint64 bytes);
+
+signals:
+    void memoryUsageChanged(qint64 bytes);
+    void memoryLimitChanged(qint64 bytes);
+
+private slots:
+    void undoIndexChanged(int index);
+
+private:
+    void enforceLimits();
+    void discard(MemoryTrackedCommand *command);
+    void changeMemoryUsage(qint64 bytes);
+
+    QUndoStack *mUndoStack;
+    QList<MemoryTrackedCommand*> mCommands;     // Ordered from oldest to newest
+    qint64 mMemoryUsage;
+    qint64 mMemoryLimit;
+    int mUndoFloor;
+};
+
+
+/**
+ * Helps undo commands compressing the cells of a tile layer that is not part
+ * of the map. Other types of layers are left alone.
+ */
+class CompressedLayerData
+{
+public:
+    bool isCompressed() const { return !mData.isNull(); }
+
+    /**
+     * Compresses the cells of \a layer, which is left empty.
+     */
+    void compress(Layer *layer);
+
+    /**
+     * Restores the cells of \a layer, if they were compressed.
+     */
+    void uncompress(Layer *layer);
+
+    /**
+     * Frees the compressed cells, for when the layer is discarded.
+     */
+    void clear();
+
+    /**
+     * Returns the approximate amount of memory in bytes used by \a layer,
+     * taking into account whether it was compressed.
+     */
+    qint64 memoryUsage(const Layer *layer) const;
+
+private:
+    QByteArray mData;
+    QSize mSize;
+};
+
+} // namespace Internal
+} // namespace Tiled
+
+#endif // UNDOMEMORYMANAGER_H
@@ -0,0 +1,254 @@
+/*
+ * main.cpp
+ * Copyright 2016, Tiled contributors
+ *
+ * This file is part of the TMX Converter.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *    1. Redistributions of source code must retain the above copyright notice,
+ *       this list of conditions and the following disclaimer.
+ *
+ *    2. Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE CONTRIBUTORS ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO
+ * EVENT SHALL THE CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ * OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+ * ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "tmxconverter.h"
+
+#include "mapformat.h"
+#include "pluginmanager.h"
+
+#include <QDebug>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QGuiApplication>
+#include <QStringList>
+#include <QTextStream>
+
+using namespace Tiled;
+
+namespace {
+
+struct CommandLineOptions {
+    CommandLineOptions()
+        : showHelp(false)
+        , showVersion(false)
+        , showExportFormats(false)
+        , quiet(false)
+        , jobCount(0)
+    {}
+
+    bool showHelp;
+    bool showVersion;
+    bool showExportFormats;
+    bool quiet;
+    int jobCount;
+    QString format;
+    QStringList manifests;
+    QStringList files;
+};
+
+} // anonymous namespace
+
+static void showHelp()
+{
+    qWarning() <<
+            "Usage:\n"
+            "  tmxconverter [options] [input file] [output file]...\n"
+            "\n"
+            "Options:\n"
+            "  -h --help               : Display this help\n"
+            "  -v --version            : Display the version\n"
+            "  -j --jobs COUNT         : The number of maps converted in parallel\n"
+            "                            (default: the number of processor cores)\n"
+            "  -f --format FORMAT      : The format to export to (see --export-formats)\n"
+            "                            (default: based on the output file extension)\n"
+            "  -m --manifest FILE      : Read pairs of input and output files from FILE,\n"
+            "                            one pair per line, separated by a tab\n"
+            "                            Can be repeated to read multiple manifests\n"
+            "  -q --quiet              : Do not report the time taken by each conversion\n"
+            "     --export-formats     : Print a list of supported export formats\n";
+}
+
+static void showVersion()
+{
+    qWarning() << "TMX Map Converter"
+            << qPrintable(QCoreApplication::applicationVersion());
+}
+
+static void showExportFormats()
+{
+    qWarning() << "Export formats:";
+    qWarning() << "  tmx";
+    for (MapFormat *format : PluginManager::objects<MapFormat>()) {
+        if (format->hasCapabilities(MapFormat::Write))
+            qWarning() << " " << format->nameFilter();
+    }
+}
+
+static void parseCommandLineArguments(CommandLineOptions &options)
+{
+    const QStringList arguments = QCoreApplication::arguments();
+
+    for (int i = 1; i < arguments.size(); ++i) {
+        const QString &arg = arguments.at(i);
+        if (arg == QLatin1String("--help") || arg == QLatin1String("-h")) {
+            options.showHelp = true;
+        } else if (arg == QLatin1String("--version")
+                || arg == QLatin1String("-v")) {
+            options.showVersion = true;
+        } else if (arg == QLatin1String("--jobs")
+                || arg == QLatin1String("-j")) {
+            i++;
+            if (i >= arguments.size()) {
+                options.showHelp = true;
+            } else {
+                bool jobCountIsInt;
+                options.jobCount = arguments.at(i).toInt(&jobCountIsInt);
+                if (!jobCountIsInt || options.jobCount < 1) {
+                    qWarning() << arguments.at(i) << ": the specified job count is not a positive integer.";
+                    options.showHelp = true;
+                }
+            }
+        } else if (arg == QLatin1String("--format")
+                || arg == QLatin1String("-f")) {
+            i++;
+            if (i >= arguments.size())
+                options.showHelp = true;
+            else
+                options.format = arguments.at(i);
+        } else if (arg == QLatin1String("--manifest")
+                || arg == QLatin1String("-m")) {
+            i++;
+            if (i >= arguments.size())
+                options.showHelp = true;
+            else
+                options.manifests.append(arguments.at(i));
+        } else if (arg == QLatin1String("--quiet")
+                || arg == QLatin1String("-q")) {
+            options.quiet = true;
+        } else if (arg == QLatin1String("--export-formats")) {
+            options.showExportFormats = true;
+        } else if (arg.isEmpty()) {
+            options.showHelp = true;
+        } else if (arg.at(0) == QLatin1Char('-')) {
+            qWarning() << "Unknown option" << arg;
+            options.showHelp = true;
+        } else {
+            options.files.append(arg);
+        }
+    }
+
+    // Files are given as pairs of input and output file
+    if (options.files.size() % 2 != 0)
+        options.showHelp = true;
+}
+
+/**
+ * Reads the conversions listed in the manifest \a fileName. Relative paths
+ * are resolved against the directory of the manifest. Empty lines and lines
+ * starting with '#' are ignored.
+ */
+static bool readManifest(const QString &fileName,
+                         QVector<Conversion> &conversions)
+{
+    QFile file(fileName);
+    if (!file.open(QIODevice::ReadOnly | QIODevice::Text)) {
+        qWarning() << qPrintable(QString(QLatin1String("Failed to open manifest %1: %2"))
+                                 .arg(fileName, file.errorString()));
+        return false;
+    }
+
+    const QDir dir = QFileInfo(fileName).absoluteDir();
+    QTextStream stream(&file);
+    stream.setCodec("UTF-8");
+
+    int lineNumber = 0;
+    while (!stream.atEnd()) {
+        const QString line = stream.readLine().trimmed();
+        ++lineNumber;
+
+        if (line.isEmpty() || line.startsWith(QLatin1Char('#')))
+            continue;
+
+        const QStringList files = line.split(QLatin1Char('\t'), QString::SkipEmptyParts);
+        if (files.size() != 2) {
+            qWarning() << qPrintable(QString(QLatin1String("%1:%2: expected an input and an output file separated by a tab"))
+                                     .arg(fileName).arg(lineNumber));
+            return false;
+        }
+
+        conversions.append(Conversion(dir.filePath(files.at(0).trimmed()),
+                                      dir.filePath(files.at(1).trimmed())));
+    }
+
+    return true;
+}
+
+int main(int argc, char *argv[])
+{
+    // Don't require a display, since no windows are ever shown
+    if (qgetenv("QT_QPA_PLATFORM").isEmpty())
+        qputenv("QT_QPA_PLATFORM", "offscreen");
+
+    QGuiApplication a(argc, argv);
+
+    a.setOrganizationDomain(QLatin1String("mapeditor.org"));
+    a.setApplicationName(QLatin1String("TmxConverter"));
+    a.setApplicationVersion(QLatin1String("1.0"));
+
+    CommandLineOptions options;
+    parseCommandLineArguments(options);
+
+    if (options.showVersion) {
+        showVersion();
+        return 0;
+    }
+    if (options.showHelp) {
+        showHelp();
+        return 0;
+    }
+
+    // Plugins are loaded once, for all conversions
+    PluginManager::instance()->loadPlugins();
+
+    if (options.showExportFormats) {
+        showExportFormats();
+        return 0;
+    }
+
+    QVector<Conversion> conversions;
+    for (int i = 0; i < options.files.size(); i += 2)
+        conversions.append(Conversion(options.files.at(i), options.files.at(i + 1)));
+
+    for (const QString &manifest : options.manifests)
+        if (!readManifest(manifest, conversions))
+            return 1;
+
+    if (conversions.isEmpty()) {
+        showHelp();
+        return 0;
+    }
+
+    TmxConverter converter;
+    if (options.jobCount > 0)
+        converter.setJobCount(options.jobCount);
+    converter.setFormatFilter(options.format);
+    converter.setReportTimings(!options.quiet);
+
+    return converter.convert(conversions) == 0 ? 0 : 1;
+}
@@ -0,0 +1,377 @@
+/*
+ * tmxconverter.cpp
+ * Copyright 2016, Tiled contributors
+ *
+ * This file is part of the TMX Converter.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *    1. Redistributions of source code must retain the above copyright notice,
+ *       this list of conditions and the following disclaimer.
+ *
+ *    2. Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE CONTRIBUTORS ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO
+ * EVENT SHALL THE CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ * OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+ * ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "tmxconverter.h"
+
+#include "map.h"
+#include "mapformat.h"
+#include "mapreader.h"
+#include "mapwriter.h"
+#include "pluginmanager.h"
+#include "tilesetformat.h"
+
+#include <QDebug>
+#include <QElapsedTimer>
+#include <QFileInfo>
+#include <QRunnable>
+#include <QThread>
+#include <QThreadPool>
+
+#include <cstdio>
+
+using namespace Tiled;
+
+namespace {
+
+/**
+ * A map reader that takes external tilesets from the converter's cache.
+ */
+class CachingMapReader : public MapReader
+{
+public:
+    CachingMapReader(TmxConverter &converter)
+        : mConverter(converter)
+    {}
+
+protected:
+    SharedTileset readExternalTileset(const QString &source,
+                                      QString *error) override
+    {
+        return mConverter.tileset(source, error);
+    }
+
+private:
+    TmxConverter &mConverter;
+};
+
+class ConversionTask : public QRunnable
+{
+public:
+    ConversionTask(const std::function<void()> &function)
+        : mFunction(function)
+    {}
+
+    void run() override { mFunction(); }
+
+private:
+    std::function<void()> mFunction;
+};
+
+bool isTmxFile(const QString &fileName)
+{
+    return QFileInfo(fileName).suffix().compare(QLatin1String("tmx"),
+                                                Qt::CaseInsensitive) == 0;
+}
+
+} // anonymous namespace
+
+
+TmxConverter::TmxConverter()
+    : mJobCount(QThread::idealThreadCount())
+    , mReportTimings(true)
+    , mRunningJobs(0)
+    , mFailedJobs(0)
+    , mOutput(stdout)
+{
+}
+
+int TmxConverter::convert(const QVector<Conversion> &conversions)
+{
+    mMapFormats = PluginManager::objects<MapFormat>();
+    mFailedJobs = 0;
+
+    QElapsedTimer timer;
+    timer.start();
+
+    QThreadPool pool;
+    pool.setMaxThreadCount(qMax(1, mJobCount));
+
+    for (const Conversion &conversion : conversions) {
+        Job job;
+        job.conversion = conversion;
+
+        QString error;
+        if (!resolveFormats(job, &error)) {
+            report(conversion, error, 0);
+            continue;
+        }
+
+        mMutex.lock();
+        ++mRunningJobs;
+        mMutex.unlock();
+
+        pool.start(new ConversionTask([this, job] { run(job); }));
+    }
+
+    // Serve the calls into plugins until all jobs are done
+    QMutexLocker locker(&mMutex);
+    for (;;) {
+        while (!mMainThreadCalls.isEmpty()) {
+            MainThreadCall *call = mMainThreadCalls.takeFirst();
+
+            locker.unlock();
+            call->function();
+            locker.relock();
+
+            call->done = true;
+            mCallFinished.wakeAll();
+        }
+
+        if (mRunningJobs == 0)
+            break;
+
+        mMainThreadWakeUp.wait(&mMutex);
+    }
+    locker.unlock();
+
+    pool.waitForDone();
+
+    if (mReportTimings) {
+        mOutput << QString(QLatin1String("Converted %1 of %2 maps in %3 ms"))
+                   .arg(conversions.size() - mFailedJobs)
+                   .arg(conversions.size())
+                   .arg(timer.elapsed()) << endl;
+    }
+
+    mMapFormats.clear();
+    return mFailedJobs;
+}
+
+SharedTileset TmxConverter::tileset(const QString &fileName, QString *error)
+{
+    QString key = QFileInfo(fileName).canonicalFilePath();
+    if (key.isEmpty())
+        key = fileName;
+
+    QSharedPointer<CachedTileset> cached;
+    {
+        QMutexLocker locker(&mTilesetsMutex);
+        QSharedPointer<CachedTileset> &entry = mTilesets[key];
+        if (!entry)
+            entry = QSharedPointer<CachedTileset>::create();
+        cached = entry;
+    }
+
+    // Only the first job asking for a tileset loads it, others wait for it
+    QMutexLocker locker(&cached->mutex);
+    if (!cached->loaded) {
+        cached->tileset = loadTileset(fileName, &cached->error);
+        cached->loaded = true;
+    }
+
+    if (error)
+        *error = cached->error;
+
+    return cached->tileset;
+}
+
+bool TmxConverter::resolveFormats(Job &job, QString *error) const
+{
+    const QString &sourceFile = job.conversion.sourceFile;
+    const QString &targetFile = job.conversion.targetFile;
+
+    // Maps are read as TMX unless a plugin claims the source file
+    job.reader = nullptr;
+    if (!isTmxFile(sourceFile)) {
+        for (MapFormat *format : mMapFormats) {
+            if (format->hasCapabilities(MapFormat::Read) &&
+                    format->supportsFile(sourceFile)) {
+                job.reader = format;
+                break;
+            }
+        }
+    }
+
+    job.writer = nullptr;
+    if (!mFormatFilter.isEmpty()) {
+        // Find the map format supporting the given filter
+        for (MapFormat *format : mMapFormats) {
+            if (!format->hasCapabilities(MapFormat::Write))
+                continue;
+            if (format->nameFilter().compare(mFormatFilter, Qt::CaseInsensitive) == 0) {
+                job.writer = format;
+                return true;
+            }
+        }
+        if (mFormatFilter.compare(QLatin1String("tmx"), Qt::CaseInsensitive) == 0)
+            return true;
+
+        *error = QLatin1String("Format not recognized (see --export-formats)");
+        return false;
+    }
+
+    if (isTmxFile(targetFile))
+        return true;
+
+    // Find the map format based on target file extension
+    const QString suffix = QFileInfo(targetFile).completeSuffix();
+    for (MapFormat *format : mMapFormats) {
+        if (!format->hasCapabilities(MapFormat::Write))
+            continue;
+        if (format->nameFilter().contains(suffix, Qt::CaseInsensitive)) {
+            if (job.writer) {
+                *error = QLatin1String("Non-unique file extension. Can't determine correct export format.");
+                return false;
+            }
+            job.writer = format;
+        }
+    }
+
+    if (!job.writer) {
+        *error = QLatin1String("No exporter found for target file.");
+        return false;
+    }
+
+    return true;
+}
+
+void TmxConverter::run(const Job &job)
+{
+    QElapsedTimer timer;
+    timer.start();
+
+    QString error;
+    QScopedPointer<Map> map(readMap(job, &error));
+    if (map)
+        writeMap(map.data(), job, &error);
+
+    report(job.conversion, error, timer.elapsed());
+
+    QMutexLocker locker(&mMutex);
+    --mRunningJobs;
+    mMainThreadWakeUp.wakeAll();
+}
+
+Map *TmxConverter::readMap(const Job &job, QString *error)
+{
+    const QString &fileName = job.conversion.sourceFile;
+    Map *map = nullptr;
+
+    if (MapFormat *format = job.reader) {
+        runOnMainThread([&] {
+            map = format->read(fileName);
+            if (!map)
+                *error = format->errorString();
+        });
+    } else {
+        CachingMapReader reader(*this);
+        map = reader.readMap(fileName);
+        if (!map)
+            *error = reader.errorString();
+    }
+
+    if (!map && error->isEmpty())
+        *error = QLatin1String("Failed to load source map.");
+
+    return map;
+}
+
+bool TmxConverter::writeMap(const Map *map, const Job &job, QString *error)
+{
+    const QString &fileName = job.conversion.targetFile;
+    bool success = false;
+
+    if (MapFormat *format = job.writer) {
+        runOnMainThread([&] {
+            success = format->write(map, fileName);
+            if (!success)
+                *error = format->errorString();
+        });
+    } else {
+        MapWriter writer;
+        success = writer.writeMap(map, fileName);
+        if (!success)
+            *error = writer.errorString();
+    }
+
+    if (!success && error->isEmpty())
+        *error = QLatin1String("Failed to export map to target file.");
+
+    return success;
+}
+
+SharedTileset TmxConverter::loadTileset(const QString &fileName, QString *error)
+{
+    for (TilesetFormat *format : PluginManager::objects<TilesetFormat>()) {
+        if (!format->supportsFile(fileName))
+            continue;
+
+        SharedTileset tileset;
+        runOnMainThread([&] {
+            tileset = format->read(fileName);
+            if (!tileset)
+                *error = format->errorString();
+        });
+        return tileset;
+    }
+
+    MapReader reader;
+    SharedTileset tileset = reader.readTileset(fileName);
+    if (!tileset)
+        *error = reader.errorString();
+
+    return tileset;
+}
+
+/**
+ * Queues the given \a function to be called on the main thread, and waits
+ * until it has been called.
+ */
+void TmxConverter::runOnMainThread(const std::function<void()> &function)
+{
+    MainThreadCall call;
+    call.function = function;
+    call.done = false;
+
+    QMutexLocker locker(&mMutex);
+    mMainThreadCalls.append(&call);
+    mMainThreadWakeUp.wakeAll();
+
+    while (!call.done)
+        mCallFinished.wait(&mMutex);
+}
+
+void TmxConverter::report(const Conversion &conversion, const QString &error,
+                          qint64 elapsed)
+{
+    QMutexLocker locker(&mReportMutex);
+
+    if (!error.isEmpty()) {
+        ++mFailedJobs;
+        qWarning() << qPrintable(QString(QLatin1String("Failed to convert %1: %2"))
+                                 .arg(conversion.sourceFile, error));
+        return;
+    }
+
+    if (mReportTimings) {
+        mOutput << QString(QLatin1String("%1 -> %2 (%3 ms)"))
+                   .arg(conversion.sourceFile,
+                        conversion.targetFile,
+                        QString::number(elapsed)) << endl;
+    }
+}
@@ -0,0 +1,166 @@
+/*
+ * tmxconverter.h
+ * Copyright 2016, Tiled contributors
+ *
+ * This file is part of the TMX Converter.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *    1. Redistributions of source code must retain the above copyright notice,
+ *       this list of conditions and the following disclaimer.
+ *
+ *    2. Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE CONTRIBUTORS ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO
+ * EVENT SHALL THE CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ * OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+ * ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef TMXCONVERTER_H
+#define TMXCONVERTER_H
+
+#include "tileset.h"
+
+#include <QHash>
+#include <QList>
+#include <QMutex>
+#include <QSharedPointer>
+#include <QString>
+#include <QTextStream>
+#include <QVector>
+#include <QWaitCondition>
+
+#include <functional>
+
+namespace Tiled {
+class Map;
+class MapFormat;
+}
+
+/**
+ * A map to convert, and the file it should be written to.
+ */
+struct Conversion
+{
+    Conversion() {}
+    Conversion(const QString &sourceFile, const QString &targetFile)
+        : sourceFile(sourceFile)
+        , targetFile(targetFile)
+    {}
+
+    QString sourceFile;
+    QString targetFile;
+};
+
+/**
+ * Converts many maps in one go, running the conversions on a pool of worker
+ * threads.
+ *
+ * TMX maps are read and written on the worker threads, and external tilesets
+ * are loaded only once and shared between all maps that use them. Map and
+ * tileset formats provided by plugins are not expected to be thread-safe, so
+ * calls into them are made one at a time on the main thread.
+ */
+class TmxConverter
+{
+public:
+    TmxConverter();
+
+    /**
+     * Sets the number of conversions that run in parallel. Defaults to
+     * QThread::idealThreadCount().
+     */
+    void setJobCount(int jobCount) { mJobCount = jobCount; }
+    int jobCount() const { return mJobCount; }
+
+    /**
+     * Sets the name filter of the format to write the maps in. When empty,
+     * the format is determined by the extension of each target file.
+     */
+    void setFormatFilter(const QString &filter) { mFormatFilter = filter; }
+
+    /**
+     * Sets whether the time taken by each conversion is reported.
+     */
+    void setReportTimings(bool reportTimings) { mReportTimings = reportTimings; }
+
+    /**
+     * Converts the given maps. Has to be called from the main thread, after
+     * the plugins have been loaded.
+     *
+     * Returns the number of conversions that failed.
+     */
+    int convert(const QVector<Conversion> &conversions);
+
+    /**
+     * Returns the tileset stored in \a fileName, loading it when it is
+     * requested for the first time. Safe to call from any thread.
+     */
+    Tiled::SharedTileset tileset(const QString &fileName, QString *error);
+
+private:
+    struct Job
+    {
+        Conversion conversion;
+        Tiled::MapFormat *reader;   // nullptr for TMX
+        Tiled::MapFormat *writer;   // nullptr for TMX
+    };
+
+    struct CachedTileset
+    {
+        CachedTileset() : loaded(false) {}
+
+        QMutex mutex;
+        bool loaded;
+        Tiled::SharedTileset tileset;
+        QString error;
+    };
+
+    struct MainThreadCall
+    {
+        std::function<void()> function;
+        bool done;
+    };
+
+    bool resolveFormats(Job &job, QString *error) const;
+    void run(const Job &job);
+
+    Tiled::Map *readMap(const Job &job, QString *error);
+    bool writeMap(const Tiled::Map *map, const Job &job, QString *error);
+    Tiled::SharedTileset loadTileset(const QString &fileName, QString *error);
+
+    void runOnMainThread(const std::function<void()> &function);
+    void report(const Conversion &conversion, const QString &error,
+                qint64 elapsed);
+
+    int mJobCount;
+    QString mFormatFilter;
+    bool mReportTimings;
+    QList<Tiled::MapFormat*> mMapFormats;
+
+    QMutex mTilesetsMutex;
+    QHash<QString, QSharedPointer<CachedTileset>> mTilesets;
+
+    // Protects the calls queued for the main thread and the job counters
+    QMutex mMutex;
+    QWaitCondition mMainThreadWakeUp;
+    QWaitCondition mCallFinished;
+    QList<MainThreadCall*> mMainThreadCalls;
+    int mRunningJobs;
+    int mFailedJobs;
+
+    QMutex mReportMutex;
+    QTextStream mOutput;
+};
+
+#endif // TMXCONVERTER_H
@@ -29,11 +29,10 @@
 #include "tmxrasterizer.h"
 
 #include "hexagonalrenderer.h"
-#include "imagelayer.h"
 #include "isometricrenderer.h"
 #include "map.h"
+#include "mapcompositor.h"
 #include "mapreader.h"
-#include "objectgroup.h"
 #include "orthogonalrenderer.h"
 #include "staggeredrenderer.h"
 #include "tilelayer.h"
@@ -55,7 +54,7 @@ TmxRasterizer::~TmxRasterizer()
 {
 }
 
-bool TmxRasterizer::shouldDrawLayer(Layer *layer)
+bool TmxRasterizer::shouldDrawLayer(const Layer *layer) const
 {
     if (layer->isObjectGroup())
         return false;
@@ -75,6 +74,8 @@ int TmxRasterizer::render(const QString &mapFileName,
     Map *map;
     MapRenderer *renderer;
     MapReader reader;
+    // Only the layers that are drawn need their data decoded
+    reader.setLazyLayerLoading(true);
     map = reader.readMap(mapFileName);
     if (!map) {
         qWarning().nospace() << "Error while reading " << mapFileName << ":\n"
@@ -130,26 +131,29 @@ int TmxRasterizer::render(const QString &mapFileName,
 
     painter.translate(margins.left(), margins.top());
 
-    // Perform a similar rendering than found in exportasimagedialog.cpp
+    // Load the data of the layers that are drawn
     for (Layer *layer : map->layers()) {
-        if (!shouldDrawLayer(layer)) 
+        if (!shouldDrawLayer(layer))
             continue;
 
-        painter.setOpacity(layer->opacity());
-        painter.translate(layer->offset());
-
-        const TileLayer *tileLayer = dynamic_cast<const TileLayer*>(layer);
-        const ImageLayer *imageLayer = dynamic_cast<const ImageLayer*>(layer);
-
-        if (tileLayer) {
-            renderer->drawTileLayer(&painter, tileLayer);
-        } else if (imageLayer) {
-            renderer->drawImageLayer(&painter, imageLayer);
+        if (TileLayer *tileLayer = layer->asTileLayer()) {
+            QString error;
+            if (!tileLayer->loadData(&error)) {
+                qWarning().nospace() << "Error while reading " << mapFileName << ":\n"
+                                     << qPrintable(error);
+                delete renderer;
+                delete map;
+                return 1;
+            }
         }
-
-        painter.translate(-layer->offset());
     }
 
+    MapCompositor compositor(renderer);
+    compositor.setLayerFilter([this] (const Layer *layer) {
+        return shouldDrawLayer(layer);
+    });
+    compositor.render(&painter);
+
     delete renderer;
     delete map;
 
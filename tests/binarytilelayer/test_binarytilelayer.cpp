@@ -0,0 +1,173 @@
+#include "tilelayerbinaryformat.h"
+
+#include "map.h"
+#include "tile.h"
+#include "tilelayer.h"
+
+#include <QtTest/QtTest>
+
+#include <memory>
+
+using namespace Tiled;
+using namespace Tiled::Internal;
+
+static SharedTileset createTileset(int tileCount)
+{
+    SharedTileset tileset = Tileset::create(QLatin1String("Tiles"), 16, 16);
+    for (int i = 0; i < tileCount; ++i)
+        tileset->addTile(QPixmap());
+    return tileset;
+}
+
+/**
+ * Creates a map with a single 3x2 tile layer using the given tileset, in
+ * which the last tile is used.
+ */
+static Map *createMap(const SharedTileset &tileset)
+{
+    Map *map = new Map(Map::Orthogonal, 3, 2, 16, 16);
+    map->addTileset(tileset);
+
+    TileLayer *tileLayer = new TileLayer(QLatin1String("Ground"), 1, 2, 3, 2);
+    tileLayer->setOpacity(0.5f);
+    tileLayer->setVisible(false);
+    tileLayer->setProperty(QLatin1String("kind"), QLatin1String("grass"));
+
+    Cell flipped(tileset->findTile(1));
+    flipped.flippedHorizontally = true;
+    flipped.flippedAntiDiagonally = true;
+
+    tileLayer->setCell(0, 0, Cell(tileset->findTile(0)));
+    tileLayer->setCell(1, 0, flipped);
+    tileLayer->setCell(2, 1, Cell(tileset->findTile(tileset->tileCount() - 1)));
+
+    map->addLayer(tileLayer);
+    return map;
+}
+
+class test_BinaryTileLayer : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void roundTrip();
+    void truncated();
+    void unknownGid();
+    void missingExternalTileset();
+};
+
+void test_BinaryTileLayer::roundTrip()
+{
+    const SharedTileset tileset = createTileset(4);
+    const std::unique_ptr<Map> map(createMap(tileset));
+    QVERIFY(canWriteBinaryTileLayer(map.get()));
+
+    const QByteArray data = writeBinaryTileLayer(map.get());
+    const std::unique_ptr<Map> result(readBinaryTileLayer(data));
+    QVERIFY(result);
+
+    QCOMPARE(result->orientation(), Map::Orthogonal);
+    QCOMPARE(result->width(), 3);
+    QCOMPARE(result->height(), 2);
+
+    // Embedded tilesets are read as new instances
+    QCOMPARE(result->tilesetCount(), 1);
+    const SharedTileset resultTileset = result->tilesets().first();
+    QVERIFY(resultTileset != tileset);
+    QCOMPARE(resultTileset->tileCount(), 4);
+
+    QCOMPARE(result->layerCount(), 1);
+    const TileLayer *original = map->layerAt(0)->asTileLayer();
+    const TileLayer *tileLayer = result->layerAt(0)->asTileLayer();
+    QVERIFY(tileLayer);
+
+    QCOMPARE(tileLayer->name(), QString(QLatin1String("Ground")));
+    QCOMPARE(tileLayer->position(), QPoint(1, 2));
+    QCOMPARE(tileLayer->size(), QSize(3, 2));
+    QCOMPARE(tileLayer->opacity(), 0.5f);
+    QCOMPARE(tileLayer->isVisible(), false);
+    QCOMPARE(tileLayer->property(QLatin1String("kind")).toString(),
+             QString(QLatin1String("grass")));
+
+    for (int y = 0; y < tileLayer->height(); ++y) {
+        for (int x = 0; x < tileLayer->width(); ++x) {
+            const Cell &expected = original->cellAt(x, y);
+            const Cell &cell = tileLayer->cellAt(x, y);
+
+            QCOMPARE(cell.isEmpty(), expected.isEmpty());
+            QCOMPARE(cell.flippedHorizontally, expected.flippedHorizontally);
+            QCOMPARE(cell.flippedVertically, expected.flippedVertically);
+            QCOMPARE(cell.flippedAntiDiagonally, expected.flippedAntiDiagonally);
+
+            if (!cell.isEmpty()) {
+                QCOMPARE(cell.tile->id(), expected.tile->id());
+                QCOMPARE(cell.tile->tileset(), resultTileset.data());
+            }
+        }
+    }
+}
+
+void test_BinaryTileLayer::truncated()
+{
+    const std::unique_ptr<Map> map(createMap(createTileset(4)));
+    const QByteArray data = writeBinaryTileLayer(map.get());
+
+    for (int length = 0; length < data.size(); ++length) {
+        const std::unique_ptr<Map> result(readBinaryTileLayer(data.left(length)));
+        QVERIFY2(!result, qPrintable(QString::number(length)));
+    }
+}
+
+void test_BinaryTileLayer::unknownGid()
+{
+    const SharedTileset tileset = createTileset(4);
+    tileset->setFileName(QLatin1String("tiles.tsx"));
+
+    const std::unique_ptr<Map> map(createMap(tileset));
+    const QByteArray data = writeBinaryTileLayer(map.get());
+
+    // The external tileset lost its last tile since the data was written
+    const SharedTileset changedTileset = createTileset(3);
+    const auto readExternalTileset = [&] (const QString &fileName) {
+        return fileName == tileset->fileName() ? changedTileset : SharedTileset();
+    };
+
+    const std::unique_ptr<Map> result(readBinaryTileLayer(data, readExternalTileset));
+    QVERIFY(!result);
+
+    // No tile was created for the unknown GID
+    QCOMPARE(changedTileset->tileCount(), 3);
+
+    // With all tiles present, the same data can be read
+    const SharedTileset sameTileset = createTileset(4);
+    const std::unique_ptr<Map> sameResult(readBinaryTileLayer(data, [&] (const QString &) {
+        return sameTileset;
+    }));
+    QVERIFY(sameResult);
+    QCOMPARE(sameResult->tilesets().first(), sameTileset);
+}
+
+void test_BinaryTileLayer::missingExternalTileset()
+{
+    const QDir tempDir(QDir::tempPath());
+    const QString fileName = tempDir.filePath(QLatin1String("tiled-missing-tileset.tsx"));
+    QVERIFY(!QFile::exists(fileName));
+
+    const SharedTileset tileset = createTileset(4);
+    tileset->setFileName(fileName);
+
+    const std::unique_ptr<Map> map(createMap(tileset));
+    const QByteArray data = writeBinaryTileLayer(map.get());
+
+    // The tileset file is read from disk by default
+    const std::unique_ptr<Map> result(readBinaryTileLayer(data));
+    QVERIFY(!result);
+
+    const std::unique_ptr<Map> readerResult(readBinaryTileLayer(data, [] (const QString &) {
+        return SharedTileset();
+    }));
+    QVERIFY(!readerResult);
+}
+
+QTEST_MAIN(test_BinaryTileLayer)
+#include "test_binarytilelayer.moc"
@@ -0,0 +1,256 @@
+#include "jsonstreamreader.h"
+#include "jsonstreamwriter.h"
+
+#include <QBuffer>
+#include <QtTest/QtTest>
+
+using namespace Json;
+
+typedef QVector<unsigned> PackedData;
+
+static QVariant read(const QByteArray &json,
+                     bool skipPrefix = false,
+                     QString *error = nullptr)
+{
+    QBuffer buffer;
+    buffer.setData(json);
+    buffer.open(QIODevice::ReadOnly);
+
+    JsonStreamReader reader(&buffer);
+    reader.setSkipPrefix(skipPrefix);
+
+    if (!reader.parse()) {
+        if (error)
+            *error = reader.errorString();
+        return QVariant();
+    }
+
+    return reader.result();
+}
+
+static QByteArray write(const QVariant &variant)
+{
+    QBuffer buffer;
+    buffer.open(QIODevice::WriteOnly);
+
+    JsonStreamWriter writer(&buffer);
+    writer.write(variant);
+    writer.flush();
+
+    return buffer.data();
+}
+
+class test_JsonStream : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void stringRoundTrip_data();
+    void stringRoundTrip();
+    void writtenEscapes();
+
+    void surrogatePairs();
+    void invalidSurrogatePairs();
+
+    void jsonpPrefix();
+
+    void numbers_data();
+    void numbers();
+    void invalidNumbers();
+
+    void packedData();
+    void packedRoundTrip();
+
+    void truncated();
+};
+
+void test_JsonStream::stringRoundTrip_data()
+{
+    QTest::addColumn<QString>("string");
+
+    QTest::newRow("empty") << QString();
+    QTest::newRow("plain") << QString(QLatin1String("Some tile layer"));
+    QTest::newRow("quotes") << QString(QLatin1String("say \"hi\" \\ bye"));
+    QTest::newRow("control") << QString(QLatin1String("a\bb\fc\nd\re\tf"));
+    QTest::newRow("slash") << QString(QLatin1String("maps/level1.json"));
+    QTest::newRow("latin1") << QString::fromUtf8("caf\xC3\xA9");
+    QTest::newRow("bmp") << QString::fromUtf8("\xE2\x82\xAC 100");
+    QTest::newRow("surrogates") << QString::fromUtf8("\xF0\x9F\x98\x80!");
+}
+
+void test_JsonStream::stringRoundTrip()
+{
+    QFETCH(QString, string);
+
+    QVariantMap map;
+    map.insert(string, string);
+
+    const QVariant result = read(write(map));
+    QCOMPARE(result.toMap(), map);
+}
+
+void test_JsonStream::writtenEscapes()
+{
+    const QVariantList list {
+        QString(QLatin1String("a\"/\n")),
+        QString::fromUtf8("\xF0\x9F\x98\x80")
+    };
+
+    QCOMPARE(write(list),
+             QByteArray("[\"a\\\"\\/\\n\",\"\\ud83d\\ude00\"]"));
+}
+
+void test_JsonStream::surrogatePairs()
+{
+    const QVariant result = read("[\"\\ud83d\\ude00\", \"\\uD83D\\uDE00\", \"\\u00e9\"]");
+    const QVariantList list = result.toList();
+
+    QCOMPARE(list.size(), 3);
+    QCOMPARE(list.at(0).toString(), QString::fromUtf8("\xF0\x9F\x98\x80"));
+    QCOMPARE(list.at(1).toString(), QString::fromUtf8("\xF0\x9F\x98\x80"));
+    QCOMPARE(list.at(2).toString(), QString::fromUtf8("\xC3\xA9"));
+}
+
+void test_JsonStream::invalidSurrogatePairs()
+{
+    QString error;
+
+    QVERIFY(!read("[\"\\ud83d\"]", false, &error).isValid());
+    QVERIFY(!error.isEmpty());
+
+    error.clear();
+    QVERIFY(!read("[\"\\ud83d\\u0041\"]", false, &error).isValid());
+    QVERIFY(!error.isEmpty());
+
+    error.clear();
+    QVERIFY(!read("[\"\\u12g4\"]", false, &error).isValid());
+    QVERIFY(!error.isEmpty());
+}
+
+void test_JsonStream::jsonpPrefix()
+{
+    const QByteArray jsonp("loadMap(\n{\"width\":2}\n);\n");
+
+    const QVariantMap map = read(jsonp, true).toMap();
+    QCOMPARE(map.value(QLatin1String("width")).toInt(), 2);
+
+    // Without skipping the prefix, the file is not valid JSON
+    QString error;
+    QVERIFY(!read(jsonp, false, &error).isValid());
+    QVERIFY(!error.isEmpty());
+
+    // A byte order mark is skipped in both cases
+    const QByteArray bom("\xEF\xBB\xBF");
+    QCOMPARE(read(bom + "{\"width\":3}").toMap().value(QLatin1String("width")).toInt(), 3);
+    QCOMPARE(read(bom + jsonp, true).toMap().value(QLatin1String("width")).toInt(), 2);
+}
+
+void test_JsonStream::numbers_data()
+{
+    QTest::addColumn<QByteArray>("json");
+    QTest::addColumn<QVariant>("expected");
+
+    QTest::newRow("zero") << QByteArray("0") << QVariant(qlonglong(0));
+    QTest::newRow("negative") << QByteArray("-1") << QVariant(qlonglong(-1));
+    QTest::newRow("integer") << QByteArray("42") << QVariant(qlonglong(42));
+    QTest::newRow("18 digits") << QByteArray("123456789012345678")
+                               << QVariant(qlonglong(123456789012345678LL));
+    QTest::newRow("20 digits") << QByteArray("12345678901234567890")
+                               << QVariant(12345678901234567890.0);
+    QTest::newRow("fraction") << QByteArray("1.5") << QVariant(1.5);
+    QTest::newRow("exponent") << QByteArray("-2.5e3") << QVariant(-2500.0);
+    QTest::newRow("positive exponent") << QByteArray("1E+2") << QVariant(100.0);
+}
+
+void test_JsonStream::numbers()
+{
+    QFETCH(QByteArray, json);
+    QFETCH(QVariant, expected);
+
+    const QVariantList list = read("[" + json + "]").toList();
+    QCOMPARE(list.size(), 1);
+    QCOMPARE(list.first().userType(), expected.userType());
+    QCOMPARE(list.first(), expected);
+
+    // Written numbers read back the same, though large numbers lose some
+    // precision since they are written with 15 significant digits
+    const QVariantList written = read(write(list)).toList();
+    QCOMPARE(written.size(), 1);
+    QCOMPARE(written.first().toDouble(), expected.toDouble());
+}
+
+void test_JsonStream::invalidNumbers()
+{
+    QString error;
+    QVERIFY(!read("[1-2]", false, &error).isValid());
+    QVERIFY(!error.isEmpty());
+
+    error.clear();
+    QVERIFY(!read("[-]", false, &error).isValid());
+    QVERIFY(!error.isEmpty());
+}
+
+void test_JsonStream::packedData()
+{
+    const int packedType = qMetaTypeId<PackedData>();
+
+    // The data of tile layers is packed, regardless of the key order
+    QVariantMap layer = read("{\"type\":\"tilelayer\",\"data\":[0,1,2]}").toMap();
+    QCOMPARE(layer.value(QLatin1String("data")).userType(), packedType);
+    QCOMPARE(layer.value(QLatin1String("data")).value<PackedData>(),
+             PackedData({ 0, 1, 2 }));
+
+    layer = read("{\"data\":[3,4],\"type\":\"tilelayer\"}").toMap();
+    QCOMPARE(layer.value(QLatin1String("data")).value<PackedData>(),
+             PackedData({ 3, 4 }));
+
+    layer = read("{\"data\":[],\"type\":\"tilelayer\"}").toMap();
+    QCOMPARE(layer.value(QLatin1String("data")).userType(), packedType);
+
+    // Arrays named "data" elsewhere are left alone
+    const QVariantList expected { qlonglong(1), qlonglong(2) };
+
+    QVariantMap object = read("{\"type\":\"objectgroup\",\"data\":[1,2]}").toMap();
+    QCOMPARE(object.value(QLatin1String("data")).toList(), expected);
+
+    object = read("{\"properties\":{\"data\":[1,2]}}").toMap();
+    object = object.value(QLatin1String("properties")).toMap();
+    QCOMPARE(object.value(QLatin1String("data")).userType(), int(QMetaType::QVariantList));
+    QCOMPARE(object.value(QLatin1String("data")).toList(), expected);
+
+    // Tile layer data that isn't all unsigned integers is not packed
+    layer = read("{\"type\":\"tilelayer\",\"data\":[1,-2,3.5]}").toMap();
+    const QVariantList mixed { qlonglong(1), qlonglong(-2), 3.5 };
+    QCOMPARE(layer.value(QLatin1String("data")).toList(), mixed);
+}
+
+void test_JsonStream::packedRoundTrip()
+{
+    const PackedData data { 0, 1, 2147483648u, 4294967295u };
+
+    QVariantMap layer;
+    layer.insert(QLatin1String("type"), QLatin1String("tilelayer"));
+    layer.insert(QLatin1String("data"), QVariant::fromValue(data));
+
+    const QByteArray json = write(layer);
+    QVERIFY(json.contains("[0,1,2147483648,4294967295]"));
+
+    const QVariantMap result = read(json).toMap();
+    QCOMPARE(result.value(QLatin1String("data")).value<PackedData>(), data);
+}
+
+void test_JsonStream::truncated()
+{
+    const QByteArray json("{\"type\":\"tilelayer\",\"data\":[1,2,3],\"name\":\"Ground\"}");
+    QVERIFY(read(json).isValid());
+
+    for (int length = 1; length < json.size(); ++length) {
+        QString error;
+        QVERIFY2(!read(json.left(length), false, &error).isValid(),
+                 json.left(length).constData());
+        QVERIFY(!error.isEmpty());
+    }
+}
+
+QTEST_MAIN(test_JsonStream)
+#include "test_jsonstream.moc"
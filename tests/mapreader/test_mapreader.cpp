@@ -14,6 +14,7 @@ class test_MapReader : public QObject
 
 private slots:
     void loadMap();
+    void loadMapLazily();
 };
 
 void test_MapReader::loadMap()
@@ -53,5 +54,54 @@ void test_MapReader::loadMap()
     QCOMPARE(mapObject->height(), qreal(64));
 }
 
+void test_MapReader::loadMapLazily()
+{
+    MapReader eagerReader;
+    QScopedPointer<Map> eagerMap(eagerReader.readMap("../data/layerdata.tmx"));
+    QVERIFY(eagerMap);
+
+    MapReader reader;
+    reader.setLazyLayerLoading(true);
+    QScopedPointer<Map> map(reader.readMap("../data/layerdata.tmx"));
+    QVERIFY(map);
+
+    TileLayer *eagerLayer = dynamic_cast<TileLayer*>(eagerMap->layerAt(0));
+    TileLayer *tileLayer = dynamic_cast<TileLayer*>(map->layerAt(0));
+
+    QVERIFY(eagerLayer);
+    QVERIFY(tileLayer);
+    QVERIFY(eagerLayer->isDataLoaded());
+    QVERIFY(!tileLayer->isDataLoaded());
+    QCOMPARE(tileLayer->width(), 4);
+    QCOMPARE(tileLayer->height(), 3);
+
+    // Accessing a cell decodes the data
+    QVERIFY(!tileLayer->cellAt(0, 0).isEmpty());
+    QVERIFY(tileLayer->isDataLoaded());
+
+    QString error;
+    QVERIFY(tileLayer->loadData(&error));
+    QVERIFY(error.isEmpty());
+    QVERIFY(!tileLayer->isEmpty());
+
+    for (int y = 0; y < eagerLayer->height(); ++y) {
+        for (int x = 0; x < eagerLayer->width(); ++x) {
+            const Cell &expected = eagerLayer->cellAt(x, y);
+            const Cell &cell = tileLayer->cellAt(x, y);
+
+            QCOMPARE(cell.isEmpty(), expected.isEmpty());
+            QCOMPARE(cell.flippedHorizontally, expected.flippedHorizontally);
+            QCOMPARE(cell.flippedVertically, expected.flippedVertically);
+            QCOMPARE(cell.flippedAntiDiagonally, expected.flippedAntiDiagonally);
+            if (!expected.isEmpty())
+                QCOMPARE(cell.tile->id(), expected.tile->id());
+        }
+    }
+
+    QVERIFY(tileLayer->cellAt(1, 1).flippedHorizontally);
+    QVERIFY(tileLayer->cellAt(2, 1).flippedVertically);
+    QCOMPARE(tileLayer->region(), eagerLayer->region());
+}
+
 QTEST_MAIN(test_MapReader)
 #include "test_mapreader.moc"
@@ -0,0 +1,112 @@
+#include "selectionmask.h"
+
+#include <QtTest/QtTest>
+
+using namespace Tiled;
+
+class test_SelectionMask : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void empty();
+    void rect();
+
+    void operations_data();
+    void operations();
+
+    void rects();
+    void translate();
+};
+
+void test_SelectionMask::empty()
+{
+    SelectionMask mask;
+    QVERIFY(mask.isEmpty());
+    QCOMPARE(mask.boundingRect(), QRect());
+    QVERIFY(mask.rects().isEmpty());
+    QVERIFY(mask.toRegion().isEmpty());
+    QCOMPARE(mask, SelectionMask(QRegion()));
+}
+
+void test_SelectionMask::rect()
+{
+    const QRect rect(-3, 2, 130, 4);
+    SelectionMask mask(rect);
+
+    QCOMPARE(mask.boundingRect(), rect);
+    QVERIFY(mask.contains(-3, 2));
+    QVERIFY(mask.contains(126, 5));
+    QVERIFY(!mask.contains(127, 5));
+    QVERIFY(!mask.contains(-4, 2));
+    QCOMPARE(mask.toRegion(), QRegion(rect));
+
+    mask.remove(QRect(0, 0, 200, 10));
+    QCOMPARE(mask.boundingRect(), QRect(-3, 2, 3, 4));
+}
+
+void test_SelectionMask::operations_data()
+{
+    QTest::addColumn<QRegion>("a");
+    QTest::addColumn<QRegion>("b");
+
+    QTest::newRow("disjoint")
+            << QRegion(0, 0, 10, 10)
+            << QRegion(20, 20, 10, 10);
+    QTest::newRow("overlapping")
+            << QRegion(0, 0, 100, 10)
+            << QRegion(50, 5, 100, 10);
+    QTest::newRow("unaligned")
+            << (QRegion(-70, 0, 3, 1) + QRegion(10, 3, 200, 2))
+            << (QRegion(-65, 0, 140, 4) - QRegion(5, 1, 2, 2));
+    QTest::newRow("empty")
+            << QRegion(5, 5, 70, 3)
+            << QRegion();
+}
+
+void test_SelectionMask::operations()
+{
+    QFETCH(QRegion, a);
+    QFETCH(QRegion, b);
+
+    const SelectionMask maskA(a);
+    const SelectionMask maskB(b);
+
+    QCOMPARE((maskA | maskB).toRegion(), a.united(b));
+    QCOMPARE((maskA & maskB).toRegion(), a.intersected(b));
+    QCOMPARE((maskA - maskB).toRegion(), a.subtracted(b));
+    QCOMPARE((maskA ^ maskB).toRegion(), a.xored(b));
+
+    QCOMPARE((maskA | maskB).boundingRect(), a.united(b).boundingRect());
+    QCOMPARE(maskA | maskB, SelectionMask(a.united(b)));
+}
+
+void test_SelectionMask::rects()
+{
+    // A checkerboard can't be merged into larger rects
+    const SelectionMask checkers =
+            SelectionMask::fromCondition(QRect(0, 0, 100, 100),
+                                         [] (int x, int y) { return (x + y) % 2; });
+    QCOMPARE(checkers.rects().size(), 100 * 100 / 2);
+
+    // Identical rows are merged into a single band
+    const SelectionMask stripes =
+            SelectionMask::fromCondition(QRect(0, 0, 100, 100),
+                                         [] (int x, int) { return x % 3 == 0; });
+    QCOMPARE(stripes.rects().size(), 34);
+    QCOMPARE(stripes.rects().first(), QRect(0, 0, 1, 100));
+}
+
+void test_SelectionMask::translate()
+{
+    const QRegion region = QRegion(0, 0, 65, 2) + QRegion(3, 4, 10, 10);
+    const SelectionMask mask(region);
+
+    QCOMPARE(mask.translated(QPoint(-7, 9)).toRegion(),
+             region.translated(-7, 9));
+    QCOMPARE(mask.translated(QPoint(-7, 9)).boundingRect(),
+             region.boundingRect().translated(-7, 9));
+}
+
+QTEST_MAIN(test_SelectionMask)
+#include "test_selectionmask.moc"
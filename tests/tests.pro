@@ -1,4 +1,7 @@
 TEMPLATE=subdirs
 SUBDIRS = \
+    binarytilelayer \
+    jsonstream \
     mapreader \
+    selectionmask \
     staggeredrenderer